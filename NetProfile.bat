@@ -0,0 +1,27 @@
+@echo off
+rem Starts a local dedicated server and N headless clients, and records a cpu / net trace on the server.
+rem Run once with PushModel=0 and once with PushModel=1, then compare ServerReplicateActors in Unreal Insights.
+rem Usage: NetProfile.bat <UnrealEditor-Cmd.exe> [Clients=100] [PushModel=1]
+set workdir=%~dp0
+set editor=%~1
+set clients=%~2
+set pushmodel=%~3
+if "%editor%"=="" (
+echo Usage: NetProfile.bat ^<UnrealEditor-Cmd.exe^> [Clients=100] [PushModel=1]
+exit /b 1
+)
+if "%clients%"=="" set clients=100
+if "%pushmodel%"=="" set pushmodel=1
+set project=%workdir%ThirdPerson.uproject
+set tracefile=%workdir%Saved\Profiling\NetProfile_Push%pushmodel%_%clients%.utrace
+
+start "NetProfile Server" "%editor%" "%project%" /Game/Maps/ThirdPersonExampleMap -server -log -nullrhi -NetTrace=1 -trace=cpu,net,stats -statnamedevents -tracefile="%tracefile%" -ini:Engine:[SystemSettings]:Net.IsPushModelEnabled=%pushmodel%
+
+rem Give the server time to load the map
+timeout /t 30 /nobreak > nul
+
+for /l %%i in (1,1,%clients%) do (
+start "NetProfile Client %%i" /min "%editor%" "%project%" 127.0.0.1 -game -nullrhi -nosound -unattended -nosplash -log=NetProfileClient%%i.log
+)
+
+echo Started %clients% clients, Net.IsPushModelEnabled=%pushmodel%, server trace: %tracefile%
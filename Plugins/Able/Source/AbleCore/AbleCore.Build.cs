@@ -42,6 +42,8 @@ namespace UnrealBuildTool.Rules
 			PrivateDependencyModuleNames.AddRange(
 				new string[]
 				{
+					"Json",
+					"NetCore",
 					// ... add private dependencies that you statically link with here ...
 				}
 				);
@@ -13,6 +13,7 @@
 
 class UPrimitiveComponent;
 class UAblAbilityTargetingFilter;
+class FAblTargetIndex;
 
 /* Base class for all our Targeting volumes/types. */
 UCLASS(Abstract, EditInlineNew)
@@ -40,6 +41,9 @@ public:
 	/* Returns true if Targeting is using an Async query. */
 	FORCEINLINE bool IsUsingAsync() const { return m_UseAsync; }
 
+	/* Returns true if Targeting should query the world Target Index rather than the physics scene. */
+	FORCEINLINE bool IsUsingTargetIndex() const { return m_UseTargetIndex; }
+
 	/* Returns the range of this Targeting query.*/
 	FORCEINLINE float GetRange() const { return m_Range; }
 
@@ -67,6 +71,12 @@ protected:
 	/* Runs all Targeting Filters. */
 	void FilterTargets(UAblAbilityContext& Context) const;
 
+	/* Returns the world Target Index if this query should use it, otherwise nullptr and the physics scene should be used. */
+	const FAblTargetIndex* GetTargetIndex(const UWorld* World) const;
+
+	/* Adds the Target Index results as Targets and runs all Targeting Filters. */
+	void ProcessTargetIndexResults(UAblAbilityContext& Context, const TArray<FAblQueryResult>& Results) const;
+
 	/* If true, the targeting range will be automatically calculated using shape, rotation, and offset information. This does not include socket offsets. */
 	UPROPERTY(EditInstanceOnly, Category = "Targeting|Range", meta = (DisplayName = "Auto-calculate Range"))
 	bool m_AutoCalculateRange;
@@ -108,6 +118,13 @@ protected:
 	*/
 	UPROPERTY(EditInstanceOnly, Category = "Optimization", meta = (DisplayName = "Use Async"))
 	bool m_UseAsync;
+
+	/*
+	*  If true, and the Target Index is enabled in the Able settings, the query is run against the registered Ability Component owners
+	*  in memory rather than the physics scene. Only use this when you only want to target those Actors (e.g. Pawns). Runs synchronously.
+	*/
+	UPROPERTY(EditInstanceOnly, Category = "Optimization", meta = (DisplayName = "Use Target Index"))
+	bool m_UseTargetIndex;
 	
 	/* The Identifier applied to any Dynamic Property methods for this task. This can be used to differentiate multiple tasks of the same type from each other within the same Ability. */
 	UPROPERTY(EditInstanceOnly, Category = "Dynamic Properties", meta = (DisplayName = "Identifier"))
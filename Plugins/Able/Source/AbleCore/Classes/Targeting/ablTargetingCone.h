@@ -40,6 +40,9 @@ private:
 	/* Helper method to process all potential results. */
 	void ProcessResults(UAblAbilityContext& Context, const TArray<struct FOverlapResult>& Results, float _FOV, float _Height, float _Length) const;
 
+	/* Runs the cone test on the candidates (from either the physics scene or the Target Index). */
+	void ProcessResults(UAblAbilityContext& Context, const TArray<FAblQueryResult>& Results, float _FOV, float _Height, float _Length) const;
+
 	/* The Field of View (Angle/Azimuth) of the cone, in degrees. Supports Angles greater than 180 degrees. */
 	UPROPERTY(EditInstanceOnly, Category = "Cone", meta = (DisplayName = "FOV", ClampMin=1.0f, ClampMax=360.0f, AblBindableProperty))
 	float m_FOV; // Azimuth
@@ -74,6 +74,7 @@ public:
 	/* UObject override to fix up any properties. */
 	virtual void PostInitProperties() override;
     void PostLoad() override;
+	virtual bool NeedsLoadForServer() const override;
 	virtual UWorld* GetWorld() const override;
 	virtual int32 GetFunctionCallspace(UFunction* Function, FFrame* Stack) override;
 	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
@@ -120,6 +121,9 @@ public:
 	/* Returns any Tasks we are dependent on. */
 	FORCEINLINE const TArray<const UAblAbilityTask*>& GetTaskDependencies() const { return m_Dependencies; }
 
+	/* Returns true if a Dependency was stripped from this server cook. Such a Task waits on it forever, as it would on a client only Task. */
+	FORCEINLINE bool HasStrippedDependencies() const { return m_HasStrippedDependencies; }
+
 	/* Returns whether to run in verbose mode or not. */
 	FORCEINLINE bool IsVerbose() const { return m_Verbose; }
 
@@ -135,6 +139,10 @@ public:
 	/* Called when a Task is about to begin execution. Used to allocate any run-specific memory requirements. */
 	virtual UAblAbilityTaskScratchPad* CreateScratchPad(const TWeakObjectPtr<UAblAbilityContext>& Context) const { return nullptr; }
 
+	/* Opt in alternative to CreateScratchPad for C++ Tasks. The returned struct is constructed in place, in an arena owned by the Context, rather than as a UObject.
+	 * The arena isn't seen by the Garbage Collector, so the struct must not hold strong UObject references (use TWeakObjectPtr). Read it with Context->GetScratchPadStructForTask<T>(this). */
+	virtual const UScriptStruct* GetScratchPadStruct() const { return nullptr; }
+
 	/* Returns the StatId for this Task, used by the Profiler. */
 	virtual TStatId GetStatId() const { checkNoEntry(); return TStatId(); }
 
@@ -288,6 +296,9 @@ protected:
 	UPROPERTY(EditInstanceOnly, Category = "Internal")
 	TArray<const UAblAbilityTask*> m_Dependencies;
 
+	/* Set in PostLoad when Dependencies were stripped from a server cook. */
+	bool m_HasStrippedDependencies = false;
+
 	/* If true, this task will print out various debug information as it executes. This is automatically disabled in shipping builds. */
 	UPROPERTY(EditInstanceOnly, Category = "Debug", meta=(DisplayName = "Verbose"))
 	bool m_Verbose;
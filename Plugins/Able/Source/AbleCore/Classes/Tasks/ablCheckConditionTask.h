@@ -12,13 +12,15 @@
 class UAblBranchCondition;
 class UInputSettings;
 
-UCLASS(Transient)
-class UAblCheckConditionTaskScratchPad : public UAblAbilityTaskScratchPad
+/* Plain struct ScratchPad, lives in the Context's ScratchPad arena. */
+USTRUCT()
+struct FAblCheckConditionTaskScratchPad
 {
 	GENERATED_BODY()
 public:
-	UAblCheckConditionTaskScratchPad();
-	virtual ~UAblCheckConditionTaskScratchPad();
+	FAblCheckConditionTaskScratchPad()
+		: ConditionMet(false)
+	{ }
 
     /* Cached for the Custom Branch Conditional*/
     UPROPERTY(transient)
@@ -51,8 +53,8 @@ public:
 	/* Returns the Realm to execute this task in. */
 	virtual EAblAbilityTaskRealm GetTaskRealm() const override { return EAblAbilityTaskRealm::ATR_ClientAndServer; } // Client for Auth client, Server for AIs/Proxies.
 
-	/* Create the Scratchpad for this Task. */
-	virtual UAblAbilityTaskScratchPad* CreateScratchPad(const TWeakObjectPtr<UAblAbilityContext>& Context) const;
+	/* Returns the struct Scratchpad for this Task. */
+	virtual const UScriptStruct* GetScratchPadStruct() const override { return FAblCheckConditionTaskScratchPad::StaticStruct(); }
 
 	/* Return the Profiler Stat Id for this Task. */
 	virtual TStatId GetStatId() const override;
@@ -78,7 +80,7 @@ public:
 #endif
 protected:
 	/* Helper method to check our conditions. */
-	bool CheckCondition(const TWeakObjectPtr<const UAblAbilityContext>& Context, const UAblCheckConditionTaskScratchPad& ScratchPad) const;
+	bool CheckCondition(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FAblCheckConditionTaskScratchPad& ScratchPad) const;
 
     // If using Dynamic Branch Ability, this name will be passed along when calling the function (optional).
     UPROPERTY(EditAnywhere, Category = "Branch", meta = (DisplayName = "Custom Event Name"))
@@ -13,6 +13,7 @@
 #include "ablCollisionQueryTypes.generated.h"
 
 struct FAblQueryResult;
+class FAblTargetIndex;
 
 #define LOCTEXT_NAMESPACE "AblAbilityTask"
 
@@ -31,12 +32,18 @@ public:
 	/* Perform the Async Query.*/
 	virtual FTraceHandle DoAsyncQuery(const TWeakObjectPtr<const UAblAbilityContext>& Context, FTransform& OutQueryTransform) const { return FTraceHandle(); }
 
-	/* Returns true, or false, if this Query is Async or not. */
-	FORCEINLINE bool IsAsync() const { return m_UseAsyncQuery; }
+	/* Returns true, or false, if this Query is Async or not. Target Index queries are always synchronous. */
+	FORCEINLINE bool IsAsync() const { return m_UseAsyncQuery && !m_UseTargetIndex; }
+
+	/* Returns true if this Query should use the world Target Index rather than the physics scene. */
+	FORCEINLINE bool IsUsingTargetIndex() const { return m_UseTargetIndex; }
 	
 	/* Returns the World this Query is occurring in.*/
 	UWorld* GetQueryWorld(const TWeakObjectPtr<const UAblAbilityContext>& Context) const;
 
+	/* Returns the world Target Index if this Query should use it, otherwise nullptr and the physics scene should be used. */
+	const FAblTargetIndex* GetTargetIndex(const UWorld* World) const;
+
 	/* Helper method to help process Async Query. */
 	virtual void ProcessAsyncOverlaps(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& QueryTransform, const TArray<FOverlapResult>& Overlaps, TArray<FAblQueryResult>& OutResults) const;
 
@@ -80,6 +87,11 @@ protected:
 	UPROPERTY(EditInstanceOnly, Category = "Optimization", meta = (DisplayName = "Use Async Query"))
 	bool m_UseAsyncQuery;
 
+	/* If true, and the Target Index is enabled in the Able settings, the query is run against the registered Ability Component owners in memory rather than
+	 * the physics scene. Only use this when you only want to hit those Actors (e.g. Pawns). Target Index queries are synchronous. */
+	UPROPERTY(EditInstanceOnly, Category = "Optimization", meta = (DisplayName = "Use Target Index"))
+	bool m_UseTargetIndex;
+
 	/* The Identifier applied to any Dynamic Property methods for this task. This can be used to differentiate multiple tasks of the same type from each other within the same Ability. */
 	UPROPERTY(EditInstanceOnly, Category = "Dynamic Properties", meta = (DisplayName = "Identifier"))
 	FString m_DynamicPropertyIdentifer;
@@ -218,6 +230,9 @@ public:
 	/* Helper method to help process our Async Query*/
 	virtual void ProcessAsyncOverlaps(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& QueryTransform, const TArray<FOverlapResult>& Overlaps, TArray<FAblQueryResult>& OutResults) const;
 
+	/* Runs the cone test on the candidates (from either the physics scene or the Target Index). FOV / Height / Length are packed in the Transform's scale. */
+	void ProcessConeResults(const FTransform& QueryTransform, const TArray<FAblQueryResult>& Candidates, TArray<FAblQueryResult>& OutResults) const;
+
 	/* Bind any Dynamic Delegates */
 	virtual void BindDynamicDelegates(class UAblAbility* Ability) override;
 #if WITH_EDITOR
@@ -33,6 +33,21 @@ public:
 	/* Whether or not the Async query has been processed. */
 	UPROPERTY(transient)
 	bool AsyncProcessed;
+
+	/* Sweep Location samples, for Sub Stepped sweeps. */
+	UPROPERTY(Transient)
+	TArray<FTransform> SubStepTransforms;
+
+	/* Ability time of each Sweep Location sample. */
+	UPROPERTY(Transient)
+	TArray<float> SubStepTimes;
+
+	/* Our Async Handles, one per segment. */
+	TArray<FTraceHandle> SubStepHandles;
+
+	/* Whether or not the Sub Stepped segments have been queued. */
+	UPROPERTY(transient)
+	bool SubStepQueued;
 };
 
 UCLASS()
@@ -59,7 +74,7 @@ public:
 	virtual bool IsSingleFrame() const override { return false; }
 
 	/* Returns true if our Task needs its OnTick method called. */
-	virtual bool NeedsTick() const override { return m_SweepShape ? m_SweepShape->IsAsync() : false; }
+	virtual bool NeedsTick() const override { return m_SweepShape ? m_SweepShape->IsAsync() || m_SubStep : false; }
 	
 	/* Returns the Realm this Task belongs to. */
 	virtual EAblAbilityTaskRealm GetTaskRealm() const override { return m_TaskRealm; }
@@ -119,6 +134,9 @@ private:
 	/* Helper method to copy our query results into the Ability Context. */
 	void CopyResultsToContext(const TArray<FAblQueryResult>& InResults, const TWeakObjectPtr<const UAblAbilityContext>& Context) const;
 
+	/* Samples the Sweep Location if enough time has passed since the last sample (or always, if Force is true). */
+	void SampleSubStep(const TWeakObjectPtr<const UAblAbilityContext>& Context, UAblCollisionSweepTaskScratchPad& ScratchPad, bool Force) const;
+
 	/* Bind our dynamic delegates. */
 	virtual void BindDynamicDelegates(UAblAbility* Ability) override;
 protected:
@@ -134,6 +152,19 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Sweep|Event", meta = (DisplayName = "Name", EditCondition = m_FireEvent))
 	FName m_Name;
 
+	/* If true, the Sweep Location is sampled over the length of the Task and every segment of that path is swept, so fast motion (e.g. a weapon swing) 
+	 * doesn't skip over targets between the start and end. Results are merged per Actor, keeping the earliest hit. */
+	UPROPERTY(EditAnywhere, Category = "Sweep|Sub Step", meta = (DisplayName = "Sub Step"))
+	bool m_SubStep;
+
+	/* How many times per second to sample the Sweep Location. Samples are taken at most once a frame. */
+	UPROPERTY(EditAnywhere, Category = "Sweep|Sub Step", meta = (DisplayName = "Sample Rate", EditCondition = m_SubStep, ClampMin = 1.0))
+	float m_SubStepRate;
+
+	/* The most segments we'll sweep, regardless of Sample Rate and Task length. */
+	UPROPERTY(EditAnywhere, Category = "Sweep|Sub Step", meta = (DisplayName = "Max Segments", EditCondition = m_SubStep, ClampMin = 1))
+	int32 m_MaxSubSteps;
+
 	/* The Filters to execute on our results. */
 	UPROPERTY(EditAnywhere, Instanced, Category = "Sweep|Filter", meta = (DisplayName = "Filters"))
 	TArray<UAblCollisionFilter*> m_Filters;
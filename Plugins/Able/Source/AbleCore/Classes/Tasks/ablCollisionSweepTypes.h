@@ -23,18 +23,30 @@ public:
 	UAblCollisionSweepShape(const FObjectInitializer& ObjectInitializer);
 	virtual ~UAblCollisionSweepShape();
 
-	/* Perform the Synchronous Sweep. */
-	virtual void DoSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, TArray<FAblQueryResult>& OutResults) const { }
+	/* Perform the Synchronous Sweep, from the Source Transform to the current Sweep Location. */
+	virtual void DoSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, TArray<FAblQueryResult>& OutResults) const;
 	
-	/* Queue up the Async Sweep. */
-	virtual FTraceHandle DoAsyncSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform) const { return FTraceHandle(); }
+	/* Queue up the Async Sweep, from the Source Transform to the current Sweep Location. */
+	virtual FTraceHandle DoAsyncSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform) const;
+
+	/* Perform a Synchronous Sweep between two Sweep Location samples. Hit Time is relative to the segment. */
+	virtual void DoSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform, TArray<FHitResult>& OutHits) const { }
+
+	/* Queue up an Async Sweep between two Sweep Location samples. */
+	virtual FTraceHandle DoAsyncSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform) const { return FTraceHandle(); }
 	
 	/* Retrieve the Async results and process them. */
 	virtual void GetAsyncResults(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTraceHandle& Handle, TArray<FAblQueryResult>& OutResults) const;
 
+	/* Retrieve the raw Async hits. */
+	void GetAsyncHits(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTraceHandle& Handle, TArray<FHitResult>& OutHits) const;
+
 	/* Returns true if this shape is using Async. */
 	FORCEINLINE bool IsAsync() const { return m_UseAsyncQuery; }
 
+	/* Returns true if this shape only returns the blocking hit. */
+	FORCEINLINE bool OnlyReturnsBlockingHit() const { return m_OnlyReturnBlockingHit; }
+
 	/* Helper method to return the transform used in our Query. */
 	void GetQueryTransform(const TWeakObjectPtr<const UAblAbilityContext>& Context, FTransform& OutTransform) const;
 
@@ -95,11 +107,11 @@ public:
 	UAblCollisionSweepBox(const FObjectInitializer& ObjectInitializer);
 	virtual ~UAblCollisionSweepBox();
 
-	/* Perform the Synchronous Sweep. */
-	virtual void DoSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, TArray<FAblQueryResult>& OutResults) const override;
+	/* Perform a Synchronous Sweep between two Sweep Location samples. */
+	virtual void DoSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform, TArray<FHitResult>& OutHits) const override;
 	
-	/* Queue up the Async Sweep. */
-	virtual FTraceHandle DoAsyncSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform) const override;
+	/* Queue up an Async Sweep between two Sweep Location samples. */
+	virtual FTraceHandle DoAsyncSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform) const override;
 
 	/* Bind any Dynamic Delegates */
 	virtual void BindDynamicDelegates(class UAblAbility* Ability) override;
@@ -132,11 +144,11 @@ public:
 	UAblCollisionSweepSphere(const FObjectInitializer& ObjectInitializer);
 	virtual ~UAblCollisionSweepSphere();
 
-	/* Perform the Synchronous Sweep. */
-	virtual void DoSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, TArray<FAblQueryResult>& OutResults) const override;
+	/* Perform a Synchronous Sweep between two Sweep Location samples. */
+	virtual void DoSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform, TArray<FHitResult>& OutHits) const override;
 	
-	/* Queue up the Async Sweep. */
-	virtual FTraceHandle DoAsyncSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform) const override;
+	/* Queue up an Async Sweep between two Sweep Location samples. */
+	virtual FTraceHandle DoAsyncSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform) const override;
 
 	/* Bind any Dynamic Delegates */
 	virtual void BindDynamicDelegates(class UAblAbility* Ability) override;
@@ -169,11 +181,11 @@ public:
 	UAblCollisionSweepCapsule(const FObjectInitializer& ObjectInitializer);
 	virtual ~UAblCollisionSweepCapsule();
 
-	/* Perform the Synchronous Sweep. */
-	virtual void DoSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, TArray<FAblQueryResult>& OutResults) const override;
+	/* Perform a Synchronous Sweep between two Sweep Location samples. */
+	virtual void DoSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform, TArray<FHitResult>& OutHits) const override;
 	
-	/* Queue up the Async Sweep.*/
-	virtual FTraceHandle DoAsyncSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform) const override;
+	/* Queue up an Async Sweep between two Sweep Location samples. */
+	virtual FTraceHandle DoAsyncSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform) const override;
 
 	/* Bind any Dynamic Delegates */
 	virtual void BindDynamicDelegates(class UAblAbility* Ability) override;
@@ -0,0 +1,27 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#pragma once
+
+#include "ablAbilityTaskPlan.h"
+#include "Tasks/IAblAbilityTask.h"
+#include "UObject/ObjectMacros.h"
+
+#include "ablTaskPlanStressTask.generated.h"
+
+/* Does nothing, used by Able.StressTaskDoneMask and Able.BenchTaskPlan to build Task plans with a fixed lane layout. Hidden from the Task picker (no Task name). */
+UCLASS(Transient, HideDropdown, NotBlueprintable)
+class ABLECORE_API UAblTaskPlanStressTask : public UAblAbilityTask
+{
+	GENERATED_BODY()
+public:
+	virtual bool IsAsyncFriendly() const override { return m_Lane == EAblTaskLane::Async; }
+	virtual EAblAbilityTaskRealm GetTaskRealm() const override { return EAblAbilityTaskRealm::ATR_ClientAndServer; }
+	virtual TStatId GetStatId() const override { return TStatId(); }
+
+#if WITH_EDITOR
+	virtual FText GetTaskName() const override { return FText::GetEmpty(); }
+#endif
+
+	/* Lane the plan puts this Task in. */
+	EAblTaskLane m_Lane = EAblTaskLane::Sync;
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "ablAbilityContext.h"
+#include "ablAbilityTaskPlan.h"
 #include "Channeling/ablChannelingBase.h"
 #include "GameplayTagContainer.h"
 #include "Targeting/ablTargetingBase.h"
@@ -76,6 +77,17 @@ enum class EAblClientExecutionPolicy : uint8
 	LocalAndAuthoritativeOnly UMETA(DisplayName = "Local And Authoritative"),
 };
 
+UENUM(BlueprintType)
+enum class EAblForceAbilityDelivery : uint8
+{
+	// Sent unreliably, only to connections the owner is relevant to. A lost one is replayed by the remote client's validation pass.
+	Unreliable UMETA(DisplayName = "Unreliable"),
+	// Sent reliably to every connection with an open channel for the owner (the old behavior).
+	Reliable UMETA(DisplayName = "Reliable"),
+	// Sent unreliably, only to relevant connections, and never replayed. For Abilities that are purely cosmetic on remote clients.
+	Cosmetic UMETA(DisplayName = "Cosmetic (Unreliable, No Recovery)"),
+};
+
 UCLASS(Abstract, Transient, Blueprintable)
 class ABLECORE_API UAblAbilityScratchPad : public UObject
 {
@@ -263,6 +275,20 @@ public:
 	*/
 	FORCEINLINE const TArray<const UAblAbilityTask*>& GetAllTaskDependencies() const { return m_AllDependentTasks; }
 
+	/**
+	* Returns the baked Task plan, built during PreExecutionInit.
+	*
+	* @return the Task plan, shared by all Instances of this Ability.
+	*/
+	FORCEINLINE const TSharedPtr<const FAblAbilityTaskPlan>& GetTaskPlan() const { return m_TaskPlan; }
+
+	/**
+	* Returns the slot layout for this Ability's Context Parameters.
+	*
+	* @return the Context Parameter schema, shared by all Contexts of this Ability.
+	*/
+	const TSharedPtr<const FAblContextParamSchema>& GetContextParamSchema() const;
+
 	/**
 	* Returns the Length, in seconds, of the Ability.
 	*
@@ -1024,6 +1050,13 @@ public:
 	*/
 	FORCEINLINE EAblClientExecutionPolicy GetClientPolicy() const { return m_ClientPolicy; }
 
+	/**
+	* Returns how the server tells remote clients this Ability was restarted.
+	*
+	* @return The Force Delivery (Unreliable, Reliable, Cosmetic)
+	*/
+	FORCEINLINE EAblForceAbilityDelivery GetForceDelivery() const { return m_ForceDelivery; }
+
 	/**
 	* Returns the class, if any, to use as the Ability Scratchpad.
 	*
@@ -1343,6 +1376,10 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "Tags", meta = (DisplayName = "Tag Container"))
 	FGameplayTagContainer m_TagContainer;
 
+	/* Context Parameters this Ability uses. Declared Parameters get a fixed slot in the Context, so they don't need to be looked up (or allocated) at runtime. */
+	UPROPERTY(EditDefaultsOnly, Category = "Parameters", meta = (DisplayName = "Context Parameters"))
+	TArray<FAblContextParamDesc> m_ContextParameters;
+
 	/* Our Tasks */
 	UPROPERTY(EditDefaultsOnly, Instanced, Category = "Internal")
 	TArray<UAblAbilityTask*> m_Tasks;
@@ -1355,6 +1392,10 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "Misc", meta = (DisplayName="Client Policy"))
 	EAblClientExecutionPolicy m_ClientPolicy;
 
+	/* How the server tells remote clients this Ability was restarted while already playing. */
+	UPROPERTY(EditDefaultsOnly, Category = "Misc", meta = (DisplayName = "Force Delivery"))
+	EAblForceAbilityDelivery m_ForceDelivery;
+
 	// Various run-time parameters.
 
 	/* CRC Hash of our Ability Name. */
@@ -1375,6 +1416,12 @@ private:
 	/* Whether we need to update our dependencies or not. */
 	UPROPERTY(Transient)
 	mutable bool m_DependenciesDirty;
+
+	/* Slot layout of our Context Parameters. Rebuilt (not modified) when they change. */
+	mutable TSharedPtr<const FAblContextParamSchema> m_ContextParamSchema;
+
+	/* Our Tasks baked down into start events and dependency indices. Rebuilt (not modified) when our Tasks change, so running Instances keep the plan they started with. */
+	mutable TSharedPtr<const FAblAbilityTaskPlan> m_TaskPlan;
 };
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include "ablAbilityContext.h"
 #include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
 #include "GameplayTagContainer.h"
 #include "GameplayTagAssetInterface.h"
 #include "Tasks/IAblAbilityTask.h"
@@ -14,13 +15,15 @@
 #include "UObject/ScriptMacros.h"
 #include "ablAbilityContext.h"
 #include "ablAbilityInstance.h"
+#include "ablCooldownTable.h"
 #include "ablAbilityComponent.generated.h"
 
 #define LOCTEXT_NAMESPACE "AbleCore"
 
 class UAblAbility;
 class UAbleSettings;
-class FAsyncAbilityCooldownUpdaterTask;
+class UAblAbilitySchedulerSubsystem;
+struct FAblScheduledAsyncUpdate;
 struct FAnimNode_AbilityAnimPlayer;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAbilityStartBP, const UAblAbilityContext*, Context);
@@ -33,50 +36,6 @@ DECLARE_MULTICAST_DELEGATE_TwoParams(FOnAbilityEnd, const UAblAbilityContext& /*
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnAbilityInterrupt, const UAblAbilityContext& /*Context*/);
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnAbilityBranched, const UAblAbilityContext& /*Context*/);
 
-/* Helper struct to keep track of Cooldowns. */
-USTRUCT(BlueprintType)
-struct FAblAbilityCooldown
-{
-	GENERATED_USTRUCT_BODY()
-public:
-	FAblAbilityCooldown();
-	FAblAbilityCooldown(const UAblAbility& InAbility, const UAblAbilityContext& InContext);
-
-	/* The Ability tied to this Cooldown. */
-	const UAblAbility* GetAbility() const { return Ability; }
-
-	/* Returns a value between 0 - 1.0 with how much time is left on the cooldown.*/
-	float getTimeRatio() const { return FMath::Min(CurrentTime / CooldownTime, 1.0f);	}
-	
-	/* Returns if the Cooldown is complete or not. */
-	bool IsComplete() const { return CurrentTime > CooldownTime; }
-	
-	/* Updates the Cooldown. */
-	void Update(float DeltaTime);
-
-	/* Returns the Calculated Cooldown. */
-	float GetCooldownTime() const { return CooldownTime; }
-
-	/* Sets the Cooldown. */
-	void SetCooldownTime(float time) { CooldownTime = time; }
-protected:
-	/* The Ability for this Cooldown.*/
-	UPROPERTY(BlueprintReadOnly, Category = "Cooldown")
-	const UAblAbility* Ability;
-
-	/* The Context for this Cooldown.*/
-	UPROPERTY(BlueprintReadOnly, Category = "Cooldown")
-	const UAblAbilityContext* Context;
-	
-	/* Current Time on the Cooldown.*/
-	UPROPERTY(BlueprintReadOnly, Category = "Cooldown")
-	float CurrentTime;
-
-	/* Total Cooldown time. */
-	UPROPERTY(BlueprintReadOnly, Category = "Cooldown")
-	float CooldownTime;
-};
-
 USTRUCT()
 struct FAblPendingCancelContext
 {
@@ -100,6 +59,79 @@ private:
 	EAblAbilityTaskResult ResultToUse;
 };
 
+struct FAblServerPassiveAbilities;
+
+/* A Passive Ability running on the server, one item of FAblServerPassiveAbilities. */
+USTRUCT()
+struct ABLECORE_API FAblServerPassiveAbility : public FFastArraySerializerItem
+{
+	GENERATED_USTRUCT_BODY()
+public:
+	FAblServerPassiveAbility() : m_AbilityNameHash(0U) {}
+	FAblServerPassiveAbility(const FAblAbilityNetworkContext& Context);
+
+	const FAblAbilityNetworkContext& GetContext() const { return m_Context; }
+
+	/* Name hash of the Ability, kept so a removed item can still find its instance if the Ability itself is gone. */
+	uint32 GetAbilityNameHash() const { return m_AbilityNameHash; }
+
+	/* Sets the Stacks, returns true if they changed. */
+	bool SetCurrentStacks(int8 CurrentStacks);
+
+	// FFastArraySerializer callbacks, client only.
+	void PreReplicatedRemove(const FAblServerPassiveAbilities& ArraySerializer);
+	void PostReplicatedAdd(const FAblServerPassiveAbilities& ArraySerializer);
+	void PostReplicatedChange(const FAblServerPassiveAbilities& ArraySerializer);
+
+private:
+	UPROPERTY()
+	FAblAbilityNetworkContext m_Context;
+
+	uint32 m_AbilityNameHash;
+};
+
+/* The server's Passive Abilities. Items are delta replicated, so adding, restacking or removing one Passive only sends that Passive,
+ * and clients get a callback per item instead of rescanning the whole list. */
+USTRUCT()
+struct ABLECORE_API FAblServerPassiveAbilities : public FFastArraySerializer
+{
+	GENERATED_USTRUCT_BODY()
+public:
+	FAblServerPassiveAbilities() : m_Component(nullptr) {}
+
+	/* Returns the item for the Ability, or nullptr. */
+	FAblServerPassiveAbility* FindByHash(uint32 AbilityNameHash);
+
+	/* Adds an item and marks it dirty. */
+	FAblServerPassiveAbility& Add(const FAblAbilityNetworkContext& Context);
+
+	/* Removes any item whose Ability isn't in the Whitelist. Returns the number removed. */
+	int32 RemoveAllNotIn(const TArray<uint32>& Whitelist);
+
+	const TArray<FAblServerPassiveAbility>& GetItems() const { return m_Items; }
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FAblServerPassiveAbility, FAblServerPassiveAbilities>(m_Items, DeltaParms, *this);
+	}
+
+	/* The Component that owns this list, set in its constructor. */
+	UAblAbilityComponent* m_Component;
+
+private:
+	UPROPERTY()
+	TArray<FAblServerPassiveAbility> m_Items;
+};
+
+template<>
+struct TStructOpsTypeTraits< FAblServerPassiveAbilities > : public TStructOpsTypeTraitsBase2< FAblServerPassiveAbilities >
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
 UCLASS(ClassGroup = Able, hidecategories = (Internal, Activation, Collision), Blueprintable, meta = (BlueprintSpawnableComponent, DisplayName = "Ability Component", ShortToolTip = "A component for playing active and passive abilities."))
 class ABLECORE_API UAblAbilityComponent : public UActorComponent, public IGameplayTagAssetInterface
 {
@@ -329,11 +361,8 @@ public:
 	/* Returns the Gameplay Tag Container. */
 	const FGameplayTagContainer& GetGameplayTagContainer() const { return m_TagContainer; }
 	
-	/* Returns all Cooldowns, mutable. */
-	TMap<uint32, FAblAbilityCooldown>& GetMutableCooldowns() { return m_ActiveCooldowns; }
-	
-	/* Returns all Cooldowns, non-mutable. */
-	const TMap<uint32, FAblAbilityCooldown>& GetCooldowns() const {	return m_ActiveCooldowns; }
+	/* Returns the Cooldown table our Cooldowns live in (shared by the world if possible) and our Owner index within it. Null if we've never had a Cooldown. */
+	const FAblCooldownTable* GetCooldownTable(int32& OutOwnerIndex) const;
 
 	/* Finds the appropriate ability and adds the provided array to the Context Target Actors. AllowDuplicates will prevent adding any duplicates to the Target array (or not), Clear Targets will clear the current targets before adding the new ones. */
 	void AddAdditionTargetsToContext(const TWeakObjectPtr<const UAblAbilityContext>& Context, const TArray<TWeakObjectPtr<AActor>>& AdditionalTargets, bool AllowDuplicates = false, bool ClearTargets = false);
@@ -514,6 +543,16 @@ protected:
 	UFUNCTION(Server, Reliable, WithValidation)
 	void ServerCancelAbility(uint32 AbilityNameHash, EAblAbilityTaskResult ResultToUse);
 
+	/**
+	* INTERNAL - Runs each Command in order, exactly as if it had been sent with ServerActivateAbility / ServerBranchAbility / ServerCancelAbility.
+	*
+	* @param Batch The Commands issued by the client this frame.
+	*
+	* @return none
+	*/
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerAbilityCommands(const FAblAbilityCommandBatch& Batch);
+
 	/**
 	* INTERNAL - Sent from the Server when delta compression wouldn't catch a change.
 	*
@@ -524,6 +563,17 @@ protected:
 	UFUNCTION(NetMulticast, Reliable, WithValidation)
 	void ClientForceAbility(const FAblAbilityNetworkContext& Context);
 
+	/**
+	* INTERNAL - Unreliable version of ClientForceAbility. Unreliable multicasts are only sent to connections the owner is relevant to.
+	*
+	* @param Context AbilityNetworkContext
+	* @param Sequence Force Sequence this was sent with, 0 if it should never be replayed.
+	*
+	* @return none
+	*/
+	UFUNCTION(NetMulticast, Unreliable, WithValidation)
+	void ClientForceAbilityUnreliable(const FAblAbilityNetworkContext& Context, uint16 Sequence);
+
 	////
 
 	// Client Replication Notifications
@@ -532,9 +582,13 @@ protected:
 	UFUNCTION()
 	void OnServerActiveAbilityChanged();
 	
-	/* Called when the number of Passives (or some aspect of the passive) is changed on the Server. */
-	UFUNCTION()
-	void OnServerPassiveAbilitiesChanged();
+	/* Called when a Passive is added or changed (e.g. its stacks) on the Server. */
+	void OnServerPassiveAbilityChanged(const FAblAbilityNetworkContext& ServerPassive, bool IsNew);
+
+	/* Called when a Passive is removed on the Server. */
+	void OnServerPassiveAbilityRemoved(uint32 AbilityNameHash);
+
+	friend struct FAblServerPassiveAbility;
 
 	UFUNCTION()
 	void OnServerPredictiveKeyChanged();
@@ -543,6 +597,25 @@ protected:
 	/* Checks if this Component still needs to Tick each frame. */
 	virtual void CheckNeedsTick();
 
+	/* Returns true if this Component has any work to do this frame (Abilities, Cooldowns, Pending queues). */
+	bool NeedsUpdate() const;
+
+	// Update phases, run back to back by TickComponent or batched across all components by the Scheduler.
+	friend class UAblAbilitySchedulerSubsystem;
+	friend struct FAblScheduledAsyncUpdate;
+
+	/* Updates our local Cooldowns, if we aren't using the world Cooldown table. */
+	void UpdateCooldownPhase(float DeltaTime);
+
+	/* Checks our Active Ability status and processes any Pending cancels, contexts, and Async targeting. */
+	void UpdatePendingPhase();
+
+	/* Updates our Active and Passive Ability Instances. */
+	void UpdateInstancePhase(float DeltaTime);
+
+	/* Cleans up finished Passives, syncs our Server fields, and ends the update. */
+	void FinishUpdatePhase();
+
 	/* Returns true if the Component is in the middle of an update. */
 	bool IsProcessingUpdate() const { return m_IsProcessingUpdate; }
 
@@ -567,11 +640,11 @@ protected:
 	/* Cancels the current Active Ability using the provided result. */
 	void CancelActiveAbility(EAblAbilityTaskResult ResultToUse);
 
-	// Friend class to help call this method via Async task graph.
-	friend class FAsyncAbilityCooldownUpdaterTask;
+	/* Returns the Cooldown table to use, allocating our Owner index the first time. */
+	FAblCooldownTable& GetOrCreateCooldownTable();
 
-	/* Updates all Cooldowns using the provided DeltaTime. */
-	void UpdateCooldowns(float DeltaTime);
+	/* Returns the Handle for the Ability's Cooldown, if it's active. */
+	FAblCooldownHandle FindCooldown(const UAblAbility* Ability) const;
 
 	/* Helper method to deal with all the pending contexts we may have. */
 	void HandlePendingContexts();
@@ -587,6 +660,12 @@ protected:
 
 	/* Check our running Abilities against our Server variables. Only executed on remote clients. */
 	void ValidateRemoteRunningAbilities();
+
+	/* Locally controlled clients only. Stops predicted Passives the server never confirmed. */
+	void ValidatePredictedPassiveAbilities();
+
+	/* Returns true if a prediction of this Ability is still waiting on the server. */
+	bool IsPredictionPending(uint32 AbilityNameHash) const;
 	////
 
 	// Network Helper Methods
@@ -599,6 +678,21 @@ protected:
 
 	/* Updates the server representation of the current active Ability (to be replicated to the client). */
 	void UpdateServerActiveAbility();
+
+	/* Sends an Activate, Branch or Cancel to the server, either right away or buffered until the end of the frame. */
+	void SendAbilityCommand(const FAblAbilityCommand& Command);
+
+	/* Sends any buffered Commands. A single Command goes through its own RPC, more than one through ServerAbilityCommands. */
+	void FlushAbilityCommands();
+
+	/* Flushes our buffered Commands once every Actor has ticked, before the net driver sends this frame. */
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/* Tells remote clients the Active was restarted, using the Ability's Force Delivery. */
+	void ForceAbilityOnClients(const FAblAbilityNetworkContext& Context);
+
+	/* Returns true if Force Sequence A is after B. */
+	static bool IsNewerForceSequence(uint16 A, uint16 B);
 	////
 
     void GetCombinedGameplayTags(FGameplayTagContainer& CombinedTags, bool includeRunningAbilities) const;
@@ -618,13 +712,32 @@ protected:
     UPROPERTY(Transient)
     bool m_PassivesDirty = false;
 
+	/* Whether our Active/Passives changed during the current update. */
+	UPROPERTY(Transient)
+	bool m_ActiveChangedThisFrame;
+
+	UPROPERTY(Transient)
+	bool m_PassivesChangedThisFrame;
+
+	/* True if the world Scheduler is updating us instead of our own tick function. */
+	UPROPERTY(Transient)
+	bool m_RegisteredWithScheduler;
+
+	/* Set by the Scheduler during the Instance phase, async only Instances are queued here rather than dispatched. */
+	TArray<FAblScheduledAsyncUpdate>* m_ScheduledAsyncUpdates;
+
 	/* Cached Settings Object for log reporting. */
 	UPROPERTY(Transient)
 	TWeakObjectPtr<const UAbleSettings> m_Settings;
 	
-	/* Active Cooldowns. */
-	UPROPERTY(Transient)
-	TMap<uint32, FAblAbilityCooldown> m_ActiveCooldowns;
+	/* Our Owner index in the Cooldown table, INDEX_NONE until our first Cooldown. */
+	int32 m_CooldownOwnerIndex;
+
+	/* The Scheduler that owns the world Cooldown table, if we're using it. */
+	TWeakObjectPtr<UAblAbilitySchedulerSubsystem> m_CooldownScheduler;
+
+	/* Used when there's no world Cooldown table (e.g. preview worlds). */
+	FAblCooldownTable m_LocalCooldownTable;
 
 	/* Pending Context */
 	UPROPERTY(Transient)
@@ -659,11 +772,21 @@ protected:
 
 	static const uint16 ABLE_ABILITY_PREDICTION_RING_SIZE = 16;
 
+	/* Ring of Abilities we've predicted, indexed by Prediction Key modulo the ring size. An entry is cleared once the server confirms it. */
 	UPROPERTY(Transient)
-	TArray<FAblAbilityNetworkContext> m_LocallyPredictedAbilities;
+	FAblAbilityNetworkContext m_LocallyPredictedAbilities[ABLE_ABILITY_PREDICTION_RING_SIZE];
 
 	uint16 m_ClientPredictionKey;
 
+	/* Commands issued this frame, waiting for FlushAbilityCommands. */
+	FAblAbilityCommandBatch m_PendingCommands;
+
+	/* Bound to FWorldDelegates::OnWorldPostActorTick while we have pending Commands. */
+	FDelegateHandle m_FlushCommandsHandle;
+
+	/* Last Force Sequence this client has played, compared against m_ServerForceSequence to replay a lost ClientForceAbilityUnreliable. */
+	uint16 m_ClientForceSequence;
+
 	// C++ delegates
 
 	FOnAbilityStart m_AbilityStartDelegate;
@@ -684,11 +807,15 @@ protected:
 	FAblAbilityNetworkContext m_ServerActive;
 
 	// The Active Passive Abilities being played on the server.
-	UPROPERTY(Transient, ReplicatedUsing = OnServerPassiveAbilitiesChanged)
-	TArray<FAblAbilityNetworkContext> m_ServerPassiveAbilities;
+	UPROPERTY(Transient, Replicated)
+	FAblServerPassiveAbilities m_ServerPassiveAbilities;
 
 	UPROPERTY(Transient, ReplicatedUsing = OnServerPredictiveKeyChanged)
 	uint16 m_ServerPredictionKey;
+
+	// Bumped each time the Active is forced unreliably, so remote clients can tell they missed one.
+	UPROPERTY(Transient, Replicated)
+	uint16 m_ServerForceSequence;
 	///// 
 
 };
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "ablAbilityTypes.h"
+#include "ablAbilityTaskPlan.h"
 #include "Components/PrimitiveComponent.h"
 #include "Engine/EngineTypes.h"
 #include "WorldCollision.h"
@@ -66,29 +67,86 @@ public:
 	TWeakObjectPtr<AActor> Actor;
 };
 
-/* Slightly more compact version of our normal Ability Context, for transfer across the wire. */
+/* Types a Context Parameter can hold. */
+UENUM(BlueprintType)
+enum class EAblContextParamType : uint8
+{
+	Int,
+	Float,
+	String,
+	UObject,
+	Vector
+};
+
+/* A Context Parameter an Ability expects. Declaring it up front gives it a fixed slot in every Context of that Ability. */
+USTRUCT(BlueprintType)
+struct ABLECORE_API FAblContextParamDesc
+{
+	GENERATED_USTRUCT_BODY();
+public:
+	FAblContextParamDesc() : Name(NAME_None), Type(EAblContextParamType::Float) {}
+
+	/* The Identifier used to Get/Set the Parameter. */
+	UPROPERTY(EditDefaultsOnly, Category = "Parameter", meta = (DisplayName = "Name"))
+	FName Name;
+
+	/* The type of value the Parameter holds. */
+	UPROPERTY(EditDefaultsOnly, Category = "Parameter", meta = (DisplayName = "Type"))
+	EAblContextParamType Type;
+};
+
+/* Header entry for a single Context Parameter. Int/Float/Vector values live in the value buffer at Offset, String/UObject values live in their own arrays at Offset. */
+struct FAblContextParamSlot
+{
+	FName Name;
+	EAblContextParamType Type;
+	bool IsSet;
+	uint16 Offset;
+};
+
+/* Slot layout for an Ability's declared Context Parameters. Built once per Ability and shared by all of its Contexts. */
+struct ABLECORE_API FAblContextParamSchema
+{
+	FAblContextParamSchema();
+
+	/* Lays out slots for the provided Parameters. Duplicates (same Name and Type) are ignored. */
+	void Build(const TArray<FAblContextParamDesc>& Params);
+
+	/* Returns the slot for this Parameter, or INDEX_NONE if it wasn't declared. */
+	int32 FindSlot(FName Id, EAblContextParamType Type) const;
+
+	TArray<FAblContextParamSlot> Slots;
+	uint16 NumBytes;
+	uint16 NumStrings;
+	uint16 NumUObjects;
+};
+
+/* Context Parameters, stored as a small header of typed slots plus an inline value buffer. Slots declared by the Ability's schema come first and
+ * have fixed indices, anything else set by name is appended after them. Clearing keeps our memory around, so pooled Contexts don't churn the heap. */
 USTRUCT()
 struct ABLECORE_API FAblAbilityContextParams
 {
 	GENERATED_USTRUCT_BODY();
 public:
 	FAblAbilityContextParams();
-	FAblAbilityContextParams(const FAblAbilityContextParams& Context);
+
+	/* Sets up our slots from the schema. Clears any current values. */
+	void SetSchema(const TSharedPtr<const FAblContextParamSchema>& Schema);
+
+	/* Returns the schema we're laid out with, if any. */
+	const TSharedPtr<const FAblContextParamSchema>& GetSchema() const { return m_Schema; }
+
 	void ClearParams();
 	void AppendParams(const FAblAbilityContextParams& params);
 
-	/* Parameter Accessors. */
-	const TMap<FName, int>& GetIntParameters() const { return m_IntParameters; }
-	const TMap<FName, float>& GetFloatParameters() const { return m_FloatParameters; }
-	const TMap<FName, FString>& GetStringParameters() const { return m_StringParameters; }
-	const TMap<FName, UObject*>& GetUObjectParameters() const { return m_UObjectParameters; }
-	const TMap<FName, FVector>& GetVectorParameters() const { return m_VectorParameters; }
-
-	void AppendIntParams(const TMap<FName, int>& params) { m_IntParameters.Append(params); }
-	void AppendFloatParams(const TMap<FName, float>& params) { m_FloatParameters.Append(params); }
-	void AppendStringParams(const TMap<FName, FString>& params) { m_StringParameters.Append(params); }
-	void AppendUObjectParams(const TMap<FName, UObject*>& params) { m_UObjectParameters.Append(params); }
-	void AppendVectorParams(const TMap<FName, FVector>& params) { m_VectorParameters.Append(params); }
+	/* Returns the slot of the provided Parameter, or INDEX_NONE. Slots declared by the Ability's schema never change, so they can be cached. */
+	int32 FindSlot(FName Id, EAblContextParamType Type) const;
+
+	/* Returns the number of slots (set or not). */
+	int32 NumSlots() const { return m_Slots.Num(); }
+
+	/* Returns the slot header. */
+	const FAblContextParamSlot& GetSlot(int32 Slot) const { return m_Slots[Slot]; }
 
 	//Set an Integer parameter on this Context using an FName Identifier. Parameters are not replicated across client/server.
 	void SetIntParameter(FName Id, int Value);
@@ -112,21 +170,68 @@ public:
 	//return the parameter value, or nullptr if not found.
 	FVector GetVectorParameter(FName Id) const;
 
+	// Slot versions of the above, Slot must be of the matching type (see FindSlot). Getters return the default value if the Parameter hasn't been set.
+	void SetIntParameterAt(int32 Slot, int Value);
+	void SetFloatParameterAt(int32 Slot, float Value);
+	void SetStringParameterAt(int32 Slot, const FString& Value);
+	void SetUObjectParameterAt(int32 Slot, UObject* Value);
+	void SetVectorParameterAt(int32 Slot, const FVector& Value);
+
+	int GetIntParameterAt(int32 Slot) const;
+	float GetFloatParameterAt(int32 Slot) const;
+	const FString& GetStringParameterAt(int32 Slot) const;
+	UObject* GetUObjectParameterAt(int32 Slot) const;
+	FVector GetVectorParameterAt(int32 Slot) const;
+
 private:
-	UPROPERTY(Transient, NotReplicated)
-		TMap<FName, int> m_IntParameters;
+	/* Returns the slot for this Parameter, adding one if needed. */
+	int32 FindOrAddSlot(FName Id, EAblContextParamType Type);
 
-	UPROPERTY(Transient, NotReplicated)
-		TMap<FName, float> m_FloatParameters;
+	/* Copies a value from another set of Parameters. */
+	void CopySlotValue(const FAblAbilityContextParams& Source, int32 SourceSlot);
 
-	UPROPERTY(Transient, NotReplicated)
-		TMap<FName, FString> m_StringParameters;
+	template<typename T>
+	void WriteValue(int32 Slot, const T& Value)
+	{
+		FAblContextParamSlot& SlotHeader = m_Slots[Slot];
+		FMemory::Memcpy(m_Values.GetData() + SlotHeader.Offset, &Value, sizeof(T));
+		SlotHeader.IsSet = true;
+	}
+
+	template<typename T>
+	T ReadValue(int32 Slot, const T& Default) const
+	{
+		// FindParameterSlot returns INDEX_NONE for unknown names.
+		if (!m_Slots.IsValidIndex(Slot))
+		{
+			return Default;
+		}
+
+		const FAblContextParamSlot& SlotHeader = m_Slots[Slot];
+		if (!SlotHeader.IsSet)
+		{
+			return Default;
+		}
+
+		T Value;
+		FMemory::Memcpy(&Value, m_Values.GetData() + SlotHeader.Offset, sizeof(T));
+		return Value;
+	}
+
+	/* The schema our declared slots came from. */
+	TSharedPtr<const FAblContextParamSchema> m_Schema;
+
+	/* Slot header. */
+	TArray<FAblContextParamSlot, TInlineAllocator<8>> m_Slots;
+
+	/* Int/Float/Vector values. */
+	TArray<uint8, TInlineAllocator<64>> m_Values;
 
 	UPROPERTY(Transient, NotReplicated)
-		TMap<FName, UObject*> m_UObjectParameters;
+	TArray<FString> m_StringValues;
 
 	UPROPERTY(Transient, NotReplicated)
-		TMap<FName, FVector> m_VectorParameters;
+	TArray<UObject*> m_UObjectValues;
 };
 
 /* Slightly more compact version of our normal Ability Context, for transfer across the wire. */
@@ -180,11 +285,9 @@ public:
 
 	/* Parameter Accessors. */
 	const FAblAbilityContextParams& GetParameters() const { return m_Parameters; }
-	const TMap<FName, int>& GetIntParameters() const { return m_Parameters.GetIntParameters(); }
-	const TMap<FName, float>& GetFloatParameters() const { return m_Parameters.GetFloatParameters(); }
-	const TMap<FName, FString>& GetStringParameters() const { return m_Parameters.GetStringParameters(); }
-	const TMap<FName, UObject*>& GetUObjectParameters() const { return m_Parameters.GetUObjectParameters(); }
-	const TMap<FName, FVector>& GetVectorParameters() const { return m_Parameters.GetVectorParameters(); }
+
+	/* Bit packed replication: the Ability as a FAblAbilityNetIndex index, quantized location / time stamp, and default values left out. Able.CompactNetContext 0 sends every property instead. */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
 private:
 	/* The Ability for this Context. */
 	UPROPERTY()
@@ -227,6 +330,100 @@ private:
 	FAblAbilityContextParams m_Parameters;
 };
 
+template<>
+struct TStructOpsTypeTraits< FAblAbilityNetworkContext > : public TStructOpsTypeTraitsBase2< FAblAbilityNetworkContext >
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/* What an Ability Command asks the server to do. */
+UENUM()
+enum class EAblAbilityCommandType : uint8
+{
+	Activate,
+	Branch,
+	Cancel,
+
+	Count UMETA(Hidden)
+};
+
+/* One client request (Activate, Branch or Cancel) sent to the server as part of an FAblAbilityCommandBatch. */
+USTRUCT()
+struct ABLECORE_API FAblAbilityCommand
+{
+	GENERATED_USTRUCT_BODY();
+public:
+	FAblAbilityCommand() : m_Type(EAblAbilityCommandType::Activate), m_AbilityNameHash(0U), m_Result(EAblAbilityTaskResult::Successful) {}
+
+	static FAblAbilityCommand MakeActivate(const FAblAbilityNetworkContext& Context);
+	static FAblAbilityCommand MakeBranch(const FAblAbilityNetworkContext& Context);
+	static FAblAbilityCommand MakeCancel(uint32 AbilityNameHash, EAblAbilityTaskResult ResultToUse);
+
+	EAblAbilityCommandType GetType() const { return m_Type; }
+
+	/* Activate and Branch only. */
+	const FAblAbilityNetworkContext& GetContext() const { return m_Context; }
+
+	/* Cancel only. */
+	uint32 GetAbilityNameHash() const { return m_AbilityNameHash; }
+	EAblAbilityTaskResult GetResult() const { return m_Result.GetValue(); }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+private:
+	UPROPERTY()
+	EAblAbilityCommandType m_Type;
+
+	UPROPERTY()
+	FAblAbilityNetworkContext m_Context;
+
+	UPROPERTY()
+	uint32 m_AbilityNameHash;
+
+	UPROPERTY()
+	TEnumAsByte<EAblAbilityTaskResult> m_Result;
+};
+
+template<>
+struct TStructOpsTypeTraits< FAblAbilityCommand > : public TStructOpsTypeTraitsBase2< FAblAbilityCommand >
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/* Ability Commands issued by a client in one frame, sent in order as a single RPC. */
+USTRUCT()
+struct ABLECORE_API FAblAbilityCommandBatch
+{
+	GENERATED_USTRUCT_BODY();
+public:
+	/* Most Commands a batch can carry, anything past this is flushed in another RPC. */
+	static const int32 MaxCommands = 32;
+
+	TArray<FAblAbilityCommand>& GetCommands() { return m_Commands; }
+	const TArray<FAblAbilityCommand>& GetCommands() const { return m_Commands; }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+private:
+	UPROPERTY()
+	TArray<FAblAbilityCommand> m_Commands;
+};
+
+template<>
+struct TStructOpsTypeTraits< FAblAbilityCommandBatch > : public TStructOpsTypeTraitsBase2< FAblAbilityCommandBatch >
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
 class AbleRWScopeLock
 {
 public:
@@ -287,9 +484,19 @@ public:
 	/* Updates the time of this Context. */
 	void UpdateTime(float DeltaTime);
 
+	/* Sets the plan index of the Task a lane is calling into (INDEX_NONE once done), so that Task's Scratchpad lookups skip the Task map. */
+	FORCEINLINE void SetCurrentTaskIndex(EAblTaskLane Lane, int32 TaskIndex) { m_CurrentTaskIndices[(uint8)Lane] = TaskIndex; }
+
 	/* Returns the Scratchpad for the provided Task (if it has one). */
 	class UAblAbilityTaskScratchPad* GetScratchPadForTask(const class UAblAbilityTask* Task) const;
 
+	/* Returns the struct Scratchpad for the provided Task (if it has one). See UAblAbilityTask::GetScratchPadStruct. */
+	void* GetScratchPadStructForTask(const class UAblAbilityTask* Task) const;
+
+	/* Returns the struct Scratchpad for the provided Task (if it has one). */
+	template<typename T>
+	T* GetScratchPadStructForTask(const class UAblAbilityTask* Task) const { return static_cast<T*>(GetScratchPadStructForTask(Task)); }
+
 	/* Returns Target Actor array, mutable. */
 	TArray<TWeakObjectPtr<AActor>>& GetMutableTargetActors() { return m_TargetActors; }
 
@@ -490,6 +697,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Able|Ability|Context")
 	FVector GetVectorParameter(FName Id) const;
 
+	/* Returns the slot of a Parameter, or INDEX_NONE. Parameters declared on the Ability always have the same slot, so it can be cached and used with the *At accessors. */
+	int32 FindParameterSlot(FName Id, EAblContextParamType Type) const;
+
+	/* Slot versions of the Parameter getters. */
+	int GetIntParameterAt(int32 Slot) const;
+	float GetFloatParameterAt(int32 Slot) const;
+	const FString& GetStringParameterAt(int32 Slot) const;
+	UObject* GetUObjectParameterAt(int32 Slot) const;
+	FVector GetVectorParameterAt(int32 Slot) const;
+
 	/**
 	* Returns the Ability contained in this Context.
 	*
@@ -561,16 +778,16 @@ public:
 
 	/* Parameter Accessors. */
 	const FAblAbilityContextParams& GetParameters() const { return m_Parameters; }
-	const TMap<FName, int>& GetIntParameters() const { return m_Parameters.GetIntParameters(); }
-	const TMap<FName, float>& GetFloatParameters() const { return m_Parameters.GetFloatParameters(); }
-	const TMap<FName, FString>& GetStringParameters() const { return m_Parameters.GetStringParameters(); }
-	const TMap<FName, UObject*>& GetUObjectParameters() const { return m_Parameters.GetUObjectParameters(); }
-	const TMap<FName, FVector>& GetVectorParameters() const { return m_Parameters.GetVectorParameters(); }
 
 	FAblAbilityContextParams& GetMutableParameters() { return m_Parameters; }
 	/* Resets the Context to it's default state, and returns it to the pool if pooling is enabled.*/
 	void Reset();
 protected:
+	/* Destructs any struct ScratchPads living in the arena. The arena itself is kept. */
+	void DestroyScratchPadStructs();
+
+	/* Returns the ScratchPad slot (plan index) for a Task. Direct for the Task a lane is calling into, otherwise looked up through the plan. */
+	int32 FindScratchPadSlot(const class UAblAbilityTask* Task) const;
 
     /* A Target Location. */
     UPROPERTY(Transient)
@@ -612,9 +829,20 @@ protected:
 	UPROPERTY(Transient)
 	TArray<TWeakObjectPtr<AActor>> m_TargetActors;
 
-	/* Map of Task Unique IDs to ScratchPads. */
+	/* Task ScratchPads, indexed by Task ScratchPad slot. */
 	UPROPERTY(Transient)
-	TMap<uint32, class UAblAbilityTaskScratchPad*> m_TaskScratchPadMap;
+	TArray<class UAblAbilityTaskScratchPad*> m_TaskScratchPads;
+
+	/* Plan our ScratchPads were allocated from. Task slots and struct offsets are resolved through it, not the Ability's current plan. */
+	TSharedPtr<const FAblAbilityTaskPlan> m_ScratchPadPlan;
+
+	/* Plan index of the Task each lane is currently calling into, see SetCurrentTaskIndex. Each lane only writes its own entry. */
+	int32 m_CurrentTaskIndices[(uint8)EAblTaskLane::Count];
+
+	/* Arena holding struct ScratchPads. Kept between uses while the Context is pooled. */
+	uint8* m_ScratchPadArena;
+	int32 m_ScratchPadArenaSize;
+	int32 m_ScratchPadArenaAlignment;
 
 	/* The Ability ScratchPad, if allocated. */
 	UPROPERTY(Transient)
@@ -0,0 +1,86 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/SoftObjectPath.h"
+
+class UAblAbility;
+
+/* Assets an Ability references through its Tasks (Animations, Particles, Sounds, spawned Actor classes, etc), split by the realm that needs them. */
+struct ABLECORE_API FAblAbilityDependencies
+{
+	/* Assets referenced by Server or Client And Server Tasks, or by the Ability itself. */
+	TArray<FSoftObjectPath> m_Gameplay;
+
+	/* Assets only referenced by Client Tasks. A dedicated server never runs those Tasks, so it can skip these. */
+	TArray<FSoftObjectPath> m_Cosmetic;
+
+	/* Walks the Ability and every Task (including instanced sub objects, such as Targeting and Collision queries) for hard and soft references to assets outside the Ability's own package. */
+	static void Gather(const UAblAbility& Ability, FAblAbilityDependencies& OutDependencies);
+
+	/* Returns the paths to load, the Ability class first. */
+	void GetLoadList(const FSoftObjectPath& AbilityClass, bool IncludeCosmetic, TArray<FSoftObjectPath>& OutPaths) const;
+};
+
+/* Ability class path to dependencies, written at cook time by the AblAbilityManifest commandlet and read back at runtime so an Ability and its content can be streamed in one request. */
+struct ABLECORE_API FAblAbilityManifest
+{
+	/* Adds (or replaces) the dependencies of an Ability class. */
+	void Add(const FSoftObjectPath& AbilityClass, FAblAbilityDependencies&& Dependencies);
+
+	/* Returns the dependencies of an Ability class, or nullptr if it isn't in the manifest. */
+	const FAblAbilityDependencies* Find(const FSoftObjectPath& AbilityClass) const { return m_Abilities.Find(AbilityClass); }
+
+	int32 Num() const { return m_Abilities.Num(); }
+
+	/* Returns every Ability class in the manifest, sorted by path. */
+	void GetAbilityClasses(TArray<FSoftObjectPath>& OutAbilityClasses) const;
+
+	/* JSON, sorted by path so re-running the commandlet on unchanged content produces the same file. */
+	bool SaveToFile(const FString& FilePath) const;
+	bool LoadFromFile(const FString& FilePath);
+
+private:
+	TMap<FSoftObjectPath, FAblAbilityDependencies> m_Abilities;
+};
+
+/* Ability class <-> index table, so FAblAbilityNetworkContext can send an Ability as a small integer instead of an object reference.
+ * Built from the manifest, which the server and its clients load from the same cooked content, so the indices agree on both ends.
+ * Abilities that aren't in the table (no manifest, instanced Abilities) fall back to a normal object reference. */
+struct ABLECORE_API FAblAbilityNetIndex
+{
+	static FAblAbilityNetIndex& Get();
+
+	/* Replaces the table with the manifest's Ability classes, in path order. */
+	void Build(const FAblAbilityManifest& Manifest);
+
+	/* Returns the index of an Ability class default object, or INDEX_NONE. Game thread only. */
+	int32 Find(const UAblAbility* Ability) const;
+
+	/* Returns the Ability class default object for an index if its class is loaded. Otherwise starts loading it and returns nullptr. Game thread only. */
+	const UAblAbility* Resolve(int32 Index) const;
+
+	int32 Num() const { return m_AbilityClasses.Num(); }
+
+private:
+	/* A class seen by Find, weak so a class that was unloaded (and its address reused) isn't mistaken for it. */
+	struct FClassIndex
+	{
+		TWeakObjectPtr<const UClass> m_Class;
+		int32 m_Index;
+	};
+
+	TArray<FSoftObjectPath> m_AbilityClasses;
+	TMap<FSoftObjectPath, int32> m_Indices;
+
+	/* Find results by class, including classes that aren't in the table, so sends don't build paths. */
+	mutable TMap<const UClass*, FClassIndex> m_ClassIndices;
+
+	/* Classes Resolve has found, by index. */
+	mutable TArray<TWeakObjectPtr<const UClass>> m_ResolvedClasses;
+
+	/* Indices Resolve has started loading. */
+	mutable TBitArray<> m_LoadsRequested;
+};
+
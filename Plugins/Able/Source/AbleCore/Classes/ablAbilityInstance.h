@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "ablAbilityTaskPlan.h"
 #include "ablAbilityTypes.h"
 #include "Tasks/IAblAbilityTask.h"
 #include "UObject/ObjectMacros.h"
@@ -21,7 +22,7 @@ struct FAblAbilityInstance
 public:
 	FAblAbilityInstance();
 
-	/* Initializes this instance, allocates any scratch pads, sorts our tasks into Async/Sync arrays. */
+	/* Initializes this instance, allocates any scratch pads, marks our tasks as pending in their Async/Sync lanes. */
 	void Initialize(UAblAbilityContext& AbilityContext);
 
 	/* Called just before we begin processing an update. There is no PostUpdate since we have no idea when our Async tasks have finished. */
@@ -33,6 +34,9 @@ public:
 	/* True/False depending on if we have any Async friendly tasks. */
 	bool HasAsyncTasks() const;
 
+	/* True/False depending on if we have any Synchronous tasks. */
+	bool HasSyncTasks() const;
+
 	/* Resets the instance for the next run. */
 	void ResetForNextIteration();
 
@@ -126,44 +130,59 @@ public:
 	bool IsValid() const { return m_Context != nullptr; }
 
 protected:
+	/* Per lane Task state. Bits are indexed by the Task's slot within the lane (see FAblAbilityTaskPlan::GetLaneSlot). */
+	struct FLaneState
+	{
+		FLaneState() : NumPending(0), NumActive(0) {}
+
+		/* Sizes the bit arrays and clears all state. */
+		void Init(int32 NumSlots);
+
+		/* Tasks waiting to start. */
+		TBitArray<> Pending;
+
+		/* Tasks currently being executed. */
+		TBitArray<> Active;
+
+		/* Tasks that have been completed, used when looping. */
+		TBitArray<> Finished;
+
+		int32 NumPending;
+		int32 NumActive;
+	};
+
 	/* Shared code used by both Update versions (Async/Sync). */
-	void InternalUpdateTasks(TArray<const UAblAbilityTask*>& InTasks, TArray<const UAblAbilityTask*>& InActiveTasks, TArray<const UAblAbilityTask*>& InFinishedTasks, float CurrentTime, float DeltaTime);
-	
+	void InternalUpdateTasks(EAblTaskLane Lane, float CurrentTime, float DeltaTime);
+
+	/* Marks all Tasks that are enabled and valid for our Net Mode as pending. Active Tasks are left alone. */
+	void QueuePendingTasks();
+
 	/* Safely calls the appropriate OnTaskEnd for all running tasks. */
 	void InternalStopRunningTasks(EAblAbilityTaskResult Reason, bool ResetForLoop = false);
 
 	/* Sets all our Tasks we are keeping track of as being non-executed. */
 	void ResetTaskDependencyStatus();
 
+	/* Flags a Task as having finished, for dependency purposes. */
+	void MarkTaskDone(int32 TaskIndex);
+
+	/* Returns true if all the Task's dependencies have finished. */
+	bool AreDependenciesDone(int32 TaskIndex) const;
+
     /* Our stack decay time, if any. */
     UPROPERTY(Transient)
     float m_DecayTime;
 
-	/* Note we only store pointers to our tasks. The tasks themselves are stateless/purely functional (State is stored inside Scratch Pads as needed). */
-	
-	/* Array of all Asynchronous Tasks in this Ability. */
-	UPROPERTY(Transient)
-	TArray<const UAblAbilityTask*> m_AsyncTasks;
+	/* Note we only refer to our tasks by index into the plan. The tasks themselves are stateless/purely functional (State is stored inside Scratch Pads as needed). */
 
-	/* Array of any Asynchronous Tasks currently being executed. */
-	UPROPERTY(Transient)
-	TArray<const UAblAbilityTask*> m_ActiveAsyncTasks;
+	/* Our Ability's baked Task plan. */
+	TSharedPtr<const FAblAbilityTaskPlan> m_TaskPlan;
 
-	/* Array of Asynchronous Tasks that have been completed, used when looping. */
-	UPROPERTY(Transient)
-	TArray<const UAblAbilityTask*> m_FinishedAyncTasks;
-	
-	/* Array of all Synchronous Tasks in this Ability. */
-	UPROPERTY(Transient)
-	TArray<const UAblAbilityTask*> m_SyncTasks;
+	/* Sync/Async Task state. */
+	FLaneState m_Lanes[(uint8)EAblTaskLane::Count];
 
-	/* Array of any Synchronous Tasks currently being executed. */
-	UPROPERTY(Transient)
-	TArray<const UAblAbilityTask*> m_ActiveSyncTasks;
-
-	/* Array of Synchronous Tasks that have been completed, used when looping. */
-	UPROPERTY(Transient)
-	TArray<const UAblAbilityTask*> m_FinishedSyncTasks;
+	/* Tasks that have finished at least once, indexed by plan Task index. Shared by both lanes, lock free. */
+	FAblTaskDoneMask m_TaskDone;
 
 	/* The Ability. */
 	UPROPERTY(Transient)
@@ -180,10 +199,6 @@ protected:
 	UPROPERTY(Transient)
 	TArray<TWeakObjectPtr<AActor>> m_AdditionalTargets;
 
-	/* Tasks we need to keep track of, for dependency purposes. */
-	UPROPERTY(Transient)
-	TMap<const UAblAbilityTask*, bool> m_TaskDependencyMap;
-
 	UPROPERTY(Transient)
 	TWeakObjectPtr<AActor> m_RequestedInstigator;
 
@@ -195,9 +210,6 @@ protected:
 
 	/* Critical Section for AddAdditionalTargets. */
 	FCriticalSection m_AddTargetCS;
-
-	/* Critical Section for Task Dependency Map. */
-	FCriticalSection m_DependencyMapCS;
 };
 
 template<>
@@ -0,0 +1,123 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UAblAbilityTask;
+class UScriptStruct;
+
+/* Execution lanes, Tasks run in one or the other based on IsAsyncFriendly. */
+enum class EAblTaskLane : uint8
+{
+	Sync = 0,
+	Async,
+	Count
+};
+
+/* Dependencies that live in a single 64 bit word of a FAblTaskDoneMask. A Word of INDEX_NONE is a Dependency that isn't part of the Ability and can never be satisfied. */
+struct FAblTaskDependencyWord
+{
+	int32 Word;
+	uint64 Mask;
+};
+
+/* Finished Tasks, indexed by plan Task index. Lock free, both lanes can publish and check at the same time.
+ * A finished Task publishes with a single atomic OR, a waiting Task checks each word its Dependencies live in with a single load (usually just the one). */
+struct ABLECORE_API FAblTaskDoneMask
+{
+	/* Sizes the mask and clears all bits. Not thread safe. */
+	void Init(int32 NumTasks);
+
+	/* Flags a Task as finished. */
+	void MarkDone(int32 TaskIndex);
+
+	/* Clears a Task's finished flag. */
+	void ClearDone(int32 TaskIndex);
+
+	/* Returns true if the Task has finished. */
+	bool IsDone(int32 TaskIndex) const;
+
+	/* Returns true if all the Dependencies have finished. */
+	bool AreDone(TArrayView<const FAblTaskDependencyWord> Dependencies) const;
+
+	/* Returns the number of Tasks the mask was sized for. */
+	FORCEINLINE int32 Num() const { return m_NumTasks; }
+
+private:
+	FORCEINLINE static int32 GetWord(int32 TaskIndex) { return TaskIndex >> 6; }
+	FORCEINLINE static int64 GetBit(int32 TaskIndex) { return (int64)(1ULL << (TaskIndex & 63)); }
+
+	TArray<int64, TInlineAllocator<2>> m_Words;
+	int32 m_NumTasks = 0;
+};
+
+/* Immutable, baked view of an Ability's Tasks. Built by the Ability during PreExecutionInit and shared by every running Instance of it.
+ * Tasks are referred to by index so Instances can keep their per Task state in bit arrays rather than arrays of pointers and maps.
+ * The index doubles as the Task's ScratchPad slot, and the plan lays out one arena for any struct ScratchPads. */
+struct ABLECORE_API FAblAbilityTaskPlan
+{
+	/* Start events for a single lane. */
+	struct FLane
+	{
+		/* Task indices, sorted by Start Time. */
+		TArray<int32> Tasks;
+
+		/* Start Time of each entry in Tasks. */
+		TArray<float> StartTimes;
+	};
+
+	/* Bakes the plan from the Ability's Task list. */
+	void Build(const TArray<UAblAbilityTask*>& InTasks);
+
+	/* Returns the number of Tasks in the plan. */
+	FORCEINLINE int32 Num() const { return m_Tasks.Num(); }
+
+	/* Returns the Task at the given index. */
+	FORCEINLINE const UAblAbilityTask* GetTask(int32 TaskIndex) const { return m_Tasks[TaskIndex]; }
+
+	/* Returns the lane for a Task. */
+	FORCEINLINE EAblTaskLane GetTaskLane(int32 TaskIndex) const { return (EAblTaskLane)m_TaskLanes[TaskIndex]; }
+
+	/* Returns the position of a Task within its lane. */
+	FORCEINLINE int32 GetLaneSlot(int32 TaskIndex) const { return m_LaneSlots[TaskIndex]; }
+
+	/* Returns the start events for a lane. */
+	FORCEINLINE const FLane& GetLane(EAblTaskLane Lane) const { return m_Lanes[(uint8)Lane]; }
+
+	/* Returns the Dependencies for a Task, grouped by the FAblTaskDoneMask word they live in. */
+	FORCEINLINE TArrayView<const FAblTaskDependencyWord> GetDependencies(int32 TaskIndex) const
+	{
+		return TArrayView<const FAblTaskDependencyWord>(m_DependencyWords.GetData() + m_DependencyOffsets[TaskIndex], m_DependencyOffsets[TaskIndex + 1] - m_DependencyOffsets[TaskIndex]);
+	}
+
+	/* Returns the index of the Task in this plan (also its ScratchPad slot), or INDEX_NONE. */
+	int32 FindTaskIndex(const UAblAbilityTask* Task) const;
+
+	/* Returns the struct ScratchPad type for a Task, or nullptr if it doesn't use one. */
+	FORCEINLINE const UScriptStruct* GetScratchPadStruct(int32 TaskIndex) const { return m_ScratchPadStructs[TaskIndex]; }
+
+	/* Returns the offset of a Task's struct ScratchPad within the ScratchPad arena, or INDEX_NONE. */
+	FORCEINLINE int32 GetScratchPadOffset(int32 TaskIndex) const { return m_ScratchPadOffsets[TaskIndex]; }
+
+	/* Returns the size of the ScratchPad arena, 0 if no Tasks use struct ScratchPads. */
+	FORCEINLINE int32 GetScratchPadArenaSize() const { return m_ScratchPadArenaSize; }
+
+	/* Returns the alignment required by the ScratchPad arena. */
+	FORCEINLINE int32 GetScratchPadArenaAlignment() const { return m_ScratchPadArenaAlignment; }
+
+private:
+	TArray<const UAblAbilityTask*> m_Tasks;
+	TMap<const UAblAbilityTask*, int32> m_TaskIndices;
+	TArray<uint8> m_TaskLanes;
+	TArray<int32> m_LaneSlots;
+	TArray<int32> m_DependencyOffsets;
+	TArray<FAblTaskDependencyWord> m_DependencyWords;
+	FLane m_Lanes[(uint8)EAblTaskLane::Count];
+
+	// Struct ScratchPads, indexed by Task index.
+	TArray<const UScriptStruct*> m_ScratchPadStructs;
+	TArray<int32> m_ScratchPadOffsets;
+	int32 m_ScratchPadArenaSize = 0;
+	int32 m_ScratchPadArenaAlignment = 1;
+};
@@ -58,44 +58,6 @@ private:
 	float m_DeltaTime;
 };
 
-class FAsyncAbilityCooldownUpdaterTask
-{
-public:
-	// We make a copy of the Current time since it is written to during the sync update.
-	FAsyncAbilityCooldownUpdaterTask(UAblAbilityComponent* InComponent, float InDeltaTime)
-		: m_AbilityComponent(InComponent),
-		m_DeltaTime(InDeltaTime)
-	{ }
-
-	/* Update all Cooldowns. */
-	void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
-	{
-		if (m_AbilityComponent.IsValid())
-		{
-			m_AbilityComponent->UpdateCooldowns(m_DeltaTime);
-		}
-	}
-
-	/* Returns the mode of this Task. */
-	static ESubsequentsMode::Type GetSubsequentsMode() { return ESubsequentsMode::FireAndForget; }
-	
-	/* Returns the desired thread of this Task. */
-	ENamedThreads::Type GetDesiredThread() { return ENamedThreads::GameThread; }
-	
-	/* Returns the Profiler Stat ID for this Task. */
-	FORCEINLINE TStatId GetStatId() const
-	{
-		RETURN_QUICK_DECLARE_CYCLE_STAT(FAsyncAbilityInstanceUpdaterTask, STATGROUP_TaskGraphTasks);
-	}
-
-private:
-	/* The Ability Component to update Cooldowns on. */
-	TWeakObjectPtr<UAblAbilityComponent> m_AbilityComponent;
-
-	/* The Delta Time to apply. */
-	float m_DeltaTime;
-};
-
 struct FAblFindAbilityInstanceByHash
 {
 	FAblFindAbilityInstanceByHash(uint32 InAbilityHash)
@@ -0,0 +1,50 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* How the vertical extent of a 3D (non slice) cone is tested. */
+enum class EAblConeHeightTest : uint8
+{
+	/* Angle between the cone forward and the target is less than the height angle (Targeting Cone). */
+	Angle = 0,
+
+	/* Dot product between the cone forward and the target is less than the height angle (Collision Query Cone, kept as is so existing Abilities hit the same targets). */
+	Dot
+};
+
+/* Cone / sector test shared by UAblTargetingCone and UAblCollisionShapeCone.
+ * Filter gathers candidate offsets into SoA float arrays and tests four at a time against precomputed cosines (no Acos), then compacts the survivors.
+ * Any candidate that lands within a small tolerance of a threshold is re-tested with TestScalar (the original per result code), so the accepted set is the same. */
+struct ABLECORE_API FAblConeFilter
+{
+	FAblConeFilter(const FTransform& QueryTransform, float FOV, float Height, float Length, bool Is2D, bool Is3DSlice, EAblConeHeightTest HeightTest);
+
+	/* Appends the index of every Location inside the cone to OutPassed, in order. */
+	void Filter(TArrayView<const FVector> Locations, TArray<int32>& OutPassed) const;
+
+	/* Tests a single Location, one branch at a time. */
+	bool TestScalar(const FVector& Location) const;
+
+private:
+	// Scalar values, same types as the original per result code.
+	FVector m_QueryLocation;
+	FVector m_QueryForward;
+	FVector2D m_XYForward;
+	float m_HalfAngle;
+	float m_HeightAngle;
+	float m_LengthSqr;
+	float m_HeightSqr;
+	float m_Height;
+
+	// Batched values.
+	float m_RangeSqr;
+	float m_CosHalfAngle;
+	float m_CosHeightAngle;
+
+	bool m_GreaterThanOneEighty;
+	bool m_Is2D;
+	bool m_Is3DSlice;
+	EAblConeHeightTest m_HeightTest;
+};
@@ -0,0 +1,114 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UAblAbility;
+class UAblAbilityContext;
+
+/* Stable reference to a Cooldown entry. Entries move around as the table is compacted, Handles don't. */
+struct ABLECORE_API FAblCooldownHandle
+{
+	FAblCooldownHandle() : Index(INDEX_NONE), Serial(0U) {}
+	FAblCooldownHandle(int32 InIndex, uint32 InSerial) : Index(InIndex), Serial(InSerial) {}
+
+	bool IsSet() const { return Index != INDEX_NONE; }
+
+	int32 Index;
+	uint32 Serial;
+};
+
+/* Cooldowns for every Ability Component in a World, stored as parallel arrays (Ability Hash, Owner, Current Time, Total Time).
+ * A single pass advances all Cooldowns each frame, finished entries are swap removed. Owners (Ability Components) are referenced by index.
+ * Only Abilities that can't cache their Cooldown keep a reference to their Ability/Context, so their Total Time can be recalculated before the update. */
+class ABLECORE_API FAblCooldownTable
+{
+public:
+	FAblCooldownTable();
+
+	/* Returns a new Owner index, used for all the Owner's Cooldowns. */
+	int32 AllocateOwner();
+
+	/* Removes all Cooldowns for this Owner and frees up the index. */
+	void ReleaseOwner(int32 OwnerIndex);
+
+	/* Starts (or restarts) the Cooldown for this Ability. Returns an unset Handle if the Ability has no Cooldown. */
+	FAblCooldownHandle Add(int32 OwnerIndex, const UAblAbility& Ability, const UAblAbilityContext& Context);
+
+	/* Starts (or restarts) a Cooldown with an explicit total time. */
+	FAblCooldownHandle Add(int32 OwnerIndex, uint32 AbilityHash, float TotalTime);
+
+	/* Returns the Handle for an Owner's Ability Cooldown, if it's active. */
+	FAblCooldownHandle Find(int32 OwnerIndex, uint32 AbilityHash) const;
+
+	/* Returns true if this Handle still refers to an active Cooldown. */
+	bool IsValid(const FAblCooldownHandle& Handle) const;
+
+	/* Removes the Cooldown. */
+	void Remove(const FAblCooldownHandle& Handle);
+
+	/* Returns a value between 0 - 1.0 with how much of the Cooldown has elapsed. */
+	float GetRatio(const FAblCooldownHandle& Handle) const;
+
+	/* Returns the elapsed time of the Cooldown. */
+	float GetCurrentTime(const FAblCooldownHandle& Handle) const;
+
+	/* Returns the total time of the Cooldown. */
+	float GetTotalTime(const FAblCooldownHandle& Handle) const;
+
+	/* Overrides the total time of the Cooldown. The Ability will no longer recalculate it. */
+	void SetTotalTime(const FAblCooldownHandle& Handle, float TotalTime);
+
+	/* Advances all Cooldowns and removes any that have finished. */
+	void Update(float DeltaTime);
+
+	/* Returns the total number of active Cooldowns. */
+	int32 Num() const { return m_CurrentTimes.Num(); }
+
+	/* Returns the number of active Cooldowns for this Owner. */
+	int32 Num(int32 OwnerIndex) const { return m_OwnerCounts.IsValidIndex(OwnerIndex) ? m_OwnerCounts[OwnerIndex] : 0; }
+
+	/* Clears all Cooldowns and Owners. */
+	void Reset();
+
+private:
+	/* An Ability that can't cache its Cooldown. */
+	struct FCooldownSource
+	{
+		int32 HandleIndex;
+		TWeakObjectPtr<const UAblAbility> Ability;
+		TWeakObjectPtr<const UAblAbilityContext> Context;
+	};
+
+	static uint64 MakeKey(int32 OwnerIndex, uint32 AbilityHash) { return ((uint64)(uint32)OwnerIndex << 32) | (uint64)AbilityHash; }
+
+	int32 GetDenseIndex(const FAblCooldownHandle& Handle) const;
+	void RemoveAtDense(int32 DenseIndex);
+	void RemoveSource(int32 HandleIndex);
+
+	// Entries, all the same length.
+	TArray<uint32> m_AbilityHashes;
+	TArray<int32> m_OwnerIndices;
+	TArray<float> m_CurrentTimes;
+	TArray<float> m_TotalTimes;
+	TArray<int32> m_HandleIndices;
+
+	// Handles, indexed by Handle Index.
+	TArray<int32> m_HandleToDense;
+	TArray<uint32> m_HandleSerials;
+	TArray<int32> m_HandleSources;
+	TArray<int32> m_FreeHandles;
+	uint32 m_NextSerial;
+
+	/* Owner + Ability Hash to Handle Index. */
+	TMap<uint64, int32> m_HandleLookup;
+
+	/* Abilities that recalculate their Cooldown each update. */
+	TSparseArray<FCooldownSource> m_Sources;
+
+	// Owners.
+	TArray<int32> m_OwnerCounts;
+	TArray<int32> m_FreeOwners;
+};
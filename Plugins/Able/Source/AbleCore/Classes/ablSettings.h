@@ -27,9 +27,6 @@ public:
 	/* Returns true if the Async Update for Abilities is allowed. */
 	FORCEINLINE bool GetAllowAbilityAsyncUpdate() const { return m_AllowAsyncAbilityUpdate; }
 	
-	/* Returns true if the Async Cooldown Update is allowed. */
-	FORCEINLINE bool GetAllowAsyncCooldownUpdate() const { return m_AllowAsyncCooldownUpdate; }
-
 	/* Returns true if we should log all Ability failures. */
 	FORCEINLINE bool GetLogAbilityFailures() const { return m_LogAbilityFailues; }
 	
@@ -68,6 +65,24 @@ public:
 
 	/* Returns the Max ScratchPad pool size. */
 	FORCEINLINE uint32 GetMaxScratchPadPoolSize() const { return m_MaxPooledScratchPadsSize; }
+
+	/* Returns whether or not Ability Components are updated in batches by the world scheduler rather than ticking individually. */
+	FORCEINLINE bool GetUseBatchedAbilityUpdate() const { return m_UseBatchedAbilityUpdate; }
+
+	/* Returns whether or not Ability Component owners are registered with the world Target Index. */
+	FORCEINLINE bool GetEnableTargetIndex() const { return m_EnableTargetIndex; }
+
+	/* Returns the Target Index grid cell size. */
+	FORCEINLINE float GetTargetIndexCellSize() const { return m_TargetIndexCellSize; }
+
+	/* Returns whether or not client only Tasks are left out of server cooks. */
+	FORCEINLINE bool GetStripClientTasksOnServer() const { return m_StripClientTasksOnServer; }
+
+	/* Returns whether or not client Activate / Branch / Cancel requests issued in the same frame are sent to the server as one RPC. */
+	FORCEINLINE bool GetBatchAbilityRPCs() const { return m_BatchAbilityRPCs; }
+
+	/* Returns how long a locally predicted Passive can wait for the server before it's stopped. */
+	FORCEINLINE float GetPredictedPassiveTimeout() const { return m_PredictedPassiveTimeout; }
 private:
 	/* If true, Able will attempt to use Async options when available and hardware permits it. */
 	UPROPERTY(config, EditAnywhere, Category = Ability, meta=(DisplayName="Enable Async"))
@@ -77,10 +92,6 @@ private:
 	UPROPERTY(config, EditAnywhere, Category = Ability, meta=(DisplayName="Allow Async Ability Update", EditCondition=m_EnableAsync))
 	bool m_AllowAsyncAbilityUpdate;
 
-	/* If true, Ability components will launch a separate task to update their active cooldowns. This can increase performance during heavy ability usage. */
-	UPROPERTY(config, EditAnywhere, Category = Ability, meta = (DisplayName = "Allow Async Cooldown Update", EditCondition = m_EnableAsync))
-	bool m_AllowAsyncCooldownUpdate;
-
 	/* If true, we write out Ability name and failure codes when they fail to play (cooldown, custom check, etc). */
 	UPROPERTY(config, EditAnywhere, Category = Ability, meta = (DisplayName = "Log Ability Failures"))
 	bool m_LogAbilityFailues;
@@ -132,4 +143,28 @@ private:
 	/* The maximum number of Scratchpads to pool. You can use this value to prevent Able from holding on to too many Scratchpads if there's a sudden spike of Abilities. 0 = No limit. Only enable this if you see memory being an issue.*/
 	UPROPERTY(config, EditAnywhere, Category = Ability, meta = (DisplayName = "Max Scratchpad Pool Size"))
 	uint32 m_MaxPooledScratchPadsSize;
+
+	/* If true, Ability Components in game worlds no longer tick on their own. Instead a world scheduler updates every registered component in phases (Cooldowns, Pending Queues, Instances). Use "stat AbleScheduler" to compare costs.*/
+	UPROPERTY(config, EditAnywhere, Category = Ability, meta = (DisplayName = "Use Batched Ability Update"))
+	bool m_UseBatchedAbilityUpdate;
+
+	/* If true, the owners of Ability Components in game worlds are kept in an in memory grid, rebuilt once a frame. Targeting and Collision Query shapes with "Use Target Index" set query it instead of the physics scene. Use "Able.BenchTargetIndex" to compare costs.*/
+	UPROPERTY(config, EditAnywhere, Category = Ability, meta = (DisplayName = "Enable Target Index"))
+	bool m_EnableTargetIndex;
+
+	/* Size (in cm) of the Target Index grid cells. Roughly the radius of your common queries works well.*/
+	UPROPERTY(config, EditAnywhere, Category = Ability, meta = (DisplayName = "Target Index Cell Size", ClampMin = 50.0f, EditCondition = m_EnableTargetIndex))
+	float m_TargetIndexCellSize;
+
+	/* If true, Tasks that only run on clients (Particle Effects, Sounds, Camera Shakes, etc) are left out of server cooks along with any assets only they reference. Run "-run=AblAbilityManifest -Report" to see the savings per Ability.*/
+	UPROPERTY(config, EditAnywhere, Category = Ability, meta = (DisplayName = "Strip Client Tasks On Server"))
+	bool m_StripClientTasksOnServer;
+
+	/* If true, the Activate, Branch and Cancel requests a client issues in one frame are buffered and sent to the server as a single RPC at the end of the frame. The server still runs them in order. Use "Able.AbilityRPCSoak" and "Able.AbilityRPCStats" to compare.*/
+	UPROPERTY(config, EditAnywhere, Category = Ability, meta = (DisplayName = "Batch Ability RPCs"))
+	bool m_BatchAbilityRPCs;
+
+	/* How long (in seconds) a Passive the local player predicted can run without showing up in the server's Passives. After that it's treated as rejected and stopped. Should be comfortably above your worst round trip time.*/
+	UPROPERTY(config, EditAnywhere, Category = Ability, meta = (DisplayName = "Predicted Passive Timeout", ClampMin = 0.1f))
+	float m_PredictedPassiveTimeout;
 };
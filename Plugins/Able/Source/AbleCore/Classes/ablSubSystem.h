@@ -2,11 +2,38 @@
 
 #pragma once
 
+#include "ablCooldownTable.h"
+#include "ablTargetIndex.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "Tasks/IAblAbilityTask.h"
 
 #include "ablSubSystem.generated.h"
 
+class UAblAbility;
+class UAblAbilityComponent;
+struct FAblAbilityInstance;
+
+/* An Async only Ability Instance update, deferred by the Scheduler so it can be run in parallel.
+ * Passives can be added (and the Passive array reallocated) while the instance phase is still running, so the Instance isn't stored.
+ * It's found again from the Ability and Context just before the parallel update. */
+struct ABLECORE_API FAblScheduledAsyncUpdate
+{
+	FAblScheduledAsyncUpdate(UAblAbilityComponent* InComponent, const FAblAbilityInstance& InInstance, bool InIsPassive, float InCurrentTime, float InDeltaTime);
+
+	/* Returns the Instance this update was queued for, or nullptr if it's gone (or was restarted with a new Context). */
+	FAblAbilityInstance* ResolveInstance() const;
+
+	UAblAbilityComponent* Component;
+	uint32 AbilityNameHash;
+	const UAblAbilityContext* Context;
+	bool IsPassive;
+	float CurrentTime;
+	float DeltaTime;
+
+	/* Set by ResolveInstance right before the parallel update, nothing can add or remove Instances after that. */
+	FAblAbilityInstance* Instance;
+};
+
 USTRUCT()
 struct ABLECORE_API FAblTaskScratchPadBucket
 {
@@ -59,11 +86,22 @@ public:
 	void ReturnTaskScratchPad(UAblAbilityTaskScratchPad* Scratchpad);
 	void ReturnAbilityScratchPad(UAblAbilityScratchPad* Scratchpad);
 
+	/* Fills the pools with the Ability / Task Scratchpads (and Contexts) these Abilities need, enough to run each Ability Copies times at once.
+	 * Pass the Ability Component they'll run on, so Tasks that look at the Owner when creating their Scratchpad see a real one. */
+	void PrewarmScratchPads(const TArray<const UAblAbility*>& Abilities, int32 Copies = 1, UAblAbilityComponent* AbilityComponent = nullptr);
+
+	/* Loads every Ability Blueprint under the provided content path (e.g. /Game/Skill) and prewarms the Scratchpads they need.
+	 * Loading is synchronous and the warm up Contexts have no Owner, prefer PrewarmScratchPads as Abilities finish loading. */
+	UFUNCTION(BlueprintCallable, Category = "Able")
+	void PrewarmScratchPadsInPath(const FString& Path, int32 Copies = 1);
+
+	/* Returns the number of Scratchpads currently sitting in the pools. */
+	uint32 GetTotalScratchPads() const { return m_TotalPooledScratchPads; }
+
 private:
 	// Helper methods
 	FAblTaskScratchPadBucket* GetTaskBucketByClass(TSubclassOf<UAblAbilityTaskScratchPad>& Class);
 	FAblAbilityScratchPadBucket* GetAbilityBucketByClass(TSubclassOf<UAblAbilityScratchPad>& Class);
-	uint32 GetTotalScratchPads() const;
 
 	UPROPERTY(Transient)
 	TArray<UAblAbilityContext*> m_AllocatedContexts;
@@ -72,11 +110,70 @@ private:
 	TArray<UAblAbilityContext*> m_AvailableContexts;
 
 	UPROPERTY(Transient)
-	TArray<FAblTaskScratchPadBucket> m_TaskBuckets;
+	TMap<UClass*, FAblTaskScratchPadBucket> m_TaskBuckets;
 
 	UPROPERTY(Transient)
-	TArray<FAblAbilityScratchPadBucket> m_AbilityBuckets;
+	TMap<UClass*, FAblAbilityScratchPadBucket> m_AbilityBuckets;
+
+	/* Running total of pooled Scratchpads across all buckets. */
+	uint32 m_TotalPooledScratchPads;
 
 	UPROPERTY(Transient)
 	const UAbleSettings* m_Settings;
-};
\ No newline at end of file
+};
+
+/* Updates every registered Ability Component in the world in batched phases (Cooldowns, Pending Queues, Instances) rather than one tick function per component.
+ * Components only register when "Use Batched Ability Update" is enabled in the Able settings. The world Cooldown table and Target Index are always owned and updated here. */
+UCLASS()
+class ABLECORE_API UAblAbilitySchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	UAblAbilitySchedulerSubsystem();
+	virtual ~UAblAbilitySchedulerSubsystem();
+
+	// UTickableWorldSubsystem Overrides
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	////
+
+	/* Adds the Component to the Scheduler, its own tick function will be left disabled. */
+	void RegisterComponent(UAblAbilityComponent* Component);
+
+	/* Removes the Component from the Scheduler. Safe to call mid update. */
+	void UnregisterComponent(UAblAbilityComponent* Component);
+
+	/* Returns the number of registered Components. */
+	int32 GetNumRegisteredComponents() const { return m_Components.Num(); }
+
+	/* Returns the Cooldown table shared by all Ability Components in this world. */
+	FAblCooldownTable& GetCooldownTable() { return m_CooldownTable; }
+
+	/* Returns the Target Index for this world. */
+	FAblTargetIndex& GetTargetIndex() { return m_TargetIndex; }
+
+	/* Returns the Target Index for the world, if it's enabled and has something in it. Queries fall back to the physics scene otherwise. */
+	static const FAblTargetIndex* FindTargetIndex(const UWorld* World);
+
+private:
+	UPROPERTY(Transient)
+	TArray<UAblAbilityComponent*> m_Components;
+
+	/* Components being updated this frame. Entries are nulled out if they unregister mid update. */
+	TArray<UAblAbilityComponent*> m_UpdateList;
+
+	/* Async only Instances queued during the Instance phase. */
+	TArray<FAblScheduledAsyncUpdate> m_AsyncUpdates;
+
+	/* Every Cooldown in the world. */
+	FAblCooldownTable m_CooldownTable;
+
+	/* Registered Targets, for queries that don't need the physics scene. */
+	FAblTargetIndex m_TargetIndex;
+
+	UPROPERTY(Transient)
+	const UAbleSettings* m_Settings;
+};
@@ -0,0 +1,102 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class AActor;
+class UPrimitiveComponent;
+struct FAblQueryResult;
+
+/* In memory broadphase for Able queries that only care about registered Actors (normally Pawns), so they can skip the physics scene entirely.
+ * Each Target is kept as a vertical capsule taken from its root component, and bucketed into a uniform XY grid that is rebuilt once a frame from Actor locations.
+ * Results match what an overlap against the root component would return, using the same object type filtering.
+ * Register / Unregister / Update are Game Thread only. Queries only read the per frame snapshot, so they're safe to run from the Async lane. */
+class ABLECORE_API FAblTargetIndex
+{
+public:
+	FAblTargetIndex();
+
+	/* Adds the Actor to the index. It will show up in queries after the next Update. */
+	void Register(AActor* Actor);
+
+	/* Removes the Actor from the index. It will no longer show up in queries after the next Update. */
+	void Unregister(AActor* Actor);
+
+	/* Sets the size (in cm) of the grid cells. Roughly the radius of a typical query works well. */
+	void SetCellSize(float CellSize);
+
+	/* Refreshes every Target's location / shape and rebuilds the grid. */
+	void Update();
+
+	/* Removes every Target. */
+	void Reset();
+
+	/* Returns the number of registered Targets. */
+	int32 Num() const { return m_Targets.Num(); }
+
+	/* Returns the number of Targets in the current snapshot. */
+	int32 NumIndexed() const { return m_Locations.Num(); }
+
+	/* Finds all Targets overlapping the sphere. ObjectTypeMask is a FCollisionObjectQueryParams query bitfield. */
+	void QuerySphere(const FVector& Center, float Radius, int32 ObjectTypeMask, TArray<FAblQueryResult>& OutResults) const;
+
+	/* Finds all Targets overlapping the oriented box. */
+	void QueryBox(const FVector& Center, const FQuat& Rotation, const FVector& HalfExtents, int32 ObjectTypeMask, TArray<FAblQueryResult>& OutResults) const;
+
+	/* Finds all Targets overlapping the capsule. HalfHeight includes the hemispheres, same as FCollisionShape::MakeCapsule. */
+	void QueryCapsule(const FVector& Center, const FQuat& Rotation, float Radius, float HalfHeight, int32 ObjectTypeMask, TArray<FAblQueryResult>& OutResults) const;
+
+private:
+	struct FTarget
+	{
+		const AActor* Key;
+		TWeakObjectPtr<AActor> Actor;
+	};
+
+	struct FCell
+	{
+		int32 Start;
+		int32 Num;
+	};
+
+	struct FSnapshotEntry
+	{
+		uint64 CellKey;
+		FVector Location;
+		float Radius;
+		float HalfSegment;
+		int32 ObjectTypeBit;
+		TWeakObjectPtr<AActor> Actor;
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+	};
+
+	FORCEINLINE int32 GetCellCoord(float Value) const { return FMath::FloorToInt(Value * m_InvCellSize); }
+	FORCEINLINE static uint64 MakeCellKey(int32 X, int32 Y) { return ((uint64)(uint32)X << 32) | (uint64)(uint32)Y; }
+
+	/* Runs Test on every Target whose cell overlaps the XY bounds (expanded by the largest Target radius). */
+	template<typename TestType>
+	void QueryBounds(const FVector& Min, const FVector& Max, int32 ObjectTypeMask, TestType&& Test, TArray<FAblQueryResult>& OutResults) const;
+
+	// Registered Targets.
+	TSparseArray<FTarget> m_Targets;
+	TMap<const AActor*, int32> m_TargetLookup;
+
+	// Snapshot, sorted by cell. All the same length.
+	TArray<FVector> m_Locations;
+	TArray<float> m_Radii;
+	TArray<float> m_HalfSegments;
+	TArray<int32> m_ObjectTypeBits;
+	TArray<TWeakObjectPtr<AActor>> m_Actors;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> m_Components;
+
+	/* Cell Key to range within the snapshot. */
+	TMap<uint64, FCell> m_Cells;
+
+	/* Scratch used to sort the snapshot by cell. */
+	TArray<FSnapshotEntry> m_SortScratch;
+
+	float m_InvCellSize;
+	float m_MaxRadius;
+};
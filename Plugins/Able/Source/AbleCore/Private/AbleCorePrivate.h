@@ -10,4 +10,5 @@
 DECLARE_LOG_CATEGORY_EXTERN(LogAble, Log, All);
 
 
-DECLARE_STATS_GROUP(TEXT("Able"), STATGROUP_Able, STATCAT_Advanced);
\ No newline at end of file
+DECLARE_STATS_GROUP(TEXT("Able"), STATGROUP_Able, STATCAT_Advanced);
+DECLARE_STATS_GROUP(TEXT("AbleScheduler"), STATGROUP_AbleScheduler, STATCAT_Advanced);
@@ -8,6 +8,7 @@
 #include "Components/SkeletalMeshComponent.h"
 #include "Targeting/ablTargetingFilters.h"
 #include "ablAbility.h"
+#include "ablSubSystem.h"
 
 #define LOCTEXT_NAMESPACE "AblAbilityTargeting"
 
@@ -18,7 +19,8 @@ UAblTargetingBase::UAblTargetingBase(const FObjectInitializer& ObjectInitializer
 	m_CalculateAs2DRange(true),
 	m_Location(),
 	m_CollisionChannel(ECollisionChannel::ECC_Pawn),
-	m_UseAsync(false)
+	m_UseAsync(false),
+	m_UseTargetIndex(false)
 {
 
 }
@@ -51,6 +53,26 @@ void UAblTargetingBase::FilterTargets(UAblAbilityContext& Context) const
 	}
 }
 
+const FAblTargetIndex* UAblTargetingBase::GetTargetIndex(const UWorld* World) const
+{
+	return m_UseTargetIndex ? UAblAbilitySchedulerSubsystem::FindTargetIndex(World) : nullptr;
+}
+
+void UAblTargetingBase::ProcessTargetIndexResults(UAblAbilityContext& Context, const TArray<FAblQueryResult>& Results) const
+{
+	TArray<TWeakObjectPtr<AActor>>& TargetActors = Context.GetMutableTargetActors();
+
+	for (const FAblQueryResult& Result : Results)
+	{
+		if (Result.Actor.IsValid())
+		{
+			TargetActors.Add(Result.Actor);
+		}
+	}
+
+	FilterTargets(Context);
+}
+
 FName UAblTargetingBase::GetDynamicDelegateName(const FString& PropertyName) const
 {
 	FString DelegateName = TEXT("OnGetDynamicProperty_Targeting_") + PropertyName;
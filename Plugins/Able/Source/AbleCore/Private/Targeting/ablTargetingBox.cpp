@@ -5,6 +5,7 @@
 #include "ablAbility.h"
 #include "ablAbilityDebug.h"
 #include "ablSettings.h"
+#include "ablTargetIndex.h"
 #include "Engine/World.h"
 
 UAblTargetingBox::UAblTargetingBox(const FObjectInitializer& ObjectInitializer)
@@ -37,7 +38,18 @@ void UAblTargetingBox::FindTargets(UAblAbilityContext& Context) const
 	FCollisionObjectQueryParams ObjectQuery;
 	GetCollisionObjectParams(ObjectQuery);
 
-	if (IsUsingAsync() && UAbleSettings::IsAsyncEnabled())
+	if (const FAblTargetIndex* TargetIndex = GetTargetIndex(World))
+	{
+		Location.GetTransform(Context, QueryTransform);
+
+		// Push our query out by our half extents so we aren't centered in the box.
+		QueryTransform *= FTransform(QueryTransform.GetRotation().GetForwardVector() * HalfExtents.X);
+
+		TArray<FAblQueryResult> Results;
+		TargetIndex->QueryBox(QueryTransform.GetLocation(), QueryTransform.GetRotation(), HalfExtents, ObjectQuery.GetQueryBitfield(), Results);
+		ProcessTargetIndexResults(Context, Results);
+	}
+	else if (IsUsingAsync() && UAbleSettings::IsAsyncEnabled())
 	{
 		// Check if we have a valid Async handle already. 
 		if (!Context.HasValidAsyncHandle())
@@ -5,6 +5,7 @@
 #include "ablAbility.h"
 #include "ablAbilityDebug.h"
 #include "ablSettings.h"
+#include "ablTargetIndex.h"
 #include "Engine/World.h"
 
 UAblTargetingCapsule::UAblTargetingCapsule(const FObjectInitializer& ObjectInitializer)
@@ -38,7 +39,15 @@ void UAblTargetingCapsule::FindTargets(UAblAbilityContext& Context) const
 	FCollisionObjectQueryParams ObjectQuery;
 	GetCollisionObjectParams(ObjectQuery);
 
-	if (IsUsingAsync() && UAbleSettings::IsAsyncEnabled())
+	if (const FAblTargetIndex* TargetIndex = GetTargetIndex(World))
+	{
+		Location.GetTransform(Context, QueryTransform);
+
+		TArray<FAblQueryResult> Results;
+		TargetIndex->QueryCapsule(QueryTransform.GetTranslation(), QueryTransform.GetRotation(), Radius, Height * 0.5f, ObjectQuery.GetQueryBitfield(), Results);
+		ProcessTargetIndexResults(Context, Results);
+	}
+	else if (IsUsingAsync() && UAbleSettings::IsAsyncEnabled())
 	{
 		if (!Context.HasValidAsyncHandle()) // If we don't have a handle, create our query.
 		{
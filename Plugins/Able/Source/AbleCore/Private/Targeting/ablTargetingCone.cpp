@@ -4,7 +4,9 @@
 
 #include "ablAbility.h"
 #include "ablAbilityDebug.h"
+#include "ablConeFilter.h"
 #include "ablSettings.h"
+#include "ablTargetIndex.h"
 #include "Engine/World.h"
 
 UAblTargetingCone::UAblTargetingCone(const FObjectInitializer& ObjectInitializer)
@@ -46,7 +48,23 @@ void UAblTargetingCone::FindTargets(UAblAbilityContext& Context) const
 	FCollisionObjectQueryParams ObjectQuery;
 	GetCollisionObjectParams(ObjectQuery);
 
-	if (IsUsingAsync() && UAbleSettings::IsAsyncEnabled())
+	if (const FAblTargetIndex* TargetIndex = GetTargetIndex(World))
+	{
+		// Same bounding sphere the physics query uses, then the usual cone test.
+		const float Radius = (Is2DQuery() ? Length : FMath::Max(Height, Length)) * 0.5f;
+
+		Location.GetTransform(Context, QueryTransform);
+
+		const FVector QueryForward = QueryTransform.GetRotation().GetForwardVector();
+		const FVector QueryLocation = FOV > 180.0f ? QueryTransform.GetTranslation() : QueryTransform.GetTranslation() + QueryForward * Radius;
+
+		TArray<FAblQueryResult> Results;
+		TargetIndex->QuerySphere(QueryLocation, FOV < 180.0f ? Radius : Radius * 2.0f, ObjectQuery.GetQueryBitfield(), Results);
+
+		Context.SetAsyncQueryTransform(QueryTransform);
+		ProcessResults(Context, Results, FOV, Height, Length);
+	}
+	else if (IsUsingAsync() && UAbleSettings::IsAsyncEnabled())
 	{
 		if (!Context.HasValidAsyncHandle()) // Populate our Async query
 		{
@@ -143,118 +161,43 @@ float UAblTargetingCone::CalculateRange() const
 
 void UAblTargetingCone::ProcessResults(UAblAbilityContext& Context, const TArray<struct FOverlapResult>& Results, float _FOV, float _Height, float _Length) const
 {
-	// Our output
-	TArray<TWeakObjectPtr<AActor>>& TargetActors = Context.GetMutableTargetActors();
-
-	// Grab the Transform we used.
-	const FTransform& QueryTransform = Context.GetAsyncQueryTransform();
-	FVector QueryLocation = QueryTransform.GetLocation();
-
-	// Cache off various values we use in our cone test.
-	const bool GreaterThanOneEighty = _FOV > 180.0f;
-	const float QueryAngle = GreaterThanOneEighty ? 360.0f - _FOV : _FOV;
-	const float HalfAngle = FMath::DegreesToRadians(QueryAngle * 0.5f);
-	const float LengthSqr = _Length * _Length;
-	const float HeightSqr = _Height * _Height;
-	const float HeightAngle = Is2DQuery() ? 0.0f : FMath::Atan2(_Height * 0.5f, _Length);
-
-	FVector QueryForward = QueryTransform.GetRotation().GetForwardVector();
-
-	// If we're great than 180, we take the angle of the "hole" and compare against that (which requires flipping our forward around).
-	if (GreaterThanOneEighty)
+	TArray<FAblQueryResult> Candidates;
+	Candidates.Reserve(Results.Num());
+	for (const FOverlapResult& Result : Results)
 	{
-		// Flip it around.
-		QueryForward = -QueryForward;
+		Candidates.Add(FAblQueryResult(Result));
 	}
 
-	// Store all our Vectors to test against.
-	const FVector QueryRight = QueryTransform.GetRotation().GetRightVector();
-	const FVector2D XYForward(QueryForward.X, QueryForward.Y); // Horiz Plane
-	const FVector2D XZForward(QueryForward.X, QueryForward.Z); // Vert Plane
-
-	// Various Parameters that will be written each check, declared here so we don't thrash the cache. 
-	FTransform ResultTransform; // Our Overlap Result Transform.
-	FVector ResultLocation; // Our Overlap Result Location (from our Transform).
-
-	FVector ToTarget; // Vector from our Query Location to our Result. 
-	FVector2D ToTargetXZ; // 2D Vector (XZ Plane) from our Query Location to our Result.
-	FVector2D ToTargetXY; // 2D Vector (XY Plane) from our Query Location to our Result.
+	ProcessResults(Context, Candidates, _FOV, _Height, _Length);
+}
 
-	bool ValidEntry = false; // Whether we've passed all checks or not.
-	bool WithInAngle = false; // Whether we're within our Cone Angle 
-	bool HalfSpace = false; // Half space check.
+void UAblTargetingCone::ProcessResults(UAblAbilityContext& Context, const TArray<FAblQueryResult>& Results, float _FOV, float _Height, float _Length) const
+{
+	// Our output
+	TArray<TWeakObjectPtr<AActor>>& TargetActors = Context.GetMutableTargetActors();
 
-	float QueryToTargetDotProduct = 0.0f; // Dot product of our XYForward and ToTargetXY.
-	float VerticalAngle = 0.0f;  // Angle, in radians, of our XZForward and ToTarget XZ.
+	// Grab the Transform we used.
+	const FAblConeFilter Cone(Context.GetAsyncQueryTransform(), _FOV, _Height, _Length, Is2DQuery(), Is3DSlice(), EAblConeHeightTest::Angle);
 
-	for (const FOverlapResult& Result : Results)
+	// Gather our Result locations.
+	FTransform ResultTransform;
+	TArray<FVector, TInlineAllocator<64>> ResultLocations;
+	ResultLocations.Reserve(Results.Num());
+	for (const FAblQueryResult& TempTarget : Results)
 	{
-		FAblQueryResult TempTarget(Result);
-
 		TempTarget.GetTransform(ResultTransform);
+		ResultLocations.Add(ResultTransform.GetTranslation());
+	}
 
-		ResultLocation = ResultTransform.GetTranslation();
-
-		ToTarget = ResultLocation - QueryLocation;
-		ToTarget.Normalize();
-		ToTargetXZ.Set(ToTarget.X, ToTarget.Z);
-		ToTargetXY.Set(ToTarget.X, ToTarget.Y);
-
-		ValidEntry = true;
-
-		// If we're a 3D query, we base our initial sphere query on whichever is largest (height or length),
-		// so do a quick distance check here, if those pass - go ahead and do our vertical angle check.
-		if (!Is2DQuery())
-		{
-			if (FVector::DistSquared(ResultLocation, QueryLocation) > HeightSqr ||
-				FVector::DistSquared(ResultLocation, QueryLocation) > LengthSqr)
-			{
-				ValidEntry = false;
-			}
-			else
-			{
-				if (Is3DSlice())
-				{
-					ValidEntry = FMath::Abs(ResultLocation.Z - QueryLocation.Z) <= _Height;
-				}
-				else
-				{
-					VerticalAngle = FMath::Acos(FVector::DotProduct(QueryForward, ToTarget));
-
-					ValidEntry = VerticalAngle < HeightAngle;
-				}
-			}
-		}
-		else
-		{
-			ValidEntry = FVector::DistSquared2D(ResultLocation, QueryLocation) <= LengthSqr;
-		}
-
-		// Move on to our Dot product checks
-		if (ValidEntry)
-		{
-			// Check our Horizontal angle.
-			QueryToTargetDotProduct = FVector2D::DotProduct(XYForward, ToTargetXY);
-
-			WithInAngle = FMath::Acos(QueryToTargetDotProduct) < HalfAngle;
-
-			HalfSpace = QueryToTargetDotProduct > 0.0f;
-
-			ValidEntry = WithInAngle && HalfSpace;
+	TArray<int32> Passed;
+	Cone.Filter(ResultLocations, Passed);
 
-			if (GreaterThanOneEighty) // If our FOV > 180 degrees, we want everything not in the angle check.
-			{
-				ValidEntry = !ValidEntry;
-			}
-		}
-
-		// Save our success
-		if (ValidEntry)
+	// Save our success
+	for (int32 ResultIndex : Passed)
+	{
+		if (Results[ResultIndex].Actor.IsValid())
 		{
-			if (TempTarget.Actor.IsValid())
-			{
-				TargetActors.Add(TempTarget.Actor);
-			}
+			TargetActors.Add(Results[ResultIndex].Actor);
 		}
 	}
 
@@ -5,6 +5,7 @@
 #include "ablAbility.h"
 #include "ablAbilityDebug.h"
 #include "ablSettings.h"
+#include "ablTargetIndex.h"
 #include "Engine/World.h"
 
 UAblTargetingSphere::UAblTargetingSphere(const FObjectInitializer& ObjectInitializer)
@@ -36,7 +37,15 @@ void UAblTargetingSphere::FindTargets(UAblAbilityContext& Context) const
 	FCollisionObjectQueryParams ObjectQuery;
 	GetCollisionObjectParams(ObjectQuery);
 
-	if (IsUsingAsync() && UAbleSettings::IsAsyncEnabled())
+	if (const FAblTargetIndex* TargetIndex = GetTargetIndex(World))
+	{
+		Location.GetTransform(Context, QueryTransform);
+
+		TArray<FAblQueryResult> Results;
+		TargetIndex->QuerySphere(QueryTransform.GetTranslation(), Radius, ObjectQuery.GetQueryBitfield(), Results);
+		ProcessTargetIndexResults(Context, Results);
+	}
+	else if (IsUsingAsync() && UAbleSettings::IsAsyncEnabled())
 	{
 		if (!Context.HasValidAsyncHandle()) // If we don't have a handle, create our query.
 		{
@@ -10,9 +10,9 @@
 #include "Serialization/ObjectWriter.h"
 #include "Serialization/ObjectReader.h"
 #include "Targeting/ablTargetingBase.h"
+#include "ablSettings.h"
 
 #if !(UE_BUILD_SHIPPING)
-#include "ablSettings.h"
 #include "ablAbilityUtilities.h"
 #if WITH_EDITOR
 #include "Editor.h"
@@ -186,12 +186,33 @@ void UAblAbilityTask::PostLoad()
     // remove any broken references
     const int32 numDependencies = m_Dependencies.Num();
     m_Dependencies.RemoveAll([](const UAblAbilityTask* Source) { return Source == nullptr; });
-    if (numDependencies < m_Dependencies.Num())
+    if (m_Dependencies.Num() < numDependencies)
     {
-        UE_LOG(LogAble, Warning, TEXT("UAblAbilityTask.PostLoad() %s had %d NULL Dependencies."), *GetClass()->GetName(), m_Dependencies.Num() - numDependencies);
+        // Server cooks leave client only Tasks out (see NeedsLoadForServer). A client Task never finishes on the server, so keep waiting on it forever
+        // rather than starting early now that it's gone.
+        const bool StrippedForServer = FPlatformProperties::RequiresCookedData() && IsRunningDedicatedServer() && GetDefault<UAbleSettings>()->GetStripClientTasksOnServer();
+        m_HasStrippedDependencies = StrippedForServer;
+        UE_CLOG(!StrippedForServer, LogAble, Warning, TEXT("UAblAbilityTask.PostLoad() %s had %d NULL Dependencies."), *GetClass()->GetName(), numDependencies - m_Dependencies.Num());
+        UE_CLOG(StrippedForServer, LogAble, Verbose, TEXT("UAblAbilityTask.PostLoad() %s had %d client Dependencies stripped, it will never start."), *GetClass()->GetName(), numDependencies - m_Dependencies.Num());
     }
 }
 
+bool UAblAbilityTask::NeedsLoadForServer() const
+{
+	// Client only Tasks never run on a server, so leave them (and anything only they reference) out of server cooks.
+	// The owning Ability drops the resulting NULL entries in PostLoad. The CDO is kept so the class itself still loads.
+	if (!HasAnyFlags(RF_ClassDefaultObject) && GetTaskRealm() == EAblAbilityTaskRealm::ATR_Client)
+	{
+		const UAbleSettings* Settings = GetDefault<UAbleSettings>();
+		if (Settings && Settings->GetStripClientTasksOnServer())
+		{
+			return false;
+		}
+	}
+
+	return Super::NeedsLoadForServer();
+}
+
 void UAblAbilityTask::PostInitProperties()
 {
 	Super::PostInitProperties();
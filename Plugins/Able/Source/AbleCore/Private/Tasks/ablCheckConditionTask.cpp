@@ -4,23 +4,11 @@
 
 #include "ablAbility.h"
 #include "ablAbilityComponent.h"
-#include "ablSubSystem.h"
 #include "AbleCorePrivate.h"
 #include "Tasks/ablBranchCondition.h"
 
 #define LOCTEXT_NAMESPACE "AblAbilityTask"
 
-UAblCheckConditionTaskScratchPad::UAblCheckConditionTaskScratchPad()
-    : ConditionMet(false)
-{
-
-}
-
-UAblCheckConditionTaskScratchPad::~UAblCheckConditionTaskScratchPad()
-{
-
-}
-
 UAblCheckConditionTask::UAblCheckConditionTask(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
     , m_ConditionEventName()
@@ -40,7 +28,7 @@ bool UAblCheckConditionTask::IsDone(const TWeakObjectPtr<const UAblAbilityContex
         return false;
 	}
 
-    UAblCheckConditionTaskScratchPad* ScratchPad = Cast<UAblCheckConditionTaskScratchPad>(Context->GetScratchPadForTask(this));
+    FAblCheckConditionTaskScratchPad* ScratchPad = Context->GetScratchPadStructForTask<FAblCheckConditionTaskScratchPad>(this);
     check(ScratchPad);
 
     return ScratchPad->ConditionMet;
@@ -50,7 +38,7 @@ void UAblCheckConditionTask::OnTaskStart(const TWeakObjectPtr<const UAblAbilityC
 {
 	Super::OnTaskStart(Context);
 
-	UAblCheckConditionTaskScratchPad* ScratchPad = Cast<UAblCheckConditionTaskScratchPad>(Context->GetScratchPadForTask(this));
+	FAblCheckConditionTaskScratchPad* ScratchPad = Context->GetScratchPadStructForTask<FAblCheckConditionTaskScratchPad>(this);
 	check(ScratchPad);
 
     ScratchPad->ConditionMet = CheckCondition(Context, *ScratchPad);
@@ -69,7 +57,7 @@ void UAblCheckConditionTask::OnTaskTick(const TWeakObjectPtr<const UAblAbilityCo
 {
 	Super::OnTaskTick(Context, deltaTime);
 
-    UAblCheckConditionTaskScratchPad* ScratchPad = CastChecked<UAblCheckConditionTaskScratchPad>(Context->GetScratchPadForTask(this));
+    FAblCheckConditionTaskScratchPad* ScratchPad = Context->GetScratchPadStructForTask<FAblCheckConditionTaskScratchPad>(this);
     check(ScratchPad);
 
     if (ScratchPad->ConditionMet)
@@ -90,23 +78,12 @@ void UAblCheckConditionTask::OnTaskTick(const TWeakObjectPtr<const UAblAbilityCo
 	}
 }
 
-UAblAbilityTaskScratchPad* UAblCheckConditionTask::CreateScratchPad(const TWeakObjectPtr<UAblAbilityContext>& Context) const
-{
-	if (UAblAbilityUtilitySubsystem* Subsystem = Context->GetUtilitySubsystem())
-	{
-		static TSubclassOf<UAblAbilityTaskScratchPad> ScratchPadClass = UAblCheckConditionTaskScratchPad::StaticClass();
-		return Subsystem->FindOrConstructTaskScratchPad(ScratchPadClass);
-	}
-
-	return NewObject<UAblCheckConditionTaskScratchPad>(Context.Get());
-}
-
 TStatId UAblCheckConditionTask::GetStatId() const
 {
 	RETURN_QUICK_DECLARE_CYCLE_STAT(UAblCheckConditionTask, STATGROUP_Able);
 }
 
-bool UAblCheckConditionTask::CheckCondition(const TWeakObjectPtr<const UAblAbilityContext>& Context, const UAblCheckConditionTaskScratchPad& ScratchPad) const
+bool UAblCheckConditionTask::CheckCondition(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FAblCheckConditionTaskScratchPad& ScratchPad) const
 {
     return Context.Get()->GetAbility()->CheckCustomConditionEventBP(Context.Get(), m_ConditionEventName);
 }
@@ -4,6 +4,9 @@
 
 #include "ablAbility.h"
 #include "ablAbilityDebug.h"
+#include "ablConeFilter.h"
+#include "ablSubSystem.h"
+#include "ablTargetIndex.h"
 #include "AbleCorePrivate.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Engine/Engine.h"
@@ -14,7 +17,8 @@
 
 UAblCollisionShape::UAblCollisionShape(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer),
-	m_UseAsyncQuery(false)
+	m_UseAsyncQuery(false),
+	m_UseTargetIndex(false)
 {
 
 }
@@ -34,6 +38,11 @@ UWorld* UAblCollisionShape::GetQueryWorld(const TWeakObjectPtr<const UAblAbility
 	return GEngine->GetWorld();
 }
 
+const FAblTargetIndex* UAblCollisionShape::GetTargetIndex(const UWorld* World) const
+{
+	return m_UseTargetIndex ? UAblAbilitySchedulerSubsystem::FindTargetIndex(World) : nullptr;
+}
+
 void UAblCollisionShape::ProcessAsyncOverlaps(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& QueryTransform, const TArray<FOverlapResult>& Overlaps, TArray<FAblQueryResult>& OutResults) const
 {
 	for (const FOverlapResult& Result : Overlaps)
@@ -138,7 +147,11 @@ void UAblCollisionShapeBox::DoQuery(const TWeakObjectPtr<const UAblAbilityContex
 	}
 
 	TArray<FOverlapResult> OverlapResults;
-    if (World->OverlapMultiByObjectType(OverlapResults, QueryTransform.GetLocation(), QueryTransform.GetRotation(), ObjectQuery, Box))
+	if (const FAblTargetIndex* TargetIndex = GetTargetIndex(World))
+	{
+		TargetIndex->QueryBox(QueryTransform.GetLocation(), QueryTransform.GetRotation(), HalfExtents, ObjectQuery.GetQueryBitfield(), OutResults);
+	}
+	else if (World->OverlapMultiByObjectType(OverlapResults, QueryTransform.GetLocation(), QueryTransform.GetRotation(), ObjectQuery, Box))
 	{
 		for (FOverlapResult& Result : OverlapResults)
 		{
@@ -283,7 +296,11 @@ void UAblCollisionShapeSphere::DoQuery(const TWeakObjectPtr<const UAblAbilityCon
 	}
 
 	TArray<FOverlapResult> OverlapResults;
-	if (World->OverlapMultiByObjectType(OverlapResults, QueryTransform.GetLocation(), QueryTransform.GetRotation(), ObjectQuery, Sphere))
+	if (const FAblTargetIndex* TargetIndex = GetTargetIndex(World))
+	{
+		TargetIndex->QuerySphere(QueryTransform.GetLocation(), Radius, ObjectQuery.GetQueryBitfield(), OutResults);
+	}
+	else if (World->OverlapMultiByObjectType(OverlapResults, QueryTransform.GetLocation(), QueryTransform.GetRotation(), ObjectQuery, Sphere))
 	{
 		for (FOverlapResult& Result : OverlapResults)
 		{
@@ -411,7 +428,11 @@ void UAblCollisionShapeCapsule::DoQuery(const TWeakObjectPtr<const UAblAbilityCo
 	}
 
 	TArray<FOverlapResult> OverlapResults;
-	if (World->OverlapMultiByObjectType(OverlapResults, QueryTransform.GetLocation(), QueryTransform.GetRotation(), ObjectQuery, Capsule))
+	if (const FAblTargetIndex* TargetIndex = GetTargetIndex(World))
+	{
+		TargetIndex->QueryCapsule(QueryTransform.GetLocation(), QueryTransform.GetRotation(), Radius, Height * 0.5f, ObjectQuery.GetQueryBitfield(), OutResults);
+	}
+	else if (World->OverlapMultiByObjectType(OverlapResults, QueryTransform.GetLocation(), QueryTransform.GetRotation(), ObjectQuery, Capsule))
 	{
 		for (FOverlapResult& Result : OverlapResults)
 		{
@@ -552,7 +573,16 @@ void UAblCollisionShapeCone::DoQuery(const TWeakObjectPtr<const UAblAbilityConte
 	}
 
 	TArray<FOverlapResult> OverlapResults;
-	if (World->OverlapMultiByObjectType(OverlapResults, QueryLocation, QueryTransform.GetRotation(), ObjectQuery, SphereShape))
+	if (const FAblTargetIndex* TargetIndex = GetTargetIndex(World))
+	{
+		// Same bounding sphere as the physics query, then the usual cone test.
+		TArray<FAblQueryResult> Candidates;
+		TargetIndex->QuerySphere(QueryLocation, SphereShape.GetSphereRadius(), ObjectQuery.GetQueryBitfield(), Candidates);
+
+		QueryTransform.SetScale3D(FVector(FOV, Height, Length)); // Store these values in the scale, this is safe because we don't use Scale anyway.
+		ProcessConeResults(QueryTransform, Candidates, OutResults);
+	}
+	else if (World->OverlapMultiByObjectType(OverlapResults, QueryLocation, QueryTransform.GetRotation(), ObjectQuery, SphereShape))
 	{
 		// Do our actual cone logic, just use the Async method to keep the logic in one place.
 		QueryTransform.SetScale3D(FVector(FOV, Height, Length)); // Store these values in the scale, this is safe because we don't use Scale anyway.
@@ -641,117 +671,42 @@ FTraceHandle UAblCollisionShapeCone::DoAsyncQuery(const TWeakObjectPtr<const UAb
 
 void UAblCollisionShapeCone::ProcessAsyncOverlaps(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& QueryTransform, const TArray<FOverlapResult>& Overlaps, TArray<FAblQueryResult>& OutResults) const
 {
-	float FOV = QueryTransform.GetScale3D().X;
-	float Height = QueryTransform.GetScale3D().Y;
-	float Length = QueryTransform.GetScale3D().Z;
-
-	// Cache off various values we use in our cone test.
-	const bool GreaterThanOneEighty = FOV > 180.0f;
-	const float QueryAngle = GreaterThanOneEighty ? 360.0f - FOV : FOV;
-	const float HalfAngle = FMath::DegreesToRadians(QueryAngle * 0.5f);
-	const float LengthSqr = Length * Length;
-	const float HeightSqr = Height * Height;
-	const float HeightAngle = m_Is2DQuery ? 0.0f : FMath::Atan2(Height * 0.5f, Length);
-
-	FVector QueryForward = QueryTransform.GetRotation().GetForwardVector();
-
-	// If we're great than 180, we take the angle of the "hole" and compare against that (which requires flipping our forward around).
-	if (GreaterThanOneEighty)
+	TArray<FAblQueryResult> Candidates;
+	Candidates.Reserve(Overlaps.Num());
+	for (const FOverlapResult& Result : Overlaps)
 	{
-		// Flip it around.
-		QueryForward = -QueryForward;
+		Candidates.Add(FAblQueryResult(Result));
 	}
 
-	// Store all our Vectors to test against.
-	const FVector QueryRight = QueryTransform.GetRotation().GetRightVector();
-	const FVector QueryLocation = QueryTransform.GetTranslation();
-	const FVector2D XYForward(QueryForward.X, QueryForward.Y); // Horiz Plane
-	const FVector2D XZForward(QueryForward.X, QueryForward.Z); // Vert Plane
-
-    // Various Parameters that will be written each check, declared here so we don't thrash the cache. 
-	FTransform ResultTransform; // Our Overlap Result Transform.
-	FVector ResultLocation; // Our Overlap Result Location (from our Transform).
-
-	FVector ToTarget; // Vector from our Query Location to our Result. 
-	FVector2D ToTargetXZ; // 2D Vector (XZ Plane) from our Query Location to our Result.
-	FVector2D ToTargetXY; // 2D Vector (XY Plane) from our Query Location to our Result.
+	ProcessConeResults(QueryTransform, Candidates, OutResults);
+}
 
-	bool ValidEntry = false; // Whether we've passed all checks or not.
-	bool WithInAngle = false; // Whether we're within our Cone Angle 
-	bool HalfSpace = false; // Half space check.
+void UAblCollisionShapeCone::ProcessConeResults(const FTransform& QueryTransform, const TArray<FAblQueryResult>& Candidates, TArray<FAblQueryResult>& OutResults) const
+{
+	float FOV = QueryTransform.GetScale3D().X;
+	float Height = QueryTransform.GetScale3D().Y;
+	float Length = QueryTransform.GetScale3D().Z;
 
-	float QueryToTargetDotProduct = 0.0f; // Dot product of our XYForward and ToTargetXY.
-	float VerticalAngle = 0.0f;  // Angle, in radians, of our XZForward and ToTarget XZ.
+	const FAblConeFilter Cone(QueryTransform, FOV, Height, Length, m_Is2DQuery, m_3DSlice, EAblConeHeightTest::Dot);
 
-	for (const FOverlapResult& Result : Overlaps)
+	// Gather our Candidate locations.
+	FTransform ResultTransform;
+	TArray<FVector, TInlineAllocator<64>> ResultLocations;
+	ResultLocations.Reserve(Candidates.Num());
+	for (const FAblQueryResult& TempTarget : Candidates)
 	{
-		FAblQueryResult TempTarget(Result);
-
 		TempTarget.GetTransform(ResultTransform);
+		ResultLocations.Add(ResultTransform.GetTranslation());
+	}
 
-		ResultLocation = ResultTransform.GetTranslation();
-
-		ToTarget = ResultLocation - QueryLocation;
-		ToTarget.Normalize();
-
-		ToTargetXZ.Set(ToTarget.X, ToTarget.Z);
-		ToTargetXY.Set(ToTarget.X, ToTarget.Y);
-
-		ValidEntry = true;
-
-		// If we're a 3D query, we base our initial sphere query on whichever is largest (height or length),
-		// so do a quick distance check here, if those pass - go ahead and do our vertical angle check.
-		if (!m_Is2DQuery)
-		{
-			if (FVector::DistSquared(ResultLocation, QueryLocation) > HeightSqr ||
-				FVector::DistSquared(ResultLocation, QueryLocation) > LengthSqr)
-			{
-				ValidEntry = false;
-			}
-			else
-			{
-				if (m_3DSlice)
-				{
-					ValidEntry = FMath::Abs(ResultLocation.Z - QueryLocation.Z) <= Height;
-				}
-				else
-				{
-					VerticalAngle = FVector::DotProduct(QueryForward, ToTarget);
-
-					ValidEntry = VerticalAngle < HeightAngle;
-				}
-			}
-		}
-		else
-		{
-			ValidEntry = FVector::DistSquared2D(ResultLocation, QueryLocation) <= LengthSqr;
-		}
-
-		// Move on to our Dot product checks
-		if (ValidEntry)
-		{
-			// Check our Horizontal angle.
-			QueryToTargetDotProduct = FVector2D::DotProduct(XYForward, ToTargetXY);
-
-			WithInAngle = FMath::Acos(QueryToTargetDotProduct) < HalfAngle;
-
-			HalfSpace = QueryToTargetDotProduct > 0.0f;
-
-			ValidEntry = WithInAngle && HalfSpace;
-
-			if (GreaterThanOneEighty) // If our FOV > 180 degrees, we want everything not in the angle check.
-			{
-				ValidEntry = !ValidEntry;
-			}
-		}
+	TArray<int32> Passed;
+	Cone.Filter(ResultLocations, Passed);
 
-		// Save our success
-		if (ValidEntry)
-		{
-			OutResults.Add(TempTarget);
-		}
+	// Save our success
+	for (int32 CandidateIndex : Passed)
+	{
+		OutResults.Add(Candidates[CandidateIndex]);
 	}
-
 }
 
 void UAblCollisionShapeCone::BindDynamicDelegates(class UAblAbility* Ability)
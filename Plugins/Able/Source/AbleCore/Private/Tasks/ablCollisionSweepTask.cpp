@@ -14,7 +14,8 @@
 UAblCollisionSweepTaskScratchPad::UAblCollisionSweepTaskScratchPad()
 	: SourceTransform(FTransform::Identity),
 	AsyncHandle(),
-	AsyncProcessed(false)
+	AsyncProcessed(false),
+	SubStepQueued(false)
 {
 
 }
@@ -28,6 +29,9 @@ UAblCollisionSweepTask::UAblCollisionSweepTask(const FObjectInitializer& ObjectI
 	: Super(ObjectInitializer),
 	m_FireEvent(false),
 	m_Name(NAME_None),
+	m_SubStep(false),
+	m_SubStepRate(30.0f),
+	m_MaxSubSteps(12),
 	m_CopyResultsToContext(true),
 	m_AllowDuplicateEntries(false),
 	m_ClearExistingTargets(false),
@@ -52,6 +56,16 @@ void UAblCollisionSweepTask::OnTaskStart(const TWeakObjectPtr<const UAblAbilityC
 		m_SweepShape->GetQueryTransform(Context, ScratchPad->SourceTransform);
 		ScratchPad->AsyncProcessed = false;
 		ScratchPad->AsyncHandle._Handle = 0;
+
+		ScratchPad->SubStepTransforms.Reset();
+		ScratchPad->SubStepTimes.Reset();
+		ScratchPad->SubStepHandles.Reset();
+		ScratchPad->SubStepQueued = false;
+		if (m_SubStep)
+		{
+			ScratchPad->SubStepTransforms.Add(ScratchPad->SourceTransform);
+			ScratchPad->SubStepTimes.Add(Context->GetCurrentTime());
+		}
 	}
 }
 
@@ -61,7 +75,29 @@ void UAblCollisionSweepTask::OnTaskTick(const TWeakObjectPtr<const UAblAbilityCo
 
 	UAblCollisionSweepTaskScratchPad* ScratchPad = Cast<UAblCollisionSweepTaskScratchPad>(Context->GetScratchPadForTask(this));
 	check(ScratchPad);
-	if (m_SweepShape && m_SweepShape->IsAsync() && 
+	if (m_SweepShape && m_SubStep)
+	{
+		if (m_SweepShape->IsAsync() &&
+			UAbleSettings::IsAsyncEnabled() &&
+			UAblAbilityTask::IsDone(Context))
+		{
+			if (!ScratchPad->SubStepQueued)
+			{
+				// Take our final sample and queue every segment together, so they all come back next frame.
+				SampleSubStep(Context, *ScratchPad, true);
+				for (int32 i = 1; i < ScratchPad->SubStepTransforms.Num(); ++i)
+				{
+					ScratchPad->SubStepHandles.Add(m_SweepShape->DoAsyncSweepSegment(Context, ScratchPad->SubStepTransforms[i - 1], ScratchPad->SubStepTransforms[i]));
+				}
+				ScratchPad->SubStepQueued = true;
+			}
+		}
+		else
+		{
+			SampleSubStep(Context, *ScratchPad, false);
+		}
+	}
+	else if (m_SweepShape && m_SweepShape->IsAsync() && 
 		UAbleSettings::IsAsyncEnabled() && 
 		UAblAbilityTask::IsDone(Context))
 	{
@@ -84,7 +120,77 @@ void UAblCollisionSweepTask::OnTaskEnd(const TWeakObjectPtr<const UAblAbilityCon
 		UAblCollisionSweepTaskScratchPad* ScratchPad = Cast<UAblCollisionSweepTaskScratchPad>(Context->GetScratchPadForTask(this));
 		check(ScratchPad);
 
-		if (m_SweepShape->IsAsync() && UAbleSettings::IsAsyncEnabled())
+		if (m_SubStep)
+		{
+			const bool UseAsync = m_SweepShape->IsAsync() && UAbleSettings::IsAsyncEnabled();
+			if (!UseAsync)
+			{
+				SampleSubStep(Context, *ScratchPad, true);
+			}
+
+			// Merge the segments, keeping the earliest hit per Actor.
+			TArray<float> HitTimes;
+			TArray<FHitResult> SegmentHits;
+			const int32 NumSegments = UseAsync ? ScratchPad->SubStepHandles.Num() : ScratchPad->SubStepTransforms.Num() - 1;
+			for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+			{
+				SegmentHits.Reset();
+				if (UseAsync)
+				{
+					m_SweepShape->GetAsyncHits(Context, ScratchPad->SubStepHandles[Segment], SegmentHits);
+				}
+				else
+				{
+					m_SweepShape->DoSweepSegment(Context, ScratchPad->SubStepTransforms[Segment], ScratchPad->SubStepTransforms[Segment + 1], SegmentHits);
+				}
+
+				for (const FHitResult& Hit : SegmentHits)
+				{
+					const float HitTime = FMath::Lerp(ScratchPad->SubStepTimes[Segment], ScratchPad->SubStepTimes[Segment + 1], Hit.Time);
+					const FAblQueryResult HitResult(Hit);
+					const int32 ExistingIndex = OutResults.IndexOfByPredicate([&HitResult](const FAblQueryResult& Existing)
+					{
+						return Existing.Actor == HitResult.Actor && (HitResult.Actor.IsValid() || Existing.PrimitiveComponent == HitResult.PrimitiveComponent);
+					});
+
+					if (ExistingIndex == INDEX_NONE)
+					{
+						OutResults.Add(HitResult);
+						HitTimes.Add(HitTime);
+					}
+					else if (HitTime < HitTimes[ExistingIndex])
+					{
+						OutResults[ExistingIndex] = HitResult;
+						HitTimes[ExistingIndex] = HitTime;
+					}
+				}
+			}
+			ScratchPad->AsyncProcessed = UseAsync;
+
+			// Earliest hit first.
+			TArray<int32> Order;
+			Order.Reserve(OutResults.Num());
+			for (int32 i = 0; i < OutResults.Num(); ++i)
+			{
+				Order.Add(i);
+			}
+			Order.StableSort([&HitTimes](int32 LHS, int32 RHS) { return HitTimes[LHS] < HitTimes[RHS]; });
+
+			TArray<FAblQueryResult> SortedResults;
+			SortedResults.Reserve(Order.Num());
+			for (int32 i : Order)
+			{
+				SortedResults.Add(OutResults[i]);
+			}
+			OutResults = MoveTemp(SortedResults);
+
+			// Each segment only returned its blocking hit, only the first one along the path counts.
+			if (m_SweepShape->OnlyReturnsBlockingHit() && OutResults.Num() > 1)
+			{
+				OutResults.SetNum(1);
+			}
+		}
+		else if (m_SweepShape->IsAsync() && UAbleSettings::IsAsyncEnabled())
 		{
 			m_SweepShape->GetAsyncResults(Context, ScratchPad->AsyncHandle, OutResults);
 			ScratchPad->AsyncProcessed = true;
@@ -143,6 +249,37 @@ void UAblCollisionSweepTask::OnTaskEnd(const TWeakObjectPtr<const UAblAbilityCon
 	}
 }
 
+void UAblCollisionSweepTask::SampleSubStep(const TWeakObjectPtr<const UAblAbilityContext>& Context, UAblCollisionSweepTaskScratchPad& ScratchPad, bool Force) const
+{
+	const float CurrentTime = Context->GetCurrentTime();
+	if (ScratchPad.SubStepTimes.Num() == 0)
+	{
+		return;
+	}
+
+	// Spread our samples out so long Tasks don't go over our segment budget.
+	const float SampleInterval = FMath::Max(1.0f / FMath::Max(m_SubStepRate, 1.0f), GetDuration() / FMath::Max(m_MaxSubSteps, 1));
+	if (!Force && CurrentTime - ScratchPad.SubStepTimes.Last() < SampleInterval)
+	{
+		return;
+	}
+
+	FTransform Sample;
+	m_SweepShape->GetQueryTransform(Context, Sample);
+
+	// The final sample replaces the last one, rather than adding an empty or over budget segment.
+	const int32 NumSegments = ScratchPad.SubStepTransforms.Num() - 1;
+	if (Force && NumSegments > 0 && (NumSegments >= m_MaxSubSteps || CurrentTime <= ScratchPad.SubStepTimes.Last()))
+	{
+		ScratchPad.SubStepTransforms.Last() = Sample;
+		ScratchPad.SubStepTimes.Last() = CurrentTime;
+		return;
+	}
+
+	ScratchPad.SubStepTransforms.Add(Sample);
+	ScratchPad.SubStepTimes.Add(CurrentTime);
+}
+
 UAblAbilityTaskScratchPad* UAblCollisionSweepTask::CreateScratchPad(const TWeakObjectPtr<UAblAbilityContext>& Context) const
 {
 	if (UAblAbilityUtilitySubsystem* Subsystem = Context->GetUtilitySubsystem())
@@ -197,7 +334,7 @@ bool UAblCollisionSweepTask::IsDone(const TWeakObjectPtr<const UAblAbilityContex
 	{
 		UAblCollisionSweepTaskScratchPad* ScratchPad = Cast<UAblCollisionSweepTaskScratchPad>(Context->GetScratchPadForTask(this));
 		check(ScratchPad);
-		return ScratchPad->AsyncHandle._Handle != 0;
+		return m_SubStep ? ScratchPad->SubStepQueued : ScratchPad->AsyncHandle._Handle != 0;
 	}
 	else
 	{
@@ -21,7 +21,44 @@ UAblCollisionSweepShape::~UAblCollisionSweepShape()
 
 }
 
+void UAblCollisionSweepShape::DoSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, TArray<FAblQueryResult>& OutResults) const
+{
+	check(Context.IsValid());
+	FAblAbilityTargetTypeLocation SweepLocation = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_SweepLocation);
+
+	FTransform EndTransform;
+	SweepLocation.GetTransform(*Context.Get(), EndTransform);
+
+	TArray<FHitResult> SweepResults;
+	DoSweepSegment(Context, SourceTransform, EndTransform, SweepResults);
+	for (const FHitResult& SweepResult : SweepResults)
+	{
+		OutResults.Add(FAblQueryResult(SweepResult));
+	}
+}
+
+FTraceHandle UAblCollisionSweepShape::DoAsyncSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform) const
+{
+	check(Context.IsValid());
+	FAblAbilityTargetTypeLocation SweepLocation = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_SweepLocation);
+
+	FTransform EndTransform;
+	SweepLocation.GetTransform(*Context.Get(), EndTransform);
+
+	return DoAsyncSweepSegment(Context, SourceTransform, EndTransform);
+}
+
 void UAblCollisionSweepShape::GetAsyncResults(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTraceHandle& Handle, TArray<FAblQueryResult>& OutResults) const
+{
+	TArray<FHitResult> SweepResults;
+	GetAsyncHits(Context, Handle, SweepResults);
+	for (const FHitResult& HitResult : SweepResults)
+	{
+		OutResults.Add(FAblQueryResult(HitResult));
+	}
+}
+
+void UAblCollisionSweepShape::GetAsyncHits(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTraceHandle& Handle, TArray<FHitResult>& OutHits) const
 {
 	check(Context.IsValid());
 	const UAblAbilityContext& ConstContext = *Context.Get();
@@ -39,10 +76,7 @@ void UAblCollisionSweepShape::GetAsyncResults(const TWeakObjectPtr<const UAblAbi
 	FTraceDatum Datum;
 	if (World->QueryTraceData(Handle, Datum))
 	{
-		for (const FHitResult& HitResult : Datum.OutHits)
-		{
-			OutResults.Add(FAblQueryResult(HitResult));
-		}
+		OutHits.Append(Datum.OutHits);
 	}
 }
 
@@ -113,7 +147,7 @@ UAblCollisionSweepBox::~UAblCollisionSweepBox()
 
 }
 
-void UAblCollisionSweepBox::DoSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, TArray<FAblQueryResult>& OutResults) const
+void UAblCollisionSweepBox::DoSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& TargetTransform, TArray<FHitResult>& OutHits) const
 {
 	check(Context.IsValid());
 	FAblAbilityTargetTypeLocation SweepLocation = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_SweepLocation);
@@ -128,8 +162,7 @@ void UAblCollisionSweepBox::DoSweep(const TWeakObjectPtr<const UAblAbilityContex
 
 	FVector HalfExtents = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_HalfExtents);
 
-	FTransform StartTransform, EndTransform;
-	SweepLocation.GetTransform(ConstContext, EndTransform);
+	FTransform StartTransform, EndTransform = TargetTransform;
 
 	FQuat SourceRotation = SourceTransform.GetRotation();
 	FVector StartOffset = SourceRotation.GetForwardVector() * HalfExtents.X;
@@ -156,7 +189,7 @@ void UAblCollisionSweepBox::DoSweep(const TWeakObjectPtr<const UAblAbilityContex
 		FHitResult SweepResult;
 		if (World->SweepSingleByObjectType(SweepResult, StartTransform.GetLocation(), EndTransform.GetLocation(), SourceTransform.GetRotation(), ObjectQuery, Shape))
 		{
-			OutResults.Add(FAblQueryResult(SweepResult));
+			OutHits.Add(SweepResult);
 		}
 	}
 	else
@@ -164,10 +197,7 @@ void UAblCollisionSweepBox::DoSweep(const TWeakObjectPtr<const UAblAbilityContex
 		TArray<FHitResult> SweepResults;
 		if (World->SweepMultiByObjectType(SweepResults, StartTransform.GetLocation(), EndTransform.GetLocation(), SourceTransform.GetRotation(), ObjectQuery, Shape))
 		{
-			for (const FHitResult& SweepResult : SweepResults)
-			{
-				OutResults.Add(FAblQueryResult(SweepResult));
-			}
+			OutHits.Append(SweepResults);
 		}
 	}
 
@@ -183,7 +213,7 @@ void UAblCollisionSweepBox::DoSweep(const TWeakObjectPtr<const UAblAbilityContex
 #endif
 }
 
-FTraceHandle UAblCollisionSweepBox::DoAsyncSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform) const
+FTraceHandle UAblCollisionSweepBox::DoAsyncSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& TargetTransform) const
 {
 	check(Context.IsValid());
 	FAblAbilityTargetTypeLocation SweepLocation = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_SweepLocation);
@@ -198,8 +228,7 @@ FTraceHandle UAblCollisionSweepBox::DoAsyncSweep(const TWeakObjectPtr<const UAbl
 
 	FVector HalfExtents = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_HalfExtents);
 
-	FTransform StartTransform, EndTransform;
-	SweepLocation.GetTransform(ConstContext, EndTransform);
+	FTransform StartTransform, EndTransform = TargetTransform;
 
 	FQuat SourceRotation = SourceTransform.GetRotation();
 	FVector StartOffset = SourceRotation.GetForwardVector() * HalfExtents.X;
@@ -285,7 +314,7 @@ UAblCollisionSweepSphere::~UAblCollisionSweepSphere()
 
 }
 
-void UAblCollisionSweepSphere::DoSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, TArray<FAblQueryResult>& OutResults) const
+void UAblCollisionSweepSphere::DoSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform, TArray<FHitResult>& OutHits) const
 {
 	check(Context.IsValid());
 	FAblAbilityTargetTypeLocation SweepLocation = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_SweepLocation);
@@ -300,9 +329,6 @@ void UAblCollisionSweepSphere::DoSweep(const TWeakObjectPtr<const UAblAbilityCon
 
 	float Radius = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_Radius);
 
-	FTransform EndTransform;
-	SweepLocation.GetTransform(ConstContext, EndTransform);
-
 	UWorld* World = SourceActor->GetWorld();
 	check(World);
 
@@ -318,7 +344,7 @@ void UAblCollisionSweepSphere::DoSweep(const TWeakObjectPtr<const UAblAbilityCon
 		FHitResult SweepResult;
 		if (World->SweepSingleByObjectType(SweepResult, SourceTransform.GetLocation(), EndTransform.GetLocation(), FQuat::Identity, ObjectQuery, Shape))
 		{
-			OutResults.Add(FAblQueryResult(SweepResult));
+			OutHits.Add(SweepResult);
 		}
 	}
 	else
@@ -326,10 +352,7 @@ void UAblCollisionSweepSphere::DoSweep(const TWeakObjectPtr<const UAblAbilityCon
 		TArray<FHitResult> SweepResults;
 		if (World->SweepMultiByObjectType(SweepResults, SourceTransform.GetLocation(), EndTransform.GetLocation(), FQuat::Identity, ObjectQuery, Shape))
 		{
-			for (const FHitResult& SweepResult : SweepResults)
-			{
-				OutResults.Add(FAblQueryResult(SweepResult));
-			}
+			OutHits.Append(SweepResults);
 		}
 	}
 
@@ -342,7 +365,7 @@ void UAblCollisionSweepSphere::DoSweep(const TWeakObjectPtr<const UAblAbilityCon
 
 }
 
-FTraceHandle UAblCollisionSweepSphere::DoAsyncSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform) const
+FTraceHandle UAblCollisionSweepSphere::DoAsyncSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform) const
 {
 	check(Context.IsValid());
 	FAblAbilityTargetTypeLocation SweepLocation = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_SweepLocation);
@@ -357,9 +380,6 @@ FTraceHandle UAblCollisionSweepSphere::DoAsyncSweep(const TWeakObjectPtr<const U
 
 	float Radius = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_Radius);
 
-	FTransform EndTransform;
-	SweepLocation.GetTransform(ConstContext, EndTransform);
-
 	UWorld* World = SourceActor->GetWorld();
 	check(World);
 
@@ -427,7 +447,7 @@ UAblCollisionSweepCapsule::~UAblCollisionSweepCapsule()
 
 }
 
-void UAblCollisionSweepCapsule::DoSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, TArray<FAblQueryResult>& OutResults) const
+void UAblCollisionSweepCapsule::DoSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform, TArray<FHitResult>& OutHits) const
 {
 	check(Context.IsValid());
 	FAblAbilityTargetTypeLocation SweepLocation = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_SweepLocation);
@@ -443,9 +463,6 @@ void UAblCollisionSweepCapsule::DoSweep(const TWeakObjectPtr<const UAblAbilityCo
 	float Radius = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_Radius);
 	float Height = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_Height);
 
-	FTransform EndTransform;
-	SweepLocation.GetTransform(ConstContext, EndTransform);
-
 	UWorld* World = SourceActor->GetWorld();
 	check(World);
 
@@ -461,7 +478,7 @@ void UAblCollisionSweepCapsule::DoSweep(const TWeakObjectPtr<const UAblAbilityCo
 		FHitResult SweepResult;
 		if (World->SweepSingleByObjectType(SweepResult, SourceTransform.GetLocation(), EndTransform.GetLocation(), SourceTransform.GetRotation(), ObjectQuery, Shape))
 		{
-			OutResults.Add(FAblQueryResult(SweepResult));
+			OutHits.Add(SweepResult);
 		}
 	}
 	else
@@ -469,10 +486,7 @@ void UAblCollisionSweepCapsule::DoSweep(const TWeakObjectPtr<const UAblAbilityCo
 		TArray<FHitResult> SweepResults;
 		if (World->SweepMultiByObjectType(SweepResults, SourceTransform.GetLocation(), EndTransform.GetLocation(), SourceTransform.GetRotation(), ObjectQuery, Shape))
 		{
-			for (const FHitResult& SweepResult : SweepResults)
-			{
-				OutResults.Add(FAblQueryResult(SweepResult));
-			}
+			OutHits.Append(SweepResults);
 		}
 	}
 
@@ -485,7 +499,7 @@ void UAblCollisionSweepCapsule::DoSweep(const TWeakObjectPtr<const UAblAbilityCo
 
 }
 
-FTraceHandle UAblCollisionSweepCapsule::DoAsyncSweep(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform) const
+FTraceHandle UAblCollisionSweepCapsule::DoAsyncSweepSegment(const TWeakObjectPtr<const UAblAbilityContext>& Context, const FTransform& SourceTransform, const FTransform& EndTransform) const
 {
 	check(Context.IsValid());
 	FAblAbilityTargetTypeLocation SweepLocation = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_SweepLocation);
@@ -501,9 +515,6 @@ FTraceHandle UAblCollisionSweepCapsule::DoAsyncSweep(const TWeakObjectPtr<const
 	float Radius = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_Radius);
 	float Height = ABL_GET_DYNAMIC_PROPERTY_VALUE(Context, m_Height);
 
-	FTransform EndTransform;
-	SweepLocation.GetTransform(ConstContext, EndTransform);
-
 	UWorld* World = SourceActor->GetWorld();
 	check(World);
 
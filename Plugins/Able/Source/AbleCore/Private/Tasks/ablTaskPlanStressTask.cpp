@@ -0,0 +1,377 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#include "Tasks/ablTaskPlanStressTask.h"
+
+#include "ablAbilityTaskPlan.h"
+#include "AbleCorePrivate.h"
+#include "Algo/BinarySearch.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/Package.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if !UE_BUILD_SHIPPING
+
+/* Exercises FAblTaskDoneMask the way Instances do: thousands of masks sharing one built FAblAbilityTaskPlan, Async lane Tasks finishing on worker threads
+ * while the Sync lane finishes on the calling thread, each Task depending on the previous Task in its own lane and the previous Task in the other lane.
+ * The Tasks are UAblTaskPlanStressTasks with a fixed lane that are never run, only the plan and masks are. A lost update stalls a chain and is reported. */
+static void StressTaskDoneMask(const TArray<FString>& Args)
+{
+	const int32 NumInstances = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 4096;
+	const int32 NumTasks = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 2, 1024) : 96;
+
+	// Even Tasks are Async, Odd Tasks are Sync. Task N depends on Task N - 2 (same lane) and Task N - 1 (other lane), except the first two.
+	// Start Times are all the same, so Build keeps them in this order.
+	TArray<TStrongObjectPtr<UAblAbilityTask>> TaskRefs;
+	TArray<UAblAbilityTask*> Tasks;
+	for (int32 TaskIndex = 0; TaskIndex < NumTasks; ++TaskIndex)
+	{
+		UAblTaskPlanStressTask* Task = NewObject<UAblTaskPlanStressTask>(GetTransientPackage());
+		Task->m_Lane = TaskIndex % 2 == 0 ? EAblTaskLane::Async : EAblTaskLane::Sync;
+		if (TaskIndex >= 2)
+		{
+			Task->GetMutableTaskDependencies().Add(Tasks[TaskIndex - 2]);
+			Task->GetMutableTaskDependencies().Add(Tasks[TaskIndex - 1]);
+		}
+		TaskRefs.Emplace(Task);
+		Tasks.Add(Task);
+	}
+
+	FAblAbilityTaskPlan Plan;
+	Plan.Build(Tasks);
+
+	const FAblAbilityTaskPlan::FLane& AsyncLane = Plan.GetLane(EAblTaskLane::Async);
+	const FAblAbilityTaskPlan::FLane& SyncLane = Plan.GetLane(EAblTaskLane::Sync);
+	if (AsyncLane.Tasks.Num() == 0 || SyncLane.Tasks.Num() == 0)
+	{
+		UE_LOG(LogAble, Error, TEXT("Able.StressTaskDoneMask: Plan needs Tasks in both lanes, got %d Async and %d Sync."), AsyncLane.Tasks.Num(), SyncLane.Tasks.Num());
+		return;
+	}
+
+	TArray<FAblTaskDoneMask> Masks;
+	Masks.SetNum(NumInstances);
+	for (FAblTaskDoneMask& Mask : Masks)
+	{
+		Mask.Init(Plan.Num());
+	}
+
+	// Next lane slot to finish, per Instance, per lane.
+	TArray<int32> NextAsync;
+	TArray<int32> NextSync;
+	NextAsync.Init(0, NumInstances);
+	NextSync.Init(0, NumInstances);
+
+	auto UpdateLane = [&](const FAblAbilityTaskPlan::FLane& Lane, TArray<int32>& Next, int32 Instance)
+	{
+		const int32 LaneSlot = Next[Instance];
+		if (LaneSlot < Lane.Tasks.Num() && Masks[Instance].AreDone(Plan.GetDependencies(Lane.Tasks[LaneSlot])))
+		{
+			Masks[Instance].MarkDone(Lane.Tasks[LaneSlot]);
+			Next[Instance] = LaneSlot + 1;
+		}
+	};
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 MaxFrames = NumTasks * 2;
+	int32 Frame = 0;
+	for (; Frame < MaxFrames; ++Frame)
+	{
+		TFuture<void> AsyncUpdate = Async(EAsyncExecution::TaskGraph, [&]()
+		{
+			ParallelFor(NumInstances, [&](int32 Instance) { UpdateLane(AsyncLane, NextAsync, Instance); });
+		});
+
+		for (int32 Instance = 0; Instance < NumInstances; ++Instance)
+		{
+			UpdateLane(SyncLane, NextSync, Instance);
+		}
+
+		AsyncUpdate.Wait();
+
+		bool AllDone = true;
+		for (int32 Instance = 0; Instance < NumInstances && AllDone; ++Instance)
+		{
+			AllDone = NextAsync[Instance] >= AsyncLane.Tasks.Num() && NextSync[Instance] >= SyncLane.Tasks.Num();
+		}
+
+		if (AllDone)
+		{
+			break;
+		}
+	}
+
+	int32 NumFailed = 0;
+	for (int32 Instance = 0; Instance < NumInstances; ++Instance)
+	{
+		for (int32 TaskIndex = 0; TaskIndex < Plan.Num(); ++TaskIndex)
+		{
+			if (!Masks[Instance].IsDone(TaskIndex))
+			{
+				++NumFailed;
+				break;
+			}
+		}
+	}
+
+	UE_LOG(LogAble, Display, TEXT("Able.StressTaskDoneMask: %d Instances x %d Tasks, %d frames, %.2f ms. %d Instances stalled."),
+		NumInstances, NumTasks, FMath::Min(Frame + 1, MaxFrames), (FPlatformTime::Seconds() - StartTime) * 1000.0, NumFailed);
+
+	if (NumFailed)
+	{
+		UE_LOG(LogAble, Error, TEXT("Able.StressTaskDoneMask: Task Done updates were lost."));
+	}
+}
+
+static FAutoConsoleCommand StressTaskDoneMaskCommand(
+	TEXT("Able.StressTaskDoneMask"),
+	TEXT("Builds a Task plan with cross lane dependencies from transient Tasks (never executed), finishes its Sync and Async lanes at the same time across many Instances' masks, and reports any lost updates. Args: [NumInstances=4096] [NumTasks=96]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&StressTaskDoneMask));
+
+/* Per Instance Task bookkeeping the way FAblAbilityInstance did it before Task plans: per lane arrays of pending / active Tasks sorted by Start Time,
+ * a linear scan with Contains checks, and a Dependency map guarded by a lock. Kept here only so Able.BenchTaskPlan has something to compare against. */
+struct FAblLegacyTaskBookkeeping
+{
+	TArray<const UAblAbilityTask*> Pending[(uint8)EAblTaskLane::Count];
+	TArray<const UAblAbilityTask*> Active[(uint8)EAblTaskLane::Count];
+	TMap<const UAblAbilityTask*, bool> DependencyMap;
+	FCriticalSection DependencyMapCS;
+
+	void Init(const FAblAbilityTaskPlan& Plan)
+	{
+		DependencyMap.Reset();
+		for (uint8 Lane = 0; Lane < (uint8)EAblTaskLane::Count; ++Lane)
+		{
+			Pending[Lane].Reset();
+			Active[Lane].Reset();
+			for (int32 TaskIndex : Plan.GetLane((EAblTaskLane)Lane).Tasks)
+			{
+				const UAblAbilityTask* Task = Plan.GetTask(TaskIndex);
+				Pending[Lane].Add(Task);
+				for (const UAblAbilityTask* Dependency : Task->GetTaskDependencies())
+				{
+					DependencyMap.Add(Dependency, false);
+				}
+			}
+		}
+	}
+
+	/* Returns the number of Tasks started. */
+	int32 Update(EAblTaskLane Lane, float Time)
+	{
+		TArray<const UAblAbilityTask*>& LanePending = Pending[(uint8)Lane];
+		TArray<const UAblAbilityTask*>& LaneActive = Active[(uint8)Lane];
+		TArray<const UAblAbilityTask*, TInlineAllocator<8>> NewlyStarted;
+
+		for (int32 i = 0; i < LanePending.Num(); )
+		{
+			const UAblAbilityTask* Task = LanePending[i];
+			bool IsStarting = Time >= Task->GetStartTime();
+			if (IsStarting && Task->HasDependencies())
+			{
+				for (const UAblAbilityTask* Dependency : Task->GetTaskDependencies())
+				{
+					if (!DependencyMap.Contains(Dependency) || !DependencyMap[Dependency])
+					{
+						IsStarting = false;
+						break;
+					}
+				}
+			}
+
+			if (IsStarting && !LaneActive.Contains(Task))
+			{
+				NewlyStarted.Add(Task);
+				LanePending.RemoveAt(i, 1, false);
+				continue;
+			}
+			else if (Time < Task->GetStartTime())
+			{
+				break;
+			}
+
+			++i;
+		}
+
+		for (int32 i = 0; i < LaneActive.Num(); )
+		{
+			const UAblAbilityTask* Task = LaneActive[i];
+			if (Time >= Task->GetEndTime())
+			{
+				if (DependencyMap.Contains(Task))
+				{
+					FScopeLock DependencyMapLock(&DependencyMapCS);
+					DependencyMap[Task] = true;
+				}
+
+				LaneActive.RemoveAt(i, 1, false);
+				continue;
+			}
+
+			++i;
+		}
+
+		LaneActive.Append(NewlyStarted);
+		return NewlyStarted.Num();
+	}
+};
+
+/* Per Instance Task bookkeeping the way FAblAbilityInstance does it now: per lane pending / active bits over the plan's lanes and a shared done mask. */
+struct FAblPlanTaskBookkeeping
+{
+	TBitArray<> Pending[(uint8)EAblTaskLane::Count];
+	TBitArray<> Active[(uint8)EAblTaskLane::Count];
+	int32 NumPending[(uint8)EAblTaskLane::Count];
+	FAblTaskDoneMask Done;
+
+	void Init(const FAblAbilityTaskPlan& Plan)
+	{
+		for (uint8 Lane = 0; Lane < (uint8)EAblTaskLane::Count; ++Lane)
+		{
+			NumPending[Lane] = Plan.GetLane((EAblTaskLane)Lane).Tasks.Num();
+			Pending[Lane].Init(true, NumPending[Lane]);
+			Active[Lane].Init(false, NumPending[Lane]);
+		}
+		Done.Init(Plan.Num());
+	}
+
+	/* Returns the number of Tasks started. */
+	int32 Update(const FAblAbilityTaskPlan& Plan, EAblTaskLane Lane, float Time)
+	{
+		const FAblAbilityTaskPlan::FLane& PlanLane = Plan.GetLane(Lane);
+		TBitArray<>& LanePending = Pending[(uint8)Lane];
+		TBitArray<>& LaneActive = Active[(uint8)Lane];
+		TArray<int32, TInlineAllocator<8>> NewlyStarted;
+
+		const int32 NumReachedSlots = NumPending[(uint8)Lane] ? Algo::UpperBound(PlanLane.StartTimes, Time) : 0;
+		for (TConstSetBitIterator<> PendingIt(LanePending); PendingIt && PendingIt.GetIndex() < NumReachedSlots; ++PendingIt)
+		{
+			const int32 Slot = PendingIt.GetIndex();
+			if (!LaneActive[Slot] && Done.AreDone(Plan.GetDependencies(PlanLane.Tasks[Slot])))
+			{
+				NewlyStarted.Add(Slot);
+			}
+		}
+
+		for (int32 Slot : NewlyStarted)
+		{
+			LanePending[Slot] = false;
+		}
+		NumPending[(uint8)Lane] -= NewlyStarted.Num();
+
+		for (TConstSetBitIterator<> ActiveIt(LaneActive); ActiveIt; ++ActiveIt)
+		{
+			const int32 Slot = ActiveIt.GetIndex();
+			const int32 TaskIndex = PlanLane.Tasks[Slot];
+			if (Time >= Plan.GetTask(TaskIndex)->GetEndTime())
+			{
+				Done.MarkDone(TaskIndex);
+				LaneActive[Slot] = false;
+			}
+		}
+
+		for (int32 Slot : NewlyStarted)
+		{
+			LaneActive[Slot] = true;
+		}
+		return NewlyStarted.Num();
+	}
+};
+
+/* Plays the same large Ability through the old array / map Task bookkeeping and through the Task plan bookkeeping, and reports the time each spends per frame.
+ * Only the scheduling is timed: the Tasks are UAblTaskPlanStressTasks that are never run, they start at their Start Time (once their Dependencies are done)
+ * and finish at their End Time. Both sides must start the same number of Tasks on every frame, any difference is reported. */
+static void BenchTaskPlan(const TArray<FString>& Args)
+{
+	const int32 NumTasks = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, 1024) : 64;
+	const int32 NumInstances = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 256;
+	const int32 NumFrames = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 300;
+
+	// Tasks spread over the length of the Ability, a third of them in the Async lane, a quarter depending on an earlier Task.
+	FRandomStream Stream(0x41626c65);
+	const float AbilityLength = 5.0f;
+	TArray<TStrongObjectPtr<UAblAbilityTask>> TaskRefs;
+	TArray<UAblAbilityTask*> Tasks;
+	for (int32 TaskIndex = 0; TaskIndex < NumTasks; ++TaskIndex)
+	{
+		UAblTaskPlanStressTask* Task = NewObject<UAblTaskPlanStressTask>(GetTransientPackage());
+		Task->m_Lane = TaskIndex % 3 == 0 ? EAblTaskLane::Async : EAblTaskLane::Sync;
+		Task->SetStartTime(Stream.FRandRange(0.0f, AbilityLength * 0.9f));
+		Task->SetEndTime(FMath::Min(Task->GetStartTime() + Stream.FRandRange(0.05f, 1.0f), AbilityLength));
+		if (TaskIndex > 0 && TaskIndex % 4 == 0)
+		{
+			Task->GetMutableTaskDependencies().Add(Tasks[Stream.RandHelper(TaskIndex)]);
+		}
+		TaskRefs.Emplace(Task);
+		Tasks.Add(Task);
+	}
+
+	FAblAbilityTaskPlan Plan;
+	Plan.Build(Tasks);
+
+	const float FrameTime = AbilityLength / NumFrames;
+	TArray<int32> LegacyStarted;
+	TArray<int32> PlanStarted;
+	LegacyStarted.Init(0, NumFrames);
+	PlanStarted.Init(0, NumFrames);
+
+	TArray<FAblLegacyTaskBookkeeping> LegacyInstances;
+	LegacyInstances.SetNum(NumInstances);
+	for (FAblLegacyTaskBookkeeping& Instance : LegacyInstances)
+	{
+		Instance.Init(Plan);
+	}
+
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const float Time = (Frame + 1) * FrameTime;
+		for (FAblLegacyTaskBookkeeping& Instance : LegacyInstances)
+		{
+			LegacyStarted[Frame] += Instance.Update(EAblTaskLane::Async, Time);
+			LegacyStarted[Frame] += Instance.Update(EAblTaskLane::Sync, Time);
+		}
+	}
+	const double LegacyMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumFrames;
+
+	TArray<FAblPlanTaskBookkeeping> PlanInstances;
+	PlanInstances.SetNum(NumInstances);
+	for (FAblPlanTaskBookkeeping& Instance : PlanInstances)
+	{
+		Instance.Init(Plan);
+	}
+
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const float Time = (Frame + 1) * FrameTime;
+		for (FAblPlanTaskBookkeeping& Instance : PlanInstances)
+		{
+			PlanStarted[Frame] += Instance.Update(Plan, EAblTaskLane::Async, Time);
+			PlanStarted[Frame] += Instance.Update(Plan, EAblTaskLane::Sync, Time);
+		}
+	}
+	const double PlanMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumFrames;
+
+	int32 TotalStarted = 0;
+	for (int32 Started : PlanStarted)
+	{
+		TotalStarted += Started;
+	}
+	const bool Matched = LegacyStarted == PlanStarted;
+
+	UE_LOG(LogAble, Display, TEXT("Able.BenchTaskPlan: %d Instances x %d Tasks (%d Async), %d frames, %d Tasks started. Arrays + Map %.3f ms/frame, Plan %.3f ms/frame (%.1fx). %s"),
+		NumInstances, NumTasks, Plan.GetLane(EAblTaskLane::Async).Tasks.Num(), NumFrames, TotalStarted, LegacyMs, PlanMs, PlanMs > 0.0 ? LegacyMs / PlanMs : 0.0, Matched ? TEXT("Match") : TEXT("MISMATCH"));
+
+	if (!Matched)
+	{
+		UE_LOG(LogAble, Error, TEXT("Able.BenchTaskPlan: The Task plan started Tasks on different frames than the old bookkeeping."));
+	}
+}
+
+static FAutoConsoleCommand BenchTaskPlanCommand(
+	TEXT("Able.BenchTaskPlan"),
+	TEXT("Times the old per frame Task scan (arrays, Contains and a locked Dependency map) against the Task plan bitsets over the same generated Ability, and verifies they start the same Tasks each frame. Args: [NumTasks=64] [NumInstances=256] [NumFrames=300]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchTaskPlan));
+
+#endif
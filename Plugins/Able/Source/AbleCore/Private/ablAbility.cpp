@@ -6,6 +6,7 @@
 #include "Animation/AnimMontage.h"
 #include "Engine/Engine.h"
 #include "Engine/NetDriver.h"
+#include "ablSettings.h"
 #include "Misc/Crc.h"
 #include "Tasks/ablPlayAnimationTask.h"
 #include "Tasks/IAblAbilityTask.h"
@@ -44,6 +45,7 @@ UAblAbility::UAblAbility(const FObjectInitializer& ObjectInitializer)
 	m_Tasks(),
 	m_InstancePolicy(EAblInstancePolicy::Default),
 	m_ClientPolicy(EAblClientExecutionPolicy::Default),
+	m_ForceDelivery(EAblForceAbilityDelivery::Unreliable),
 	m_AbilityNameHash(0U),
 	m_AbilityRealm(0),
 	m_DependenciesDirty(true)
@@ -76,9 +78,19 @@ void UAblAbility::PostLoad()
     // remove any broken references
     const int32 numTasks = m_Tasks.Num();
     m_Tasks.RemoveAll([](const UAblAbilityTask* Source) { return Source == nullptr; });
-    if (numTasks < m_Tasks.Num())
+    if (m_Tasks.Num() < numTasks)
     {
-        UE_LOG(LogAble, Warning, TEXT("UAblAbility.PostLoad() %s had %d NULL Tasks."), *GetDisplayName(), m_Tasks.Num()-numTasks);
+        // Server cooks leave client only Tasks out (see UAblAbilityTask::NeedsLoadForServer), that's expected.
+        const bool StrippedForServer = FPlatformProperties::RequiresCookedData() && IsRunningDedicatedServer() && GetDefault<UAbleSettings>()->GetStripClientTasksOnServer();
+        UE_CLOG(!StrippedForServer, LogAble, Warning, TEXT("UAblAbility.PostLoad() %s had %d NULL Tasks."), *GetDisplayName(), numTasks - m_Tasks.Num());
+        UE_CLOG(StrippedForServer, LogAble, Verbose, TEXT("UAblAbility.PostLoad() %s had %d client Tasks stripped."), *GetDisplayName(), numTasks - m_Tasks.Num());
+
+#if WITH_EDITOR
+        SortTasks();
+#endif
+        // Removal keeps the remaining Tasks in order, but dependencies and the Task Plan were built against the old list.
+        m_DependenciesDirty = true;
+        m_TaskPlan.Reset();
     }
 
 	BindDynamicProperties();
@@ -106,6 +118,25 @@ void UAblAbility::PreExecutionInit() const
 	{
 		BuildDependencyList();
 	}
+
+	if (!m_TaskPlan.IsValid())
+	{
+		TSharedPtr<FAblAbilityTaskPlan> TaskPlan = MakeShared<FAblAbilityTaskPlan>();
+		TaskPlan->Build(m_Tasks);
+		m_TaskPlan = TaskPlan;
+	}
+}
+
+const TSharedPtr<const FAblContextParamSchema>& UAblAbility::GetContextParamSchema() const
+{
+	if (!m_ContextParamSchema.IsValid())
+	{
+		TSharedPtr<FAblContextParamSchema> Schema = MakeShared<FAblContextParamSchema>();
+		Schema->Build(m_ContextParameters);
+		m_ContextParamSchema = Schema;
+	}
+
+	return m_ContextParamSchema;
 }
 
 EAblAbilityStartResult UAblAbility::CanAbilityExecute(UAblAbilityContext& Context) const
@@ -424,6 +455,9 @@ void UAblAbility::BuildDependencyList() const
 	}
 
 	m_DependenciesDirty = false;
+
+	// Our plan is rebuilt on the next execution.
+	m_TaskPlan.Reset();
 }
 
 FName UAblAbility::GetDynamicDelegateName(const FString& PropertyName) const
@@ -686,6 +720,9 @@ void UAblAbility::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyC
 	// Loop End can never be past our length.
 	m_LoopEnd = FMath::Min(m_LoopEnd, m_Length);
 
+	m_TaskPlan.Reset();
+	m_ContextParamSchema.Reset();
+
 	if (PropertyChangedEvent.Property && PropertyChangedEvent.Property->GetFName() == GET_MEMBER_NAME_CHECKED(UAblAbility, m_Tasks))
 	{
 		// Our Tasks have changed, rebuild dependencies.
@@ -703,6 +740,9 @@ void UAblAbility::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyC
 
 void UAblAbility::OnReferencedTaskPropertyModified(UAblAbilityTask& Task, struct FPropertyChangedEvent& PropertyChangedEvent)
 {
+	// Timing, realm, etc. may have changed. Rebake our plan on the next execution.
+	m_TaskPlan.Reset();
+
 	if (PropertyChangedEvent.Property && PropertyChangedEvent.Property->GetFName() == FName(TEXT("m_Dependencies")))
 	{
 		// Our Task changed dependencies. Validate/Rebuild.
@@ -7,58 +7,139 @@
 #include "ablAbilityUtilities.h"
 #include "AbleCorePrivate.h"
 #include "ablSettings.h"
+#include "ablSubSystem.h"
 #include "ablAbilityUtilities.h"
 #include "Animation/AnimNode_AbilityAnimPlayer.h"
 
+#include "Containers/Ticker.h"
 #include "Engine/ActorChannel.h"
 #include "Engine/World.h"
 #include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
 #include "Misc/ScopeLock.h"
 
 #if WITH_EDITOR
 #include "FXSystem.h"
 #endif
 
+#include "Net/Core/PushModel/PushModel.h"
 #include "Net/UnrealNetwork.h"
 
 #define LOCTEXT_NAMESPACE "AbleCore"
 
-FAblAbilityCooldown::FAblAbilityCooldown()
-	: Ability(nullptr),
-	Context(nullptr),
-	CurrentTime(0.0f),
-	CooldownTime(1.0f)
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ability Commands Issued"), STAT_AblAbilityCommands_Issued, STATGROUP_Able);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ability Server RPCs Sent"), STAT_AblAbilityServerRPCs_Sent, STATGROUP_Able);
+
+namespace AblAbilityCommands
 {
+	// Running totals for Able.AbilityRPCStats.
+	static int64 NumIssued = 0;
+	static int64 NumRPCs = 0;
+}
 
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Prediction Hits"), STAT_AblPrediction_Hits, STATGROUP_Able);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Prediction Misses"), STAT_AblPrediction_Misses, STATGROUP_Able);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Predictions Expired"), STAT_AblPrediction_Expired, STATGROUP_Able);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Prediction Rollbacks"), STAT_AblPrediction_Rollbacks, STATGROUP_Able);
+
+namespace AblPrediction
+{
+	// Running totals for Able.PredictionStats.
+	static int64 NumHits = 0;
+	static int64 NumMisses = 0;
+	static int64 NumExpired = 0;
+	static int64 NumRollbacks = 0;
+
+	// Misses bucketed by how far the nearest prediction of the same Ability was, last bucket is that distance or more.
+	static const int32 MaxMissDistance = 8;
+	static int64 MissDistances[MaxMissDistance + 1] = { 0 };
 }
-FAblAbilityCooldown::FAblAbilityCooldown(const UAblAbility& InAbility, const UAblAbilityContext& InContext)
-	: Ability(nullptr),
-	Context(nullptr),
-	CurrentTime(0.0f),
-	CooldownTime(1.0f)
+
+static TAutoConsoleVariable<int32> CVarForceAbilityReliable(TEXT("Able.ForceAbilityReliable"), 0, TEXT("1 to send every forced Ability reliably to all connections (the old behavior), ignoring each Ability's Force Delivery."));
+
+FAblServerPassiveAbility::FAblServerPassiveAbility(const FAblAbilityNetworkContext& Context)
+	: m_Context(Context),
+	m_AbilityNameHash(Context.GetAbility().IsValid() ? Context.GetAbility()->GetAbilityNameHash() : 0U)
 {
-	Ability = &InAbility;
-	Context = &InContext;
-	CooldownTime = Ability->GetCooldown(Context);
+
 }
 
-void FAblAbilityCooldown::Update(float DeltaTime)
+bool FAblServerPassiveAbility::SetCurrentStacks(int8 CurrentStacks)
 {
-	if (Ability && Context && !Ability->CanCacheCooldown())
+	if (m_Context.GetCurrentStack() == CurrentStacks)
 	{
-		CooldownTime = Ability->GetCooldown(Context);
+		return false;
 	}
 
-	CurrentTime += DeltaTime;
+	m_Context.SetCurrentStacks(CurrentStacks);
+	return true;
+}
+
+void FAblServerPassiveAbility::PreReplicatedRemove(const FAblServerPassiveAbilities& ArraySerializer)
+{
+	if (ArraySerializer.m_Component && m_AbilityNameHash != 0U)
+	{
+		ArraySerializer.m_Component->OnServerPassiveAbilityRemoved(m_AbilityNameHash);
+	}
+}
+
+void FAblServerPassiveAbility::PostReplicatedAdd(const FAblServerPassiveAbilities& ArraySerializer)
+{
+	// The hash isn't replicated, cache it now while we still have the Ability.
+	m_AbilityNameHash = m_Context.GetAbility().IsValid() ? m_Context.GetAbility()->GetAbilityNameHash() : 0U;
+
+	if (ArraySerializer.m_Component)
+	{
+		ArraySerializer.m_Component->OnServerPassiveAbilityChanged(m_Context, true);
+	}
+}
+
+void FAblServerPassiveAbility::PostReplicatedChange(const FAblServerPassiveAbilities& ArraySerializer)
+{
+	if (ArraySerializer.m_Component)
+	{
+		ArraySerializer.m_Component->OnServerPassiveAbilityChanged(m_Context, false);
+	}
+}
+
+FAblServerPassiveAbility* FAblServerPassiveAbilities::FindByHash(uint32 AbilityNameHash)
+{
+	return m_Items.FindByPredicate([AbilityNameHash](const FAblServerPassiveAbility& Item) { return Item.GetAbilityNameHash() == AbilityNameHash; });
+}
+
+FAblServerPassiveAbility& FAblServerPassiveAbilities::Add(const FAblAbilityNetworkContext& Context)
+{
+	FAblServerPassiveAbility& NewItem = m_Items.Add_GetRef(FAblServerPassiveAbility(Context));
+	MarkItemDirty(NewItem);
+	return NewItem;
+}
+
+int32 FAblServerPassiveAbilities::RemoveAllNotIn(const TArray<uint32>& Whitelist)
+{
+	const int32 NumRemoved = m_Items.RemoveAll([&Whitelist](const FAblServerPassiveAbility& Item) { return !Whitelist.Contains(Item.GetAbilityNameHash()); });
+	if (NumRemoved > 0)
+	{
+		MarkArrayDirty();
+	}
+
+	return NumRemoved;
 }
 
 UAblAbilityComponent::UAblAbilityComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer),
 	m_ActiveAbilityInstance(),
     m_PassivesDirty(false),
+	m_ActiveChangedThisFrame(false),
+	m_PassivesChangedThisFrame(false),
+	m_RegisteredWithScheduler(false),
+	m_ScheduledAsyncUpdates(nullptr),
+	m_CooldownOwnerIndex(INDEX_NONE),
 	m_ClientPredictionKey(0),
+	m_ClientForceSequence(0),
 	m_AbilityAnimationNode(nullptr),
-	m_ServerPredictionKey(0)
+	m_ServerPredictionKey(0),
+	m_ServerForceSequence(0)
 {
 	PrimaryComponentTick.TickGroup = TG_DuringPhysics;
 	PrimaryComponentTick.bStartWithTickEnabled = false;
@@ -68,8 +149,7 @@ UAblAbilityComponent::UAblAbilityComponent(const FObjectInitializer& ObjectIniti
 
 	m_Settings = GetDefault<UAbleSettings>(UAbleSettings::StaticClass());
 
-	m_LocallyPredictedAbilities.Reserve(ABLE_ABILITY_PREDICTION_RING_SIZE);
-	m_LocallyPredictedAbilities.AddDefaulted(ABLE_ABILITY_PREDICTION_RING_SIZE);
+	m_ServerPassiveAbilities.m_Component = this;
 }
 
 void UAblAbilityComponent::BeginPlay()
@@ -77,10 +157,33 @@ void UAblAbilityComponent::BeginPlay()
 	m_TagContainer.AppendTags(m_AutoApplyTags);
 
 	Super::BeginPlay();
+
+	// Initial properties are in by now. Anything forced before we became relevant is already covered by m_ServerActive, so don't replay it.
+	m_ClientForceSequence = m_ServerForceSequence;
+
+	UWorld* World = GetWorld();
+	if (m_Settings->GetUseBatchedAbilityUpdate() && World && World->IsGameWorld())
+	{
+		if (UAblAbilitySchedulerSubsystem* Scheduler = World->GetSubsystem<UAblAbilitySchedulerSubsystem>())
+		{
+			Scheduler->RegisterComponent(this);
+			CheckNeedsTick();
+		}
+	}
+
+	if (m_Settings->GetEnableTargetIndex() && World && World->IsGameWorld())
+	{
+		if (UAblAbilitySchedulerSubsystem* Scheduler = World->GetSubsystem<UAblAbilitySchedulerSubsystem>())
+		{
+			Scheduler->GetTargetIndex().Register(GetOwner());
+		}
+	}
 }
 
 void UAblAbilityComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	FlushAbilityCommands();
+
 	if (m_ActiveAbilityInstance.IsValid())
 	{
 		m_ActiveAbilityInstance.StopAbility();
@@ -97,6 +200,30 @@ void UAblAbilityComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	}
 	m_PassiveAbilityInstances.Empty();
 
+	if (m_RegisteredWithScheduler)
+	{
+		if (UAblAbilitySchedulerSubsystem* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UAblAbilitySchedulerSubsystem>() : nullptr)
+		{
+			Scheduler->UnregisterComponent(this);
+		}
+		m_RegisteredWithScheduler = false;
+	}
+
+	if (m_Settings->GetEnableTargetIndex())
+	{
+		if (UAblAbilitySchedulerSubsystem* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UAblAbilitySchedulerSubsystem>() : nullptr)
+		{
+			Scheduler->GetTargetIndex().Unregister(GetOwner());
+		}
+	}
+
+	if (m_CooldownOwnerIndex != INDEX_NONE)
+	{
+		GetOrCreateCooldownTable().ReleaseOwner(m_CooldownOwnerIndex);
+		m_CooldownOwnerIndex = INDEX_NONE;
+		m_CooldownScheduler.Reset();
+	}
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -104,22 +231,26 @@ void UAblAbilityComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
 {
 	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("AblAbilityComponent::TickComponent"), STAT_AblAbilityComponent_TickComponent, STATGROUP_Able);
 
-	// Do our cooldowns first (if we're Async this will give it a bit of time to go ahead and start running).
-	if (m_ActiveCooldowns.Num() > 0)
+	// Same phases the Scheduler runs, just for this component alone.
+	UpdateCooldownPhase(DeltaTime);
+	UpdatePendingPhase();
+	UpdateInstancePhase(DeltaTime);
+	FinishUpdatePhase();
+}
+
+void UAblAbilityComponent::UpdateCooldownPhase(float DeltaTime)
+{
+	// The world Cooldown table is updated by the Scheduler, we only have to handle our local one.
+	if (!m_CooldownScheduler.IsValid() && m_LocalCooldownTable.Num() > 0)
 	{
-		// Go ahead and fire off our cooldown update first.
-		if (UAbleSettings::IsAsyncEnabled() && m_Settings->GetAllowAsyncCooldownUpdate())
-		{
-			TGraphTask<FAsyncAbilityCooldownUpdaterTask>::CreateTask().ConstructAndDispatchWhenReady(this, DeltaTime);
-		}
-		else
-		{
-			UpdateCooldowns(DeltaTime);
-		}
+		m_LocalCooldownTable.Update(DeltaTime);
 	}
+}
 
-	bool ActiveChanged = false;
-	bool PassivesChanged = false;
+void UAblAbilityComponent::UpdatePendingPhase()
+{
+	m_ActiveChangedThisFrame = false;
+	m_PassivesChangedThisFrame = false;
 
 	// Check the status of our Active, we only do this on our authoritative client, or if we're locally controlled for local simulation purposes.
 	if (m_ActiveAbilityInstance.IsValid() && 
@@ -142,7 +273,7 @@ void UAblAbilityComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
 
 				m_PendingCancels.Add(FAblPendingCancelContext(m_ActiveAbilityInstance.GetAbilityNameHash(), EAblAbilityTaskResult::Successful));
 
-				ActiveChanged = true;
+				m_ActiveChangedThisFrame = true;
 			}
 			else
 			{
@@ -151,7 +282,7 @@ void UAblAbilityComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
 		}
 		
 		// Check for Channeling...
-		if (!ActiveChanged && m_ActiveAbilityInstance.IsChanneled())
+		if (!m_ActiveChangedThisFrame && m_ActiveAbilityInstance.IsChanneled())
 		{
 			if (m_ActiveAbilityInstance.CheckChannelConditions() == EAblConditionResults::ACR_Failed)
 			{
@@ -167,12 +298,12 @@ void UAblAbilityComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
 
 				if (!IsAuthoritative() && m_ActiveAbilityInstance.RequiresServerNotificationOfChannelFailure())
 				{
-					ServerCancelAbility(m_ActiveAbilityInstance.GetAbilityNameHash(), m_ActiveAbilityInstance.GetChannelFailureResult());
+					SendAbilityCommand(FAblAbilityCommand::MakeCancel(m_ActiveAbilityInstance.GetAbilityNameHash(), m_ActiveAbilityInstance.GetChannelFailureResult()));
 				}
 
 				m_PendingCancels.Add(FAblPendingCancelContext(m_ActiveAbilityInstance.GetAbilityNameHash(), m_ActiveAbilityInstance.GetChannelFailureResult()));
 
-				ActiveChanged = true;
+				m_ActiveChangedThisFrame = true;
 			}
 		}
 
@@ -184,7 +315,7 @@ void UAblAbilityComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
 	HandlePendingCancels();
 
 #if WITH_EDITOR
-	if (ActiveChanged && m_ActiveAbilityInstance.IsValid())
+	if (m_ActiveChangedThisFrame && m_ActiveAbilityInstance.IsValid())
 	{
 		UE_LOG(LogAble, Warning, TEXT("Killed Active Ability manually after it failed to cancel."));
 		m_ActiveAbilityInstance.Reset();
@@ -196,8 +327,8 @@ void UAblAbilityComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
 	// Handle any Pending abilities.
 	HandlePendingContexts();
 
-	ActiveChanged |= ActiveWasValid != m_ActiveAbilityInstance.IsValid();
-	PassivesChanged |= m_PassivesDirty;
+	m_ActiveChangedThisFrame |= ActiveWasValid != m_ActiveAbilityInstance.IsValid();
+	m_PassivesChangedThisFrame |= m_PassivesDirty;
 
 	// Try and process our Async targeting queue..
 	TArray<UAblAbilityContext*> RemovalList;
@@ -211,11 +342,11 @@ void UAblAbilityComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
 
 			if ((*ItAsync)->GetAbility()->IsPassive())
 			{
-				PassivesChanged = true;
+				m_PassivesChangedThisFrame = true;
 			}
 			else
 			{
-				ActiveChanged = true;
+				m_ActiveChangedThisFrame = true;
 			}
 		}
 	}
@@ -224,7 +355,10 @@ void UAblAbilityComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
 	{
 		m_AsyncContexts.Remove(ToRemove);
 	}
+}
 
+void UAblAbilityComponent::UpdateInstancePhase(float DeltaTime)
+{
 	m_IsProcessingUpdate = true;
     
 	// Update our Active
@@ -321,23 +455,26 @@ void UAblAbilityComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
             }
 		}
 	}
+}
 
+void UAblAbilityComponent::FinishUpdatePhase()
+{
 	// Clean up finished passives.
 	const int32 removed = m_PassiveAbilityInstances.RemoveAll([](const FAblAbilityInstance& Instance)->bool
 	{
 		return !Instance.IsValid() || (Instance.IsIterationDone() && Instance.IsDone());
 	});
-    PassivesChanged |= removed > 0;
+    m_PassivesChangedThisFrame |= removed > 0;
 
 	if (IsNetworked() && IsAuthoritative())
 	{
 		// Make sure we keep our client watched fields in sync.
-		if (ActiveChanged)
+		if (m_ActiveChangedThisFrame)
 		{
 			UpdateServerActiveAbility();
 		}
 
-		if (PassivesChanged)
+		if (m_PassivesChangedThisFrame)
 		{
 			UpdateServerPassiveAbilities();
             m_PassivesDirty = false;
@@ -356,10 +493,14 @@ void UAblAbilityComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	// These two fields are replicated and watched by the client.
-	DOREPLIFETIME(UAblAbilityComponent, m_ServerActive);
-	DOREPLIFETIME(UAblAbilityComponent, m_ServerPassiveAbilities);
-	DOREPLIFETIME(UAblAbilityComponent, m_ServerPredictionKey);
+	// These fields are replicated and watched by the client.
+	// They rarely change, so they're push based: every write marks them dirty and the net driver doesn't compare them otherwise.
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UAblAbilityComponent, m_ServerActive, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UAblAbilityComponent, m_ServerPassiveAbilities, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UAblAbilityComponent, m_ServerPredictionKey, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UAblAbilityComponent, m_ServerForceSequence, Params);
 }
 
 void UAblAbilityComponent::BeginDestroy()
@@ -444,7 +585,7 @@ EAblAbilityStartResult UAblAbilityComponent::ActivateAbility(UAblAbilityContext*
 			FAblAbilityNetworkContext AbilityNetworkContext(*Context);
 			if (m_Settings->GetAlwaysForwardToServerFirst())
 			{
-				ServerActivateAbility(AbilityNetworkContext);
+				SendAbilityCommand(FAblAbilityCommand::MakeActivate(AbilityNetworkContext));
 			}
 
 			// If we're a locally controlled player...
@@ -469,7 +610,7 @@ EAblAbilityStartResult UAblAbilityComponent::ActivateAbility(UAblAbilityContext*
 					{
 						if (Result == EAblAbilityStartResult::Success)
 						{
-							ServerActivateAbility(AbilityNetworkContext);
+							SendAbilityCommand(FAblAbilityCommand::MakeActivate(AbilityNetworkContext));
 							// Track it for prediction.
 							AddLocallyPredictedAbility(AbilityNetworkContext);
 						}
@@ -785,7 +926,7 @@ void UAblAbilityComponent::CancelAbility(const UAblAbility* Ability, EAblAbility
 
 	if (!IsAuthoritative())
 	{
-		ServerCancelAbility(Ability->GetAbilityNameHash(), ResultToUse);
+		SendAbilityCommand(FAblAbilityCommand::MakeCancel(Ability->GetAbilityNameHash(), ResultToUse));
 
 		// Fall through and Locally simulate the cancel if we're player controlled.
 		if (!IsOwnerLocallyControlled())
@@ -872,12 +1013,10 @@ void UAblAbilityComponent::SetPassiveStackCount(const UAblAbility* Ability, int3
 
 float UAblAbilityComponent::GetAbilityCooldownRatio(const UAblAbility* Ability) const
 {
-	if (Ability)
+	int32 OwnerIndex = INDEX_NONE;
+	if (const FAblCooldownTable* Table = GetCooldownTable(OwnerIndex))
 	{
-		if (const FAblAbilityCooldown* FoundCooldown = m_ActiveCooldowns.Find(Ability->GetAbilityNameHash()))
-		{
-			return FoundCooldown->getTimeRatio();
-		}
+		return Table->GetRatio(FindCooldown(Ability));
 	}
 
 	return 0.0f;
@@ -885,12 +1024,10 @@ float UAblAbilityComponent::GetAbilityCooldownRatio(const UAblAbility* Ability)
 
 float UAblAbilityComponent::GetAbilityCooldownTotal(const UAblAbility* Ability) const
 {
-	if (Ability)
+	int32 OwnerIndex = INDEX_NONE;
+	if (const FAblCooldownTable* Table = GetCooldownTable(OwnerIndex))
 	{
-		if (const FAblAbilityCooldown* FoundCooldown = m_ActiveCooldowns.Find(Ability->GetAbilityNameHash()))
-		{
-			return FoundCooldown->GetCooldownTime();
-		}
+		return Table->GetTotalTime(FindCooldown(Ability));
 	}
 
 	return 0.0f;
@@ -898,9 +1035,10 @@ float UAblAbilityComponent::GetAbilityCooldownTotal(const UAblAbility* Ability)
 
 void UAblAbilityComponent::RemoveCooldown(const UAblAbility* Ability)
 {
-	if (Ability)
+	const FAblCooldownHandle Handle = FindCooldown(Ability);
+	if (Handle.IsSet())
 	{
-		m_ActiveCooldowns.Remove(Ability->GetAbilityNameHash());
+		GetOrCreateCooldownTable().Remove(Handle);
 	}
 }
 
@@ -911,16 +1049,18 @@ void UAblAbilityComponent::SetCooldown(const UAblAbility* Ability, UAblAbilityCo
 		if (time <= 0.0f)
 		{
 			RemoveCooldown(Ability);
+			return;
 		}
 
-		if (FAblAbilityCooldown* cooldown = m_ActiveCooldowns.Find(Ability->GetAbilityNameHash()))
+		FAblCooldownHandle Handle = FindCooldown(Ability);
+		if (Handle.IsSet())
 		{
-			cooldown->SetCooldownTime(time);
+			GetOrCreateCooldownTable().SetTotalTime(Handle, time);
 		}
 		else if (Context)
 		{
-			FAblAbilityCooldown newCooldown(*Ability, *Context);
-			m_ActiveCooldowns.Add(Ability->GetAbilityNameHash(), newCooldown);
+			FAblCooldownTable& Table = GetOrCreateCooldownTable();
+			Table.Add(m_CooldownOwnerIndex, Ability->GetAbilityNameHash(), time);
 		}
 		else
 		{
@@ -929,6 +1069,45 @@ void UAblAbilityComponent::SetCooldown(const UAblAbility* Ability, UAblAbilityCo
 	}
 }
 
+const FAblCooldownTable* UAblAbilityComponent::GetCooldownTable(int32& OutOwnerIndex) const
+{
+	OutOwnerIndex = m_CooldownOwnerIndex;
+	if (m_CooldownOwnerIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	return m_CooldownScheduler.IsValid() ? &m_CooldownScheduler->GetCooldownTable() : &m_LocalCooldownTable;
+}
+
+FAblCooldownTable& UAblAbilityComponent::GetOrCreateCooldownTable()
+{
+	if (m_CooldownOwnerIndex == INDEX_NONE)
+	{
+		// Share the world table if there is one, otherwise keep our own.
+		UWorld* World = GetWorld();
+		m_CooldownScheduler = World ? World->GetSubsystem<UAblAbilitySchedulerSubsystem>() : nullptr;
+
+		FAblCooldownTable& Table = m_CooldownScheduler.IsValid() ? m_CooldownScheduler->GetCooldownTable() : m_LocalCooldownTable;
+		m_CooldownOwnerIndex = Table.AllocateOwner();
+		return Table;
+	}
+
+	return m_CooldownScheduler.IsValid() ? m_CooldownScheduler->GetCooldownTable() : m_LocalCooldownTable;
+}
+
+FAblCooldownHandle UAblAbilityComponent::FindCooldown(const UAblAbility* Ability) const
+{
+	int32 OwnerIndex = INDEX_NONE;
+	const FAblCooldownTable* Table = GetCooldownTable(OwnerIndex);
+	if (Ability && Table)
+	{
+		return Table->Find(OwnerIndex, Ability->GetAbilityNameHash());
+	}
+
+	return FAblCooldownHandle();
+}
+
 float UAblAbilityComponent::GetAbilityCurrentTime(const UAblAbility* Ability) const
 {
 	if (Ability)
@@ -1044,16 +1223,22 @@ void UAblAbilityComponent::ModifyContext(const TWeakObjectPtr<const UAblAbilityC
 
 void UAblAbilityComponent::CheckNeedsTick()
 {
-	// We need to tick if we...
-	bool NeedsTick = m_ActiveAbilityInstance.IsValid() || // Have an active ability...
+	const bool NeedsTick = NeedsUpdate();
+
+	// Scheduled components are updated by the world Scheduler, so our own tick stays off.
+	PrimaryComponentTick.SetTickFunctionEnable(NeedsTick && !m_RegisteredWithScheduler);
+}
+
+bool UAblAbilityComponent::NeedsUpdate() const
+{
+	// We need to update if we...
+	return m_ActiveAbilityInstance.IsValid() || // Have an active ability...
         m_PassivesDirty || // Have pending dirty passives...
         m_PassiveAbilityInstances.Num() || // Have any passive abilities...
-		m_ActiveCooldowns.Num() || // Have active cooldowns...
+		(!m_CooldownScheduler.IsValid() && m_LocalCooldownTable.Num() > 0) || // Have local cooldowns (the world table is updated without us)...
 		m_AsyncContexts.Num() || // Have Async targeting to process...
 		m_PendingContext.Num() || // We have a pending context...
 		m_PendingCancels.Num();  // We have a pending cancel...
-
-	PrimaryComponentTick.SetTickFunctionEnable(NeedsTick);
 }
 
 EAblAbilityStartResult UAblAbilityComponent::InternalStartAbility(UAblAbilityContext* Context, bool ServerActivatedAbility)
@@ -1235,13 +1420,14 @@ void UAblAbilityComponent::AddCooldownForAbility(const UAblAbility& Ability, con
 {
 	if (Ability.GetCooldown(&Context) > 0.0f)
 	{
-		m_ActiveCooldowns.Add(Ability.GetAbilityNameHash(), FAblAbilityCooldown(Ability, Context));
+		FAblCooldownTable& Table = GetOrCreateCooldownTable();
+		Table.Add(m_CooldownOwnerIndex, Ability, Context);
 	}
 }
 
 bool UAblAbilityComponent::IsAbilityOnCooldown(const UAblAbility* Ability) const
 {
-	return Ability ? m_ActiveCooldowns.Find(Ability->GetAbilityNameHash()) != nullptr : false;
+	return FindCooldown(Ability).IsSet();
 }
 
 bool UAblAbilityComponent::IsPassiveActive(const UAblAbility* Ability) const
@@ -1266,7 +1452,12 @@ void UAblAbilityComponent::InternalUpdateAbility(FAblAbilityInstance* AbilityIns
 
 		if (AbilityInstance->HasAsyncTasks())
 		{
-			if (UAbleSettings::IsAsyncEnabled() && m_Settings->GetAllowAbilityAsyncUpdate())
+			if (m_ScheduledAsyncUpdates && !AbilityInstance->HasSyncTasks())
+			{
+				// Only Async Tasks, the Scheduler runs these in parallel with every other async only Instance in the world.
+				m_ScheduledAsyncUpdates->Add(FAblScheduledAsyncUpdate(this, *AbilityInstance, AbilityInstance != &m_ActiveAbilityInstance, AbilityInstance->GetCurrentTime(), DeltaTime));
+			}
+			else if (UAbleSettings::IsAsyncEnabled() && m_Settings->GetAllowAbilityAsyncUpdate())
 			{
 				TGraphTask<FAsyncAbilityInstanceUpdaterTask>::CreateTask().ConstructAndDispatchWhenReady(AbilityInstance, AbilityInstance->GetCurrentTime(), DeltaTime);
 			}
@@ -1281,21 +1472,6 @@ void UAblAbilityComponent::InternalUpdateAbility(FAblAbilityInstance* AbilityIns
 	}
 }
 
-void UAblAbilityComponent::UpdateCooldowns(float DeltaTime)
-{
-	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("AblAbilityComponent::UpdateCooldowns"), STAT_AblAbilityComponent_UpdateCooldowns, STATGROUP_Able);
-	for (auto ItUpdate = m_ActiveCooldowns.CreateIterator(); ItUpdate; ++ItUpdate)
-	{
-		FAblAbilityCooldown& AbilityCooldown = ItUpdate->Value;
-
-		AbilityCooldown.Update(DeltaTime);
-		if (AbilityCooldown.IsComplete())
-		{
-			ItUpdate.RemoveCurrent();
-		}
-	}
-}
-
 void UAblAbilityComponent::HandlePendingContexts()
 {
 	check(m_PendingContext.Num() == m_PendingResult.Num());
@@ -1474,8 +1650,14 @@ void UAblAbilityComponent::HandleInstanceCleanUp(const UAblAbility& Ability)
 
 void UAblAbilityComponent::ValidateRemoteRunningAbilities()
 {
-	if (IsOwnerLocallyControlled() || IsAuthoritative())
+	if (IsAuthoritative())
+	{
+		return;
+	}
+
+	if (IsOwnerLocallyControlled())
 	{
+		ValidatePredictedPassiveAbilities();
 		return;
 	}
 
@@ -1484,14 +1666,25 @@ void UAblAbilityComponent::ValidateRemoteRunningAbilities()
 	{
 		if (!m_ActiveAbilityInstance.IsValid() || m_ServerActive.GetAbility()->GetAbilityNameHash() != m_ActiveAbilityInstance.GetAbilityNameHash())
 		{
-			// Server has an Active, but we aren't playing anything (or we're playing the wrong thing some how).
+			// Server has an Active, but we aren't playing anything (or we're playing the wrong thing some how). This start covers any missed force too.
+			m_ClientForceSequence = m_ServerForceSequence;
+			InternalStartAbility(UAblAbilityContext::MakeContext(m_ServerActive), true);
+		}
+		else if (IsNewerForceSequence(m_ServerForceSequence, m_ClientForceSequence))
+		{
+			// Server forced a restart of our Active, but the unreliable RPC never made it. Replay it.
+			UE_LOG(LogAble, Verbose, TEXT("[%s] Replaying missed forced Ability [%s], sequence %d (last played %d)."),
+				*GetNameSafe(GetOwner()), *GetNameSafe(m_ServerActive.GetAbility().Get()), m_ServerForceSequence, m_ClientForceSequence);
+
+			m_ClientForceSequence = m_ServerForceSequence;
 			InternalStartAbility(UAblAbilityContext::MakeContext(m_ServerActive), true);
 		}
 	}
 
 	// Validate Passive Abilities.
-	for (const FAblAbilityNetworkContext& PassiveContext : m_ServerPassiveAbilities)
+	for (const FAblServerPassiveAbility& ServerPassive : m_ServerPassiveAbilities.GetItems())
 	{
+		const FAblAbilityNetworkContext& PassiveContext = ServerPassive.GetContext();
 		if (PassiveContext.IsValid())
 		{
 			if (!IsPassiveActive(PassiveContext.GetAbility().Get()))
@@ -1560,7 +1753,7 @@ EAblAbilityStartResult UAblAbilityComponent::BranchAbility(UAblAbilityContext* C
 	if (!IsAuthoritative())
 	{
 		FAblAbilityNetworkContext AbilityNetworkContext(*Context);
-		ServerBranchAbility(AbilityNetworkContext);
+		SendAbilityCommand(FAblAbilityCommand::MakeBranch(AbilityNetworkContext));
 
 		if (IsOwnerLocallyControlled())
 		{
@@ -1621,22 +1814,34 @@ void UAblAbilityComponent::UpdateServerPassiveAbilities()
 {
 	check(IsAuthoritative()); // Should only be called on the server.
 
+	// Only dirty the items that actually changed, so only those get sent.
+	bool Changed = false;
 	TArray<uint32> Whitelist;
 	for (const FAblAbilityInstance& PassiveInstance : m_PassiveAbilityInstances)
 	{
 		Whitelist.Add(PassiveInstance.GetAbilityNameHash());
-		if (FAblAbilityNetworkContext* ExistingNetworkContext = m_ServerPassiveAbilities.FindByPredicate(FAblFindAbilityNetworkContextByHash(PassiveInstance.GetAbilityNameHash())))
+		if (FAblServerPassiveAbility* ExistingPassive = m_ServerPassiveAbilities.FindByHash(PassiveInstance.GetAbilityNameHash()))
 		{
-			ExistingNetworkContext->SetCurrentStacks(PassiveInstance.GetStackCount());
+			if (ExistingPassive->SetCurrentStacks(PassiveInstance.GetStackCount()))
+			{
+				m_ServerPassiveAbilities.MarkItemDirty(*ExistingPassive);
+				Changed = true;
+			}
 		}
 		else
 		{
 			// New Passive.
 			m_ServerPassiveAbilities.Add(FAblAbilityNetworkContext(PassiveInstance.GetContext()));
+			Changed = true;
 		}
 	}
 
-	m_ServerPassiveAbilities.RemoveAll(FAblAbilityNetworkContextWhiteList(Whitelist));
+	Changed |= m_ServerPassiveAbilities.RemoveAllNotIn(Whitelist) > 0;
+
+	if (Changed)
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(UAblAbilityComponent, m_ServerPassiveAbilities, this);
+	}
 }
 
 void UAblAbilityComponent::UpdateServerActiveAbility()
@@ -1646,15 +1851,17 @@ void UAblAbilityComponent::UpdateServerActiveAbility()
 	if (!m_ActiveAbilityInstance.IsValid())
 	{
 		m_ServerActive.Reset();
+		MARK_PROPERTY_DIRTY_FROM_NAME(UAblAbilityComponent, m_ServerActive, this);
 	}
 	else if(!m_ServerActive.IsValid() || m_ServerActive.GetAbility()->GetAbilityNameHash() != m_ActiveAbilityInstance.GetAbilityNameHash())
 	{
 		m_ServerActive = FAblAbilityNetworkContext(m_ActiveAbilityInstance.GetContext(), m_ActiveAbilityResult.GetValue());
+		MARK_PROPERTY_DIRTY_FROM_NAME(UAblAbilityComponent, m_ServerActive, this);
 	}
 	else if (m_ServerActive.IsValid() && m_ServerActive.GetAbility()->GetAbilityNameHash() == m_ActiveAbilityInstance.GetAbilityNameHash())
 	{
 		FAblAbilityNetworkContext forcedContext(m_ActiveAbilityInstance.GetContext());
-		ClientForceAbility(forcedContext);
+		ForceAbilityOnClients(forcedContext);
 	}
 }
 
@@ -1666,19 +1873,25 @@ void UAblAbilityComponent::ServerActivateAbility_Implementation(const FAblAbilit
 		if (!Context.GetAbility()->IsPassive())
 		{
 			m_ServerActive = FAblAbilityNetworkContext(*LocalContext);
+			MARK_PROPERTY_DIRTY_FROM_NAME(UAblAbilityComponent, m_ServerActive, this);
 		}
 		else
 		{
 			int32 StackCount = GetCurrentStackCountForPassiveAbility(Context.GetAbility().Get());
-			if (FAblAbilityNetworkContext* ExistingContext = m_ServerPassiveAbilities.FindByPredicate(FAblFindAbilityNetworkContextByHash(Context.GetAbility()->GetAbilityNameHash())))
+			if (FAblServerPassiveAbility* ExistingPassive = m_ServerPassiveAbilities.FindByHash(Context.GetAbility()->GetAbilityNameHash()))
 			{
-				ExistingContext->SetCurrentStacks(StackCount);
+				if (ExistingPassive->SetCurrentStacks(StackCount))
+				{
+					m_ServerPassiveAbilities.MarkItemDirty(*ExistingPassive);
+					MARK_PROPERTY_DIRTY_FROM_NAME(UAblAbilityComponent, m_ServerPassiveAbilities, this);
+				}
 			}
 			else
 			{
 				FAblAbilityNetworkContext NewNetworkContext(*LocalContext);
 				NewNetworkContext.SetCurrentStacks(StackCount);
 				m_ServerPassiveAbilities.Add(NewNetworkContext);
+				MARK_PROPERTY_DIRTY_FROM_NAME(UAblAbilityComponent, m_ServerPassiveAbilities, this);
 			}
 		}
 	}
@@ -1743,6 +1956,154 @@ bool UAblAbilityComponent::ServerBranchAbility_Validate(const FAblAbilityNetwork
 	return Context.IsValid();
 }
 
+void UAblAbilityComponent::ServerAbilityCommands_Implementation(const FAblAbilityCommandBatch& Batch)
+{
+	for (const FAblAbilityCommand& Command : Batch.GetCommands())
+	{
+		switch (Command.GetType())
+		{
+			case EAblAbilityCommandType::Activate:
+			{
+				ServerActivateAbility_Implementation(Command.GetContext());
+			}
+			break;
+			case EAblAbilityCommandType::Branch:
+			{
+				ServerBranchAbility_Implementation(Command.GetContext());
+			}
+			break;
+			case EAblAbilityCommandType::Cancel:
+			{
+				ServerCancelAbility_Implementation(Command.GetAbilityNameHash(), Command.GetResult());
+			}
+			break;
+			default:
+				break;
+		}
+	}
+}
+
+bool UAblAbilityComponent::ServerAbilityCommands_Validate(const FAblAbilityCommandBatch& Batch)
+{
+	// Same checks the individual RPCs make, one bad Command rejects the batch just like one bad RPC would.
+	for (const FAblAbilityCommand& Command : Batch.GetCommands())
+	{
+		switch (Command.GetType())
+		{
+			case EAblAbilityCommandType::Activate:
+			{
+				if (!ServerActivateAbility_Validate(Command.GetContext()))
+				{
+					return false;
+				}
+			}
+			break;
+			case EAblAbilityCommandType::Branch:
+			{
+				if (!ServerBranchAbility_Validate(Command.GetContext()))
+				{
+					return false;
+				}
+			}
+			break;
+			case EAblAbilityCommandType::Cancel:
+			{
+				if (!ServerCancelAbility_Validate(Command.GetAbilityNameHash(), Command.GetResult()))
+				{
+					return false;
+				}
+			}
+			break;
+			default:
+				return false;
+		}
+	}
+
+	return Batch.GetCommands().Num() > 0;
+}
+
+void UAblAbilityComponent::SendAbilityCommand(const FAblAbilityCommand& Command)
+{
+	INC_DWORD_STAT(STAT_AblAbilityCommands_Issued);
+	++AblAbilityCommands::NumIssued;
+
+	m_PendingCommands.GetCommands().Add(Command);
+
+	UWorld* World = GetWorld();
+	if (!m_Settings->GetBatchAbilityRPCs() || !World || !World->IsGameWorld())
+	{
+		FlushAbilityCommands();
+		return;
+	}
+
+	if (m_PendingCommands.GetCommands().Num() >= FAblAbilityCommandBatch::MaxCommands)
+	{
+		FlushAbilityCommands();
+	}
+	else if (!m_FlushCommandsHandle.IsValid())
+	{
+		m_FlushCommandsHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UAblAbilityComponent::OnWorldPostActorTick);
+	}
+}
+
+void UAblAbilityComponent::FlushAbilityCommands()
+{
+	if (m_FlushCommandsHandle.IsValid())
+	{
+		FWorldDelegates::OnWorldPostActorTick.Remove(m_FlushCommandsHandle);
+		m_FlushCommandsHandle.Reset();
+	}
+
+	TArray<FAblAbilityCommand>& Commands = m_PendingCommands.GetCommands();
+	if (Commands.Num() == 0)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_AblAbilityServerRPCs_Sent);
+	++AblAbilityCommands::NumRPCs;
+
+	if (Commands.Num() == 1)
+	{
+		// Nothing to coalesce, the single RPC is smaller than a batch of one.
+		const FAblAbilityCommand& Command = Commands[0];
+		switch (Command.GetType())
+		{
+			case EAblAbilityCommandType::Activate:
+			{
+				ServerActivateAbility(Command.GetContext());
+			}
+			break;
+			case EAblAbilityCommandType::Branch:
+			{
+				ServerBranchAbility(Command.GetContext());
+			}
+			break;
+			case EAblAbilityCommandType::Cancel:
+			{
+				ServerCancelAbility(Command.GetAbilityNameHash(), Command.GetResult());
+			}
+			break;
+			default:
+				break;
+		}
+	}
+	else
+	{
+		ServerAbilityCommands(m_PendingCommands);
+	}
+
+	Commands.Reset();
+}
+
+void UAblAbilityComponent::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == GetWorld())
+	{
+		FlushAbilityCommands();
+	}
+}
+
 bool UAblAbilityComponent::ClientForceAbility_Validate(const FAblAbilityNetworkContext& Context)
 {
 	return Context.IsValid();
@@ -1756,6 +2117,70 @@ void UAblAbilityComponent::ClientForceAbility_Implementation(const FAblAbilityNe
 	}
 }
 
+bool UAblAbilityComponent::ClientForceAbilityUnreliable_Validate(const FAblAbilityNetworkContext& Context, uint16 Sequence)
+{
+	return Context.IsValid();
+}
+
+void UAblAbilityComponent::ClientForceAbilityUnreliable_Implementation(const FAblAbilityNetworkContext& Context, uint16 Sequence)
+{
+	if (!GetOwner() || GetOwner()->GetNetMode() != ENetMode::NM_Client)
+	{
+		return;
+	}
+
+	if (Sequence != 0)
+	{
+		if (!IsNewerForceSequence(Sequence, m_ClientForceSequence))
+		{
+			// Already replayed this one (or a later one) from validation.
+			return;
+		}
+
+		m_ClientForceSequence = Sequence;
+	}
+
+	InternalStartAbility(UAblAbilityContext::MakeContext(Context), true);
+}
+
+void UAblAbilityComponent::ForceAbilityOnClients(const FAblAbilityNetworkContext& Context)
+{
+	check(IsAuthoritative()); // Should only be called on the server.
+
+	const UAblAbility* Ability = Context.GetAbility().Get();
+	const EAblForceAbilityDelivery Delivery = CVarForceAbilityReliable.GetValueOnGameThread() != 0 ? EAblForceAbilityDelivery::Reliable :
+		(Ability ? Ability->GetForceDelivery() : EAblForceAbilityDelivery::Reliable);
+
+	switch (Delivery)
+	{
+		case EAblForceAbilityDelivery::Reliable:
+		{
+			ClientForceAbility(Context);
+		}
+		break;
+		case EAblForceAbilityDelivery::Cosmetic:
+		{
+			ClientForceAbilityUnreliable(Context, 0);
+		}
+		break;
+		case EAblForceAbilityDelivery::Unreliable:
+		default:
+		{
+			// Skip 0, it means "don't replay".
+			m_ServerForceSequence = m_ServerForceSequence == MAX_uint16 ? 1 : m_ServerForceSequence + 1;
+			MARK_PROPERTY_DIRTY_FROM_NAME(UAblAbilityComponent, m_ServerForceSequence, this);
+			ClientForceAbilityUnreliable(Context, m_ServerForceSequence);
+		}
+		break;
+	}
+}
+
+bool UAblAbilityComponent::IsNewerForceSequence(uint16 A, uint16 B)
+{
+	// Wrap around safe, treats anything within half the range ahead of B as newer.
+	return A != B && (int16)(A - B) > 0;
+}
+
 void UAblAbilityComponent::OnServerActiveAbilityChanged()
 {
 	if (m_ServerActive.IsValid() && 
@@ -1769,6 +2194,13 @@ void UAblAbilityComponent::OnServerActiveAbilityChanged()
 
 		if (IsPlayingAbility())
 		{
+			if (IsOwnerLocallyControlled())
+			{
+				// We're throwing away whatever we predicted in favor of the server's Ability.
+				INC_DWORD_STAT(STAT_AblPrediction_Rollbacks);
+				++AblPrediction::NumRollbacks;
+			}
+
 			// TODO: Should the client care about server based interrupt/branches?
 			InternalCancelAbility(GetActiveAbility(), EAblAbilityTaskResult::Successful);
 		}
@@ -1784,34 +2216,103 @@ void UAblAbilityComponent::OnServerActiveAbilityChanged()
 	}
 }
 
-void UAblAbilityComponent::OnServerPassiveAbilitiesChanged()
+void UAblAbilityComponent::ValidatePredictedPassiveAbilities()
 {
-	TArray<uint32> ValidAbilityNameHashes;
-	for (const FAblAbilityNetworkContext& ServerPassive : m_ServerPassiveAbilities)
+	if (!IsNetworked())
 	{
-		if (ServerPassive.IsValid() && 
-			ServerPassive.GetAbility().IsValid() && 
-			AbilityClientPolicyAllowsExecution(ServerPassive.GetAbility().Get()))
+		return;
+	}
+
+	for (int32 i = m_PassiveAbilityInstances.Num() - 1; i >= 0; --i)
+	{
+		FAblAbilityInstance& PassiveInstance = m_PassiveAbilityInstances[i];
+		if (!PassiveInstance.IsValid())
 		{
-			if (FAblAbilityInstance* CurrentPassive = m_PassiveAbilityInstances.FindByPredicate(FAblFindAbilityInstanceByHash(ServerPassive.GetAbility()->GetAbilityNameHash())))
-			{
-				// Just make sure our stack count is accurate.
-				CurrentPassive->SetStackCount(ServerPassive.GetCurrentStack());
-			}
-			else // New Passive Ability
-			{
-				if (!WasLocallyPredicted(ServerPassive))
-				{
-					ActivatePassiveAbility(UAblAbilityContext::MakeContext(ServerPassive));
-				}
-			}
+			continue;
+		}
+
+		const uint32 AbilityNameHash = PassiveInstance.GetAbilityNameHash();
+		if (m_ServerPassiveAbilities.FindByHash(AbilityNameHash) || IsPredictionPending(AbilityNameHash))
+		{
+			continue;
+		}
 
-			ValidAbilityNameHashes.Add(ServerPassive.GetAbility()->GetAbilityNameHash());
+		// We predicted this one, but the server rejected it (or never heard of it). Stop it.
+		if (m_Settings->GetLogVerbose())
+		{
+			UE_LOG(LogAble, Warning, TEXT("[%s] Stopping predicted Passive [%s], the server isn't running it."),
+				*FAbleLogHelper::GetWorldName(GetOwner()->GetWorld()),
+				*PassiveInstance.GetAbility().GetDisplayName());
 		}
+
+		INC_DWORD_STAT(STAT_AblPrediction_Rollbacks);
+		++AblPrediction::NumRollbacks;
+
+		PassiveInstance.FinishAbility();
+		HandleInstanceCleanUp(PassiveInstance.GetAbility());
+		m_PassiveAbilityInstances.RemoveAt(i);
+		m_PassivesDirty |= true;
 	}
+}
+
+bool UAblAbilityComponent::IsPredictionPending(uint32 AbilityNameHash) const
+{
+	const UWorld* World = GetWorld();
+	const float Now = World ? World->GetRealTimeSeconds() : 0.0f;
+	const float Timeout = m_Settings->GetPredictedPassiveTimeout();
 
-	m_PassiveAbilityInstances.RemoveAll(FAblAbilityInstanceWhiteList(ValidAbilityNameHashes));
-    m_PassivesDirty |= true;
+	for (const FAblAbilityNetworkContext& Predicted : m_LocallyPredictedAbilities)
+	{
+		if (Predicted.GetAbility().IsValid() && Predicted.GetAbility()->GetAbilityNameHash() == AbilityNameHash && Now - Predicted.GetTimeStamp() < Timeout)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UAblAbilityComponent::OnServerPassiveAbilityChanged(const FAblAbilityNetworkContext& ServerPassive, bool IsNew)
+{
+	if (!ServerPassive.IsValid() ||
+		!ServerPassive.GetAbility().IsValid() ||
+		!AbilityClientPolicyAllowsExecution(ServerPassive.GetAbility().Get()))
+	{
+		return;
+	}
+
+	if (FAblAbilityInstance* CurrentPassive = m_PassiveAbilityInstances.FindByPredicate(FAblFindAbilityInstanceByHash(ServerPassive.GetAbility()->GetAbilityNameHash())))
+	{
+		// Just make sure our stack count is accurate.
+		CurrentPassive->SetStackCount(ServerPassive.GetCurrentStack());
+
+		if (IsNew)
+		{
+			// The server confirmed a Passive we're already running, consume our prediction of it.
+			WasLocallyPredicted(ServerPassive);
+		}
+	}
+	else // New Passive Ability
+	{
+		if (!WasLocallyPredicted(ServerPassive))
+		{
+			ActivatePassiveAbility(UAblAbilityContext::MakeContext(ServerPassive));
+		}
+	}
+
+	m_PassivesDirty |= true;
+}
+
+void UAblAbilityComponent::OnServerPassiveAbilityRemoved(uint32 AbilityNameHash)
+{
+	const int32 PassiveIndex = m_PassiveAbilityInstances.IndexOfByPredicate(FAblFindAbilityInstanceByHash(AbilityNameHash));
+	if (PassiveIndex != INDEX_NONE)
+	{
+		m_PassiveAbilityInstances[PassiveIndex].FinishAbility();
+		HandleInstanceCleanUp(m_PassiveAbilityInstances[PassiveIndex].GetAbility());
+		m_PassiveAbilityInstances.RemoveAt(PassiveIndex);
+		m_PassivesDirty |= true;
+	}
 }
 
 void UAblAbilityComponent::OnServerPredictiveKeyChanged()
@@ -1974,6 +2475,7 @@ uint16 UAblAbilityComponent::GetPredictionKey()
 	if (IsAuthoritative())
 	{
 		m_ServerPredictionKey = FMath::Max<uint16>(++m_ServerPredictionKey, 1);
+		MARK_PROPERTY_DIRTY_FROM_NAME(UAblAbilityComponent, m_ServerPredictionKey, this);
 		return m_ServerPredictionKey;
 	}
 
@@ -1983,31 +2485,199 @@ uint16 UAblAbilityComponent::GetPredictionKey()
 
 void UAblAbilityComponent::AddLocallyPredictedAbility(const FAblAbilityNetworkContext& Context)
 {
-	m_LocallyPredictedAbilities[Context.GetPredictionKey() % ABLE_ABILITY_PREDICTION_RING_SIZE] = Context;
+	FAblAbilityNetworkContext& Slot = m_LocallyPredictedAbilities[Context.GetPredictionKey() % ABLE_ABILITY_PREDICTION_RING_SIZE];
+	if (Slot.GetAbility().IsValid())
+	{
+		// The server never confirmed this one (rejected, or it came back with a key outside our tolerance).
+		INC_DWORD_STAT(STAT_AblPrediction_Expired);
+		++AblPrediction::NumExpired;
+	}
+
+	Slot = Context;
 }
 
 bool UAblAbilityComponent::WasLocallyPredicted(const FAblAbilityNetworkContext& Context)
 {
-	if (Context.GetPredictionKey() == 0 || m_LocallyPredictedAbilities.Num() == 0)
+	if (Context.GetPredictionKey() == 0 || !Context.GetAbility().IsValid())
 	{
 		return false;
 	}
 
-	uint32 PredictionTolerance = m_Settings.IsValid() ? m_Settings->GetPredictionTolerance() : 0U;
+	const uint32 PredictionTolerance = m_Settings.IsValid() ? m_Settings->GetPredictionTolerance() : 0U;
+	const uint32 AbilityNameHash = Context.GetAbility()->GetAbilityNameHash();
+	const int32 Key = (int32)Context.GetPredictionKey();
 
-	FAblAbilityNetworkContext* FoundLocalContext = m_LocallyPredictedAbilities.FindByPredicate([&](const FAblAbilityNetworkContext& LHS)
+	auto Matches = [&](const FAblAbilityNetworkContext& LHS, uint32 Tolerance)
 	{
-		return LHS.GetAbility().IsValid() && LHS.GetAbility()->GetAbilityNameHash() == Context.GetAbility()->GetAbilityNameHash() && (uint32)FMath::Abs(LHS.GetPredictionKey() - Context.GetPredictionKey()) <= PredictionTolerance;
-	});
+		return LHS.GetAbility().IsValid() && LHS.GetAbility()->GetAbilityNameHash() == AbilityNameHash && (uint32)FMath::Abs((int32)LHS.GetPredictionKey() - Key) <= Tolerance;
+	};
 
-	if (FoundLocalContext)
+	// Only the slots a key within our tolerance could land in, nearest first. Past half the ring that's every slot.
+	const int32 MaxOffset = FMath::Min<int32>(PredictionTolerance, ABLE_ABILITY_PREDICTION_RING_SIZE / 2);
+	for (int32 Offset = 0; Offset <= MaxOffset; ++Offset)
 	{
-		// Found a match entry, consume it.
-		FoundLocalContext->Reset();
-		return true;
+		for (int32 Sign = 0; Sign < (Offset == 0 ? 1 : 2); ++Sign)
+		{
+			const int32 ProbeKey = Sign == 0 ? Key + Offset : Key - Offset;
+			FAblAbilityNetworkContext& Slot = m_LocallyPredictedAbilities[(uint32)ProbeKey % ABLE_ABILITY_PREDICTION_RING_SIZE];
+			if (Matches(Slot, PredictionTolerance))
+			{
+				// Found a match entry, consume it.
+				INC_DWORD_STAT(STAT_AblPrediction_Hits);
+				++AblPrediction::NumHits;
+
+				Slot.Reset();
+				return true;
+			}
+		}
+	}
+
+	if (IsOwnerLocallyControlled())
+	{
+		// Stats only: if we did predict this Ability, how far off was the key? That's the tolerance that would have caught it.
+		// Abilities the server started on its own aren't in the ring, so they don't count as misses.
+		int32 NearestDistance = MAX_int32;
+		for (const FAblAbilityNetworkContext& Predicted : m_LocallyPredictedAbilities)
+		{
+			if (Matches(Predicted, MAX_uint16))
+			{
+				NearestDistance = FMath::Min(NearestDistance, FMath::Abs((int32)Predicted.GetPredictionKey() - Key));
+			}
+		}
+
+		if (NearestDistance != MAX_int32)
+		{
+			INC_DWORD_STAT(STAT_AblPrediction_Misses);
+			++AblPrediction::NumMisses;
+			++AblPrediction::MissDistances[FMath::Min<int32>(NearestDistance, AblPrediction::MaxMissDistance)];
+		}
 	}
 
 	return false;
 }
 
+static void PredictionStats(const TArray<FString>& Args)
+{
+	using namespace AblPrediction;
+
+	const int64 Total = NumHits + NumMisses;
+	UE_LOG(LogAble, Display, TEXT("Able.PredictionStats: %lld hits, %lld misses (%.1f%% hit), %lld expired unconfirmed, %lld rollbacks. Prediction Tolerance %u."),
+		NumHits, NumMisses, Total > 0 ? 100.0 * NumHits / Total : 0.0, NumExpired, NumRollbacks, GetDefault<UAbleSettings>()->GetPredictionTolerance());
+
+	// Misses we had a prediction for, by how far off its key was.
+	for (int32 Distance = 1; Distance <= MaxMissDistance; ++Distance)
+	{
+		if (MissDistances[Distance] > 0)
+		{
+			UE_LOG(LogAble, Display, TEXT("    %lld misses were %s%d keys off, a Prediction Tolerance of %d would have matched them."),
+				MissDistances[Distance], Distance == MaxMissDistance ? TEXT(">= ") : TEXT(""), Distance, Distance);
+		}
+	}
+
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		NumHits = 0;
+		NumMisses = 0;
+		NumExpired = 0;
+		NumRollbacks = 0;
+		FMemory::Memzero(MissDistances);
+	}
+}
+
+static FAutoConsoleCommand PredictionStatsCommand(
+	TEXT("Able.PredictionStats"),
+	TEXT("Logs how often the server's Abilities matched our locally predicted ones, and how far off the misses were, to help tune Prediction Tolerance. Args: [reset]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&PredictionStats));
+
+static void AbilityRPCStats(const TArray<FString>& Args)
+{
+	using namespace AblAbilityCommands;
+
+	const double CommandsPerRPC = NumRPCs > 0 ? (double)NumIssued / NumRPCs : 0.0;
+	UE_LOG(LogAble, Display, TEXT("Able.AbilityRPCStats: %lld Ability Commands sent in %lld server RPCs, %.2f Commands per RPC (Batch Ability RPCs %s)."),
+		NumIssued, NumRPCs, CommandsPerRPC, GetDefault<UAbleSettings>()->GetBatchAbilityRPCs() ? TEXT("on") : TEXT("off"));
+
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		NumIssued = 0;
+		NumRPCs = 0;
+	}
+}
+
+static FAutoConsoleCommand AbilityRPCStatsCommand(
+	TEXT("Able.AbilityRPCStats"),
+	TEXT("Logs how many Activate / Branch / Cancel Commands clients sent and how many server RPCs carried them. Args: [reset]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&AbilityRPCStats));
+
+static void AbilityRPCSoak(const TArray<FString>& Args, UWorld* World)
+{
+	if (Args.Num() < 1)
+	{
+		UE_LOG(LogAble, Display, TEXT("Usage: Able.AbilityRPCSoak <Ability Class Path> [CommandsPerFrame=4] [Seconds=30]"));
+		return;
+	}
+
+	APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+	UAblAbilityComponent* AbilityComponent = Pawn ? Pawn->FindComponentByClass<UAblAbilityComponent>() : nullptr;
+	if (!AbilityComponent || World->GetNetMode() != NM_Client)
+	{
+		UE_LOG(LogAble, Warning, TEXT("Able.AbilityRPCSoak must be run on a client whose Pawn has an Ability Component."));
+		return;
+	}
+
+	UClass* AbilityClass = LoadClass<UAblAbility>(nullptr, *Args[0]);
+	if (!AbilityClass)
+	{
+		UE_LOG(LogAble, Warning, TEXT("Able.AbilityRPCSoak couldn't load Ability class [%s]."), *Args[0]);
+		return;
+	}
+
+	const int32 CommandsPerFrame = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 4;
+	const float Seconds = Args.Num() > 2 ? FMath::Max(1.0f, FCString::Atof(*Args[2])) : 30.0f;
+
+	const int64 StartIssued = AblAbilityCommands::NumIssued;
+	const int64 StartRPCs = AblAbilityCommands::NumRPCs;
+
+	UE_LOG(LogAble, Display, TEXT("Able.AbilityRPCSoak: %d Commands a frame for %.0f seconds (Batch Ability RPCs %s). Record a net trace to compare bandwidth."),
+		CommandsPerFrame, Seconds, GetDefault<UAbleSettings>()->GetBatchAbilityRPCs() ? TEXT("on") : TEXT("off"));
+
+	// Alternates Activate and Cancel, the same calls a combo heavy player makes.
+	TWeakObjectPtr<UAblAbilityComponent> WeakComponent(AbilityComponent);
+	const UAblAbility* Ability = GetDefault<UAblAbility>(AbilityClass);
+	float Elapsed = 0.0f;
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakComponent, Ability, CommandsPerFrame, Seconds, Elapsed, StartIssued, StartRPCs](float DeltaTime) mutable
+	{
+		UAblAbilityComponent* Component = WeakComponent.Get();
+		Elapsed += DeltaTime;
+		if (!Component || Elapsed >= Seconds)
+		{
+			const int64 Issued = AblAbilityCommands::NumIssued - StartIssued;
+			const int64 RPCs = AblAbilityCommands::NumRPCs - StartRPCs;
+			UE_LOG(LogAble, Display, TEXT("Able.AbilityRPCSoak: done, %lld Commands sent in %lld server RPCs (%.2f Commands per RPC)."),
+				Issued, RPCs, RPCs > 0 ? (double)Issued / RPCs : 0.0);
+			return false;
+		}
+
+		for (int32 i = 0; i < CommandsPerFrame; ++i)
+		{
+			if (i % 2 == 0)
+			{
+				Component->ActivateAbility(UAblAbilityContext::MakeContext(Ability, Component, Component->GetOwner(), Component->GetOwner()));
+			}
+			else
+			{
+				Component->CancelAbility(Ability, EAblAbilityTaskResult::Interrupted);
+			}
+		}
+
+		return true;
+	}));
+}
+
+static FAutoConsoleCommand AbilityRPCSoakCommand(
+	TEXT("Able.AbilityRPCSoak"),
+	TEXT("Client only. Spams Activate / Cancel of an Ability on the local Pawn, then logs how many server RPCs carried them. Run with Batch Ability RPCs on and off. Args: <Ability Class Path> [CommandsPerFrame=4] [Seconds=30]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&AbilityRPCSoak));
+
 #undef LOCTEXT_NAMESPACE
@@ -3,16 +3,27 @@
 #include "ablAbilityContext.h"
 
 #include "ablAbility.h"
+#include "ablAbilityDependencies.h"
+#include "ablAbilityTaskPlan.h"
 #include "ablAbilityComponent.h"
 #include "ablSettings.h"
 #include "ablSubSystem.h"
 #include "Components/PrimitiveComponent.h"
 #include "Engine/Engine.h"
+#include "Engine/NetSerialization.h"
 #include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
 #include "Misc/ScopeLock.h"
 #include "Net/UnrealNetwork.h"
+#include "Serialization/BitWriter.h"
 #include "Tasks/IAblAbilityTask.h"
 
+/* Measures the size of sent Network Contexts and Command Batches. NetSerialize only sees an FArchive, this assumes every saving net archive is an
+ * FBitWriter (true for stock replication and RPCs, not guaranteed for anything else), so only turn it on for local profiling. */
+#ifndef ABLE_NET_SIZE_STATS
+#define ABLE_NET_SIZE_STATS 0
+#endif
+
 //--------------------------------------------------------------------------------------------------------------------------------------------
 FVector FAblQueryResult::GetLocation() const
 {
@@ -46,105 +57,288 @@ void FAblQueryResult::GetTransform(FTransform& OutTransform) const
 
 
 //--------------------------------------------------------------------------------------------------------------------------------------------
+namespace
+{
+	/* Size of a value in our buffer, String/UObject values are stored in their own arrays. */
+	uint16 GetContextParamValueSize(EAblContextParamType Type)
+	{
+		switch (Type)
+		{
+			case EAblContextParamType::Int: return sizeof(int);
+			case EAblContextParamType::Float: return sizeof(float);
+			case EAblContextParamType::Vector: return sizeof(FVector);
+			default: return 0;
+		}
+	}
+}
+
+FAblContextParamSchema::FAblContextParamSchema()
+	: NumBytes(0),
+	NumStrings(0),
+	NumUObjects(0)
+{
+
+}
+
+void FAblContextParamSchema::Build(const TArray<FAblContextParamDesc>& Params)
+{
+	Slots.Empty(Params.Num());
+	NumBytes = 0;
+	NumStrings = 0;
+	NumUObjects = 0;
+
+	for (const FAblContextParamDesc& Param : Params)
+	{
+		if (Param.Name.IsNone() || FindSlot(Param.Name, Param.Type) != INDEX_NONE)
+		{
+			continue;
+		}
+
+		FAblContextParamSlot& Slot = Slots.AddDefaulted_GetRef();
+		Slot.Name = Param.Name;
+		Slot.Type = Param.Type;
+		Slot.IsSet = false;
+
+		switch (Param.Type)
+		{
+			case EAblContextParamType::String:
+				Slot.Offset = NumStrings++;
+				break;
+			case EAblContextParamType::UObject:
+				Slot.Offset = NumUObjects++;
+				break;
+			default:
+				Slot.Offset = NumBytes;
+				NumBytes += GetContextParamValueSize(Param.Type);
+				break;
+		}
+	}
+}
+
+int32 FAblContextParamSchema::FindSlot(FName Id, EAblContextParamType Type) const
+{
+	return Slots.IndexOfByPredicate([&](const FAblContextParamSlot& Slot) { return Slot.Name == Id && Slot.Type == Type; });
+}
+
 FAblAbilityContextParams::FAblAbilityContextParams()
 {
 }
 
-FAblAbilityContextParams::FAblAbilityContextParams(const FAblAbilityContextParams& Context)
+void FAblAbilityContextParams::SetSchema(const TSharedPtr<const FAblContextParamSchema>& Schema)
 {
 	ClearParams();
-	AppendParams(Context);
+
+	m_Schema = Schema;
+	if (m_Schema.IsValid())
+	{
+		m_Slots.Append(m_Schema->Slots);
+		m_Values.AddZeroed(m_Schema->NumBytes);
+		m_StringValues.SetNum(m_Schema->NumStrings);
+		m_UObjectValues.SetNumZeroed(m_Schema->NumUObjects);
+	}
 }
 
 void FAblAbilityContextParams::ClearParams()
 {
-	m_IntParameters.Empty();
-	m_FloatParameters.Empty();
-	m_StringParameters.Empty();
-	m_UObjectParameters.Empty();
-	m_VectorParameters.Empty();
+	// Keep our memory, Contexts are pooled.
+	m_Schema.Reset();
+	m_Slots.Reset();
+	m_Values.Reset();
+	m_StringValues.Reset();
+	m_UObjectValues.Reset();
 }
 
 void FAblAbilityContextParams::AppendParams(const FAblAbilityContextParams& params)
 {
-	m_IntParameters.Append(params.GetIntParameters());
-	m_FloatParameters.Append(params.GetFloatParameters());
-	m_StringParameters.Append(params.GetStringParameters());
-	m_UObjectParameters.Append(params.GetUObjectParameters());
-	m_VectorParameters.Append(params.GetVectorParameters());
+	const bool AnySet = m_Slots.ContainsByPredicate([](const FAblContextParamSlot& Slot) { return Slot.IsSet; });
+	if (!AnySet && (!m_Schema.IsValid() || m_Schema == params.m_Schema))
+	{
+		// Nothing to merge with and our layouts match, so just copy it all over.
+		m_Schema = params.m_Schema;
+		m_Slots = params.m_Slots;
+		m_Values = params.m_Values;
+		m_StringValues = params.m_StringValues;
+		m_UObjectValues = params.m_UObjectValues;
+		return;
+	}
+
+	for (int32 i = 0; i < params.m_Slots.Num(); ++i)
+	{
+		if (params.m_Slots[i].IsSet)
+		{
+			CopySlotValue(params, i);
+		}
+	}
+}
+
+int32 FAblAbilityContextParams::FindSlot(FName Id, EAblContextParamType Type) const
+{
+	return m_Slots.IndexOfByPredicate([&](const FAblContextParamSlot& Slot) { return Slot.Name == Id && Slot.Type == Type; });
+}
+
+int32 FAblAbilityContextParams::FindOrAddSlot(FName Id, EAblContextParamType Type)
+{
+	int32 SlotIndex = FindSlot(Id, Type);
+	if (SlotIndex != INDEX_NONE)
+	{
+		return SlotIndex;
+	}
+
+	// Not declared by our Ability, add it to the end.
+	SlotIndex = m_Slots.AddDefaulted();
+	FAblContextParamSlot& Slot = m_Slots[SlotIndex];
+	Slot.Name = Id;
+	Slot.Type = Type;
+	Slot.IsSet = false;
+
+	switch (Type)
+	{
+		case EAblContextParamType::String:
+			Slot.Offset = (uint16)m_StringValues.AddDefaulted();
+			break;
+		case EAblContextParamType::UObject:
+			Slot.Offset = (uint16)m_UObjectValues.Add(nullptr);
+			break;
+		default:
+			Slot.Offset = (uint16)m_Values.AddZeroed(GetContextParamValueSize(Type));
+			break;
+	}
+
+	return SlotIndex;
+}
+
+void FAblAbilityContextParams::CopySlotValue(const FAblAbilityContextParams& Source, int32 SourceSlot)
+{
+	const FAblContextParamSlot& Slot = Source.m_Slots[SourceSlot];
+	const int32 SlotIndex = FindOrAddSlot(Slot.Name, Slot.Type);
+	switch (Slot.Type)
+	{
+		case EAblContextParamType::Int: SetIntParameterAt(SlotIndex, Source.GetIntParameterAt(SourceSlot)); break;
+		case EAblContextParamType::Float: SetFloatParameterAt(SlotIndex, Source.GetFloatParameterAt(SourceSlot)); break;
+		case EAblContextParamType::String: SetStringParameterAt(SlotIndex, Source.GetStringParameterAt(SourceSlot)); break;
+		case EAblContextParamType::UObject: SetUObjectParameterAt(SlotIndex, Source.GetUObjectParameterAt(SourceSlot)); break;
+		case EAblContextParamType::Vector: SetVectorParameterAt(SlotIndex, Source.GetVectorParameterAt(SourceSlot)); break;
+		default: checkNoEntry(); break;
+	}
 }
 
 void FAblAbilityContextParams::SetIntParameter(FName Id, int Value)
 {
-	m_IntParameters.Add(Id, Value);
+	SetIntParameterAt(FindOrAddSlot(Id, EAblContextParamType::Int), Value);
 }
 
 void FAblAbilityContextParams::SetFloatParameter(FName Id, float Value)
 {
-	m_FloatParameters.Add(Id, Value);
+	SetFloatParameterAt(FindOrAddSlot(Id, EAblContextParamType::Float), Value);
 }
 
 void FAblAbilityContextParams::SetStringParameter(FName Id, const FString& Value)
 {
-	m_StringParameters.Add(Id, Value);
+	SetStringParameterAt(FindOrAddSlot(Id, EAblContextParamType::String), Value);
 }
 
 void FAblAbilityContextParams::SetUObjectParameter(FName Id, UObject* Value)
 {
-	m_UObjectParameters.Add(Id, Value);
+	SetUObjectParameterAt(FindOrAddSlot(Id, EAblContextParamType::UObject), Value);
 }
 
 void FAblAbilityContextParams::SetVectorParameter(FName Id, FVector Value)
 {
-	m_VectorParameters.Add(Id, Value);
+	SetVectorParameterAt(FindOrAddSlot(Id, EAblContextParamType::Vector), Value);
 }
 
 int FAblAbilityContextParams::GetIntParameter(FName Id) const
 {
-	if (const int* var = m_IntParameters.Find(Id))
-	{
-		return *var;
-	}
-	return 0;
+	const int32 Slot = FindSlot(Id, EAblContextParamType::Int);
+	return Slot != INDEX_NONE ? GetIntParameterAt(Slot) : 0;
 }
 
 float FAblAbilityContextParams::GetFloatParameter(FName Id) const
 {
-	if (const float* var = m_FloatParameters.Find(Id))
-	{
-		return *var;
-	}
-	return 0.0f;
+	const int32 Slot = FindSlot(Id, EAblContextParamType::Float);
+	return Slot != INDEX_NONE ? GetFloatParameterAt(Slot) : 0.0f;
 }
 
 UObject* FAblAbilityContextParams::GetUObjectParameter(FName Id) const
 {
-	if (m_UObjectParameters.Contains(Id)) // Find is being weird with double ptr.
-	{
-		return m_UObjectParameters[Id];
-	}
-	return nullptr;
+	const int32 Slot = FindSlot(Id, EAblContextParamType::UObject);
+	return Slot != INDEX_NONE ? GetUObjectParameterAt(Slot) : nullptr;
 }
 
 FVector FAblAbilityContextParams::GetVectorParameter(FName Id) const
 {
-	if (const FVector* var = m_VectorParameters.Find(Id))
-	{
-		return *var;
-	}
-	return FVector::ZeroVector;
+	const int32 Slot = FindSlot(Id, EAblContextParamType::Vector);
+	return Slot != INDEX_NONE ? GetVectorParameterAt(Slot) : FVector::ZeroVector;
 }
 
 const FString& FAblAbilityContextParams::GetStringParameter(FName Id) const
 {
-	if (const FString* var = m_StringParameters.Find(Id))
+	const int32 Slot = FindSlot(Id, EAblContextParamType::String);
+	return GetStringParameterAt(Slot);
+}
+
+void FAblAbilityContextParams::SetIntParameterAt(int32 Slot, int Value)
+{
+	check(m_Slots[Slot].Type == EAblContextParamType::Int);
+	WriteValue(Slot, Value);
+}
+
+void FAblAbilityContextParams::SetFloatParameterAt(int32 Slot, float Value)
+{
+	check(m_Slots[Slot].Type == EAblContextParamType::Float);
+	WriteValue(Slot, Value);
+}
+
+void FAblAbilityContextParams::SetStringParameterAt(int32 Slot, const FString& Value)
+{
+	check(m_Slots[Slot].Type == EAblContextParamType::String);
+	m_StringValues[m_Slots[Slot].Offset] = Value;
+	m_Slots[Slot].IsSet = true;
+}
+
+void FAblAbilityContextParams::SetUObjectParameterAt(int32 Slot, UObject* Value)
+{
+	check(m_Slots[Slot].Type == EAblContextParamType::UObject);
+	m_UObjectValues[m_Slots[Slot].Offset] = Value;
+	m_Slots[Slot].IsSet = true;
+}
+
+void FAblAbilityContextParams::SetVectorParameterAt(int32 Slot, const FVector& Value)
+{
+	check(m_Slots[Slot].Type == EAblContextParamType::Vector);
+	WriteValue(Slot, Value);
+}
+
+int FAblAbilityContextParams::GetIntParameterAt(int32 Slot) const
+{
+	return ReadValue(Slot, 0);
+}
+
+float FAblAbilityContextParams::GetFloatParameterAt(int32 Slot) const
+{
+	return ReadValue(Slot, 0.0f);
+}
+
+const FString& FAblAbilityContextParams::GetStringParameterAt(int32 Slot) const
+{
+	if (m_Slots.IsValidIndex(Slot) && m_Slots[Slot].IsSet)
 	{
-		return *var;
+		return m_StringValues[m_Slots[Slot].Offset];
 	}
 	static FString EmptyString;
 	return EmptyString;
 }
 
+UObject* FAblAbilityContextParams::GetUObjectParameterAt(int32 Slot) const
+{
+	return m_Slots.IsValidIndex(Slot) && m_Slots[Slot].IsSet ? m_UObjectValues[m_Slots[Slot].Offset] : nullptr;
+}
+
+FVector FAblAbilityContextParams::GetVectorParameterAt(int32 Slot) const
+{
+	return ReadValue(Slot, FVector::ZeroVector);
+}
+
 //--------------------------------------------------------------------------------------------------------------------------------------------
 UAblAbilityContext::UAblAbilityContext(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer),
@@ -156,15 +350,28 @@ UAblAbilityContext::UAblAbilityContext(const FObjectInitializer& ObjectInitializ
 	m_CurrentTime(0.0f),
 	m_LastDelta(0.0f),
 	m_AbilityScratchPad(nullptr),
+	m_ScratchPadArena(nullptr),
+	m_ScratchPadArenaSize(0),
+	m_ScratchPadArenaAlignment(0),
 	m_TargetLocation(FVector::ZeroVector),
 	m_PredictionKey(0)
 {
+	for (int32& CurrentTaskIndex : m_CurrentTaskIndices)
+	{
+		CurrentTaskIndex = INDEX_NONE;
+	}
 
 }
 
 UAblAbilityContext::~UAblAbilityContext()
 {
+	DestroyScratchPadStructs();
 
+	if (m_ScratchPadArena)
+	{
+		FMemory::Free(m_ScratchPadArena);
+		m_ScratchPadArena = nullptr;
+	}
 }
 
 UAblAbilityContext* UAblAbilityContext::MakeContext(const UAblAbility* Ability, UAblAbilityComponent* AbilityComponent, AActor* Owner, AActor* Instigator)
@@ -204,6 +411,7 @@ UAblAbilityContext* UAblAbilityContext::MakeContext(const UAblAbility* Ability,
 
 	NewContext->m_Ability = Ability;
 	NewContext->m_AbilityComponent = AbilityComponent;
+	NewContext->m_Parameters.SetSchema(Ability->GetContextParamSchema());
 
 	if (Owner)
 	{
@@ -256,18 +464,56 @@ void UAblAbilityContext::AllocateScratchPads()
 		}
 	}
 	
-	const TArray<UAblAbilityTask*>& Tasks = m_Ability->GetTasks();
+	// Make sure our Task slots have been assigned.
+	m_Ability->PreExecutionInit();
+	const TSharedPtr<const FAblAbilityTaskPlan>& TaskPlan = m_Ability->GetTaskPlan();
+	if (!TaskPlan.IsValid())
+	{
+		return;
+	}
+
+	// Any previous structs should have been released, but don't leak them if they weren't.
+	DestroyScratchPadStructs();
 
-	for (UAblAbilityTask* Task : Tasks)
+	m_TaskScratchPads.Reset();
+	m_TaskScratchPads.AddZeroed(TaskPlan->Num());
+
+	for (int32 TaskIndex = 0; TaskIndex < TaskPlan->Num(); ++TaskIndex)
 	{
-		if (!Task)
+		const UAblAbilityTask* Task = TaskPlan->GetTask(TaskIndex);
+		if (!TaskPlan->GetScratchPadStruct(TaskIndex))
 		{
-			continue;
+			m_TaskScratchPads[TaskIndex] = Task->CreateScratchPad(TWeakObjectPtr<UAblAbilityContext>(this));
+		}
+	}
+
+	// Slots are looked up through the plan we allocated with, the Ability may rebuild its own plan while we're still running.
+	m_ScratchPadPlan = TaskPlan;
+
+	const int32 ArenaSize = TaskPlan->GetScratchPadArenaSize();
+	if (!ArenaSize)
+	{
+		return;
+	}
+
+	const int32 ArenaAlignment = FMath::Max(TaskPlan->GetScratchPadArenaAlignment(), 16);
+	if (ArenaSize > m_ScratchPadArenaSize || ArenaAlignment > m_ScratchPadArenaAlignment)
+	{
+		if (m_ScratchPadArena)
+		{
+			FMemory::Free(m_ScratchPadArena);
 		}
 
-		if (UAblAbilityTaskScratchPad* ScratchPad = Task->CreateScratchPad(TWeakObjectPtr<UAblAbilityContext>(this)))
+		m_ScratchPadArena = (uint8*)FMemory::Malloc(ArenaSize, ArenaAlignment);
+		m_ScratchPadArenaSize = ArenaSize;
+		m_ScratchPadArenaAlignment = ArenaAlignment;
+	}
+
+	for (int32 TaskIndex = 0; TaskIndex < TaskPlan->Num(); ++TaskIndex)
+	{
+		if (const UScriptStruct* ScratchPadStruct = TaskPlan->GetScratchPadStruct(TaskIndex))
 		{
-			m_TaskScratchPadMap.Add(Task->GetUniqueID(), ScratchPad);
+			ScratchPadStruct->InitializeStruct(m_ScratchPadArena + TaskPlan->GetScratchPadOffset(TaskIndex));
 		}
 	}
 }
@@ -282,14 +528,36 @@ void UAblAbilityContext::ReleaseScratchPads()
 			m_AbilityScratchPad = nullptr;
 		}
 
-		TMap<uint32, UAblAbilityTaskScratchPad*>::TConstIterator Iter = m_TaskScratchPadMap.CreateConstIterator();
-		for (; Iter; ++Iter)
+		for (UAblAbilityTaskScratchPad* ScratchPad : m_TaskScratchPads)
 		{
-			SubSystem->ReturnTaskScratchPad(Iter->Value);
+			if (ScratchPad)
+			{
+				SubSystem->ReturnTaskScratchPad(ScratchPad);
+			}
 		}
 
-		m_TaskScratchPadMap.Empty();
+		m_TaskScratchPads.Reset();
 	}
+
+	DestroyScratchPadStructs();
+}
+
+void UAblAbilityContext::DestroyScratchPadStructs()
+{
+	if (!m_ScratchPadPlan.IsValid())
+	{
+		return;
+	}
+
+	for (int32 TaskIndex = 0; TaskIndex < m_ScratchPadPlan->Num(); ++TaskIndex)
+	{
+		if (const UScriptStruct* ScratchPadStruct = m_ScratchPadPlan->GetScratchPadStruct(TaskIndex))
+		{
+			ScratchPadStruct->DestroyStruct(m_ScratchPadArena + m_ScratchPadPlan->GetScratchPadOffset(TaskIndex));
+		}
+	}
+
+	m_ScratchPadPlan.Reset();
 }
 
 void UAblAbilityContext::UpdateTime(float DeltaTime)
@@ -299,15 +567,41 @@ void UAblAbilityContext::UpdateTime(float DeltaTime)
 	m_LastDelta = DeltaTime;
 }
 
+int32 UAblAbilityContext::FindScratchPadSlot(const class UAblAbilityTask* Task) const
+{
+	if (!m_ScratchPadPlan.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	// The other lane may be moving on while we read its entry, that only ever fails the compare since a Task lives in a single lane.
+	for (const int32 CurrentTaskIndex : m_CurrentTaskIndices)
+	{
+		if (CurrentTaskIndex >= 0 && CurrentTaskIndex < m_ScratchPadPlan->Num() && m_ScratchPadPlan->GetTask(CurrentTaskIndex) == Task)
+		{
+			return CurrentTaskIndex;
+		}
+	}
+
+	return m_ScratchPadPlan->FindTaskIndex(Task);
+}
+
 UAblAbilityTaskScratchPad* UAblAbilityContext::GetScratchPadForTask(const class UAblAbilityTask* Task) const
 {
-	UAblAbilityTaskScratchPad* const * ScratchPad = m_TaskScratchPadMap.Find(Task->GetUniqueID());
-	if (ScratchPad && (*ScratchPad) != nullptr)
+	const int32 Slot = FindScratchPadSlot(Task);
+	return m_TaskScratchPads.IsValidIndex(Slot) ? m_TaskScratchPads[Slot] : nullptr;
+}
+
+void* UAblAbilityContext::GetScratchPadStructForTask(const class UAblAbilityTask* Task) const
+{
+	const int32 Slot = FindScratchPadSlot(Task);
+	if (Slot == INDEX_NONE)
 	{
-		return *ScratchPad;
+		return nullptr;
 	}
 
-	return nullptr;
+	const int32 Offset = m_ScratchPadPlan->GetScratchPadOffset(Slot);
+	return Offset != INDEX_NONE ? m_ScratchPadArena + Offset : nullptr;
 }
 
 UAblAbilityComponent* UAblAbilityContext::GetSelfAbilityComponent() const
@@ -411,6 +705,42 @@ const FString& UAblAbilityContext::GetStringParameter(FName Id) const
 	return m_Parameters.GetStringParameter(Id);
 }
 
+int32 UAblAbilityContext::FindParameterSlot(FName Id, EAblContextParamType Type) const
+{
+	ABLE_RWLOCK_SCOPE_READ(m_ContextVariablesLock);
+	return m_Parameters.FindSlot(Id, Type);
+}
+
+int UAblAbilityContext::GetIntParameterAt(int32 Slot) const
+{
+	ABLE_RWLOCK_SCOPE_READ(m_ContextVariablesLock);
+	return m_Parameters.GetIntParameterAt(Slot);
+}
+
+float UAblAbilityContext::GetFloatParameterAt(int32 Slot) const
+{
+	ABLE_RWLOCK_SCOPE_READ(m_ContextVariablesLock);
+	return m_Parameters.GetFloatParameterAt(Slot);
+}
+
+const FString& UAblAbilityContext::GetStringParameterAt(int32 Slot) const
+{
+	ABLE_RWLOCK_SCOPE_READ(m_ContextVariablesLock);
+	return m_Parameters.GetStringParameterAt(Slot);
+}
+
+UObject* UAblAbilityContext::GetUObjectParameterAt(int32 Slot) const
+{
+	ABLE_RWLOCK_SCOPE_READ(m_ContextVariablesLock);
+	return m_Parameters.GetUObjectParameterAt(Slot);
+}
+
+FVector UAblAbilityContext::GetVectorParameterAt(int32 Slot) const
+{
+	ABLE_RWLOCK_SCOPE_READ(m_ContextVariablesLock);
+	return m_Parameters.GetVectorParameterAt(Slot);
+}
+
 UAblAbilityUtilitySubsystem* UAblAbilityContext::GetUtilitySubsystem() const
 {
 	if (UWorld* CurrentWorld = GetWorld())
@@ -435,7 +765,8 @@ void UAblAbilityContext::Reset()
 	m_Owner.Reset();
 	m_Instigator.Reset();
 	m_TargetActors.Empty();
-	m_TaskScratchPadMap.Empty();
+	m_TaskScratchPads.Reset();
+	DestroyScratchPadStructs();
 	m_AbilityScratchPad = nullptr;
 	m_AsyncHandle._Handle = 0;
 	m_AsyncQueryTransform = FTransform::Identity;
@@ -542,3 +873,347 @@ bool FAblAbilityNetworkContext::IsValid() const
 {
 	return m_Ability != nullptr && m_AbilityComponent != nullptr;
 }
+
+static TAutoConsoleVariable<int32> CVarCompactNetContext(TEXT("Able.CompactNetContext"), 1, TEXT("1 to bit pack Ability Network Contexts, 0 to send every property (the old encoding). Must match on the server and its clients."));
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Network Contexts Sent"), STAT_AblNetworkContext_Sent, STATGROUP_Able);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Network Context Bits Sent"), STAT_AblNetworkContext_BitsSent, STATGROUP_Able);
+
+namespace AblNetworkContext
+{
+	/* Which optional fields follow the header. */
+	enum EFlags : uint32
+	{
+		AbilityIndexed = 1 << 0, // Ability is sent as a FAblAbilityNetIndex index rather than an object reference.
+		ComponentOnOwner = 1 << 1, // Ability Component is the Owner's, found on the receiving end instead of sent.
+		InstigatorIsOwner = 1 << 2,
+		HasTargets = 1 << 3,
+		HasStacks = 1 << 4,
+		HasTimeStamp = 1 << 5,
+		HasResult = 1 << 6,
+		HasTargetLocation = 1 << 7,
+		HasPredictionKey = 1 << 8,
+
+		NumFlagBits = 9
+	};
+
+	/* How each Target is sent. */
+	enum ETargetRef : uint32
+	{
+		TargetIsOwner = 0,
+		TargetIsInstigator,
+		TargetIsActor,
+
+		NumTargetRefs
+	};
+
+	/* Time stamps are sent in 1/100ths of a second. */
+	static const float TimeStampScale = 100.0f;
+
+	/* Running totals for Able.NetContextStats, since the last reset. */
+	static int64 NumSent = 0;
+	static int64 BitsSent = 0;
+
+	static void SerializeObject(FArchive& Ar, UPackageMap* Map, UClass* Class, UObject*& Object, bool& bOutSuccess)
+	{
+		if (Map)
+		{
+			bOutSuccess &= Map->SerializeObject(Ar, Class, Object);
+		}
+		else
+		{
+			bOutSuccess = false;
+		}
+	}
+
+	template<typename T>
+	static void SerializeWeakObject(FArchive& Ar, UPackageMap* Map, TWeakObjectPtr<T>& Object, bool& bOutSuccess)
+	{
+		UObject* Raw = const_cast<UObject*>(static_cast<const UObject*>(Object.Get()));
+		SerializeObject(Ar, Map, T::StaticClass(), Raw, bOutSuccess);
+		if (Ar.IsLoading())
+		{
+			Object = Cast<T>(Raw);
+		}
+	}
+}
+
+bool FAblAbilityNetworkContext::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	using namespace AblNetworkContext;
+
+#if ABLE_NET_SIZE_STATS
+	const bool bMeasure = Ar.IsSaving() && Ar.IsNetArchive();
+	const int64 StartBits = bMeasure ? static_cast<FBitWriter&>(Ar).GetNumBits() : 0;
+#endif
+
+	bOutSuccess = true;
+
+	if (CVarCompactNetContext.GetValueOnAnyThread() == 0)
+	{
+		// Same properties the default replication sends (m_Parameters is Transient).
+		StaticStruct()->SerializeBin(Ar, this);
+	}
+	else
+	{
+		uint32 Flags = 0;
+		int32 AbilityIndex = INDEX_NONE;
+		if (Ar.IsSaving())
+		{
+			AbilityIndex = FAblAbilityNetIndex::Get().Find(m_Ability.Get());
+			const AActor* Owner = m_Owner.Get();
+
+			Flags |= AbilityIndex != INDEX_NONE ? AbilityIndexed : 0;
+			Flags |= Owner && m_AbilityComponent.IsValid() && Owner->FindComponentByClass<UAblAbilityComponent>() == m_AbilityComponent.Get() ? ComponentOnOwner : 0;
+			Flags |= m_Instigator == m_Owner ? InstigatorIsOwner : 0;
+			Flags |= m_TargetActors.Num() > 0 ? HasTargets : 0;
+			Flags |= m_CurrentStacks != 0 ? HasStacks : 0;
+			Flags |= m_TimeStamp > 0.0f ? HasTimeStamp : 0;
+			Flags |= m_Result != EAblAbilityTaskResult::Successful ? HasResult : 0;
+			Flags |= !m_TargetLocation.IsZero() ? HasTargetLocation : 0;
+			Flags |= m_PredictionKey != 0 ? HasPredictionKey : 0;
+		}
+		else
+		{
+			Reset();
+		}
+
+		Ar.SerializeBits(&Flags, NumFlagBits);
+
+		if (Flags & AbilityIndexed)
+		{
+			uint32 PackedIndex = (uint32)AbilityIndex;
+			Ar.SerializeIntPacked(PackedIndex);
+			if (Ar.IsLoading())
+			{
+				m_Ability = FAblAbilityNetIndex::Get().Resolve((int32)PackedIndex);
+				if (!m_Ability.IsValid())
+				{
+					// Known but not loaded yet is logged (and loaded) by Resolve.
+					UE_CLOG(PackedIndex >= (uint32)FAblAbilityNetIndex::Get().Num(), LogAble, Warning, TEXT("FAblAbilityNetworkContext::NetSerialize unknown Ability index %u, is the Ability manifest the same on both ends?"), PackedIndex);
+					bOutSuccess = false;
+				}
+			}
+		}
+		else
+		{
+			SerializeWeakObject(Ar, Map, m_Ability, bOutSuccess);
+		}
+
+		SerializeWeakObject(Ar, Map, m_Owner, bOutSuccess);
+
+		if (Flags & ComponentOnOwner)
+		{
+			if (Ar.IsLoading() && m_Owner.IsValid())
+			{
+				m_AbilityComponent = m_Owner->FindComponentByClass<UAblAbilityComponent>();
+			}
+		}
+		else
+		{
+			SerializeWeakObject(Ar, Map, m_AbilityComponent, bOutSuccess);
+		}
+
+		if (Flags & InstigatorIsOwner)
+		{
+			if (Ar.IsLoading())
+			{
+				m_Instigator = m_Owner;
+			}
+		}
+		else
+		{
+			SerializeWeakObject(Ar, Map, m_Instigator, bOutSuccess);
+		}
+
+		if (Flags & HasTargets)
+		{
+			uint32 NumTargets = (uint32)m_TargetActors.Num();
+			Ar.SerializeIntPacked(NumTargets);
+			if (Ar.IsLoading())
+			{
+				// Bounded by what the server could possibly send, a corrupt count shouldn't allocate.
+				if (NumTargets > 1024)
+				{
+					Ar.SetError();
+					bOutSuccess = false;
+					return false;
+				}
+				m_TargetActors.SetNum(NumTargets);
+			}
+
+			for (TWeakObjectPtr<AActor>& Target : m_TargetActors)
+			{
+				uint32 Ref = TargetIsActor;
+				if (Ar.IsSaving())
+				{
+					Ref = Target == m_Owner ? TargetIsOwner : Target == m_Instigator ? TargetIsInstigator : TargetIsActor;
+				}
+
+				Ar.SerializeInt(Ref, NumTargetRefs);
+
+				switch (Ref)
+				{
+					case TargetIsOwner: Target = m_Owner; break;
+					case TargetIsInstigator: Target = m_Instigator; break;
+					default: SerializeWeakObject(Ar, Map, Target, bOutSuccess); break;
+				}
+			}
+		}
+
+		if (Flags & HasStacks)
+		{
+			Ar << m_CurrentStacks;
+		}
+
+		if (Flags & HasTimeStamp)
+		{
+			uint32 PackedTimeStamp = (uint32)FMath::RoundToInt(m_TimeStamp * TimeStampScale);
+			Ar.SerializeIntPacked(PackedTimeStamp);
+			m_TimeStamp = PackedTimeStamp / TimeStampScale;
+		}
+
+		if (Flags & HasResult)
+		{
+			uint32 Result = (uint32)m_Result.GetValue();
+			Ar.SerializeInt(Result, EAblAbilityTaskResult::Decayed + 1);
+			m_Result = (EAblAbilityTaskResult)Result;
+		}
+
+		if (Flags & HasTargetLocation)
+		{
+			FVector_NetQuantize10 TargetLocation(m_TargetLocation);
+			TargetLocation.NetSerialize(Ar, Map, bOutSuccess);
+			m_TargetLocation = TargetLocation;
+		}
+
+		if (Flags & HasPredictionKey)
+		{
+			uint32 PredictionKey = m_PredictionKey;
+			Ar.SerializeIntPacked(PredictionKey);
+			m_PredictionKey = (uint16)PredictionKey;
+		}
+	}
+
+#if ABLE_NET_SIZE_STATS
+	if (bMeasure)
+	{
+		const int64 Bits = static_cast<FBitWriter&>(Ar).GetNumBits() - StartBits;
+		INC_DWORD_STAT(STAT_AblNetworkContext_Sent);
+		INC_DWORD_STAT_BY(STAT_AblNetworkContext_BitsSent, (uint32)Bits);
+		++NumSent;
+		BitsSent += Bits;
+	}
+#endif
+
+	return !Ar.IsError();
+}
+
+static void NetContextStats(const TArray<FString>& Args)
+{
+	using namespace AblNetworkContext;
+
+#if !ABLE_NET_SIZE_STATS
+	UE_LOG(LogAble, Display, TEXT("Able.NetContextStats: Sizes are only measured when built with ABLE_NET_SIZE_STATS=1."));
+#endif
+
+	const double AverageBytes = NumSent > 0 ? (BitsSent / 8.0) / NumSent : 0.0;
+	UE_LOG(LogAble, Display, TEXT("Able.NetContextStats: %lld Network Contexts sent, %.2f bytes each on average (Able.CompactNetContext %d)."),
+		NumSent, AverageBytes, CVarCompactNetContext.GetValueOnAnyThread());
+
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		NumSent = 0;
+		BitsSent = 0;
+	}
+}
+
+static FAutoConsoleCommand NetContextStatsCommand(
+	TEXT("Able.NetContextStats"),
+	TEXT("Logs how many Ability Network Contexts were sent (activations, branches, forced and replicated Abilities) and their average size. Args: [reset]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&NetContextStats));
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ability Command Batches Sent"), STAT_AblAbilityCommandBatch_Sent, STATGROUP_Able);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ability Command Batch Bits Sent"), STAT_AblAbilityCommandBatch_BitsSent, STATGROUP_Able);
+
+FAblAbilityCommand FAblAbilityCommand::MakeActivate(const FAblAbilityNetworkContext& Context)
+{
+	FAblAbilityCommand Command;
+	Command.m_Type = EAblAbilityCommandType::Activate;
+	Command.m_Context = Context;
+	return Command;
+}
+
+FAblAbilityCommand FAblAbilityCommand::MakeBranch(const FAblAbilityNetworkContext& Context)
+{
+	FAblAbilityCommand Command;
+	Command.m_Type = EAblAbilityCommandType::Branch;
+	Command.m_Context = Context;
+	return Command;
+}
+
+FAblAbilityCommand FAblAbilityCommand::MakeCancel(uint32 AbilityNameHash, EAblAbilityTaskResult ResultToUse)
+{
+	FAblAbilityCommand Command;
+	Command.m_Type = EAblAbilityCommandType::Cancel;
+	Command.m_AbilityNameHash = AbilityNameHash;
+	Command.m_Result = ResultToUse;
+	return Command;
+}
+
+bool FAblAbilityCommand::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	uint32 Type = (uint32)m_Type;
+	Ar.SerializeInt(Type, (uint32)EAblAbilityCommandType::Count);
+	m_Type = (EAblAbilityCommandType)Type;
+
+	if (m_Type == EAblAbilityCommandType::Cancel)
+	{
+		Ar << m_AbilityNameHash;
+
+		uint32 Result = (uint32)m_Result.GetValue();
+		Ar.SerializeInt(Result, EAblAbilityTaskResult::Decayed + 1);
+		m_Result = (EAblAbilityTaskResult)Result;
+	}
+	else
+	{
+		m_Context.NetSerialize(Ar, Map, bOutSuccess);
+	}
+
+	return !Ar.IsError();
+}
+
+bool FAblAbilityCommandBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+#if ABLE_NET_SIZE_STATS
+	const bool bMeasure = Ar.IsSaving() && Ar.IsNetArchive();
+	const int64 StartBits = bMeasure ? static_cast<FBitWriter&>(Ar).GetNumBits() : 0;
+#endif
+
+	bOutSuccess = true;
+
+	uint32 NumCommands = (uint32)FMath::Min(m_Commands.Num(), MaxCommands);
+	Ar.SerializeInt(NumCommands, MaxCommands + 1);
+
+	if (Ar.IsLoading())
+	{
+		m_Commands.SetNum(NumCommands);
+	}
+
+	for (uint32 i = 0; i < NumCommands && bOutSuccess && !Ar.IsError(); ++i)
+	{
+		m_Commands[i].NetSerialize(Ar, Map, bOutSuccess);
+	}
+
+#if ABLE_NET_SIZE_STATS
+	if (bMeasure)
+	{
+		INC_DWORD_STAT(STAT_AblAbilityCommandBatch_Sent);
+		INC_DWORD_STAT_BY(STAT_AblAbilityCommandBatch_BitsSent, (uint32)(static_cast<FBitWriter&>(Ar).GetNumBits() - StartBits));
+	}
+#endif
+
+	return !Ar.IsError();
+}
@@ -0,0 +1,317 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#include "ablAbilityDependencies.h"
+
+#include "ablAbility.h"
+#include "AbleCorePrivate.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Tasks/IAblAbilityTask.h"
+#include "UObject/Package.h"
+#include "UObject/PropertyIterator.h"
+#include "UObject/UnrealType.h"
+
+namespace AblAbilityDependencies
+{
+	static const int32 ManifestVersion = 1;
+
+	struct FGatherer
+	{
+		const UPackage* AbilityPackage = nullptr;
+		TSet<const UObject*> Visited;
+		TSet<FSoftObjectPath> Gameplay;
+		TSet<FSoftObjectPath> Cosmetic;
+
+		void AddAsset(const FSoftObjectPath& Path, bool Cosmetic)
+		{
+			if (Path.IsNull() || Path.GetLongPackageName().StartsWith(TEXT("/Script/")))
+			{
+				return;
+			}
+
+			(Cosmetic ? this->Cosmetic : Gameplay).Add(Path);
+		}
+
+		void Walk(const UObject* Object, bool Cosmetic)
+		{
+			if (!Object || Visited.Contains(Object))
+			{
+				return;
+			}
+			Visited.Add(Object);
+
+			for (TPropertyValueIterator<FProperty> It(Object->GetClass(), Object); It; ++It)
+			{
+				const FProperty* Property = It.Key();
+				if (Property->HasAnyPropertyFlags(CPF_Transient))
+				{
+					It.SkipRecursiveProperty();
+					continue;
+				}
+
+				if (const FSoftObjectProperty* SoftProperty = CastField<FSoftObjectProperty>(Property))
+				{
+					AddAsset(SoftProperty->GetPropertyValue(It.Value()).ToSoftObjectPath(), Cosmetic);
+				}
+				else if (const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property))
+				{
+					AddObject(ObjectProperty->GetObjectPropertyValue(It.Value()), Cosmetic);
+				}
+			}
+		}
+
+		void AddObject(const UObject* Object, bool Cosmetic)
+		{
+			if (!Object)
+			{
+				return;
+			}
+
+			const UPackage* Package = Object->GetOutermost();
+			if (Package == AbilityPackage)
+			{
+				// Instanced sub object of the Ability (Task, Targeting, Collision query...), walk it with the same realm.
+				Walk(Object, Cosmetic);
+				return;
+			}
+
+			if (Package == GetTransientPackage() || Package->HasAnyPackageFlags(PKG_CompiledIn))
+			{
+				return;
+			}
+
+			// Reference the top level asset, not a sub object inside it.
+			while (Object->GetOuter() && !Object->GetOuter()->IsA<UPackage>())
+			{
+				Object = Object->GetOuter();
+			}
+			AddAsset(FSoftObjectPath(Object), Cosmetic);
+		}
+	};
+
+	static TArray<TSharedPtr<FJsonValue>> ToJson(const TArray<FSoftObjectPath>& Paths)
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+		for (const FSoftObjectPath& Path : Paths)
+		{
+			Values.Add(MakeShared<FJsonValueString>(Path.ToString()));
+		}
+		return Values;
+	}
+
+	static void FromJson(const TSharedPtr<FJsonObject>& Object, const TCHAR* Field, TArray<FSoftObjectPath>& OutPaths)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+		if (Object->TryGetArrayField(Field, Values))
+		{
+			for (const TSharedPtr<FJsonValue>& Value : *Values)
+			{
+				OutPaths.Add(FSoftObjectPath(Value->AsString()));
+			}
+		}
+	}
+
+	static void Sort(TArray<FSoftObjectPath>& Paths)
+	{
+		Paths.Sort([](const FSoftObjectPath& A, const FSoftObjectPath& B) { return A.ToString() < B.ToString(); });
+	}
+}
+
+void FAblAbilityDependencies::Gather(const UAblAbility& Ability, FAblAbilityDependencies& OutDependencies)
+{
+	AblAbilityDependencies::FGatherer Gatherer;
+	Gatherer.AbilityPackage = Ability.GetOutermost();
+
+	// Tasks first, so a Task referenced from elsewhere in the Ability keeps its own realm.
+	for (const UAblAbilityTask* Task : Ability.GetTasks())
+	{
+		if (Task)
+		{
+			Gatherer.Walk(Task, Task->GetTaskRealm() == EAblAbilityTaskRealm::ATR_Client);
+		}
+	}
+	Gatherer.Walk(&Ability, false);
+
+	OutDependencies.m_Gameplay = Gatherer.Gameplay.Array();
+	OutDependencies.m_Cosmetic = Gatherer.Cosmetic.Difference(Gatherer.Gameplay).Array();
+	AblAbilityDependencies::Sort(OutDependencies.m_Gameplay);
+	AblAbilityDependencies::Sort(OutDependencies.m_Cosmetic);
+}
+
+void FAblAbilityDependencies::GetLoadList(const FSoftObjectPath& AbilityClass, bool IncludeCosmetic, TArray<FSoftObjectPath>& OutPaths) const
+{
+	OutPaths.Reserve(OutPaths.Num() + 1 + m_Gameplay.Num() + (IncludeCosmetic ? m_Cosmetic.Num() : 0));
+	OutPaths.Add(AbilityClass);
+	OutPaths.Append(m_Gameplay);
+	if (IncludeCosmetic)
+	{
+		OutPaths.Append(m_Cosmetic);
+	}
+}
+
+void FAblAbilityManifest::Add(const FSoftObjectPath& AbilityClass, FAblAbilityDependencies&& Dependencies)
+{
+	m_Abilities.Add(AbilityClass, MoveTemp(Dependencies));
+}
+
+void FAblAbilityManifest::GetAbilityClasses(TArray<FSoftObjectPath>& OutAbilityClasses) const
+{
+	m_Abilities.GetKeys(OutAbilityClasses);
+	AblAbilityDependencies::Sort(OutAbilityClasses);
+}
+
+bool FAblAbilityManifest::SaveToFile(const FString& FilePath) const
+{
+	TArray<FSoftObjectPath> AbilityClasses;
+	GetAbilityClasses(AbilityClasses);
+
+	TSharedRef<FJsonObject> Abilities = MakeShared<FJsonObject>();
+	for (const FSoftObjectPath& AbilityClass : AbilityClasses)
+	{
+		const FAblAbilityDependencies& Dependencies = m_Abilities.FindChecked(AbilityClass);
+		TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+		Entry->SetArrayField(TEXT("Gameplay"), AblAbilityDependencies::ToJson(Dependencies.m_Gameplay));
+		Entry->SetArrayField(TEXT("Cosmetic"), AblAbilityDependencies::ToJson(Dependencies.m_Cosmetic));
+		Abilities->SetObjectField(AbilityClass.ToString(), Entry);
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("Version"), AblAbilityDependencies::ManifestVersion);
+	Root->SetObjectField(TEXT("Abilities"), Abilities);
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	if (!FJsonSerializer::Serialize(Root, Writer))
+	{
+		return false;
+	}
+	return FFileHelper::SaveStringToFile(Output, *FilePath);
+}
+
+bool FAblAbilityManifest::LoadFromFile(const FString& FilePath)
+{
+	m_Abilities.Reset();
+
+	FString Input;
+	if (!FFileHelper::LoadFileToString(Input, *FilePath))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Input);
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid())
+	{
+		UE_LOG(LogAble, Warning, TEXT("Ability manifest %s is not valid JSON."), *FilePath);
+		return false;
+	}
+
+	int32 Version = 0;
+	if (!Root->TryGetNumberField(TEXT("Version"), Version) || Version != AblAbilityDependencies::ManifestVersion)
+	{
+		UE_LOG(LogAble, Warning, TEXT("Ability manifest %s is version %d, expected %d. Re-run the AblAbilityManifest commandlet."), *FilePath, Version, AblAbilityDependencies::ManifestVersion);
+		return false;
+	}
+
+	const TSharedPtr<FJsonObject>* Abilities = nullptr;
+	if (Root->TryGetObjectField(TEXT("Abilities"), Abilities))
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& It : (*Abilities)->Values)
+		{
+			const TSharedPtr<FJsonObject> Entry = It.Value->AsObject();
+			if (!Entry.IsValid())
+			{
+				continue;
+			}
+
+			FAblAbilityDependencies& Dependencies = m_Abilities.Add(FSoftObjectPath(It.Key));
+			AblAbilityDependencies::FromJson(Entry, TEXT("Gameplay"), Dependencies.m_Gameplay);
+			AblAbilityDependencies::FromJson(Entry, TEXT("Cosmetic"), Dependencies.m_Cosmetic);
+		}
+	}
+
+	return true;
+}
+
+FAblAbilityNetIndex& FAblAbilityNetIndex::Get()
+{
+	static FAblAbilityNetIndex Instance;
+	return Instance;
+}
+
+void FAblAbilityNetIndex::Build(const FAblAbilityManifest& Manifest)
+{
+	Manifest.GetAbilityClasses(m_AbilityClasses);
+
+	m_Indices.Empty(m_AbilityClasses.Num());
+	for (int32 Index = 0; Index < m_AbilityClasses.Num(); ++Index)
+	{
+		m_Indices.Add(m_AbilityClasses[Index], Index);
+	}
+
+	m_ClassIndices.Empty(m_AbilityClasses.Num());
+	m_ResolvedClasses.Reset();
+	m_ResolvedClasses.SetNum(m_AbilityClasses.Num());
+	m_LoadsRequested.Init(false, m_AbilityClasses.Num());
+
+	UE_LOG(LogAble, Log, TEXT("FAblAbilityNetIndex built with %d Abilities."), m_AbilityClasses.Num());
+}
+
+int32 FAblAbilityNetIndex::Find(const UAblAbility* Ability) const
+{
+	// Only class default objects are shared between server and client.
+	if (!Ability || m_Indices.Num() == 0 || !Ability->HasAnyFlags(RF_ClassDefaultObject))
+	{
+		return INDEX_NONE;
+	}
+
+	const UClass* AbilityClass = Ability->GetClass();
+	if (const FClassIndex* Cached = m_ClassIndices.Find(AbilityClass))
+	{
+		if (Cached->m_Class.Get() == AbilityClass)
+		{
+			return Cached->m_Index;
+		}
+	}
+
+	// First send of this class, the only time we build its path.
+	const int32* Index = m_Indices.Find(FSoftObjectPath(AbilityClass));
+	const int32 Result = Index ? *Index : INDEX_NONE;
+	m_ClassIndices.Add(AbilityClass, FClassIndex{ AbilityClass, Result });
+	return Result;
+}
+
+const UAblAbility* FAblAbilityNetIndex::Resolve(int32 Index) const
+{
+	if (!m_AbilityClasses.IsValidIndex(Index))
+	{
+		return nullptr;
+	}
+
+	const UClass* AbilityClass = m_ResolvedClasses[Index].Get();
+	if (!AbilityClass)
+	{
+		AbilityClass = Cast<UClass>(m_AbilityClasses[Index].ResolveObject());
+		m_ResolvedClasses[Index] = AbilityClass;
+		m_LoadsRequested[Index] = m_LoadsRequested[Index] && !AbilityClass;
+	}
+
+	if (!AbilityClass)
+	{
+		// Never load from inside NetSerialize, that hitches. Start loading it so the Ability resolves once the server sends it again
+		// (the owning component revalidates its running Abilities against the server's).
+		if (!m_LoadsRequested[Index])
+		{
+			m_LoadsRequested[Index] = true;
+			LoadPackageAsync(m_AbilityClasses[Index].GetLongPackageName());
+			UE_LOG(LogAble, Log, TEXT("FAblAbilityNetIndex %s wasn't loaded when received, loading it asynchronously."), *m_AbilityClasses[Index].ToString());
+		}
+		return nullptr;
+	}
+
+	return AbilityClass->IsChildOf(UAblAbility::StaticClass()) ? AbilityClass->GetDefaultObject<UAblAbility>() : nullptr;
+}
+
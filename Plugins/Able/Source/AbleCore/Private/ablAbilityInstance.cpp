@@ -4,6 +4,8 @@
 
 #include "ablAbility.h"
 #include "ablAbilityComponent.h"
+#include "AbleCorePrivate.h"
+#include "Algo/BinarySearch.h"
 #include "Engine/EngineBaseTypes.h"
 #include "GameFramework/Actor.h"
 #include "GameFramework/Character.h"
@@ -11,30 +13,22 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Misc/ScopeLock.h"
 
-struct FAblAbilityTaskIsDonePredicate
-{
-	FAblAbilityTaskIsDonePredicate(float InCurrentTime)
-		: CurrentTime(InCurrentTime)
-	{
-
-	}
-
-	float CurrentTime;
+DECLARE_DWORD_COUNTER_STAT(TEXT("Task Start Checks"), STAT_AblAbilityInstance_TaskStartChecks, STATGROUP_Able);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tasks Started"), STAT_AblAbilityInstance_TasksStarted, STATGROUP_Able);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tasks Finished"), STAT_AblAbilityInstance_TasksFinished, STATGROUP_Able);
 
-	bool operator()(const UAblAbilityTask* A) const
-	{
-		return CurrentTime >= A->GetEndTime();
-	}
-};
+void FAblAbilityInstance::FLaneState::Init(int32 NumSlots)
+{
+	Pending.Init(false, NumSlots);
+	Active.Init(false, NumSlots);
+	Finished.Init(false, NumSlots);
+	NumPending = 0;
+	NumActive = 0;
+}
 
 FAblAbilityInstance::FAblAbilityInstance()
 : m_DecayTime(0.0f),
-m_AsyncTasks(),
-m_ActiveAsyncTasks(),
-m_FinishedAyncTasks(),
-m_SyncTasks(),
-m_ActiveSyncTasks(),
-m_FinishedSyncTasks(),
+m_TaskPlan(),
 m_Ability(nullptr),
 m_Context(nullptr),
 m_ClearTargets(false),
@@ -53,51 +47,22 @@ void FAblAbilityInstance::Initialize(UAblAbilityContext& AbilityContext)
 	m_Ability->PreExecutionInit();
 	m_Context = &AbilityContext;
 
-	ENetMode NetMode = NM_Standalone;
 	if (AbilityContext.GetSelfActor())
 	{
-		NetMode = AbilityContext.GetSelfActor()->GetNetMode();
-
         AbilityContext.SetAbilityActorStartLocation(AbilityContext.GetSelfActor()->GetActorLocation());
 	}
 
-	// Sort our Tasks into Sync/Async queues.
-	const TArray<UAblAbilityTask*> & Tasks = m_Ability->GetTasks();
-	for (UAblAbilityTask* Task : Tasks)
-	{
-        if (!Task || Task->IsDisabled(m_Context))
-        {
-            continue;
-        }
-
-		if (Task->IsValidForNetMode(NetMode))
-		{
-			if (Task->IsAsyncFriendly())
-			{
-				m_AsyncTasks.Add(Task);
-			}
-			else
-			{
-				m_SyncTasks.Add(Task);
-			}
-		}
-	}
-
-	m_FinishedAyncTasks.Reserve(m_AsyncTasks.Num());
-	m_FinishedSyncTasks.Reserve(m_SyncTasks.Num());
+	// Grab our plan and mark our Tasks as pending in their Sync/Async lanes.
+	m_TaskPlan = m_Ability->GetTaskPlan();
+	check(m_TaskPlan.IsValid());
 
-	// Populate our map of Tasks we need to keep track of due to other Tasks being dependent on them.
-	const TArray<const UAblAbilityTask*>& TaskDependencies = m_Ability->GetAllTaskDependencies();
-	for (const UAblAbilityTask* TaskDependency : TaskDependencies)
+	for (uint8 Lane = 0; Lane < (uint8)EAblTaskLane::Count; ++Lane)
 	{
-        if (TaskDependency == nullptr)
-            continue;
-
-		if (!m_TaskDependencyMap.Contains(TaskDependency))
-		{
-			m_TaskDependencyMap.Add(TaskDependency, false);
-		}
+		m_Lanes[Lane].Init(m_TaskPlan->GetLane((EAblTaskLane)Lane).Tasks.Num());
 	}
+	m_TaskDone.Init(m_TaskPlan->Num());
+
+	QueuePendingTasks();
 
 	// Set our initial stacks.
 	SetStackCount(FMath::Max(m_Ability->GetInitialStacks(m_Context), 0));
@@ -175,35 +140,32 @@ uint32 FAblAbilityInstance::GetAbilityNameHash() const
 
 bool FAblAbilityInstance::HasAsyncTasks() const
 {
-	return m_AsyncTasks.Num() > 0 || m_ActiveAsyncTasks.Num() > 0;
+	const FLaneState& AsyncLane = m_Lanes[(uint8)EAblTaskLane::Async];
+	return AsyncLane.NumPending > 0 || AsyncLane.NumActive > 0;
+}
+
+bool FAblAbilityInstance::HasSyncTasks() const
+{
+	const FLaneState& SyncLane = m_Lanes[(uint8)EAblTaskLane::Sync];
+	return SyncLane.NumPending > 0 || SyncLane.NumActive > 0;
 }
 
 void FAblAbilityInstance::ResetForNextIteration()
 {
 	// Stop any active tasks.
-	for (int32 i = 0; i < m_ActiveAsyncTasks.Num(); )
+	for (EAblTaskLane Lane : { EAblTaskLane::Async, EAblTaskLane::Sync })
 	{
-		if (m_ActiveAsyncTasks[i]->GetResetForIterations())
-		{
-			m_ActiveAsyncTasks[i]->OnTaskEnd(m_Context, EAblAbilityTaskResult::Successful);
-			m_ActiveAsyncTasks.RemoveAt(i);
-		}
-		else
+		FLaneState& LaneState = m_Lanes[(uint8)Lane];
+		const TArray<int32>& LaneTasks = m_TaskPlan->GetLane(Lane).Tasks;
+		for (TConstSetBitIterator<> ActiveIt(LaneState.Active); ActiveIt; ++ActiveIt)
 		{
-			++i;
-		}
-	}
-
-	for (int32 i = 0; i < m_ActiveSyncTasks.Num(); )
-	{
-		if (m_ActiveSyncTasks[i]->GetResetForIterations())
-		{
-			m_ActiveSyncTasks[i]->OnTaskEnd(m_Context, EAblAbilityTaskResult::Successful);
-			m_ActiveSyncTasks.RemoveAt(i);
-		}
-		else
-		{
-			++i;
+			const UAblAbilityTask* Task = m_TaskPlan->GetTask(LaneTasks[ActiveIt.GetIndex()]);
+			if (Task->GetResetForIterations())
+			{
+				Task->OnTaskEnd(m_Context, EAblAbilityTaskResult::Successful);
+				LaneState.Active[ActiveIt.GetIndex()] = false;
+				--LaneState.NumActive;
+			}
 		}
 	}
 
@@ -217,46 +179,9 @@ void FAblAbilityInstance::ResetForNextIteration()
 			// Reset our time to the start of the loop range, and we'll keep going.
 			m_Context->SetCurrentTime(LoopRange.X);
 
-			m_FinishedAyncTasks.RemoveAll([&](const UAblAbilityTask* Task)
-			{
-				return Task->GetStartTime() >= LoopRange.X && Task->GetEndTime() <= LoopRange.Y;
-			});
-
-			m_FinishedSyncTasks.RemoveAll([&](const UAblAbilityTask* Task)
-			{
-				return Task->GetStartTime() >= LoopRange.X && Task->GetEndTime() <= LoopRange.Y;
-			});
-
-			// Sort our Tasks into Sync/Async queues (again, people apparently want to dynamically turn on/off tasks).
-			m_AsyncTasks.Empty(m_AsyncTasks.Num());
-			m_SyncTasks.Empty(m_SyncTasks.Num());
-
-			const TArray<UAblAbilityTask*>& Tasks = m_Ability->GetTasks();
-			for (UAblAbilityTask* Task : Tasks)
-			{
-				if (!Task || Task->IsDisabled(m_Context))
-				{
-					continue;
-				}
-
-				ENetMode NetMode = NM_Standalone;
-				if (m_Context->GetSelfActor())
-				{
-					NetMode = m_Context->GetSelfActor()->GetNetMode();
-				}
-
-				if (Task->IsValidForNetMode(NetMode))
-				{
-					if (Task->IsAsyncFriendly() && !m_ActiveAsyncTasks.Contains(Task))
-					{
-						m_AsyncTasks.Add(Task);
-					}
-					else if (!m_ActiveSyncTasks.Contains(Task))
-					{
-						m_SyncTasks.Add(Task);
-					}
-				}
-			}
+			// Queue our Tasks into their Sync/Async lanes again (people apparently want to dynamically turn on/off tasks).
+			// Our Finished state is cleared below.
+			QueuePendingTasks();
 		}
 	}
 	else
@@ -273,9 +198,10 @@ void FAblAbilityInstance::ResetForNextIteration()
 		m_Context->GetSelfAbilityComponent()->SetPassiveStackCount(m_Context->GetAbility(), newStackValue, true, EAblAbilityTaskResult::Successful);
 	}
 
-	m_FinishedAyncTasks.Empty();
-	m_FinishedSyncTasks.Empty();
-
+	for (FLaneState& LaneState : m_Lanes)
+	{
+		LaneState.Finished.Init(false, LaneState.Finished.Num());
+	}
 }
 
 bool FAblAbilityInstance::IsIterationDone() const
@@ -284,7 +210,7 @@ bool FAblAbilityInstance::IsIterationDone() const
 	{
 		if (m_Ability->MustFinishAllTasks())
 		{
-			return m_ActiveSyncTasks.Num() == 0 && m_ActiveAsyncTasks.Num() == 0;
+			return m_Lanes[(uint8)EAblTaskLane::Sync].NumActive == 0 && m_Lanes[(uint8)EAblTaskLane::Async].NumActive == 0;
 		}
 
 		return true;
@@ -295,7 +221,7 @@ bool FAblAbilityInstance::IsIterationDone() const
 		{
 			if (m_Ability->MustFinishAllTasks())
 			{
-				return m_ActiveSyncTasks.Num() == 0 && m_ActiveAsyncTasks.Num() == 0;
+				return m_Lanes[(uint8)EAblTaskLane::Sync].NumActive == 0 && m_Lanes[(uint8)EAblTaskLane::Async].NumActive == 0;
 			}
 
 			return true;
@@ -413,7 +339,7 @@ void FAblAbilityInstance::ResetTime(bool ToLoopStart /*= false*/)
 
 void FAblAbilityInstance::AsyncUpdate(float CurrentTime, float DeltaTime)
 {
-	InternalUpdateTasks(m_AsyncTasks, m_ActiveAsyncTasks, m_FinishedAyncTasks, CurrentTime, DeltaTime);
+	InternalUpdateTasks(EAblTaskLane::Async, CurrentTime, DeltaTime);
 }
 
 void FAblAbilityInstance::SyncUpdate(float DeltaTime)
@@ -421,7 +347,7 @@ void FAblAbilityInstance::SyncUpdate(float DeltaTime)
 	const float CurrentTime = m_Context->GetCurrentTime();
 	const float AdjustedTime = CurrentTime + DeltaTime;
 
-	InternalUpdateTasks(m_SyncTasks, m_ActiveSyncTasks, m_FinishedSyncTasks, CurrentTime, DeltaTime);
+	InternalUpdateTasks(EAblTaskLane::Sync, CurrentTime, DeltaTime);
 
 	m_Context->UpdateTime(DeltaTime);
 
@@ -613,71 +539,61 @@ void FAblAbilityInstance::SetCurrentTime(float NewTime)
 {
 	m_Context->SetCurrentTime(NewTime);
 
-	TArray<UAblAbilityTask*> NewTasks;
-	TArray<UAblAbilityTask*> CurrentTasks;
+	TArray<int32, TInlineAllocator<16>> NewTasks;
+	TBitArray<> CurrentTasks(false, m_TaskPlan->Num());
+	bool HasCurrentTasks = false;
 
-	const TArray<UAblAbilityTask*> & Tasks = m_Ability->GetTasks();
-	for (UAblAbilityTask* Task : Tasks)
+	for (int32 TaskIndex = 0; TaskIndex < m_TaskPlan->Num(); ++TaskIndex)
 	{
-		if (Task && Task->CanStart(m_Context, NewTime, 0.0f ) && !Task->IsDisabled(m_Context))
+		const UAblAbilityTask* Task = m_TaskPlan->GetTask(TaskIndex);
+		if (Task->CanStart(m_Context, NewTime, 0.0f) && !Task->IsDisabled(m_Context))
 		{
-			if (Task->IsAsyncFriendly() ? m_ActiveAsyncTasks.Contains(Task) : m_ActiveSyncTasks.Contains(Task))
+			if (m_Lanes[(uint8)m_TaskPlan->GetTaskLane(TaskIndex)].Active[m_TaskPlan->GetLaneSlot(TaskIndex)])
 			{
-				CurrentTasks.Add(Task);
+				CurrentTasks[TaskIndex] = true;
+				HasCurrentTasks = true;
 			}
 			else
 			{
-				NewTasks.Add(Task);
+				NewTasks.Add(TaskIndex);
 			}
 		}
 	}
 
 	// Now go through and Terminate any tasks that should no longer be running.
-	for (int i = 0; i < m_ActiveSyncTasks.Num();)
+	for (EAblTaskLane Lane : { EAblTaskLane::Sync, EAblTaskLane::Async })
 	{
-		if (!CurrentTasks.Contains(m_ActiveSyncTasks[i]))
+		FLaneState& LaneState = m_Lanes[(uint8)Lane];
+		const TArray<int32>& LaneTasks = m_TaskPlan->GetLane(Lane).Tasks;
+		for (TConstSetBitIterator<> ActiveIt(LaneState.Active); ActiveIt; ++ActiveIt)
 		{
-			m_ActiveSyncTasks[i]->OnTaskEnd(m_Context, Successful);
-			m_ActiveSyncTasks.RemoveAt(i);
-		}
-		else
-		{
-			++i;
-		}
-	}
-
-	for (int i = 0; i < m_ActiveAsyncTasks.Num();)
-	{
-		if (!CurrentTasks.Contains(m_ActiveAsyncTasks[i]))
-		{
-			m_ActiveAsyncTasks[i]->OnTaskEnd(m_Context, Successful);
-			m_ActiveAsyncTasks.RemoveAt(i);
-		}
-		else
-		{
-			++i;
+			const int32 TaskIndex = LaneTasks[ActiveIt.GetIndex()];
+			if (!CurrentTasks[TaskIndex])
+			{
+				m_TaskPlan->GetTask(TaskIndex)->OnTaskEnd(m_Context, Successful);
+				LaneState.Active[ActiveIt.GetIndex()] = false;
+				--LaneState.NumActive;
+			}
 		}
 	}
 
 	// Start our New Tasks.
-	for (UAblAbilityTask* Task : NewTasks)
+	for (int32 TaskIndex : NewTasks)
 	{
-		Task->OnTaskStart(m_Context);
+		m_TaskPlan->GetTask(TaskIndex)->OnTaskStart(m_Context);
 
-		if (Task->IsAsyncFriendly())
-		{
-			m_ActiveAsyncTasks.Add(Task);
-		}
-		else
-		{
-			m_ActiveSyncTasks.Add(Task);
-		}
+		FLaneState& LaneState = m_Lanes[(uint8)m_TaskPlan->GetTaskLane(TaskIndex)];
+		LaneState.Active[m_TaskPlan->GetLaneSlot(TaskIndex)] = true;
+		++LaneState.NumActive;
 	}
 
 	// Tell our Current Tasks to go ahead and do any logic they need to if the time was modified out from under them.
-	for (UAblAbilityTask* Task : CurrentTasks)
+	if (HasCurrentTasks)
 	{
-		Task->OnAbilityTimeSet(m_Context);
+		for (TConstSetBitIterator<> CurrentIt(CurrentTasks); CurrentIt; ++CurrentIt)
+		{
+			m_TaskPlan->GetTask(CurrentIt.GetIndex())->OnAbilityTimeSet(m_Context);
+		}
 	}
 }
 
@@ -691,136 +607,110 @@ void FAblAbilityInstance::Reset()
 	// Defaulting to false on the shrink for the arrays. These array entry values are so small, that having them constantly go in/out of allocation could be pretty gross for fragmentation.
 	// Just keep the memory for now, and if it becomes an issue (not sure why it would), then just remove the false and let the memory get released.
 	m_DecayTime = 0.0f;
-	m_AsyncTasks.Empty(false);
-	m_ActiveAsyncTasks.Empty(false);
-	m_FinishedAyncTasks.Empty(false);
-	m_SyncTasks.Empty(false);
-	m_ActiveSyncTasks.Empty(false);
-	m_FinishedSyncTasks.Empty(false);
+	m_TaskPlan.Reset();
+	for (FLaneState& LaneState : m_Lanes)
+	{
+		LaneState.Init(0);
+	}
+	m_TaskDone.Init(0);
 	m_Ability = nullptr;
 	m_Context = nullptr;
 	m_ClearTargets = false;
 	m_AdditionalTargets.Empty(false);
-	m_TaskDependencyMap.Empty(false);
 	m_RequestedInstigator.Reset();
 	m_RequestedOwner.Reset();
 	m_RequestedTargetLocation = FVector::ZeroVector;
 }
 
-void FAblAbilityInstance::InternalUpdateTasks(TArray<const UAblAbilityTask*>& InTasks, TArray<const UAblAbilityTask*>& InActiveTasks, TArray<const UAblAbilityTask*>& InFinishedTasks, float CurrentTime, float DeltaTime)
+void FAblAbilityInstance::InternalUpdateTasks(EAblTaskLane Lane, float CurrentTime, float DeltaTime)
 {
 	const float AdjustedTime = CurrentTime + DeltaTime;
 	const bool IsLooping = m_Ability->IsLooping() || m_Ability->GetDecrementAndRestartOnEnd();
 	const FVector2D LoopTimeRange = m_Ability->GetLoopRange();
 
+	FLaneState& LaneState = m_Lanes[(uint8)Lane];
+	const FAblAbilityTaskPlan::FLane& PlanLane = m_TaskPlan->GetLane(Lane);
+
 	// Just for readability...
 	bool IsStarting = false;
 
-	// if we need to clean up any active tasks.
-	bool NeedArrayCleanUp = false;
-
-	TArray<const UAblAbilityTask*> NewlyStartedTasks;
-	TArray<const UAblAbilityTask*> FinishedDependentTasks;
+	TArray<int32, TInlineAllocator<8>> NewlyStartedSlots;
+	TArray<int32, TInlineAllocator<8>> StartedSlots;
 
-	// First go through our Tasks and see if they need to be started.
-	for (int i = 0; i < InTasks.Num(); )
+	// First go through our pending Tasks and see if they need to be started. Our lane is sorted by time, so only Tasks with a Start Time we've reached need to be checked.
+	const int32 NumReachedSlots = LaneState.NumPending ? Algo::UpperBound(PlanLane.StartTimes, AdjustedTime) : 0;
+	for (TConstSetBitIterator<> PendingIt(LaneState.Pending); PendingIt && PendingIt.GetIndex() < NumReachedSlots; ++PendingIt)
 	{
-		const UAblAbilityTask* Task = InTasks[i];
+		const int32 Slot = PendingIt.GetIndex();
+		const int32 TaskIndex = PlanLane.Tasks[Slot];
+		const UAblAbilityTask* Task = m_TaskPlan->GetTask(TaskIndex);
 
-		IsStarting = Task->CanStart(m_Context, CurrentTime, DeltaTime) && !Task->IsDisabled(m_Context);
+		INC_DWORD_STAT(STAT_AblAbilityInstance_TaskStartChecks);
 
-		if (IsLooping)
+		if (LaneState.Active[Slot] || (IsLooping && LaneState.Finished[Slot]))
 		{
-			// If we're looping (And thus not cleaning up tasks as we complete them), make sure we haven't already finished this task.
-			IsStarting = IsStarting && !InFinishedTasks.Contains(Task);
+			// Already running, or if we're looping (And thus not cleaning up tasks as we complete them), already finished.
+			continue;
 		}
 
+		IsStarting = Task->CanStart(m_Context, CurrentTime, DeltaTime) && !Task->IsDisabled(m_Context);
+
 		// Check any dependencies.
-		if (IsStarting && Task->HasDependencies())
+		if (IsStarting && m_TaskPlan->GetDependencies(TaskIndex).Num())
 		{
-			for (const UAblAbilityTask* DependantTask : Task->GetTaskDependencies())
-			{
-				if (!DependantTask)
-				{
-					continue;
-				}
-
-				// This *should* always be true, but in the editor sometimes the list isn't properly updated.
-				// This is by far the assert I hit the most during iteration, so there's obviously a case I'm missing but I'd rather make this code a bit
-				// more adaptive as it was written before I added the finished lists for both processes.
-				if (!m_TaskDependencyMap.Contains(DependantTask))
-				{
-					FScopeLock DependencyMapLock(&m_DependencyMapCS);
-
-					m_TaskDependencyMap.Add(DependantTask);
-					m_TaskDependencyMap[DependantTask] = !DependantTask->IsAsyncFriendly() ? m_FinishedSyncTasks.Contains(DependantTask) : m_FinishedAyncTasks.Contains(DependantTask);
-				}
-
-				if (!m_TaskDependencyMap[DependantTask])
-				{
-					// A dependent Task is still executing, we can't start this frame.
-					IsStarting = false;
-					break;
-				}
-				else
-				{
-					// Our dependency is done, but we have some context targets that are pending. These could be needed, so delay for a frame.
-					IsStarting = m_AdditionalTargets.Num() == 0;
-				}
-			}
+			// If our dependencies are done, but we have some context targets that are pending, these could be needed so delay for a frame.
+			IsStarting = AreDependenciesDone(TaskIndex) && m_AdditionalTargets.Num() == 0;
 		}
 
-		if (IsStarting && !InActiveTasks.Contains(Task))
+		if (!IsStarting)
 		{
-			FScopeCycleCounter TaskScope(Task->GetStatId());
-
-			// New Task to start.
-			Task->OnTaskStart(m_Context);
-			if (Task->IsSingleFrame())
-			{
-				// We can go ahead and end this task and forget about it.
-				Task->OnTaskEnd(m_Context, EAblAbilityTaskResult::Successful);
+			continue;
+		}
 
-				if (m_TaskDependencyMap.Contains(Task))
-				{
-					FScopeLock DependencyMapLock(&m_DependencyMapCS);
-					m_TaskDependencyMap[Task] = true;
-				}
+		FScopeCycleCounter TaskScope(Task->GetStatId());
+		INC_DWORD_STAT(STAT_AblAbilityInstance_TasksStarted);
 
-				InFinishedTasks.Add(Task);
-			}
-			else
-			{
-				NewlyStartedTasks.Add(Task);
-			}
+		// New Task to start.
+		m_Context->SetCurrentTaskIndex(Lane, TaskIndex);
+		Task->OnTaskStart(m_Context);
+		if (Task->IsSingleFrame())
+		{
+			// We can go ahead and end this task and forget about it.
+			Task->OnTaskEnd(m_Context, EAblAbilityTaskResult::Successful);
+			INC_DWORD_STAT(STAT_AblAbilityInstance_TasksFinished);
 
-			if (!IsLooping || Task->GetStartTime() < LoopTimeRange.X)
-			{
-				// If we aren't looping, or our task starts before our loop range, we can remove items from this list as we start tasks to cut down on future iterations.
-				InTasks.RemoveAt(i, 1, false);
-				continue;
-			}
+			MarkTaskDone(TaskIndex);
+			LaneState.Finished[Slot] = true;
 		}
-		else if (AdjustedTime < Task->GetStartTime())
+		else
 		{
-			// Since our array is sorted by time. It's safe to early out.
-			break;
+			NewlyStartedSlots.Add(Slot);
 		}
 
-		++i;
+		if (!IsLooping || Task->GetStartTime() < LoopTimeRange.X)
+		{
+			// If we aren't looping, or our task starts before our loop range, we can remove items from our pending list as we start tasks to cut down on future iterations.
+			StartedSlots.Add(Slot);
+		}
 	}
 
-	InTasks.Shrink();
+	for (int32 Slot : StartedSlots)
+	{
+		LaneState.Pending[Slot] = false;
+	}
+	LaneState.NumPending -= StartedSlots.Num();
 
 	// Update our actives.
 	bool TaskCompleted = false;
-	const UAblAbilityTask* ActiveTask = nullptr;
-	for (int i = 0; i < InActiveTasks.Num(); )
+	for (TConstSetBitIterator<> ActiveIt(LaneState.Active); ActiveIt; ++ActiveIt)
 	{
-		ActiveTask = InActiveTasks[i];
+		const int32 Slot = ActiveIt.GetIndex();
+		const int32 TaskIndex = PlanLane.Tasks[Slot];
+		const UAblAbilityTask* ActiveTask = m_TaskPlan->GetTask(TaskIndex);
 
 		FScopeCycleCounter ActiveTaskScope(ActiveTask->GetStatId());
 
+		m_Context->SetCurrentTaskIndex(Lane, TaskIndex);
 		TaskCompleted = ActiveTask->IsDone(m_Context);
 		if (!TaskCompleted && ActiveTask->NeedsTick())
 		{
@@ -829,104 +719,103 @@ void FAblAbilityInstance::InternalUpdateTasks(TArray<const UAblAbilityTask*>& In
 		else if (TaskCompleted)
 		{
 			ActiveTask->OnTaskEnd(m_Context, EAblAbilityTaskResult::Successful);
+			INC_DWORD_STAT(STAT_AblAbilityInstance_TasksFinished);
 
-			if (m_TaskDependencyMap.Contains(ActiveTask))
-			{
-				FScopeLock DependencyMapLock(&m_DependencyMapCS);
-				m_TaskDependencyMap[ActiveTask] = true;
-			}
+			MarkTaskDone(TaskIndex);
 
 			if (IsLooping)
 			{
-				InFinishedTasks.Add(ActiveTask);
+				LaneState.Finished[Slot] = true;
 			}
 
-			InActiveTasks.RemoveAt(i, 1, false);
-			continue;
+			// Only clears the bit we're currently on, which the iterator has already visited.
+			LaneState.Active[Slot] = false;
+			--LaneState.NumActive;
 		}
-
-		++i;
 	}
 
-	// Move our newly started tasks over.
-	InActiveTasks.Append(NewlyStartedTasks);
+	m_Context->SetCurrentTaskIndex(Lane, INDEX_NONE);
 
-	InActiveTasks.Shrink();
+	// Move our newly started tasks over.
+	for (int32 Slot : NewlyStartedSlots)
+	{
+		LaneState.Active[Slot] = true;
+	}
+	LaneState.NumActive += NewlyStartedSlots.Num();
 }
 
-void FAblAbilityInstance::InternalStopRunningTasks(EAblAbilityTaskResult Reason, bool ResetForLoop)
+void FAblAbilityInstance::QueuePendingTasks()
 {
-	if (ResetForLoop)
+	ENetMode NetMode = NM_Standalone;
+	if (m_Context->GetSelfActor())
 	{
-		// We only want to remove Tasks that fall within our Loop time range.
-		const FVector2D LoopRange = m_Ability->GetLoopRange();
+		NetMode = m_Context->GetSelfActor()->GetNetMode();
+	}
 
-		const UAblAbilityTask* CurrentTask = nullptr;
+	for (FLaneState& LaneState : m_Lanes)
+	{
+		LaneState.Pending.Init(false, LaneState.Pending.Num());
+		LaneState.NumPending = 0;
+	}
 
-		for (int32 i = 0; i < m_ActiveAsyncTasks.Num();)
+	for (int32 TaskIndex = 0; TaskIndex < m_TaskPlan->Num(); ++TaskIndex)
+	{
+		const UAblAbilityTask* Task = m_TaskPlan->GetTask(TaskIndex);
+		if (Task->IsDisabled(m_Context) || !Task->IsValidForNetMode(NetMode))
 		{
-			CurrentTask = m_ActiveAsyncTasks[i];
-			if (CurrentTask->GetStartTime() >= LoopRange.X && CurrentTask->GetEndTime() <= LoopRange.Y)
-			{
-				CurrentTask->OnTaskEnd(m_Context, Reason);
-				m_ActiveAsyncTasks.RemoveAt(i, 1, false);
-				continue;
-			}
-			++i;
+			continue;
 		}
 
-		m_ActiveAsyncTasks.Shrink();
-
-		for (int32 i = 0; i < m_ActiveSyncTasks.Num();)
+		FLaneState& LaneState = m_Lanes[(uint8)m_TaskPlan->GetTaskLane(TaskIndex)];
+		const int32 Slot = m_TaskPlan->GetLaneSlot(TaskIndex);
+		if (!LaneState.Active[Slot])
 		{
-			CurrentTask = m_ActiveSyncTasks[i];
-			if (CurrentTask->GetStartTime() >= LoopRange.X && CurrentTask->GetEndTime() <= LoopRange.Y)
-			{
-				CurrentTask->OnTaskEnd(m_Context, Reason);
-				m_ActiveSyncTasks.RemoveAt(i, 1, false);
-				continue;
-			}
-			++i;
+			LaneState.Pending[Slot] = true;
+			++LaneState.NumPending;
 		}
+	}
+}
 
-		m_ActiveSyncTasks.Shrink();
+void FAblAbilityInstance::InternalStopRunningTasks(EAblAbilityTaskResult Reason, bool ResetForLoop)
+{
+	// We only want to remove Tasks that fall within our Loop time range, if we're resetting for a loop.
+	const FVector2D LoopRange = m_Ability->GetLoopRange();
 
-	}
-	else
+	for (EAblTaskLane Lane : { EAblTaskLane::Async, EAblTaskLane::Sync })
 	{
-		for (const UAblAbilityTask* Task : m_ActiveAsyncTasks)
+		FLaneState& LaneState = m_Lanes[(uint8)Lane];
+		const TArray<int32>& LaneTasks = m_TaskPlan->GetLane(Lane).Tasks;
+		for (TConstSetBitIterator<> ActiveIt(LaneState.Active); ActiveIt; ++ActiveIt)
 		{
-			Task->OnTaskEnd(m_Context, Reason);
-		}
-		m_ActiveAsyncTasks.Empty();
-
-		for (const UAblAbilityTask* Task : m_ActiveSyncTasks)
-		{
-			Task->OnTaskEnd(m_Context, Reason);
+			const UAblAbilityTask* CurrentTask = m_TaskPlan->GetTask(LaneTasks[ActiveIt.GetIndex()]);
+			if (!ResetForLoop || (CurrentTask->GetStartTime() >= LoopRange.X && CurrentTask->GetEndTime() <= LoopRange.Y))
+			{
+				CurrentTask->OnTaskEnd(m_Context, Reason);
+				LaneState.Active[ActiveIt.GetIndex()] = false;
+				--LaneState.NumActive;
+			}
 		}
-		m_ActiveSyncTasks.Empty();
 	}
-
 }
 
 void FAblAbilityInstance::ResetTaskDependencyStatus()
 {
-	TMap<const UAblAbilityTask*, bool>::TIterator ResetIt = m_TaskDependencyMap.CreateIterator();
-	const UAblAbilityTask* Task;
-	for (; ResetIt; ++ResetIt)
+	for (int32 TaskIndex = 0; TaskIndex < m_TaskDone.Num(); ++TaskIndex)
 	{
-		Task = ResetIt.Key();
-		if (!m_Ability->IsLooping())
-		{
-			ResetIt.Value() = false;
-		}
-		else
+		// Only reset if our task falls within our Loop range.
+		if (!m_Ability->IsLooping() || m_TaskPlan->GetTask(TaskIndex)->GetStartTime() > m_Ability->GetLoopRange().X)
 		{
-			// Only reset if our task falls within our Loop range.
-			if (Task->GetStartTime() > m_Ability->GetLoopRange().X)
-			{
-				ResetIt.Value() = false;
-			}
+			m_TaskDone.ClearDone(TaskIndex);
 		}
 	}
 }
+
+void FAblAbilityInstance::MarkTaskDone(int32 TaskIndex)
+{
+	m_TaskDone.MarkDone(TaskIndex);
+}
+
+bool FAblAbilityInstance::AreDependenciesDone(int32 TaskIndex) const
+{
+	return m_TaskDone.AreDone(m_TaskPlan->GetDependencies(TaskIndex));
+}
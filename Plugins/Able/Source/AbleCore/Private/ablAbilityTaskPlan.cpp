@@ -0,0 +1,163 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#include "ablAbilityTaskPlan.h"
+
+#include "AbleCorePrivate.h"
+#include "Tasks/IAblAbilityTask.h"
+
+void FAblAbilityTaskPlan::Build(const TArray<UAblAbilityTask*>& InTasks)
+{
+	TArray<UAblAbilityTask*> SortedTasks;
+	SortedTasks.Reserve(InTasks.Num());
+	for (UAblAbilityTask* Task : InTasks)
+	{
+		if (Task)
+		{
+			SortedTasks.Add(Task);
+		}
+	}
+
+	// Stable, so Tasks with the same Start Time keep the order they were authored in.
+	SortedTasks.StableSort([](const UAblAbilityTask& LHS, const UAblAbilityTask& RHS)
+	{
+		return LHS.GetStartTime() < RHS.GetStartTime();
+	});
+
+	m_Tasks.Empty(SortedTasks.Num());
+	m_TaskIndices.Empty(SortedTasks.Num());
+	m_ScratchPadStructs.SetNumUninitialized(SortedTasks.Num());
+	m_ScratchPadOffsets.SetNumUninitialized(SortedTasks.Num());
+	m_ScratchPadArenaSize = 0;
+	m_ScratchPadArenaAlignment = 1;
+	for (UAblAbilityTask* Task : SortedTasks)
+	{
+		const int32 TaskIndex = m_Tasks.Add(Task);
+		m_TaskIndices.Add(Task, TaskIndex);
+
+		const UScriptStruct* ScratchPadStruct = Task->GetScratchPadStruct();
+		m_ScratchPadStructs[TaskIndex] = ScratchPadStruct;
+		m_ScratchPadOffsets[TaskIndex] = INDEX_NONE;
+		if (ScratchPadStruct)
+		{
+			const int32 Alignment = FMath::Max(ScratchPadStruct->GetMinAlignment(), 1);
+			m_ScratchPadOffsets[TaskIndex] = Align(m_ScratchPadArenaSize, Alignment);
+			m_ScratchPadArenaSize = m_ScratchPadOffsets[TaskIndex] + ScratchPadStruct->GetStructureSize();
+			m_ScratchPadArenaAlignment = FMath::Max(m_ScratchPadArenaAlignment, Alignment);
+		}
+	}
+
+	m_TaskLanes.SetNumUninitialized(m_Tasks.Num());
+	m_LaneSlots.SetNumUninitialized(m_Tasks.Num());
+	for (FLane& Lane : m_Lanes)
+	{
+		Lane.Tasks.Empty();
+		Lane.StartTimes.Empty();
+	}
+
+	for (int32 TaskIndex = 0; TaskIndex < m_Tasks.Num(); ++TaskIndex)
+	{
+		const UAblAbilityTask* Task = m_Tasks[TaskIndex];
+		const EAblTaskLane TaskLane = Task->IsAsyncFriendly() ? EAblTaskLane::Async : EAblTaskLane::Sync;
+		FLane& Lane = m_Lanes[(uint8)TaskLane];
+
+		m_TaskLanes[TaskIndex] = (uint8)TaskLane;
+		m_LaneSlots[TaskIndex] = Lane.Tasks.Add(TaskIndex);
+		Lane.StartTimes.Add(Task->GetStartTime());
+	}
+
+	m_DependencyOffsets.SetNumUninitialized(m_Tasks.Num() + 1);
+	m_DependencyWords.Empty();
+	for (int32 TaskIndex = 0; TaskIndex < m_Tasks.Num(); ++TaskIndex)
+	{
+		const int32 FirstWord = m_DependencyWords.Num();
+		m_DependencyOffsets[TaskIndex] = FirstWord;
+
+		// Stands in for Dependencies left out of a server cook, which can never finish here.
+		if (m_Tasks[TaskIndex]->HasStrippedDependencies())
+		{
+			m_DependencyWords.Add(FAblTaskDependencyWord{ INDEX_NONE, 0ULL });
+		}
+		for (const UAblAbilityTask* Dependency : m_Tasks[TaskIndex]->GetTaskDependencies())
+		{
+			if (!Dependency)
+			{
+				continue;
+			}
+
+			const int32 DependencyIndex = FindTaskIndex(Dependency);
+			const int32 Word = DependencyIndex != INDEX_NONE ? DependencyIndex >> 6 : INDEX_NONE;
+			const uint64 Mask = DependencyIndex != INDEX_NONE ? 1ULL << (DependencyIndex & 63) : 0ULL;
+
+			// Fold Dependencies that share a word together.
+			FAblTaskDependencyWord* ExistingWord = nullptr;
+			for (int32 i = FirstWord; i < m_DependencyWords.Num(); ++i)
+			{
+				if (m_DependencyWords[i].Word == Word)
+				{
+					ExistingWord = &m_DependencyWords[i];
+					break;
+				}
+			}
+
+			if (ExistingWord)
+			{
+				ExistingWord->Mask |= Mask;
+			}
+			else
+			{
+				m_DependencyWords.Add(FAblTaskDependencyWord{ Word, Mask });
+			}
+		}
+	}
+	m_DependencyOffsets[m_Tasks.Num()] = m_DependencyWords.Num();
+}
+
+int32 FAblAbilityTaskPlan::FindTaskIndex(const UAblAbilityTask* Task) const
+{
+	const int32* TaskIndex = m_TaskIndices.Find(Task);
+	return TaskIndex ? *TaskIndex : INDEX_NONE;
+}
+
+void FAblTaskDoneMask::Init(int32 NumTasks)
+{
+	m_NumTasks = NumTasks;
+	m_Words.Reset();
+	m_Words.AddZeroed((NumTasks + 63) >> 6);
+}
+
+void FAblTaskDoneMask::MarkDone(int32 TaskIndex)
+{
+	checkSlow(TaskIndex >= 0 && TaskIndex < m_NumTasks);
+	FPlatformAtomics::InterlockedOr(&m_Words[GetWord(TaskIndex)], GetBit(TaskIndex));
+}
+
+void FAblTaskDoneMask::ClearDone(int32 TaskIndex)
+{
+	checkSlow(TaskIndex >= 0 && TaskIndex < m_NumTasks);
+	FPlatformAtomics::InterlockedAnd(&m_Words[GetWord(TaskIndex)], ~GetBit(TaskIndex));
+}
+
+bool FAblTaskDoneMask::IsDone(int32 TaskIndex) const
+{
+	checkSlow(TaskIndex >= 0 && TaskIndex < m_NumTasks);
+	return (FPlatformAtomics::AtomicRead(&m_Words[GetWord(TaskIndex)]) & GetBit(TaskIndex)) != 0;
+}
+
+bool FAblTaskDoneMask::AreDone(TArrayView<const FAblTaskDependencyWord> Dependencies) const
+{
+	for (const FAblTaskDependencyWord& Dependency : Dependencies)
+	{
+		// Dependencies outside of our Ability can never finish.
+		if (!m_Words.IsValidIndex(Dependency.Word))
+		{
+			return false;
+		}
+
+		if (((uint64)FPlatformAtomics::AtomicRead(&m_Words[Dependency.Word]) & Dependency.Mask) != Dependency.Mask)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
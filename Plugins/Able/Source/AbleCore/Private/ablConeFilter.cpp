@@ -0,0 +1,289 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#include "ablConeFilter.h"
+
+#include "AbleCorePrivate.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+namespace AblConeFilter
+{
+	// Float lanes are within a few ULPs of the double math, anything closer to a threshold than this is handed to TestScalar.
+	static const float RelativeTolerance = 1.0e-5f;
+	static const float DotTolerance = 1.0e-5f;
+	static const float AbsoluteTolerance = 1.0e-3f;
+
+	// Offsets this short are left un-normalized by FVector::Normalize, always hand them to TestScalar.
+	static const float MinDistanceSqr = 1.0f;
+}
+
+FAblConeFilter::FAblConeFilter(const FTransform& QueryTransform, float FOV, float Height, float Length, bool Is2D, bool Is3DSlice, EAblConeHeightTest HeightTest)
+	: m_GreaterThanOneEighty(FOV > 180.0f),
+	m_Is2D(Is2D),
+	m_Is3DSlice(Is3DSlice),
+	m_HeightTest(HeightTest)
+{
+	const float QueryAngle = m_GreaterThanOneEighty ? 360.0f - FOV : FOV;
+	m_HalfAngle = FMath::DegreesToRadians(QueryAngle * 0.5f);
+	m_LengthSqr = Length * Length;
+	m_HeightSqr = Height * Height;
+	m_Height = Height;
+	m_HeightAngle = Is2D ? 0.0f : FMath::Atan2(Height * 0.5f, Length);
+
+	m_QueryLocation = QueryTransform.GetTranslation();
+	m_QueryForward = QueryTransform.GetRotation().GetForwardVector();
+
+	// If we're great than 180, we take the angle of the "hole" and compare against that (which requires flipping our forward around).
+	if (m_GreaterThanOneEighty)
+	{
+		m_QueryForward = -m_QueryForward;
+	}
+
+	m_XYForward = FVector2D(m_QueryForward.X, m_QueryForward.Y);
+
+	// Acos(x) < Angle is x > Cos(Angle) for Angle in [0, PI].
+	m_RangeSqr = Is2D ? m_LengthSqr : FMath::Min(m_HeightSqr, m_LengthSqr);
+	m_CosHalfAngle = FMath::Cos(m_HalfAngle);
+	m_CosHeightAngle = FMath::Cos(m_HeightAngle);
+}
+
+bool FAblConeFilter::TestScalar(const FVector& Location) const
+{
+	FVector ToTarget = Location - m_QueryLocation;
+	ToTarget.Normalize();
+	const FVector2D ToTargetXY(ToTarget.X, ToTarget.Y);
+
+	bool ValidEntry = true;
+
+	// If we're a 3D query, we base our initial sphere query on whichever is largest (height or length),
+	// so do a quick distance check here, if those pass - go ahead and do our vertical angle check.
+	if (!m_Is2D)
+	{
+		if (FVector::DistSquared(Location, m_QueryLocation) > m_HeightSqr ||
+			FVector::DistSquared(Location, m_QueryLocation) > m_LengthSqr)
+		{
+			ValidEntry = false;
+		}
+		else if (m_Is3DSlice)
+		{
+			ValidEntry = FMath::Abs(Location.Z - m_QueryLocation.Z) <= m_Height;
+		}
+		else if (m_HeightTest == EAblConeHeightTest::Angle)
+		{
+			const float VerticalAngle = FMath::Acos(FVector::DotProduct(m_QueryForward, ToTarget));
+			ValidEntry = VerticalAngle < m_HeightAngle;
+		}
+		else
+		{
+			const float VerticalDot = FVector::DotProduct(m_QueryForward, ToTarget);
+			ValidEntry = VerticalDot < m_HeightAngle;
+		}
+	}
+	else
+	{
+		ValidEntry = FVector::DistSquared2D(Location, m_QueryLocation) <= m_LengthSqr;
+	}
+
+	// Move on to our Dot product checks
+	if (ValidEntry)
+	{
+		const float QueryToTargetDotProduct = FVector2D::DotProduct(m_XYForward, ToTargetXY);
+		const bool WithInAngle = FMath::Acos(QueryToTargetDotProduct) < m_HalfAngle;
+		const bool HalfSpace = QueryToTargetDotProduct > 0.0f;
+
+		ValidEntry = WithInAngle && HalfSpace;
+
+		if (m_GreaterThanOneEighty) // If our FOV > 180 degrees, we want everything not in the angle check.
+		{
+			ValidEntry = !ValidEntry;
+		}
+	}
+
+	return ValidEntry;
+}
+
+void FAblConeFilter::Filter(TArrayView<const FVector> Locations, TArray<int32>& OutPassed) const
+{
+	const int32 NumLocations = Locations.Num();
+	if (NumLocations == 0)
+	{
+		return;
+	}
+
+	// Gather offsets into SoA, padded out to a full register.
+	const int32 NumPadded = Align(NumLocations, 4);
+	TArray<float, TInlineAllocator<3 * 64>> Offsets;
+	Offsets.SetNumZeroed(NumPadded * 3);
+	float* OffsetX = Offsets.GetData();
+	float* OffsetY = OffsetX + NumPadded;
+	float* OffsetZ = OffsetY + NumPadded;
+	for (int32 i = 0; i < NumLocations; ++i)
+	{
+		const FVector Offset = Locations[i] - m_QueryLocation;
+		OffsetX[i] = (float)Offset.X;
+		OffsetY[i] = (float)Offset.Y;
+		OffsetZ[i] = (float)Offset.Z;
+	}
+
+	const VectorRegister4Float Zero = VectorSetFloat1(0.0f);
+	const VectorRegister4Float DotTolerance = VectorSetFloat1(AblConeFilter::DotTolerance);
+	const VectorRegister4Float MinDistanceSqr = VectorSetFloat1(AblConeFilter::MinDistanceSqr);
+	const VectorRegister4Float RangeSqr = VectorSetFloat1(m_RangeSqr);
+	const VectorRegister4Float RangeTolerance = VectorSetFloat1(m_RangeSqr * AblConeFilter::RelativeTolerance + AblConeFilter::AbsoluteTolerance);
+	const VectorRegister4Float Height = VectorSetFloat1(m_Height);
+	const VectorRegister4Float HeightTolerance = VectorSetFloat1(m_Height * AblConeFilter::RelativeTolerance + AblConeFilter::AbsoluteTolerance);
+	const VectorRegister4Float ForwardX = VectorSetFloat1((float)m_QueryForward.X);
+	const VectorRegister4Float ForwardY = VectorSetFloat1((float)m_QueryForward.Y);
+	const VectorRegister4Float ForwardZ = VectorSetFloat1((float)m_QueryForward.Z);
+	const VectorRegister4Float XYForwardX = VectorSetFloat1((float)m_XYForward.X);
+	const VectorRegister4Float XYForwardY = VectorSetFloat1((float)m_XYForward.Y);
+	const VectorRegister4Float CosHalfAngle = VectorSetFloat1(m_CosHalfAngle);
+	const VectorRegister4Float VerticalThreshold = VectorSetFloat1(m_HeightTest == EAblConeHeightTest::Angle ? m_CosHeightAngle : m_HeightAngle);
+
+	const bool TestVerticalAngle = !m_Is2D && !m_Is3DSlice;
+
+	for (int32 i = 0; i < NumPadded; i += 4)
+	{
+		const VectorRegister4Float X = VectorLoad(OffsetX + i);
+		const VectorRegister4Float Y = VectorLoad(OffsetY + i);
+		const VectorRegister4Float Z = VectorLoad(OffsetZ + i);
+
+		const VectorRegister4Float DistSqr2D = VectorMultiplyAdd(X, X, VectorMultiply(Y, Y));
+		const VectorRegister4Float DistSqr = VectorMultiplyAdd(Z, Z, DistSqr2D);
+		const VectorRegister4Float RangeDistSqr = m_Is2D ? DistSqr2D : DistSqr;
+
+		// Range.
+		int32 Valid = VectorMaskBits(VectorCompareLE(RangeDistSqr, RangeSqr));
+		int32 Unsure = VectorMaskBits(VectorCompareLE(VectorAbs(VectorSubtract(RangeDistSqr, RangeSqr)), RangeTolerance));
+		Unsure |= VectorMaskBits(VectorCompareLE(DistSqr, MinDistanceSqr));
+
+		// Normalize.
+		const VectorRegister4Float InvDist = VectorReciprocalSqrtAccurate(DistSqr);
+		const VectorRegister4Float NormX = VectorMultiply(X, InvDist);
+		const VectorRegister4Float NormY = VectorMultiply(Y, InvDist);
+		const VectorRegister4Float NormZ = VectorMultiply(Z, InvDist);
+
+		// Vertical.
+		if (m_Is3DSlice && !m_Is2D)
+		{
+			const VectorRegister4Float AbsZ = VectorAbs(Z);
+			Valid &= VectorMaskBits(VectorCompareLE(AbsZ, Height));
+			Unsure |= VectorMaskBits(VectorCompareLE(VectorAbs(VectorSubtract(AbsZ, Height)), HeightTolerance));
+		}
+		else if (TestVerticalAngle)
+		{
+			const VectorRegister4Float VerticalDot = VectorMultiplyAdd(ForwardX, NormX, VectorMultiplyAdd(ForwardY, NormY, VectorMultiply(ForwardZ, NormZ)));
+			Valid &= m_HeightTest == EAblConeHeightTest::Angle ? VectorMaskBits(VectorCompareGT(VerticalDot, VerticalThreshold)) : VectorMaskBits(VectorCompareLT(VerticalDot, VerticalThreshold));
+			Unsure |= VectorMaskBits(VectorCompareLE(VectorAbs(VectorSubtract(VerticalDot, VerticalThreshold)), DotTolerance));
+		}
+
+		// Horizontal angle and half space.
+		const VectorRegister4Float HorizontalDot = VectorMultiplyAdd(XYForwardX, NormX, VectorMultiply(XYForwardY, NormY));
+		const int32 InCone = VectorMaskBits(VectorCompareGT(HorizontalDot, CosHalfAngle)) & VectorMaskBits(VectorCompareGT(HorizontalDot, Zero));
+		Unsure |= VectorMaskBits(VectorCompareLE(VectorAbs(VectorSubtract(HorizontalDot, CosHalfAngle)), DotTolerance));
+		Unsure |= VectorMaskBits(VectorCompareLE(VectorAbs(HorizontalDot), DotTolerance));
+
+		Valid &= m_GreaterThanOneEighty ? ~InCone : InCone;
+
+		// Compact survivors, in order.
+		const int32 NumLanes = FMath::Min(4, NumLocations - i);
+		for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+		{
+			const int32 LaneBit = 1 << Lane;
+			const bool Passed = (Unsure & LaneBit) ? TestScalar(Locations[i + Lane]) : (Valid & LaneBit) != 0;
+			if (Passed)
+			{
+				OutPassed.Add(i + Lane);
+			}
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+/* Runs the scalar test and the batched filter over the same random candidates for each cone flavor, and reports timings and any mismatch. */
+static void BenchConeFilter(const TArray<FString>& Args)
+{
+	const int32 NumCandidates = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+	const int32 NumIterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 100;
+
+	FRandomStream Stream(0x41626c65);
+	const FTransform QueryTransform(FRotator(0.0f, 37.0f, 0.0f), FVector(1250.0f, -830.0f, 90.0f));
+
+	TArray<FVector> Locations;
+	Locations.Reserve(NumCandidates);
+	for (int32 i = 0; i < NumCandidates; ++i)
+	{
+		Locations.Add(QueryTransform.GetTranslation() + Stream.GetUnitVector() * Stream.FRandRange(0.0f, 1200.0f));
+	}
+
+	struct FConfig
+	{
+		const TCHAR* Name;
+		float FOV;
+		bool Is2D;
+		bool Is3DSlice;
+		EAblConeHeightTest HeightTest;
+	};
+
+	const FConfig Configs[] =
+	{
+		{ TEXT("2D 90"), 90.0f, true, false, EAblConeHeightTest::Angle },
+		{ TEXT("2D 270"), 270.0f, true, false, EAblConeHeightTest::Angle },
+		{ TEXT("3D Angle 90"), 90.0f, false, false, EAblConeHeightTest::Angle },
+		{ TEXT("3D Dot 90"), 90.0f, false, false, EAblConeHeightTest::Dot },
+		{ TEXT("3D Slice 120"), 120.0f, false, true, EAblConeHeightTest::Angle },
+		{ TEXT("3D Slice 300"), 300.0f, false, true, EAblConeHeightTest::Angle },
+	};
+
+	TArray<int32> ScalarPassed;
+	TArray<int32> FilterPassed;
+	ScalarPassed.Reserve(NumCandidates);
+	FilterPassed.Reserve(NumCandidates);
+
+	bool AllMatched = true;
+	for (const FConfig& Config : Configs)
+	{
+		const FAblConeFilter Cone(QueryTransform, Config.FOV, 800.0f, 1000.0f, Config.Is2D, Config.Is3DSlice, Config.HeightTest);
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			ScalarPassed.Reset();
+			for (int32 i = 0; i < NumCandidates; ++i)
+			{
+				if (Cone.TestScalar(Locations[i]))
+				{
+					ScalarPassed.Add(i);
+				}
+			}
+		}
+		const double ScalarMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumIterations;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			FilterPassed.Reset();
+			Cone.Filter(Locations, FilterPassed);
+		}
+		const double FilterMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumIterations;
+
+		const bool Matched = ScalarPassed == FilterPassed;
+		AllMatched &= Matched;
+
+		UE_LOG(LogAble, Display, TEXT("Able.BenchConeFilter: %s, %d candidates, %d passed. Scalar %.3f ms, Filter %.3f ms (%.1fx). %s"),
+			Config.Name, NumCandidates, ScalarPassed.Num(), ScalarMs, FilterMs, FilterMs > 0.0 ? ScalarMs / FilterMs : 0.0, Matched ? TEXT("Match") : TEXT("MISMATCH"));
+	}
+
+	if (!AllMatched)
+	{
+		UE_LOG(LogAble, Error, TEXT("Able.BenchConeFilter: Batched cone results differ from the scalar test."));
+	}
+}
+
+static FAutoConsoleCommand BenchConeFilterCommand(
+	TEXT("Able.BenchConeFilter"),
+	TEXT("Times the scalar cone test against the batched cone filter for each cone flavor and verifies they accept the same candidates. Args: [NumCandidates=10000] [Iterations=100]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchConeFilter));
+
+#endif
@@ -0,0 +1,301 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#include "ablCooldownTable.h"
+
+#include "ablAbility.h"
+#include "ablAbilityContext.h"
+#include "AbleCorePrivate.h"
+
+#include "Math/VectorRegister.h"
+
+FAblCooldownTable::FAblCooldownTable()
+	: m_NextSerial(1U)
+{
+
+}
+
+int32 FAblCooldownTable::AllocateOwner()
+{
+	if (m_FreeOwners.Num())
+	{
+		const int32 OwnerIndex = m_FreeOwners.Pop(false);
+		m_OwnerCounts[OwnerIndex] = 0;
+		return OwnerIndex;
+	}
+
+	return m_OwnerCounts.Add(0);
+}
+
+void FAblCooldownTable::ReleaseOwner(int32 OwnerIndex)
+{
+	if (!m_OwnerCounts.IsValidIndex(OwnerIndex))
+	{
+		return;
+	}
+
+	if (m_OwnerCounts[OwnerIndex] > 0)
+	{
+		for (int32 i = m_OwnerIndices.Num() - 1; i >= 0; --i)
+		{
+			if (m_OwnerIndices[i] == OwnerIndex)
+			{
+				RemoveAtDense(i);
+			}
+		}
+	}
+
+	m_OwnerCounts[OwnerIndex] = 0;
+	m_FreeOwners.Add(OwnerIndex);
+}
+
+FAblCooldownHandle FAblCooldownTable::Add(int32 OwnerIndex, const UAblAbility& Ability, const UAblAbilityContext& Context)
+{
+	const float TotalTime = Ability.GetCooldown(&Context);
+	if (TotalTime <= 0.0f)
+	{
+		return FAblCooldownHandle();
+	}
+
+	FAblCooldownHandle Handle = Add(OwnerIndex, Ability.GetAbilityNameHash(), TotalTime);
+
+	if (!Ability.CanCacheCooldown())
+	{
+		FCooldownSource Source;
+		Source.HandleIndex = Handle.Index;
+		Source.Ability = &Ability;
+		Source.Context = &Context;
+		m_HandleSources[Handle.Index] = m_Sources.Add(Source);
+	}
+
+	return Handle;
+}
+
+FAblCooldownHandle FAblCooldownTable::Add(int32 OwnerIndex, uint32 AbilityHash, float TotalTime)
+{
+	check(OwnerIndex >= 0);
+	if (OwnerIndex >= m_OwnerCounts.Num())
+	{
+		m_OwnerCounts.AddZeroed(OwnerIndex + 1 - m_OwnerCounts.Num());
+	}
+
+	const uint64 Key = MakeKey(OwnerIndex, AbilityHash);
+	if (const int32* ExistingHandle = m_HandleLookup.Find(Key))
+	{
+		// Restart the existing entry.
+		const int32 DenseIndex = m_HandleToDense[*ExistingHandle];
+		m_CurrentTimes[DenseIndex] = 0.0f;
+		m_TotalTimes[DenseIndex] = TotalTime;
+		RemoveSource(*ExistingHandle);
+
+		return FAblCooldownHandle(*ExistingHandle, m_HandleSerials[*ExistingHandle]);
+	}
+
+	int32 HandleIndex = INDEX_NONE;
+	if (m_FreeHandles.Num())
+	{
+		HandleIndex = m_FreeHandles.Pop(false);
+	}
+	else
+	{
+		HandleIndex = m_HandleToDense.Add(INDEX_NONE);
+		m_HandleSerials.Add(0U);
+		m_HandleSources.Add(INDEX_NONE);
+	}
+
+	const int32 DenseIndex = m_AbilityHashes.Add(AbilityHash);
+	m_OwnerIndices.Add(OwnerIndex);
+	m_CurrentTimes.Add(0.0f);
+	m_TotalTimes.Add(TotalTime);
+	m_HandleIndices.Add(HandleIndex);
+
+	m_HandleToDense[HandleIndex] = DenseIndex;
+	m_HandleSerials[HandleIndex] = m_NextSerial++;
+	m_HandleSources[HandleIndex] = INDEX_NONE;
+	m_HandleLookup.Add(Key, HandleIndex);
+
+	++m_OwnerCounts[OwnerIndex];
+
+	return FAblCooldownHandle(HandleIndex, m_HandleSerials[HandleIndex]);
+}
+
+FAblCooldownHandle FAblCooldownTable::Find(int32 OwnerIndex, uint32 AbilityHash) const
+{
+	if (OwnerIndex == INDEX_NONE || !m_CurrentTimes.Num())
+	{
+		return FAblCooldownHandle();
+	}
+
+	if (const int32* HandleIndex = m_HandleLookup.Find(MakeKey(OwnerIndex, AbilityHash)))
+	{
+		return FAblCooldownHandle(*HandleIndex, m_HandleSerials[*HandleIndex]);
+	}
+
+	return FAblCooldownHandle();
+}
+
+bool FAblCooldownTable::IsValid(const FAblCooldownHandle& Handle) const
+{
+	return GetDenseIndex(Handle) != INDEX_NONE;
+}
+
+void FAblCooldownTable::Remove(const FAblCooldownHandle& Handle)
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	if (DenseIndex != INDEX_NONE)
+	{
+		RemoveAtDense(DenseIndex);
+	}
+}
+
+float FAblCooldownTable::GetRatio(const FAblCooldownHandle& Handle) const
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE ? FMath::Min(m_CurrentTimes[DenseIndex] / m_TotalTimes[DenseIndex], 1.0f) : 0.0f;
+}
+
+float FAblCooldownTable::GetCurrentTime(const FAblCooldownHandle& Handle) const
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE ? m_CurrentTimes[DenseIndex] : 0.0f;
+}
+
+float FAblCooldownTable::GetTotalTime(const FAblCooldownHandle& Handle) const
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE ? m_TotalTimes[DenseIndex] : 0.0f;
+}
+
+void FAblCooldownTable::SetTotalTime(const FAblCooldownHandle& Handle, float TotalTime)
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	if (DenseIndex != INDEX_NONE)
+	{
+		m_TotalTimes[DenseIndex] = TotalTime;
+
+		// An explicit time wins over whatever the Ability would calculate.
+		RemoveSource(Handle.Index);
+	}
+}
+
+void FAblCooldownTable::Update(float DeltaTime)
+{
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("AblCooldownTable::Update"), STAT_AblCooldownTable_Update, STATGROUP_Able);
+
+	const int32 NumEntries = m_CurrentTimes.Num();
+	if (!NumEntries)
+	{
+		return;
+	}
+
+	// Refresh any Cooldowns that can't be cached.
+	for (TSparseArray<FCooldownSource>::TIterator ItSource(m_Sources); ItSource; ++ItSource)
+	{
+		const FCooldownSource& Source = *ItSource;
+		if (Source.Ability.IsValid() && Source.Context.IsValid())
+		{
+			m_TotalTimes[m_HandleToDense[Source.HandleIndex]] = Source.Ability->GetCooldown(Source.Context.Get());
+		}
+	}
+
+	float* CurrentTimes = m_CurrentTimes.GetData();
+	const float* TotalTimes = m_TotalTimes.GetData();
+
+	const VectorRegister4Float DeltaVector = VectorSetFloat1(DeltaTime);
+	int32 CompleteMask = 0;
+	int32 i = 0;
+	for (; i + 4 <= NumEntries; i += 4)
+	{
+		const VectorRegister4Float Current = VectorAdd(VectorLoad(CurrentTimes + i), DeltaVector);
+		VectorStore(Current, CurrentTimes + i);
+		CompleteMask |= VectorMaskBits(VectorCompareGT(Current, VectorLoad(TotalTimes + i)));
+	}
+
+	for (; i < NumEntries; ++i)
+	{
+		CurrentTimes[i] += DeltaTime;
+		CompleteMask |= CurrentTimes[i] > TotalTimes[i] ? 1 : 0;
+	}
+
+	if (CompleteMask == 0)
+	{
+		return;
+	}
+
+	// Walk backwards so swapped in entries have already been checked.
+	for (i = NumEntries - 1; i >= 0; --i)
+	{
+		if (m_CurrentTimes[i] > m_TotalTimes[i])
+		{
+			RemoveAtDense(i);
+		}
+	}
+}
+
+void FAblCooldownTable::Reset()
+{
+	m_AbilityHashes.Empty();
+	m_OwnerIndices.Empty();
+	m_CurrentTimes.Empty();
+	m_TotalTimes.Empty();
+	m_HandleIndices.Empty();
+	m_HandleToDense.Empty();
+	m_HandleSerials.Empty();
+	m_HandleSources.Empty();
+	m_FreeHandles.Empty();
+	m_HandleLookup.Empty();
+	m_Sources.Empty();
+	m_OwnerCounts.Empty();
+	m_FreeOwners.Empty();
+}
+
+int32 FAblCooldownTable::GetDenseIndex(const FAblCooldownHandle& Handle) const
+{
+	if (!m_HandleToDense.IsValidIndex(Handle.Index) || m_HandleSerials[Handle.Index] != Handle.Serial)
+	{
+		return INDEX_NONE;
+	}
+
+	return m_HandleToDense[Handle.Index];
+}
+
+void FAblCooldownTable::RemoveAtDense(int32 DenseIndex)
+{
+	const int32 HandleIndex = m_HandleIndices[DenseIndex];
+	const int32 OwnerIndex = m_OwnerIndices[DenseIndex];
+
+	m_HandleLookup.Remove(MakeKey(OwnerIndex, m_AbilityHashes[DenseIndex]));
+	RemoveSource(HandleIndex);
+
+	if (m_OwnerCounts.IsValidIndex(OwnerIndex))
+	{
+		--m_OwnerCounts[OwnerIndex];
+	}
+
+	// Retire the Handle.
+	m_HandleToDense[HandleIndex] = INDEX_NONE;
+	m_HandleSerials[HandleIndex] = 0U;
+	m_FreeHandles.Add(HandleIndex);
+
+	// Swap the last entry into this slot.
+	const int32 LastIndex = m_AbilityHashes.Num() - 1;
+	if (DenseIndex != LastIndex)
+	{
+		m_HandleToDense[m_HandleIndices[LastIndex]] = DenseIndex;
+	}
+
+	m_AbilityHashes.RemoveAtSwap(DenseIndex, 1, false);
+	m_OwnerIndices.RemoveAtSwap(DenseIndex, 1, false);
+	m_CurrentTimes.RemoveAtSwap(DenseIndex, 1, false);
+	m_TotalTimes.RemoveAtSwap(DenseIndex, 1, false);
+	m_HandleIndices.RemoveAtSwap(DenseIndex, 1, false);
+}
+
+void FAblCooldownTable::RemoveSource(int32 HandleIndex)
+{
+	const int32 SourceIndex = m_HandleSources[HandleIndex];
+	if (SourceIndex != INDEX_NONE)
+	{
+		m_Sources.RemoveAt(SourceIndex);
+		m_HandleSources[HandleIndex] = INDEX_NONE;
+	}
+}
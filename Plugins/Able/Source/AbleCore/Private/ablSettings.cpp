@@ -8,7 +8,6 @@ UAbleSettings::UAbleSettings(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer),
 	m_EnableAsync(true),
 	m_AllowAsyncAbilityUpdate(true),
-	m_AllowAsyncCooldownUpdate(true),
 	m_LogAbilityFailues(true),
 	m_LogVerbose(true),
 	m_EchoVerboseToScreen(false),
@@ -21,7 +20,13 @@ UAbleSettings::UAbleSettings(const FObjectInitializer& ObjectInitializer)
 	m_AllowAbilityContextReuse(true),
 	m_InitialPooledContextsSize(0),
 	m_MaxPooledContextsSize(0),
-	m_MaxPooledScratchPadsSize(0)
+	m_MaxPooledScratchPadsSize(0),
+	m_UseBatchedAbilityUpdate(false),
+	m_EnableTargetIndex(false),
+	m_TargetIndexCellSize(500.0f),
+	m_StripClientTasksOnServer(true),
+	m_BatchAbilityRPCs(true),
+	m_PredictedPassiveTimeout(2.0f)
 {
 
 }
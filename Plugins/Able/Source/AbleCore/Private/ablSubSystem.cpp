@@ -2,11 +2,33 @@
 
 #include "ablSubSystem.h"
 #include "ablAbility.h"
+#include "ablAbilityComponent.h"
 #include "ablAbilityContext.h"
+#include "ablAbilityInstance.h"
 #include "ablSettings.h"
+#include "AbleCorePrivate.h"
+
+#include "Async/ParallelFor.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/ObjectLibrary.h"
+
+DECLARE_CYCLE_STAT(TEXT("Scheduler Tick"), STAT_AblScheduler_Tick, STATGROUP_AbleScheduler);
+DECLARE_CYCLE_STAT(TEXT("Cooldown Phase"), STAT_AblScheduler_CooldownPhase, STATGROUP_AbleScheduler);
+DECLARE_CYCLE_STAT(TEXT("Target Index Phase"), STAT_AblScheduler_TargetIndexPhase, STATGROUP_AbleScheduler);
+DECLARE_CYCLE_STAT(TEXT("Pending Phase"), STAT_AblScheduler_PendingPhase, STATGROUP_AbleScheduler);
+DECLARE_CYCLE_STAT(TEXT("Instance Phase"), STAT_AblScheduler_InstancePhase, STATGROUP_AbleScheduler);
+DECLARE_CYCLE_STAT(TEXT("Async Instance Phase"), STAT_AblScheduler_AsyncInstancePhase, STATGROUP_AbleScheduler);
+DECLARE_CYCLE_STAT(TEXT("Finish Phase"), STAT_AblScheduler_FinishPhase, STATGROUP_AbleScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registered Components"), STAT_AblScheduler_RegisteredComponents, STATGROUP_AbleScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Updated Components"), STAT_AblScheduler_UpdatedComponents, STATGROUP_AbleScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Parallel Async Instances"), STAT_AblScheduler_AsyncInstances, STATGROUP_AbleScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Cooldowns"), STAT_AblScheduler_ActiveCooldowns, STATGROUP_AbleScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scratchpads Constructed"), STAT_AblUtility_ScratchPadsConstructed, STATGROUP_Able);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Scratchpads"), STAT_AblUtility_PooledScratchPads, STATGROUP_Able);
 
 UAblAbilityUtilitySubsystem::UAblAbilityUtilitySubsystem(const FObjectInitializer& ObjectInitializer)
-	: m_Settings(nullptr)
+	: m_TotalPooledScratchPads(0U),
+	m_Settings(nullptr)
 {
 
 }
@@ -38,6 +60,7 @@ UAblAbilityTaskScratchPad* UAblAbilityUtilitySubsystem::FindOrConstructTaskScrat
 {
 	if (m_Settings && !m_Settings->GetAllowScratchPadReuse())
 	{
+		INC_DWORD_STAT(STAT_AblUtility_ScratchPadsConstructed);
 		return NewObject<UAblAbilityTaskScratchPad>(this, *Class);
 	}
 
@@ -47,17 +70,21 @@ UAblAbilityTaskScratchPad* UAblAbilityUtilitySubsystem::FindOrConstructTaskScrat
 		if (ExistingBucket->Instances.Num())
 		{
 			OutInstance = ExistingBucket->Instances.Pop(false);
+			--m_TotalPooledScratchPads;
+			DEC_DWORD_STAT(STAT_AblUtility_PooledScratchPads);
 		}
 		else
 		{
 			// Ran out of Instances, make one.
+			INC_DWORD_STAT(STAT_AblUtility_ScratchPadsConstructed);
 			OutInstance = NewObject<UAblAbilityTaskScratchPad>(this, *Class);
 		}
 	}
-	else
+	else if (Class.Get())
 	{
-		FAblTaskScratchPadBucket& NewBucket = m_TaskBuckets.AddDefaulted_GetRef();
+		FAblTaskScratchPadBucket& NewBucket = m_TaskBuckets.Add(Class.Get());
 		NewBucket.ScratchPadClass = Class;
+		INC_DWORD_STAT(STAT_AblUtility_ScratchPadsConstructed);
 		OutInstance = NewObject<UAblAbilityTaskScratchPad>(this, *Class);
 	}
 
@@ -69,6 +96,7 @@ UAblAbilityScratchPad* UAblAbilityUtilitySubsystem::FindOrConstructAbilityScratc
 {
 	if (m_Settings && !m_Settings->GetAllowScratchPadReuse())
 	{
+		INC_DWORD_STAT(STAT_AblUtility_ScratchPadsConstructed);
 		return NewObject<UAblAbilityScratchPad>(this, *Class);
 	}
 
@@ -78,17 +106,21 @@ UAblAbilityScratchPad* UAblAbilityUtilitySubsystem::FindOrConstructAbilityScratc
 		if (ExistingBucket->Instances.Num())
 		{
 			OutInstance = ExistingBucket->Instances.Pop(false);
+			--m_TotalPooledScratchPads;
+			DEC_DWORD_STAT(STAT_AblUtility_PooledScratchPads);
 		}
 		else
 		{
 			// Ran out of Instances, make one.
+			INC_DWORD_STAT(STAT_AblUtility_ScratchPadsConstructed);
 			OutInstance = NewObject<UAblAbilityScratchPad>(this, *Class);
 		}
 	}
-	else
+	else if (Class.Get())
 	{
-		FAblAbilityScratchPadBucket& NewBucket = m_AbilityBuckets.AddDefaulted_GetRef();
+		FAblAbilityScratchPadBucket& NewBucket = m_AbilityBuckets.Add(Class.Get());
 		NewBucket.ScratchPadClass = Class;
+		INC_DWORD_STAT(STAT_AblUtility_ScratchPadsConstructed);
 		OutInstance = NewObject<UAblAbilityScratchPad>(this, *Class);
 	}
 
@@ -115,6 +147,8 @@ void UAblAbilityUtilitySubsystem::ReturnTaskScratchPad(UAblAbilityTaskScratchPad
 	if (FAblTaskScratchPadBucket* Bucket = GetTaskBucketByClass(ClassSubClass))
 	{
 		Bucket->Instances.Push(Scratchpad);
+		++m_TotalPooledScratchPads;
+		INC_DWORD_STAT(STAT_AblUtility_PooledScratchPads);
 	}
 
 	// If we don't have a bucket then we somehow mixed worlds... which doesn't make sense. Just let it release through the GC system.
@@ -139,62 +173,97 @@ void UAblAbilityUtilitySubsystem::ReturnAbilityScratchPad(UAblAbilityScratchPad*
 	if (FAblAbilityScratchPadBucket* Bucket = GetAbilityBucketByClass(ClassSubClass))
 	{
 		Bucket->Instances.Push(Scratchpad);
+		++m_TotalPooledScratchPads;
+		INC_DWORD_STAT(STAT_AblUtility_PooledScratchPads);
 	}
 
 	// If we don't have a bucket then we somehow mixed worlds... which doesn't make sense. Just let it release through the GC system.
 }
 
-FAblTaskScratchPadBucket* UAblAbilityUtilitySubsystem::GetTaskBucketByClass(TSubclassOf<UAblAbilityTaskScratchPad>& Class)
+void UAblAbilityUtilitySubsystem::PrewarmScratchPads(const TArray<const UAblAbility*>& Abilities, int32 Copies, UAblAbilityComponent* AbilityComponent)
 {
-	if (!Class.Get())
+	if (m_Settings && !m_Settings->GetAllowScratchPadReuse())
 	{
-		return nullptr;
+		return;
 	}
 
-	for (FAblTaskScratchPadBucket& Bucket : m_TaskBuckets)
+	// Run the normal allocation path on throw away Contexts, so we get exactly what each Ability asks for, then hand it all back to the pools.
+	TArray<UAblAbilityContext*> WarmupContexts;
+	for (const UAblAbility* Ability : Abilities)
 	{
-		if (Class->GetFName() == Bucket.ScratchPadClass->GetFName())
+		if (!Ability)
+		{
+			continue;
+		}
+
+		for (int32 i = 0; i < Copies; ++i)
 		{
-			return &Bucket;
+			UAblAbilityContext* WarmupContext = nullptr;
+			if (AbilityComponent)
+			{
+				AActor* Owner = AbilityComponent->GetOwner();
+				WarmupContext = UAblAbilityContext::MakeContext(Ability, AbilityComponent, Owner, Owner);
+			}
+			else
+			{
+				WarmupContext = FindOrConstructContext();
+				WarmupContext->SetAbility(Ability);
+			}
+
+			WarmupContext->AllocateScratchPads();
+			WarmupContexts.Add(WarmupContext);
 		}
 	}
 
-	return nullptr;
+	for (UAblAbilityContext* WarmupContext : WarmupContexts)
+	{
+		WarmupContext->ReleaseScratchPads();
+		WarmupContext->Reset();
+	}
+
+	UE_LOG(LogAble, Log, TEXT("Prewarmed Scratchpads for %d Abilities, %u Scratchpads pooled."), Abilities.Num(), GetTotalScratchPads());
 }
 
-FAblAbilityScratchPadBucket* UAblAbilityUtilitySubsystem::GetAbilityBucketByClass(TSubclassOf<UAblAbilityScratchPad>& Class)
+void UAblAbilityUtilitySubsystem::PrewarmScratchPadsInPath(const FString& Path, int32 Copies)
 {
-	if (!Class.Get())
-	{
-		return nullptr;
-	}
+	UObjectLibrary* AbilityLibrary = UObjectLibrary::CreateLibrary(UAblAbility::StaticClass(), true, GIsEditor);
+	AbilityLibrary->LoadBlueprintAssetDataFromPath(Path);
+	AbilityLibrary->LoadAssetsFromAssetData();
 
-	for (FAblAbilityScratchPadBucket& Bucket : m_AbilityBuckets)
+	TArray<UBlueprintGeneratedClass*> AbilityClasses;
+	AbilityLibrary->GetObjects<UBlueprintGeneratedClass>(AbilityClasses);
+
+	TArray<const UAblAbility*> Abilities;
+	Abilities.Reserve(AbilityClasses.Num());
+	for (UBlueprintGeneratedClass* AbilityClass : AbilityClasses)
 	{
-		if (Class->GetFName() == Bucket.ScratchPadClass->GetFName())
+		if (AbilityClass && AbilityClass->IsChildOf(UAblAbility::StaticClass()))
 		{
-			return &Bucket;
+			Abilities.Add(AbilityClass->GetDefaultObject<UAblAbility>());
 		}
 	}
 
-	return nullptr;
+	PrewarmScratchPads(Abilities, Copies);
 }
 
-uint32 UAblAbilityUtilitySubsystem::GetTotalScratchPads() const
+FAblTaskScratchPadBucket* UAblAbilityUtilitySubsystem::GetTaskBucketByClass(TSubclassOf<UAblAbilityTaskScratchPad>& Class)
 {
-	uint32 TotalAmount = 0;
-
-	for (const FAblAbilityScratchPadBucket& Bucket : m_AbilityBuckets)
+	if (!Class.Get())
 	{
-		TotalAmount += Bucket.Instances.Num();
+		return nullptr;
 	}
 
-	for (const FAblTaskScratchPadBucket& Bucket : m_TaskBuckets)
+	return m_TaskBuckets.Find(Class.Get());
+}
+
+FAblAbilityScratchPadBucket* UAblAbilityUtilitySubsystem::GetAbilityBucketByClass(TSubclassOf<UAblAbilityScratchPad>& Class)
+{
+	if (!Class.Get())
 	{
-		TotalAmount += Bucket.Instances.Num();
+		return nullptr;
 	}
 
-	return TotalAmount;
+	return m_AbilityBuckets.Find(Class.Get());
 }
 
 UAblAbilityContext* UAblAbilityUtilitySubsystem::FindOrConstructContext()
@@ -238,3 +307,236 @@ void UAblAbilityUtilitySubsystem::ReturnContext(UAblAbilityContext* Context)
 
 	m_AvailableContexts.Push(Context);
 }
+
+FAblScheduledAsyncUpdate::FAblScheduledAsyncUpdate(UAblAbilityComponent* InComponent, const FAblAbilityInstance& InInstance, bool InIsPassive, float InCurrentTime, float InDeltaTime)
+	: Component(InComponent),
+	AbilityNameHash(InInstance.GetAbilityNameHash()),
+	Context(&InInstance.GetContext()),
+	IsPassive(InIsPassive),
+	CurrentTime(InCurrentTime),
+	DeltaTime(InDeltaTime),
+	Instance(nullptr)
+{
+
+}
+
+FAblAbilityInstance* FAblScheduledAsyncUpdate::ResolveInstance() const
+{
+	if (!Component)
+	{
+		return nullptr;
+	}
+
+	FAblAbilityInstance* Found = nullptr;
+	if (IsPassive)
+	{
+		Found = Component->m_PassiveAbilityInstances.FindByPredicate([this](const FAblAbilityInstance& Passive) { return Passive.IsValid() && Passive.GetAbilityNameHash() == AbilityNameHash; });
+	}
+	else if (Component->m_ActiveAbilityInstance.IsValid() && Component->m_ActiveAbilityInstance.GetAbilityNameHash() == AbilityNameHash)
+	{
+		Found = &Component->m_ActiveAbilityInstance;
+	}
+
+	// A different Context means the Ability was restarted after we queued it, the new Instance hasn't had its update yet.
+	return Found && &Found->GetContext() == Context ? Found : nullptr;
+}
+
+UAblAbilitySchedulerSubsystem::UAblAbilitySchedulerSubsystem()
+	: m_Settings(nullptr)
+{
+
+}
+
+UAblAbilitySchedulerSubsystem::~UAblAbilitySchedulerSubsystem()
+{
+
+}
+
+void UAblAbilitySchedulerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	m_Settings = GetDefault<UAbleSettings>();
+	m_TargetIndex.SetCellSize(m_Settings->GetTargetIndexCellSize());
+}
+
+void UAblAbilitySchedulerSubsystem::Deinitialize()
+{
+	for (UAblAbilityComponent* Component : m_Components)
+	{
+		if (Component)
+		{
+			Component->m_RegisteredWithScheduler = false;
+		}
+	}
+
+	m_Components.Empty();
+	m_UpdateList.Empty();
+	m_AsyncUpdates.Empty();
+	m_CooldownTable.Reset();
+	m_TargetIndex.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UAblAbilitySchedulerSubsystem::IsTickable() const
+{
+	return IsInitialized() && (m_Components.Num() > 0 || m_CooldownTable.Num() > 0 || m_TargetIndex.Num() > 0);
+}
+
+const FAblTargetIndex* UAblAbilitySchedulerSubsystem::FindTargetIndex(const UWorld* World)
+{
+	const UAblAbilitySchedulerSubsystem* Scheduler = World ? World->GetSubsystem<UAblAbilitySchedulerSubsystem>() : nullptr;
+	if (Scheduler && Scheduler->m_TargetIndex.NumIndexed() > 0)
+	{
+		return &Scheduler->m_TargetIndex;
+	}
+
+	return nullptr;
+}
+
+TStatId UAblAbilitySchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAblAbilitySchedulerSubsystem, STATGROUP_Tickables);
+}
+
+void UAblAbilitySchedulerSubsystem::RegisterComponent(UAblAbilityComponent* Component)
+{
+	if (!Component || Component->m_RegisteredWithScheduler)
+	{
+		return;
+	}
+
+	if (!m_Settings)
+	{
+		m_Settings = GetDefault<UAbleSettings>();
+	}
+
+	m_Components.Add(Component);
+	Component->m_RegisteredWithScheduler = true;
+}
+
+void UAblAbilitySchedulerSubsystem::UnregisterComponent(UAblAbilityComponent* Component)
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	m_Components.RemoveSingleSwap(Component, false);
+	Component->m_RegisteredWithScheduler = false;
+	Component->m_ScheduledAsyncUpdates = nullptr;
+	Component->m_IsProcessingUpdate = false;
+
+	// We may be mid update, don't shift the update list - just make sure we skip this component from here on out.
+	const int32 UpdateIndex = m_UpdateList.Find(Component);
+	if (UpdateIndex != INDEX_NONE)
+	{
+		m_UpdateList[UpdateIndex] = nullptr;
+	}
+
+	m_AsyncUpdates.RemoveAllSwap([Component](const FAblScheduledAsyncUpdate& Update) { return Update.Component == Component; }, false);
+}
+
+void UAblAbilitySchedulerSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AblScheduler_Tick);
+
+	{
+		// One pass for every Cooldown in the world, regardless of which components are registered.
+		SCOPE_CYCLE_COUNTER(STAT_AblScheduler_CooldownPhase);
+		SET_DWORD_STAT(STAT_AblScheduler_ActiveCooldowns, m_CooldownTable.Num());
+		m_CooldownTable.Update(DeltaTime);
+	}
+
+	if (m_TargetIndex.Num())
+	{
+		// Snapshot every Target before any Ability runs, queries this frame all see the same positions.
+		SCOPE_CYCLE_COUNTER(STAT_AblScheduler_TargetIndexPhase);
+		m_TargetIndex.Update();
+	}
+
+	// Only grab the components that actually have something to do.
+	m_UpdateList.Reset();
+	for (UAblAbilityComponent* Component : m_Components)
+	{
+		if (Component && Component->NeedsUpdate())
+		{
+			m_UpdateList.Add(Component);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_AblScheduler_RegisteredComponents, m_Components.Num());
+	SET_DWORD_STAT(STAT_AblScheduler_UpdatedComponents, m_UpdateList.Num());
+
+	if (!m_UpdateList.Num())
+	{
+		return;
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_AblScheduler_PendingPhase);
+		for (int32 i = 0; i < m_UpdateList.Num(); ++i)
+		{
+			if (UAblAbilityComponent* Component = m_UpdateList[i])
+			{
+				Component->UpdatePendingPhase();
+			}
+		}
+	}
+
+	m_AsyncUpdates.Reset();
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_AblScheduler_InstancePhase);
+		for (int32 i = 0; i < m_UpdateList.Num(); ++i)
+		{
+			if (UAblAbilityComponent* Component = m_UpdateList[i])
+			{
+				Component->m_ScheduledAsyncUpdates = &m_AsyncUpdates;
+				Component->UpdateInstancePhase(DeltaTime);
+				Component->m_ScheduledAsyncUpdates = nullptr;
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_AblScheduler_AsyncInstances, m_AsyncUpdates.Num());
+
+	if (m_AsyncUpdates.Num())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_AblScheduler_AsyncInstancePhase);
+
+		// Passives may have been added (or removed) since these were queued, so look every Instance up again now that the game thread is done changing them.
+		for (FAblScheduledAsyncUpdate& Update : m_AsyncUpdates)
+		{
+			Update.Instance = Update.ResolveInstance();
+		}
+		m_AsyncUpdates.RemoveAllSwap([](const FAblScheduledAsyncUpdate& Update) { return Update.Instance == nullptr; }, false);
+
+		// These Instances only have Async Tasks, so they're safe to run side by side. Components don't remove finished Instances until the Finish phase, so our pointers are good until then.
+		const bool ForceSingleThread = !(UAbleSettings::IsAsyncEnabled() && m_Settings && m_Settings->GetAllowAbilityAsyncUpdate());
+		ParallelFor(m_AsyncUpdates.Num(), [this](int32 Index)
+		{
+			const FAblScheduledAsyncUpdate& Update = m_AsyncUpdates[Index];
+			if (Update.Instance->IsValid())
+			{
+				Update.Instance->AsyncUpdate(Update.CurrentTime, Update.DeltaTime);
+			}
+		}, ForceSingleThread);
+
+		m_AsyncUpdates.Reset();
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_AblScheduler_FinishPhase);
+		for (int32 i = 0; i < m_UpdateList.Num(); ++i)
+		{
+			if (UAblAbilityComponent* Component = m_UpdateList[i])
+			{
+				Component->FinishUpdatePhase();
+			}
+		}
+	}
+
+	m_UpdateList.Reset();
+}
@@ -0,0 +1,410 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#include "ablTargetIndex.h"
+
+#include "ablAbilityContext.h"
+#include "AbleCorePrivate.h"
+#include "ablSettings.h"
+#include "Components/CapsuleComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Target Index Targets"), STAT_AblTargetIndex_Targets, STATGROUP_Able);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Target Index Cells"), STAT_AblTargetIndex_Cells, STATGROUP_Able);
+
+FAblTargetIndex::FAblTargetIndex()
+	: m_InvCellSize(1.0f / 500.0f),
+	m_MaxRadius(0.0f)
+{
+
+}
+
+void FAblTargetIndex::Register(AActor* Actor)
+{
+	if (!Actor || m_TargetLookup.Contains(Actor))
+	{
+		return;
+	}
+
+	FTarget Target;
+	Target.Key = Actor;
+	Target.Actor = Actor;
+	m_TargetLookup.Add(Actor, m_Targets.Add(Target));
+}
+
+void FAblTargetIndex::Unregister(AActor* Actor)
+{
+	int32 TargetIndex = INDEX_NONE;
+	if (m_TargetLookup.RemoveAndCopyValue(Actor, TargetIndex))
+	{
+		m_Targets.RemoveAt(TargetIndex);
+	}
+}
+
+void FAblTargetIndex::SetCellSize(float CellSize)
+{
+	m_InvCellSize = 1.0f / FMath::Max(CellSize, 1.0f);
+}
+
+void FAblTargetIndex::Update()
+{
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("AblTargetIndex::Update"), STAT_AblTargetIndex_Update, STATGROUP_Able);
+
+	m_SortScratch.Reset();
+	m_MaxRadius = 0.0f;
+
+	for (TSparseArray<FTarget>::TIterator ItTarget(m_Targets); ItTarget; ++ItTarget)
+	{
+		AActor* Actor = ItTarget->Actor.Get();
+		if (!Actor)
+		{
+			// Destroyed without unregistering.
+			m_TargetLookup.Remove(ItTarget->Key);
+			ItTarget.RemoveCurrent();
+			continue;
+		}
+
+		// Physics wouldn't return an Actor without query collision, so we don't either.
+		UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+		if (!Root || !Root->IsQueryCollisionEnabled())
+		{
+			continue;
+		}
+
+		FSnapshotEntry& Entry = m_SortScratch.AddDefaulted_GetRef();
+		if (const UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(Root))
+		{
+			Entry.Location = Capsule->GetComponentLocation();
+			Entry.Radius = Capsule->GetScaledCapsuleRadius();
+			Entry.HalfSegment = Capsule->GetScaledCapsuleHalfHeight_WithoutHemisphere();
+		}
+		else
+		{
+			Entry.Location = Root->Bounds.Origin;
+			Entry.Radius = Root->Bounds.SphereRadius;
+			Entry.HalfSegment = 0.0f;
+		}
+
+		Entry.CellKey = MakeCellKey(GetCellCoord(Entry.Location.X), GetCellCoord(Entry.Location.Y));
+		Entry.ObjectTypeBit = ECC_TO_BITFIELD(Root->GetCollisionObjectType());
+		Entry.Actor = ItTarget->Actor;
+		Entry.Component = Root;
+
+		m_MaxRadius = FMath::Max(m_MaxRadius, Entry.Radius);
+	}
+
+	m_SortScratch.Sort([](const FSnapshotEntry& LHS, const FSnapshotEntry& RHS) { return LHS.CellKey < RHS.CellKey; });
+
+	const int32 NumEntries = m_SortScratch.Num();
+	m_Locations.SetNumUninitialized(NumEntries, false);
+	m_Radii.SetNumUninitialized(NumEntries, false);
+	m_HalfSegments.SetNumUninitialized(NumEntries, false);
+	m_ObjectTypeBits.SetNumUninitialized(NumEntries, false);
+	m_Actors.Reset();
+	m_Components.Reset();
+	m_Cells.Reset();
+
+	int32 CellStart = 0;
+	for (int32 i = 0; i < NumEntries; ++i)
+	{
+		const FSnapshotEntry& Entry = m_SortScratch[i];
+		m_Locations[i] = Entry.Location;
+		m_Radii[i] = Entry.Radius;
+		m_HalfSegments[i] = Entry.HalfSegment;
+		m_ObjectTypeBits[i] = Entry.ObjectTypeBit;
+		m_Actors.Add(Entry.Actor);
+		m_Components.Add(Entry.Component);
+
+		if (i + 1 == NumEntries || m_SortScratch[i + 1].CellKey != Entry.CellKey)
+		{
+			m_Cells.Add(Entry.CellKey, FCell{ CellStart, i + 1 - CellStart });
+			CellStart = i + 1;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_AblTargetIndex_Targets, NumEntries);
+	SET_DWORD_STAT(STAT_AblTargetIndex_Cells, m_Cells.Num());
+}
+
+void FAblTargetIndex::Reset()
+{
+	m_Targets.Empty();
+	m_TargetLookup.Empty();
+	m_Locations.Empty();
+	m_Radii.Empty();
+	m_HalfSegments.Empty();
+	m_ObjectTypeBits.Empty();
+	m_Actors.Empty();
+	m_Components.Empty();
+	m_Cells.Empty();
+	m_SortScratch.Empty();
+	m_MaxRadius = 0.0f;
+}
+
+template<typename TestType>
+void FAblTargetIndex::QueryBounds(const FVector& Min, const FVector& Max, int32 ObjectTypeMask, TestType&& Test, TArray<FAblQueryResult>& OutResults) const
+{
+	auto TestEntry = [&](int32 Index)
+	{
+		if ((m_ObjectTypeBits[Index] & ObjectTypeMask) && Test(m_Locations[Index], m_Radii[Index], m_HalfSegments[Index]))
+		{
+			FAblQueryResult& Result = OutResults.AddDefaulted_GetRef();
+			Result.PrimitiveComponent = m_Components[Index];
+			Result.Actor = m_Actors[Index];
+		}
+	};
+
+	const int32 MinX = GetCellCoord(Min.X - m_MaxRadius);
+	const int32 MinY = GetCellCoord(Min.Y - m_MaxRadius);
+	const int32 MaxX = GetCellCoord(Max.X + m_MaxRadius);
+	const int32 MaxY = GetCellCoord(Max.Y + m_MaxRadius);
+
+	// Large queries touch more cells than we have, just walk everything.
+	const int64 NumQueryCells = (int64)(MaxX - MinX + 1) * (int64)(MaxY - MinY + 1);
+	if (NumQueryCells > m_Cells.Num())
+	{
+		for (int32 i = 0; i < m_Locations.Num(); ++i)
+		{
+			TestEntry(i);
+		}
+
+		return;
+	}
+
+	for (int32 X = MinX; X <= MaxX; ++X)
+	{
+		for (int32 Y = MinY; Y <= MaxY; ++Y)
+		{
+			if (const FCell* Cell = m_Cells.Find(MakeCellKey(X, Y)))
+			{
+				for (int32 i = Cell->Start; i < Cell->Start + Cell->Num; ++i)
+				{
+					TestEntry(i);
+				}
+			}
+		}
+	}
+}
+
+void FAblTargetIndex::QuerySphere(const FVector& Center, float Radius, int32 ObjectTypeMask, TArray<FAblQueryResult>& OutResults) const
+{
+	const FVector Extent(Radius);
+	QueryBounds(Center - Extent, Center + Extent, ObjectTypeMask, [&](const FVector& Location, float TargetRadius, float HalfSegment)
+	{
+		const FVector Segment(0.0f, 0.0f, HalfSegment);
+		return FMath::PointDistToSegmentSquared(Center, Location - Segment, Location + Segment) <= FMath::Square(Radius + TargetRadius);
+	}, OutResults);
+}
+
+void FAblTargetIndex::QueryBox(const FVector& Center, const FQuat& Rotation, const FVector& HalfExtents, int32 ObjectTypeMask, TArray<FAblQueryResult>& OutResults) const
+{
+	const FBox Bounds = FBox(-HalfExtents, HalfExtents).TransformBy(FTransform(Rotation, Center));
+	QueryBounds(Bounds.Min, Bounds.Max, ObjectTypeMask, [&](const FVector& Location, float TargetRadius, float HalfSegment)
+	{
+		// Target segment in box space.
+		const FVector Segment = Rotation.UnrotateVector(FVector(0.0f, 0.0f, HalfSegment));
+		const FVector Local = Rotation.UnrotateVector(Location - Center);
+		const FVector Start = Local - Segment;
+		const FVector End = Local + Segment;
+
+		// Closest points between a segment and a box, a few rounds of alternating projection is plenty for character sized capsules.
+		FVector OnSegment = Local;
+		FVector OnBox = OnSegment.BoundToBox(-HalfExtents, HalfExtents);
+		for (int32 Iteration = 0; Iteration < 3 && HalfSegment > 0.0f; ++Iteration)
+		{
+			OnSegment = FMath::ClosestPointOnSegment(OnBox, Start, End);
+			OnBox = OnSegment.BoundToBox(-HalfExtents, HalfExtents);
+		}
+
+		return FVector::DistSquared(OnSegment, OnBox) <= FMath::Square(TargetRadius);
+	}, OutResults);
+}
+
+void FAblTargetIndex::QueryCapsule(const FVector& Center, const FQuat& Rotation, float Radius, float HalfHeight, int32 ObjectTypeMask, TArray<FAblQueryResult>& OutResults) const
+{
+	const FVector QuerySegment = Rotation.GetUpVector() * FMath::Max(HalfHeight - Radius, 0.0f);
+	const FVector QueryStart = Center - QuerySegment;
+	const FVector QueryEnd = Center + QuerySegment;
+	const FVector Extent = QuerySegment.GetAbs() + FVector(Radius);
+
+	QueryBounds(Center - Extent, Center + Extent, ObjectTypeMask, [&](const FVector& Location, float TargetRadius, float HalfSegment)
+	{
+		const FVector Segment(0.0f, 0.0f, HalfSegment);
+		FVector OnQuery, OnTarget;
+		FMath::SegmentDistToSegmentSafe(QueryStart, QueryEnd, Location - Segment, Location + Segment, OnQuery, OnTarget);
+		return FVector::DistSquared(OnQuery, OnTarget) <= FMath::Square(Radius + TargetRadius);
+	}, OutResults);
+}
+
+#if !UE_BUILD_SHIPPING
+
+/* Spawns capsule Actors (Pawn object type) well below the level, waits a couple of frames so the physics scene picks them up, then runs the same
+ * sphere queries against the physics scene and a FAblTargetIndex and logs the cost of each. Runs once per Actor count. */
+struct FAblTargetIndexBenchmark
+{
+	static constexpr int32 NumQueries = 1000;
+	static constexpr float QueryRadius = 500.0f;
+
+	TWeakObjectPtr<UWorld> World;
+	TArray<int32> ActorCounts;
+	int32 CountIndex = 0;
+	int32 FramesToWait = 0;
+	float HalfSize = 0.0f;
+	TArray<TWeakObjectPtr<AActor>> Actors;
+
+	bool Tick(float DeltaTime)
+	{
+		UWorld* BenchWorld = World.Get();
+		if (!BenchWorld || CountIndex >= ActorCounts.Num())
+		{
+			Cleanup();
+			return false;
+		}
+
+		if (!Actors.Num())
+		{
+			Spawn(*BenchWorld, ActorCounts[CountIndex]);
+			FramesToWait = 2;
+			return true;
+		}
+
+		if (FramesToWait-- > 0)
+		{
+			return true;
+		}
+
+		Run(*BenchWorld);
+		Cleanup();
+
+		return ++CountIndex < ActorCounts.Num();
+	}
+
+	FVector GetOrigin() const { return FVector(0.0f, 0.0f, -100000.0f); }
+
+	void Spawn(UWorld& BenchWorld, int32 NumActors)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		// Roughly one Actor per 3m x 3m.
+		HalfSize = FMath::Sqrt((float)NumActors) * 150.0f;
+		FRandomStream Stream(NumActors);
+
+		for (int32 i = 0; i < NumActors; ++i)
+		{
+			const FVector Location = GetOrigin() + FVector(Stream.FRandRange(-HalfSize, HalfSize), Stream.FRandRange(-HalfSize, HalfSize), 0.0f);
+			AActor* Actor = BenchWorld.SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location), SpawnParams);
+			if (!Actor)
+			{
+				continue;
+			}
+
+			UCapsuleComponent* Capsule = NewObject<UCapsuleComponent>(Actor);
+			Capsule->InitCapsuleSize(34.0f, 88.0f);
+			Capsule->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+			Capsule->SetCollisionObjectType(ECC_Pawn);
+			Actor->SetRootComponent(Capsule);
+			Capsule->RegisterComponent();
+			Capsule->SetWorldLocation(Location);
+
+			Actors.Add(Actor);
+		}
+	}
+
+	void Run(UWorld& BenchWorld)
+	{
+		FAblTargetIndex TargetIndex;
+		TargetIndex.SetCellSize(GetDefault<UAbleSettings>()->GetTargetIndexCellSize());
+		for (const TWeakObjectPtr<AActor>& Actor : Actors)
+		{
+			TargetIndex.Register(Actor.Get());
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		TargetIndex.Update();
+		const double UpdateMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		TArray<FVector> Centers;
+		FRandomStream Stream(NumQueries);
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			Centers.Add(GetOrigin() + FVector(Stream.FRandRange(-HalfSize, HalfSize), Stream.FRandRange(-HalfSize, HalfSize), 0.0f));
+		}
+
+		const FCollisionObjectQueryParams ObjectQuery(ECC_Pawn);
+		const FCollisionShape Sphere = FCollisionShape::MakeSphere(QueryRadius);
+
+		int32 PhysicsHits = 0;
+		TArray<FOverlapResult> Overlaps;
+		StartTime = FPlatformTime::Seconds();
+		for (const FVector& Center : Centers)
+		{
+			Overlaps.Reset();
+			BenchWorld.OverlapMultiByObjectType(Overlaps, Center, FQuat::Identity, ObjectQuery, Sphere);
+			PhysicsHits += Overlaps.Num();
+		}
+		const double PhysicsMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		int32 IndexHits = 0;
+		TArray<FAblQueryResult> Results;
+		StartTime = FPlatformTime::Seconds();
+		for (const FVector& Center : Centers)
+		{
+			Results.Reset();
+			TargetIndex.QuerySphere(Center, QueryRadius, ObjectQuery.GetQueryBitfield(), Results);
+			IndexHits += Results.Num();
+		}
+		const double IndexMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		UE_LOG(LogAble, Display, TEXT("Able.BenchTargetIndex: %d Actors, %d sphere queries (r=%.0f). Physics: %.3f ms (%d hits). Target Index: %.3f ms (%d hits) + %.3f ms update."),
+			Actors.Num(), NumQueries, QueryRadius, PhysicsMs, PhysicsHits, IndexMs, IndexHits, UpdateMs);
+	}
+
+	void Cleanup()
+	{
+		for (const TWeakObjectPtr<AActor>& Actor : Actors)
+		{
+			if (Actor.IsValid())
+			{
+				Actor->Destroy();
+			}
+		}
+		Actors.Empty();
+	}
+};
+
+static void BenchTargetIndex(const TArray<FString>& Args, UWorld* World)
+{
+	if (!World)
+	{
+		return;
+	}
+
+	TSharedRef<FAblTargetIndexBenchmark> Benchmark = MakeShared<FAblTargetIndexBenchmark>();
+	Benchmark->World = World;
+	for (const FString& Arg : Args)
+	{
+		Benchmark->ActorCounts.Add(FMath::Max(FCString::Atoi(*Arg), 1));
+	}
+
+	if (!Benchmark->ActorCounts.Num())
+	{
+		Benchmark->ActorCounts = { 500, 2000 };
+	}
+
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Benchmark](float DeltaTime)
+	{
+		return Benchmark->Tick(DeltaTime);
+	}));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchTargetIndexCommand(
+	TEXT("Able.BenchTargetIndex"),
+	TEXT("Compares sphere queries against the physics scene with the same queries against a Target Index, using temporary capsule Actors. Args: [NumActors...] (default 500 2000)"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchTargetIndex));
+
+#endif
@@ -50,6 +50,7 @@ namespace UnrealBuildTool.Rules
                     "AdvancedPreviewScene",
                     "AnimGraph",
                     "ApplicationCore",
+                    "AssetRegistry",
                     "AssetTools",
 					"BlueprintGraph",
 					"ClassViewer",
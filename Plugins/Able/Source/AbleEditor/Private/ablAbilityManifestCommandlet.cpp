@@ -0,0 +1,168 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#include "ablAbilityManifestCommandlet.h"
+
+#include "ablAbility.h"
+#include "ablAbilityDependencies.h"
+#include "AbleEditorPrivate.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/Blueprint.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "Tasks/IAblAbilityTask.h"
+#include "ablSettings.h"
+#include "UObject/UObjectHash.h"
+
+UAblAbilityManifestCommandlet::UAblAbilityManifestCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UAblAbilityManifestCommandlet::Main(const FString& Params)
+{
+	FString PathsParam = TEXT("/Game/Skill");
+	FParse::Value(*Params, TEXT("Paths="), PathsParam);
+
+	FString OutputPath = FPaths::ProjectContentDir() / TEXT("Skill/AbilityManifest.json");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	FString ReportPath;
+	const bool Report = FParse::Value(*Params, TEXT("Report="), ReportPath) || FParse::Param(*Params, TEXT("Report"));
+
+	TArray<FString> Paths;
+	PathsParam.ParseIntoArray(Paths, TEXT("+"));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.bRecursivePaths = true;
+	Filter.bRecursiveClasses = true;
+	Filter.ClassNames.Add(UBlueprint::StaticClass()->GetFName());
+	for (const FString& Path : Paths)
+	{
+		Filter.PackagePaths.Add(FName(*Path));
+	}
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	FAblAbilityManifest Manifest;
+	int32 NumAssets = 0;
+
+	const bool StripClientTasks = GetDefault<UAbleSettings>()->GetStripClientTasksOnServer();
+
+	FString ReportCSV = TEXT("Ability,ClientTasks,TaskBytes,CosmeticAssets,CosmeticDiskBytes\n");
+	FServerStripReport ReportTotal;
+	for (const FAssetData& Asset : Assets)
+	{
+		const UBlueprint* Blueprint = Cast<UBlueprint>(Asset.GetAsset());
+		const UClass* AbilityClass = Blueprint ? Blueprint->GeneratedClass : nullptr;
+		if (!AbilityClass || !AbilityClass->IsChildOf(UAblAbility::StaticClass()))
+		{
+			continue;
+		}
+
+		const UAblAbility* Ability = AbilityClass->GetDefaultObject<UAblAbility>();
+		FAblAbilityDependencies Dependencies;
+		FAblAbilityDependencies::Gather(*Ability, Dependencies);
+		UE_LOG(LogAbleEditor, Display, TEXT("%s: %d gameplay, %d cosmetic assets."), *AbilityClass->GetPathName(), Dependencies.m_Gameplay.Num(), Dependencies.m_Cosmetic.Num());
+
+		// Server cooks strip client Tasks, anything on the server waiting on one never starts (as it never would have).
+		for (const UAblAbilityTask* Task : Ability->GetTasks())
+		{
+			if (!StripClientTasks || !Task || Task->GetTaskRealm() == EAblAbilityTaskRealm::ATR_Client)
+			{
+				continue;
+			}
+
+			for (const UAblAbilityTask* Dependency : Task->GetTaskDependencies())
+			{
+				if (Dependency && Dependency->GetTaskRealm() == EAblAbilityTaskRealm::ATR_Client)
+				{
+					UE_LOG(LogAbleEditor, Warning, TEXT("%s: %s depends on client Task %s and will never start on the server."),
+						*AbilityClass->GetPathName(), *Task->GetName(), *Dependency->GetName());
+				}
+			}
+		}
+
+		if (Report)
+		{
+			const FServerStripReport AbilityReport = BuildServerStripReport(*Ability, Dependencies, AssetRegistry);
+			UE_LOG(LogAbleEditor, Display, TEXT("%s: server strips %d client Tasks (%lld bytes), %d cosmetic assets (%lld bytes on disk)."),
+				*AbilityClass->GetPathName(), AbilityReport.m_ClientTasks, AbilityReport.m_TaskBytes, Dependencies.m_Cosmetic.Num(), AbilityReport.m_CosmeticDiskBytes);
+
+			ReportCSV += FString::Printf(TEXT("%s,%d,%lld,%d,%lld\n"), *AbilityClass->GetPathName(), AbilityReport.m_ClientTasks, AbilityReport.m_TaskBytes, Dependencies.m_Cosmetic.Num(), AbilityReport.m_CosmeticDiskBytes);
+			ReportTotal.m_ClientTasks += AbilityReport.m_ClientTasks;
+			ReportTotal.m_TaskBytes += AbilityReport.m_TaskBytes;
+			ReportTotal.m_CosmeticDiskBytes += AbilityReport.m_CosmeticDiskBytes;
+		}
+
+		NumAssets += Dependencies.m_Gameplay.Num() + Dependencies.m_Cosmetic.Num();
+		Manifest.Add(FSoftObjectPath(AbilityClass), MoveTemp(Dependencies));
+	}
+
+	if (!Manifest.SaveToFile(OutputPath))
+	{
+		UE_LOG(LogAbleEditor, Error, TEXT("Failed to write Ability manifest %s."), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogAbleEditor, Display, TEXT("Wrote %d Abilities (%d asset references) to %s."), Manifest.Num(), NumAssets, *OutputPath);
+
+	if (Report)
+	{
+		// Cosmetic assets shared between Abilities are counted once per Ability, so the disk total is an upper bound.
+		UE_LOG(LogAbleEditor, Display, TEXT("Server stripping total: %d client Tasks (%lld bytes), up to %lld bytes of cosmetic assets."),
+			ReportTotal.m_ClientTasks, ReportTotal.m_TaskBytes, ReportTotal.m_CosmeticDiskBytes);
+
+		if (!ReportPath.IsEmpty() && !FFileHelper::SaveStringToFile(ReportCSV, *ReportPath))
+		{
+			UE_LOG(LogAbleEditor, Error, TEXT("Failed to write server strip report %s."), *ReportPath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+UAblAbilityManifestCommandlet::FServerStripReport UAblAbilityManifestCommandlet::BuildServerStripReport(const UAblAbility& Ability, const FAblAbilityDependencies& Dependencies, const IAssetRegistry& AssetRegistry)
+{
+	FServerStripReport Report;
+
+	// Same rule as UAblAbilityTask::NeedsLoadForServer.
+	for (const UAblAbilityTask* Task : Ability.GetTasks())
+	{
+		if (!Task || Task->GetTaskRealm() != EAblAbilityTaskRealm::ATR_Client)
+		{
+			continue;
+		}
+
+		++Report.m_ClientTasks;
+
+		// Instanced sub objects (Targeting, Queries, etc) go with their Task.
+		TArray<UObject*> TaskObjects;
+		TaskObjects.Add(const_cast<UAblAbilityTask*>(Task));
+		GetObjectsWithOuter(Task, TaskObjects, true);
+		for (UObject* TaskObject : TaskObjects)
+		{
+			FArchiveCountMem CountMem(TaskObject);
+			Report.m_TaskBytes += CountMem.GetMax();
+		}
+	}
+
+	for (const FSoftObjectPath& Asset : Dependencies.m_Cosmetic)
+	{
+		const TOptional<FAssetPackageData> PackageData = AssetRegistry.GetAssetPackageDataCopy(FName(*Asset.GetLongPackageName()));
+		if (PackageData.IsSet() && PackageData->DiskSize > 0)
+		{
+			Report.m_CosmeticDiskBytes += PackageData->DiskSize;
+		}
+	}
+
+	return Report;
+}
@@ -0,0 +1,37 @@
+// Copyright (c) Extra Life Studios, LLC. All rights reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "ablAbilityManifestCommandlet.generated.h"
+
+class IAssetRegistry;
+class UAblAbility;
+struct FAblAbilityDependencies;
+
+/* Writes the Ability dependency manifest read by the game at runtime. Run before cooking:
+ *   UnrealEditor-Cmd <Project>.uproject -run=AblAbilityManifest [-Paths=/Game/Skill+/Game/Other] [-Output=<File>] [-Report[=<File>]]
+ * Paths defaults to /Game/Skill, Output to <Project>/Content/Skill/AbilityManifest.json.
+ * Report logs what stripping client Tasks saves each Ability on the server (see UAbleSettings), and writes it as CSV when given a file. */
+UCLASS()
+class UAblAbilityManifestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAblAbilityManifestCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/* Client Task count, serialized Task bytes and on disk size of the cosmetic assets an Ability leaves out of server cooks. */
+	struct FServerStripReport
+	{
+		int32 m_ClientTasks = 0;
+		int64 m_TaskBytes = 0;
+		int64 m_CosmeticDiskBytes = 0;
+	};
+
+	static FServerStripReport BuildServerStripReport(const UAblAbility& Ability, const FAblAbilityDependencies& Dependencies, const IAssetRegistry& AssetRegistry);
+};
@@ -0,0 +1,246 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GFootIKSubsystem.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "HAL/IConsoleManager.h"
+#include "ThirdPersonCharacter.h"
+
+DECLARE_STATS_GROUP(TEXT("GFootIK"), STATGROUP_GFootIK, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Tick"), STAT_GFootIK_Tick, STATGROUP_GFootIK);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Characters"), STAT_GFootIK_Characters, STATGROUP_GFootIK);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Skipped (Offscreen)"), STAT_GFootIK_Skipped, STATGROUP_GFootIK);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Traces Per Frame"), STAT_GFootIK_Traces, STATGROUP_GFootIK);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Sync ClacIK (ms)"), STAT_GFootIK_SyncMs, STATGROUP_GFootIK);
+
+const FName UGFootIKSubsystem::LeftFootName(TEXT("foot_l"));
+const FName UGFootIKSubsystem::RightFootName(TEXT("foot_r"));
+
+UGFootIKSubsystem* UGFootIKSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UGFootIKSubsystem>() : nullptr;
+}
+
+bool UGFootIKSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	//专用服务器不渲染, 不需要脚部 IK
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGFootIKSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	EntryLookup.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UGFootIKSubsystem::IsTickable() const
+{
+	return IsInitialized() && Entries.Num() > 0;
+}
+
+TStatId UGFootIKSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGFootIKSubsystem, STATGROUP_Tickables);
+}
+
+void UGFootIKSubsystem::Request(AThirdPersonCharacter* Character)
+{
+	if (!Character)
+	{
+		return;
+	}
+
+	int32& Index = EntryLookup.FindOrAdd(Character, INDEX_NONE);
+	if (Index == INDEX_NONE)
+	{
+		Index = Entries.AddDefaulted();
+		Entries[Index].Character = Character;
+	}
+
+	Entries[Index].RequestFrame = GFrameCounter;
+}
+
+void UGFootIKSubsystem::AddSyncSample(double Seconds)
+{
+	Stats.SyncSeconds += Seconds;
+	++Stats.SyncCharacterFrames;
+	INC_FLOAT_STAT_BY(STAT_GFootIK_SyncMs, Seconds * 1000.0);
+}
+
+void UGFootIKSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GFootIK_Tick);
+
+	const double StartTime = FPlatformTime::Seconds();
+	Stats.Characters = 0;
+	Stats.Skipped = 0;
+	Stats.Traces = 0;
+
+	for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+	{
+		FEntry& Entry = Entries[Index];
+		AThirdPersonCharacter* Character = Entry.Character.Get();
+		if (!Character)
+		{
+			RemoveEntry(Index);
+			continue;
+		}
+
+		//蓝图这一帧没有调用 ClacIK, 保持当前的偏移, 旧的射线结果也不再使用
+		if (GFrameCounter - Entry.RequestFrame > 1)
+		{
+			Entry.bPending = false;
+			continue;
+		}
+
+		++Stats.Characters;
+
+		//先应用上一帧提交的射线, 再提交这一帧的
+		Consume(Entry, *Character, DeltaTime);
+
+		const USkeletalMeshComponent* Mesh = Character->GetMesh();
+		if (!Mesh || !Mesh->WasRecentlyRendered(OffscreenGraceSeconds))
+		{
+			++Stats.Skipped;
+			continue;
+		}
+
+		if (Submit(Entry, *Character))
+		{
+			Stats.Traces += UE_ARRAY_COUNT(Entry.Feet);
+		}
+	}
+
+	Stats.AsyncSeconds += FPlatformTime::Seconds() - StartTime;
+	Stats.AsyncCharacterFrames += Stats.Characters;
+
+	SET_DWORD_STAT(STAT_GFootIK_Characters, Stats.Characters);
+	SET_DWORD_STAT(STAT_GFootIK_Skipped, Stats.Skipped);
+	SET_DWORD_STAT(STAT_GFootIK_Traces, Stats.Traces);
+}
+
+void UGFootIKSubsystem::RemoveEntry(int32 Index)
+{
+	EntryLookup.Remove(Entries[Index].Character);
+	Entries.RemoveAtSwap(Index);
+	if (Entries.IsValidIndex(Index))
+	{
+		EntryLookup.Add(Entries[Index].Character, Index);
+	}
+}
+
+void UGFootIKSubsystem::Consume(FEntry& Entry, AThirdPersonCharacter& Character, float DeltaTime) const
+{
+	if (!Entry.bPending)
+	{
+		return;
+	}
+	Entry.bPending = false;
+
+	//射线结果只保留一帧, 中间跳过了就丢掉, 保持当前的偏移
+	UWorld* World = GetWorld();
+	FTraceDatum Left;
+	FTraceDatum Right;
+	if (!World->QueryTraceData(Entry.Feet[0].Trace, Left) || !World->QueryTraceData(Entry.Feet[1].Trace, Right))
+	{
+		return;
+	}
+
+	const FHitResult* LeftHit = Left.OutHits.Num() > 0 && Left.OutHits[0].bBlockingHit ? &Left.OutHits[0] : nullptr;
+	const FHitResult* RightHit = Right.OutHits.Num() > 0 && Right.OutHits[0].bBlockingHit ? &Right.OutHits[0] : nullptr;
+	Character.ApplyFootIK(LeftHit, RightHit, Entry.BaseZ, DeltaTime);
+}
+
+bool UGFootIKSubsystem::Submit(FEntry& Entry, AThirdPersonCharacter& Character)
+{
+	const USkeletalMeshComponent* Mesh = Character.GetMesh();
+	if (Entry.ResolvedMesh.Get() != Mesh->SkeletalMesh)
+	{
+		Entry.ResolvedMesh = Mesh->SkeletalMesh;
+		Entry.bFeetValid = ResolveFeet(Entry, *Mesh);
+	}
+
+	if (!Entry.bFeetValid)
+	{
+		return false;
+	}
+
+	UWorld* World = GetWorld();
+	const FVector MeshLocation = Mesh->GetComponentLocation();
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GFootIK), true, &Character);
+	for (FFoot& Foot : Entry.Feet)
+	{
+		const FVector FootLocation = GetFootLocation(Foot, *Mesh);
+		const FVector Start(FootLocation.X, FootLocation.Y, MeshLocation.Z + TraceAbove);
+		const FVector End(FootLocation.X, FootLocation.Y, MeshLocation.Z - TraceBelow);
+		Foot.Trace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, ECC_Visibility, QueryParams);
+	}
+
+	Entry.BaseZ = MeshLocation.Z;
+	Entry.bPending = true;
+	return true;
+}
+
+bool UGFootIKSubsystem::ResolveFeet(FEntry& Entry, const USkeletalMeshComponent& Mesh)
+{
+	Entry.Feet[0].Name = LeftFootName;
+	Entry.Feet[1].Name = RightFootName;
+
+	//和 DoesSocketExist / GetSocketLocation 一样, 先找 Socket, 没有再找同名骨骼
+	for (FFoot& Foot : Entry.Feet)
+	{
+		Foot.Socket = Mesh.SkeletalMesh ? Mesh.SkeletalMesh->FindSocket(Foot.Name) : nullptr;
+		Foot.BoneIndex = Foot.Socket.IsValid() ? INDEX_NONE : Mesh.GetBoneIndex(Foot.Name);
+		if (!Foot.Socket.IsValid() && Foot.BoneIndex == INDEX_NONE)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+FVector UGFootIKSubsystem::GetFootLocation(const FFoot& Foot, const USkeletalMeshComponent& Mesh)
+{
+	if (const USkeletalMeshSocket* Socket = Foot.Socket.Get())
+	{
+		return Socket->GetSocketLocation(&Mesh);
+	}
+
+	return Mesh.GetBoneTransform(Foot.BoneIndex).GetLocation();
+}
+
+void UGFootIKSubsystem::DumpStats() const
+{
+	const double AsyncUs = Stats.AsyncCharacterFrames > 0 ? Stats.AsyncSeconds * 1000000.0 / Stats.AsyncCharacterFrames : 0.0;
+	const double SyncUs = Stats.SyncCharacterFrames > 0 ? Stats.SyncSeconds * 1000000.0 / Stats.SyncCharacterFrames : 0.0;
+
+	UE_LOG(LogTemp, Display, TEXT("FootIK: %d characters, %d skipped offscreen, %d traces this frame."), Stats.Characters, Stats.Skipped, Stats.Traces);
+	UE_LOG(LogTemp, Display, TEXT("FootIK: game thread per character, async %.2f us (%lld samples), sync ClacIK %.2f us (%lld samples)."),
+		AsyncUs, Stats.AsyncCharacterFrames, SyncUs, Stats.SyncCharacterFrames);
+
+	//同步的样本来自关闭了 bUseFootIKService 的角色, 两边都有数据时才能估算
+	if (Stats.AsyncCharacterFrames > 0 && Stats.SyncCharacterFrames > 0)
+	{
+		UE_LOG(LogTemp, Display, TEXT("FootIK: estimated game thread saving at %d characters: %.3f ms/frame."), Stats.Characters, (SyncUs - AsyncUs) * Stats.Characters / 1000.0);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld GFootIKStatsCommand(
+	TEXT("G.FootIK.Stats"),
+	TEXT("Logs foot IK traces per frame and the game thread cost of the async service against the sync ClacIK."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UGFootIKSubsystem* FootIK = UGFootIKSubsystem::Get(World))
+		{
+			FootIK->DumpStats();
+		}
+	}));
+#endif
@@ -0,0 +1,105 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GFootIKSubsystem.generated.h"
+
+class AThirdPersonCharacter;
+class USkeletalMesh;
+class USkeletalMeshComponent;
+class USkeletalMeshSocket;
+
+struct FGFootIKStats
+{
+	//本帧请求脚部 IK 的角色
+	int32 Characters = 0;
+
+	//本帧不可见被跳过的角色
+	int32 Skipped = 0;
+
+	//本帧提交的异步射线
+	int32 Traces = 0;
+
+	//累计耗时, 用于和旧的同步 ClacIK 对比
+	double AsyncSeconds = 0.0;
+	int64 AsyncCharacterFrames = 0;
+	double SyncSeconds = 0.0;
+	int64 SyncCharacterFrames = 0;
+};
+
+/**
+ * Foot placement for every AThirdPersonCharacter in a world. Characters ask for it through ClacIK each frame; once per frame
+ * the subsystem submits both foot rays of every visible character as async traces, and applies the previous frame's results
+ * with the same interpolation ClacIK used. Foot sockets are resolved once per skeletal mesh. Not created on dedicated servers.
+ */
+UCLASS(Config = Game)
+class THIRDPERSON_API UGFootIKSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//射线起点在 Mesh 上方, 终点在 Mesh 下方的距离, 同步的 ClacIK 也用这些
+	static constexpr float TraceAbove = 50.0f;
+	static constexpr float TraceBelow = 75.0f;
+	static const FName LeftFootName;
+	static const FName RightFootName;
+
+	static UGFootIKSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	//角色本帧需要脚部 IK, 由 ClacIK 调用. 本帧提交射线, 结果在下一帧应用
+	void Request(AThirdPersonCharacter* Character);
+
+	//记录一次同步 ClacIK 的耗时
+	void AddSyncSample(double Seconds);
+
+	const FGFootIKStats& GetStats() const { return Stats; }
+
+	void DumpStats() const;
+
+private:
+	struct FFoot
+	{
+		FName Name;
+		int32 BoneIndex = INDEX_NONE;
+		TWeakObjectPtr<const USkeletalMeshSocket> Socket;
+		FTraceHandle Trace;
+	};
+
+	struct FEntry
+	{
+		TWeakObjectPtr<AThirdPersonCharacter> Character;
+		TWeakObjectPtr<USkeletalMesh> ResolvedMesh;
+		FFoot Feet[2];
+		//提交射线时 Mesh 的高度, 命中点相对它计算偏移
+		float BaseZ = 0.0f;
+		uint64 RequestFrame = 0;
+		bool bFeetValid = false;
+		bool bPending = false;
+	};
+
+	void RemoveEntry(int32 Index);
+	void Consume(FEntry& Entry, AThirdPersonCharacter& Character, float DeltaTime) const;
+	bool Submit(FEntry& Entry, AThirdPersonCharacter& Character);
+	static bool ResolveFeet(FEntry& Entry, const USkeletalMeshComponent& Mesh);
+	static FVector GetFootLocation(const FFoot& Foot, const USkeletalMeshComponent& Mesh);
+
+private:
+	//超过这个时间没有渲染的角色不做检测
+	UPROPERTY(Config)
+	float OffscreenGraceSeconds = 0.2f;
+
+	TArray<FEntry> Entries;
+	TMap<TWeakObjectPtr<AThirdPersonCharacter>, int32> EntryLookup;
+	FGFootIKStats Stats;
+};
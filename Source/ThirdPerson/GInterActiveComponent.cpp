@@ -1,15 +1,16 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 #include "GInterActiveComponent.h"
+#include "GInteractionSubsystem.h"
 #include "ThirdPersonCharacter.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include "Net/UnrealNetwork.h"
 
 
 // Sets default values for this component's properties
 UGInterActiveComponent::UGInterActiveComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
+	// Range checks and nearest lookups go through UGInteractionSubsystem, so this doesn't need to tick.
+	PrimaryComponentTick.bCanEverTick = false;
 
 	// ...
 	//SetIsReplicated(true);
@@ -26,21 +27,82 @@ void UGInterActiveComponent::BeginPlay()
 	{
 		OwnerRootComponent = GetOwner()->GetRootComponent();
 	}
-}
 
+	AActor* Owner = GetOwner();
+	if (bDormantWhenIdle && Owner && Owner->HasAuthority() && m_nCurInteractGuid == 0)
+	{
+		Owner->SetNetDormancy(DORM_DormantAll);
+	}
 
-// Called every frame
-void UGInterActiveComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+	if (UGInteractionSubsystem* Interaction = UGInteractionSubsystem::Get(this))
+	{
+		Interaction->Register(this, GetOwnerLocation(), Distance);
+
+		// Static roots never move, everything else keeps its cell up to date.
+		if (OwnerRootComponent.IsValid() && OwnerRootComponent->Mobility != EComponentMobility::Static)
+		{
+			OwnerRootComponent->TransformUpdated.AddUObject(this, &UGInterActiveComponent::OnOwnerMoved);
+		}
+	}
+}
+
+void UGInterActiveComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (OwnerRootComponent.IsValid())
+	{
+		OwnerRootComponent->TransformUpdated.RemoveAll(this);
+	}
 
-	// ...
+	if (UGInteractionSubsystem* Interaction = UGInteractionSubsystem::Get(this))
+	{
+		Interaction->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGInterActiveComponent::OnOwnerMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (UGInteractionSubsystem* Interaction = UGInteractionSubsystem::Get(this))
+	{
+		Interaction->UpdateLocation(this, UpdatedComponent->GetComponentLocation());
+	}
 }
 
 void UGInterActiveComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	DOREPLIFETIME(UGInterActiveComponent, m_nCurInteractGuid);
+
+	// Only written by SetInteractGuid, which marks it dirty.
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UGInterActiveComponent, m_nCurInteractGuid, Params);
+}
+
+void UGInterActiveComponent::SetInteractGuid(int64 guid)
+{
+	if (m_nCurInteractGuid == (uint64)guid)
+	{
+		return;
+	}
+
+	AActor* Owner = GetOwner();
+	const bool bManageDormancy = bDormantWhenIdle && Owner && Owner->HasAuthority();
+
+	// Wake up before the change so it goes out with the reopened channel.
+	if (bManageDormancy && guid != 0)
+	{
+		Owner->SetNetDormancy(DORM_Awake);
+	}
+
+	m_nCurInteractGuid = guid;
+	MARK_PROPERTY_DIRTY_FROM_NAME(UGInterActiveComponent, m_nCurInteractGuid, this);
+
+	// Idle again. The channel sends this last change before it goes dormant.
+	if (bManageDormancy && guid == 0)
+	{
+		Owner->SetNetDormancy(DORM_DormantAll);
+	}
 }
 
 void UGInterActiveComponent::OnReq_CurInteractGuid()
@@ -81,12 +143,37 @@ bool UGInterActiveComponent::CanInteractive(AThirdPersonCharacter* player)
 		return false;
 	}
 
+	// The HandleInteractive server RPC comes through here too, so only components in the index (between BeginPlay and EndPlay) pass.
+	if (const UGInteractionSubsystem* Interaction = UGInteractionSubsystem::Get(this))
+	{
+		return Interaction->IsInRange(this, player->GetActorLocation());
+	}
+
+	if (!OwnerRootComponent.IsValid())
+	{
+		return false;
+	}
+
 	float dis = FVector::Distance(OwnerRootComponent->GetComponentLocation(), player->GetActorLocation());
 	return dis < Distance;
 }
 
 
-FVector UGInterActiveComponent::GetOwnerLocation()
+void UGInterActiveComponent::SetDistance(float NewDistance)
+{
+	Distance = NewDistance;
+	if (!HasBegunPlay())
+	{
+		return;
+	}
+
+	if (UGInteractionSubsystem* Interaction = UGInteractionSubsystem::Get(this))
+	{
+		Interaction->Register(this, GetOwnerLocation(), Distance);
+	}
+}
+
+FVector UGInterActiveComponent::GetOwnerLocation() const
 {
 	if (!OwnerRootComponent.IsValid())
 	{
@@ -20,10 +20,9 @@ public:
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	UFUNCTION(BlueprintCallable)
@@ -34,11 +33,22 @@ public:
 		bool CanInteractive(AThirdPersonCharacter* player);
 
 	UFUNCTION(BlueprintCallable)
-		void SetInteractGuid(int64 guid) { m_nCurInteractGuid = guid; };
+		void SetInteractGuid(int64 guid);
 
-	FVector GetOwnerLocation();
+	int64 GetInteractGuid() const { return m_nCurInteractGuid; }
+
+	FVector GetOwnerLocation() const;
+
+	/** ޸Ľ룬ѾBeginPlayʱµǼǵUGInteractionSubsystem */
+	UFUNCTION(BlueprintCallable, Category = "InterActive")
+		void SetDistance(float NewDistance);
+
+	float GetDistance() const { return Distance; }
 
 private:
+	/** ƶĸƶ½ */
+	void OnOwnerMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
 	/** RepNotifyͬInteractGuid */
 	UFUNCTION()
 		void OnReq_CurInteractGuid();
@@ -46,7 +56,12 @@ private:
 protected:
 	TWeakObjectPtr<USceneComponent> OwnerRootComponent;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InterActive")
+	/** ûҽʱOwner(DORM_DormantAll)ٲͬOwnerͬ״̬޸ǰҪԼFlushNetDormancy */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "InterActive")
+		bool bDormantWhenIdle = false;
+
+	/** 룬ǼUGInteractionSubsystemʱͨSetDistance޸ */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetDistance, Category = "InterActive")
 		float Distance = 150;
 
 	/** ǰҵΨһʶ*/
@@ -0,0 +1,261 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GInteractionSubsystem.h"
+
+#include "Engine/World.h"
+#include "GInterActiveComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "ThirdPersonCharacter.h"
+#include "UObject/UObjectIterator.h"
+
+UGInteractionSubsystem* UGInteractionSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UGInteractionSubsystem>() : nullptr;
+}
+
+bool UGInteractionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGInteractionSubsystem::Deinitialize()
+{
+	Cells.Empty();
+	ComponentCells.Empty();
+	MaxDistance = 0.0f;
+
+	Super::Deinitialize();
+}
+
+void UGInteractionSubsystem::Register(UGInterActiveComponent* Component, const FVector& Location, float Distance)
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	Unregister(Component);
+
+	const FIntPoint Cell = GetCell(Location);
+	Cells.FindOrAdd(Cell).Add({ Component, Location, Distance });
+	ComponentCells.Add(Component, Cell);
+	MaxDistance = FMath::Max(MaxDistance, Distance);
+}
+
+void UGInteractionSubsystem::Unregister(UGInterActiveComponent* Component)
+{
+	FIntPoint Cell;
+	if (ComponentCells.RemoveAndCopyValue(Component, Cell))
+	{
+		RemoveFromCell(Component, Cell);
+	}
+}
+
+void UGInteractionSubsystem::UpdateLocation(UGInterActiveComponent* Component, const FVector& Location)
+{
+	FIntPoint* Cell = ComponentCells.Find(Component);
+	if (!Cell)
+	{
+		return;
+	}
+
+	TArray<FItem>& Items = Cells.FindChecked(*Cell);
+	const int32 Index = Items.IndexOfByPredicate([Component](const FItem& Item) { return Item.Component == Component; });
+	check(Index != INDEX_NONE);
+
+	const FIntPoint NewCell = GetCell(Location);
+	if (NewCell == *Cell)
+	{
+		Items[Index].Location = Location;
+		return;
+	}
+
+	//换格子
+	FItem Item = Items[Index];
+	Item.Location = Location;
+	RemoveFromCell(Component, *Cell);
+	Cells.FindOrAdd(NewCell).Add(Item);
+	*Cell = NewCell;
+}
+
+UGInterActiveComponent* UGInteractionSubsystem::FindNearest(AThirdPersonCharacter* Player) const
+{
+	return Player ? FindNearestAt(Player->GetActorLocation()) : nullptr;
+}
+
+UGInterActiveComponent* UGInteractionSubsystem::FindNearestAt(const FVector& Location, bool bOnlyAvailable) const
+{
+	if (ComponentCells.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	const FIntPoint Center = GetCell(Location);
+	const int32 Reach = FMath::Max(FMath::CeilToInt(MaxDistance / FMath::Max(CellSize, 1.0f)), 1);
+
+	UGInterActiveComponent* Nearest = nullptr;
+	double NearestDistSq = TNumericLimits<double>::Max();
+	for (int32 X = Center.X - Reach; X <= Center.X + Reach; ++X)
+	{
+		for (int32 Y = Center.Y - Reach; Y <= Center.Y + Reach; ++Y)
+		{
+			const TArray<FItem>* Items = Cells.Find(FIntPoint(X, Y));
+			if (!Items)
+			{
+				continue;
+			}
+
+			for (const FItem& Item : *Items)
+			{
+				//和 CanInteractive 一样, 距离要小于 Distance
+				const double DistSq = FVector::DistSquared(Item.Location, Location);
+				if (DistSq >= FMath::Square(Item.Distance) || DistSq >= NearestDistSq)
+				{
+					continue;
+				}
+
+				if (bOnlyAvailable && Item.Component->GetInteractGuid() != 0)
+				{
+					continue;
+				}
+
+				Nearest = Item.Component;
+				NearestDistSq = DistSq;
+			}
+		}
+	}
+
+	return Nearest;
+}
+
+bool UGInteractionSubsystem::IsInRange(const UGInterActiveComponent* Component, const FVector& Location) const
+{
+	const FItem* Item = FindItem(Component);
+	return Item && FVector::DistSquared(Item->Location, Location) < FMath::Square(Item->Distance);
+}
+
+FIntPoint UGInteractionSubsystem::GetCell(const FVector& Location) const
+{
+	const double InvCellSize = 1.0 / FMath::Max(CellSize, 1.0f);
+	return FIntPoint(FMath::FloorToInt(Location.X * InvCellSize), FMath::FloorToInt(Location.Y * InvCellSize));
+}
+
+const UGInteractionSubsystem::FItem* UGInteractionSubsystem::FindItem(const UGInterActiveComponent* Component) const
+{
+	const FIntPoint* Cell = ComponentCells.Find(Component);
+	if (!Cell)
+	{
+		return nullptr;
+	}
+
+	return Cells.FindChecked(*Cell).FindByPredicate([Component](const FItem& Item) { return Item.Component == Component; });
+}
+
+void UGInteractionSubsystem::RemoveFromCell(const UGInterActiveComponent* Component, const FIntPoint& Cell)
+{
+	TArray<FItem>* Items = Cells.Find(Cell);
+	if (!Items)
+	{
+		return;
+	}
+
+	Items->RemoveAllSwap([Component](const FItem& Item) { return Item.Component == Component; });
+	if (Items->Num() == 0)
+	{
+		Cells.Remove(Cell);
+	}
+}
+
+void UGInteractionSubsystem::DumpStats() const
+{
+	int32 MaxPerCell = 0;
+	for (const TPair<FIntPoint, TArray<FItem>>& Pair : Cells)
+	{
+		MaxPerCell = FMath::Max(MaxPerCell, Pair.Value.Num());
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Interaction: %d components in %d cells (max %d per cell), cell size %.0f, max distance %.0f."),
+		ComponentCells.Num(), Cells.Num(), MaxPerCell, CellSize, MaxDistance);
+}
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld GInteractionDumpCommand(
+	TEXT("G.Interaction.Dump"),
+	TEXT("Logs how many interactables are indexed and how they are spread over the grid."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UGInteractionSubsystem* Interaction = UGInteractionSubsystem::Get(World))
+		{
+			Interaction->DumpStats();
+		}
+	}));
+
+static void BenchInteraction(const TArray<FString>& Args, UWorld* World)
+{
+	const UGInteractionSubsystem* Interaction = UGInteractionSubsystem::Get(World);
+	if (!Interaction || Interaction->Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("G.Interaction.Bench needs interactables in the current world"));
+		return;
+	}
+
+	const int32 NumQueries = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+
+	TArray<UGInterActiveComponent*> Components;
+	for (TObjectIterator<UGInterActiveComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && Interaction->IsInRange(*It, It->GetOwnerLocation()))
+		{
+			Components.Add(*It);
+		}
+	}
+
+	//在已注册的组件附近随机取点查询
+	FRandomStream Stream(NumQueries);
+	TArray<FVector> Queries;
+	Queries.Reserve(NumQueries);
+	for (int32 Index = 0; Index < NumQueries; ++Index)
+	{
+		const FVector Origin = Components[Stream.RandHelper(Components.Num())]->GetOwnerLocation();
+		Queries.Add(Origin + FVector(Stream.FRandRange(-300.0f, 300.0f), Stream.FRandRange(-300.0f, 300.0f), 0.0f));
+	}
+
+	//旧的方式: 每个组件都算一次距离
+	int32 ScanFound = 0;
+	double StartTime = FPlatformTime::Seconds();
+	for (const FVector& Query : Queries)
+	{
+		const UGInterActiveComponent* Nearest = nullptr;
+		double NearestDistSq = TNumericLimits<double>::Max();
+		for (const UGInterActiveComponent* Component : Components)
+		{
+			const double DistSq = FVector::DistSquared(Component->GetOwnerLocation(), Query);
+			if (DistSq < NearestDistSq && Interaction->IsInRange(Component, Query) && Component->GetInteractGuid() == 0)
+			{
+				Nearest = Component;
+				NearestDistSq = DistSq;
+			}
+		}
+		ScanFound += Nearest ? 1 : 0;
+	}
+	const double ScanMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	int32 IndexFound = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (const FVector& Query : Queries)
+	{
+		IndexFound += Interaction->FindNearestAt(Query) ? 1 : 0;
+	}
+	const double IndexMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	UE_LOG(LogTemp, Display, TEXT("G.Interaction.Bench: %d interactables, %d queries. Scan %.3f ms (%d found), grid %.3f ms (%d found)."),
+		Components.Num(), NumQueries, ScanMs, ScanFound, IndexMs, IndexFound);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GInteractionBenchCommand(
+	TEXT("G.Interaction.Bench"),
+	TEXT("Compares scanning every interactable with the grid for nearest interactable queries. Args: [Queries=10000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchInteraction));
+#endif
@@ -0,0 +1,72 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GInteractionSubsystem.generated.h"
+
+class AThirdPersonCharacter;
+class UGInterActiveComponent;
+
+/**
+ * Grid of every UGInterActiveComponent in a world, bucketed by the XY location of its owner's root component.
+ * Components register in BeginPlay and leave in EndPlay; movable roots update their cell when they move, so nothing ticks.
+ * Range checks (including the HandleInteractive server RPC) and nearest lookups only visit the cells around the player.
+ */
+UCLASS(Config = Game)
+class THIRDPERSON_API UGInteractionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UGInteractionSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	//加入索引, 交互距离取注册时的 Distance
+	void Register(UGInterActiveComponent* Component, const FVector& Location, float Distance);
+
+	void Unregister(UGInterActiveComponent* Component);
+
+	//根组件移动后更新位置
+	void UpdateLocation(UGInterActiveComponent* Component, const FVector& Location);
+
+	//玩家交互范围内最近的组件, 跳过正在被交互的
+	UFUNCTION(BlueprintCallable, Category = "InterActive")
+	UGInterActiveComponent* FindNearest(AThirdPersonCharacter* Player) const;
+
+	//Location 交互范围内最近的组件, bOnlyAvailable 时跳过正在被交互的
+	UGInterActiveComponent* FindNearestAt(const FVector& Location, bool bOnlyAvailable = true) const;
+
+	//Location 是否在组件的交互范围内, 没有注册的组件返回 false
+	bool IsInRange(const UGInterActiveComponent* Component, const FVector& Location) const;
+
+	int32 Num() const { return ComponentCells.Num(); }
+
+	void DumpStats() const;
+
+private:
+	struct FItem
+	{
+		UGInterActiveComponent* Component;
+		FVector Location;
+		float Distance;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+	const FItem* FindItem(const UGInterActiveComponent* Component) const;
+	void RemoveFromCell(const UGInterActiveComponent* Component, const FIntPoint& Cell);
+
+private:
+	//格子边长, 不小于最大的交互距离时最近查询只看周围 3x3 个格子
+	UPROPERTY(Config)
+	float CellSize = 500.0f;
+
+	TMap<FIntPoint, TArray<FItem>> Cells;
+	TMap<const UGInterActiveComponent*, FIntPoint> ComponentCells;
+
+	//注册过的最大交互距离, 决定查询要看几圈格子. 只增不减, 组件移除后也保留
+	float MaxDistance = 0.0f;
+};
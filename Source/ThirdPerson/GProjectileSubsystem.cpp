@@ -0,0 +1,677 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GProjectileSubsystem.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SphereComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "GameFramework/DamageType.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "ThirdPersonBullet.h"
+
+DECLARE_STATS_GROUP(TEXT("GProjectile"), STATGROUP_GProjectile, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Tick"), STAT_GProjectile_Tick, STATGROUP_GProjectile);
+DECLARE_CYCLE_STAT(TEXT("Sweep"), STAT_GProjectile_Sweep, STATGROUP_GProjectile);
+DECLARE_CYCLE_STAT(TEXT("Visuals"), STAT_GProjectile_Visuals, STATGROUP_GProjectile);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Projectiles"), STAT_GProjectile_Live, STATGROUP_GProjectile);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Sent"), STAT_GProjectile_EventsSent, STATGROUP_GProjectile);
+
+AGProjectileReplicator::AGProjectileReplicator()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	SetReplicatingMovement(false);
+	//没有复制属性, 每帧有事件时 FlushEvents 会 ForceNetUpdate, 保持正常更新频率以免 RPC 排队
+	NetUpdateFrequency = 100.0f;
+}
+
+void AGProjectileReplicator::MulticastProjectileEvents_Implementation(const TArray<FGProjectileSpawnEvent>& Spawns, const TArray<FGProjectileImpactEvent>& Impacts)
+{
+	// The server (and a listen server's local player) already simulated these.
+	if (GetNetMode() != NM_Client)
+	{
+		return;
+	}
+
+	if (UGProjectileSubsystem* Projectiles = UGProjectileSubsystem::Get(this))
+	{
+		Projectiles->HandleEvents(Spawns, Impacts);
+	}
+}
+
+UGProjectileSubsystem* UGProjectileSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UGProjectileSubsystem>() : nullptr;
+}
+
+bool UGProjectileSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGProjectileSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const ENetMode NetMode = InWorld.GetNetMode();
+	if (NetMode == NM_DedicatedServer || NetMode == NM_ListenServer)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		Replicator = InWorld.SpawnActor<AGProjectileReplicator>(SpawnParams);
+	}
+}
+
+void UGProjectileSubsystem::Deinitialize()
+{
+	Empty();
+	PendingSpawns.Empty();
+	PendingImpacts.Empty();
+	Types.Empty();
+	TypeLookup.Empty();
+	Replicator = nullptr;
+	VisualActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UGProjectileSubsystem::IsTickable() const
+{
+	return IsInitialized() && (Ids.Num() > 0 || PendingSpawns.Num() > 0 || PendingImpacts.Num() > 0 || VisualActor != nullptr);
+}
+
+TStatId UGProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGProjectileSubsystem, STATGROUP_Tickables);
+}
+
+uint32 UGProjectileSubsystem::Fire(TSubclassOf<AThirdPersonBullet> ProjectileClass, const FVector& Location, const FRotator& Rotation, AActor* Owner, APawn* Instigator)
+{
+	if (!HasAuthority())
+	{
+		return 0;
+	}
+
+	const int32 TypeIndex = FindOrAddType(ProjectileClass);
+	if (TypeIndex == INDEX_NONE)
+	{
+		return 0;
+	}
+
+	const uint32 Id = NextId++;
+	if (NextId == 0)
+	{
+		NextId = 1;
+	}
+
+	const FVector Direction = Rotation.Vector();
+	Add(Id, TypeIndex, Location, Direction, Owner, Instigator);
+
+	if (Replicator)
+	{
+		FGProjectileSpawnEvent& Event = PendingSpawns.AddDefaulted_GetRef();
+		Event.Id = Id;
+		Event.ProjectileClass = Types[TypeIndex].ProjectileClass;
+		Event.Owner = Owner;
+		Event.Location = Location;
+		Event.Direction = Direction;
+	}
+
+	return Id;
+}
+
+void UGProjectileSubsystem::HandleEvents(const TArray<FGProjectileSpawnEvent>& Spawns, const TArray<FGProjectileImpactEvent>& Impacts)
+{
+	for (const FGProjectileSpawnEvent& Spawn : Spawns)
+	{
+		if (IdToIndex.Contains(Spawn.Id))
+		{
+			continue;
+		}
+
+		const int32 TypeIndex = FindOrAddType(Spawn.ProjectileClass);
+		if (TypeIndex != INDEX_NONE)
+		{
+			Add(Spawn.Id, TypeIndex, Spawn.Location, Spawn.Direction, Spawn.Owner, nullptr);
+		}
+	}
+
+	for (const FGProjectileImpactEvent& Event : Impacts)
+	{
+		//客户端本地扫描可能已经先撞到了
+		const int32* Found = IdToIndex.Find(Event.Id);
+		if (!Found)
+		{
+			continue;
+		}
+
+		const int32 Index = *Found;
+		if (Event.bExploded && ShouldDrawVisuals())
+		{
+			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Types[TypeIndices[Index]].ExplosionEffect, Event.Location, FRotator::ZeroRotator, true, EPSCPoolMethod::AutoRelease);
+		}
+		RemoveAtSwap(Index);
+	}
+}
+
+void UGProjectileSubsystem::Empty()
+{
+	if (HasAuthority() && Replicator)
+	{
+		for (int32 Index = 0; Index < Ids.Num(); ++Index)
+		{
+			FGProjectileImpactEvent& Event = PendingImpacts.AddDefaulted_GetRef();
+			Event.Id = Ids[Index];
+			Event.Location = Locations[Index];
+		}
+	}
+
+	Ids.Reset();
+	TypeIndices.Reset();
+	Locations.Reset();
+	Velocities.Reset();
+	LifeSpans.Reset();
+	Owners.Reset();
+	InstigatorControllers.Reset();
+	IdToIndex.Reset();
+
+	for (FGProjectileType& Type : Types)
+	{
+		if (Type.Visuals)
+		{
+			Type.Visuals->ClearInstances();
+		}
+	}
+}
+
+void UGProjectileSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GProjectile_Tick);
+
+	UWorld* World = GetWorld();
+	const int32 Count = Ids.Num();
+	SET_DWORD_STAT(STAT_GProjectile_Live, Count);
+
+	if (Count > 0)
+	{
+		const float GravityZ = World->GetGravityZ();
+		const AWorldSettings* WorldSettings = World->GetWorldSettings();
+		const double KillZ = WorldSettings ? WorldSettings->KillZ : -HALF_WORLD_MAX;
+
+		// Resolve everything that touches UObjects here, the sweeps below may run on worker threads.
+		TArray<const AActor*> IgnoredActors;
+		IgnoredActors.SetNumUninitialized(Count);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			IgnoredActors[Index] = Owners[Index].Get();
+		}
+
+		TArray<FHitResult> Hits;
+		Hits.SetNum(Count);
+		TArray<bool> HitFlags;
+		HitFlags.SetNumZeroed(Count);
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_GProjectile_Sweep);
+
+			//和 ProjectileMovementComponent 一样: 先算速度, 再从当前位置扫到新位置, 撞到就停在撞击点
+			ParallelFor(Count, [&](int32 Index)
+			{
+				const FGProjectileType& Type = Types[TypeIndices[Index]];
+				LifeSpans[Index] -= DeltaTime;
+
+				FVector& Velocity = Velocities[Index];
+				Velocity.Z += GravityZ * Type.GravityScale * DeltaTime;
+
+				const FVector Start = Locations[Index];
+				const FVector End = Start + Velocity * DeltaTime;
+
+				FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GProjectileSweep), false, IgnoredActors[Index]);
+				if (World->SweepSingleByProfile(Hits[Index], Start, End, FQuat::Identity, Type.CollisionProfile, FCollisionShape::MakeSphere(Type.Radius), QueryParams))
+				{
+					HitFlags[Index] = true;
+					Locations[Index] = Hits[Index].Location;
+				}
+				else
+				{
+					Locations[Index] = End;
+				}
+			}, Count < ParallelSweepThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+		}
+
+		// Back to front so RemoveAtSwap only ever moves an entry that has already been handled.
+		for (int32 Index = Count - 1; Index >= 0; --Index)
+		{
+			// Damage can run gameplay code that empties us.
+			if (!Ids.IsValidIndex(Index))
+			{
+				continue;
+			}
+
+			if (HitFlags[Index])
+			{
+				Impact(Index, Hits[Index]);
+			}
+			else if (LifeSpans[Index] <= 0.0f || Locations[Index].Z < KillZ)
+			{
+				if (HasAuthority() && Replicator)
+				{
+					FGProjectileImpactEvent& Event = PendingImpacts.AddDefaulted_GetRef();
+					Event.Id = Ids[Index];
+					Event.Location = Locations[Index];
+				}
+				RemoveAtSwap(Index);
+			}
+		}
+	}
+
+	if (ShouldDrawVisuals())
+	{
+		UpdateVisuals();
+	}
+
+	FlushEvents();
+}
+
+int32 UGProjectileSubsystem::FindOrAddType(TSubclassOf<AThirdPersonBullet> ProjectileClass)
+{
+	if (!ProjectileClass)
+	{
+		ProjectileClass = AThirdPersonBullet::StaticClass();
+	}
+
+	if (const int32* Found = TypeLookup.Find(ProjectileClass.Get()))
+	{
+		return *Found;
+	}
+
+	const AThirdPersonBullet* Bullet = ProjectileClass->GetDefaultObject<AThirdPersonBullet>();
+	if (!Bullet || !Bullet->SphereComponent || !Bullet->ProjectileMovementComponent)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UGProjectileSubsystem::FindOrAddType %s has no sphere or projectile movement component"), *GetNameSafe(ProjectileClass));
+		return INDEX_NONE;
+	}
+
+	FGProjectileType& Type = Types.AddDefaulted_GetRef();
+	Type.ProjectileClass = ProjectileClass;
+	Type.DamageType = Bullet->DamageType;
+	Type.ExplosionEffect = Bullet->ExplosionEffect;
+	Type.CollisionProfile = Bullet->SphereComponent->GetCollisionProfileName();
+	Type.Radius = Bullet->SphereComponent->GetScaledSphereRadius();
+
+	const UProjectileMovementComponent* Movement = Bullet->ProjectileMovementComponent;
+	Type.Speed = Movement->InitialSpeed > 0.0f ? Movement->InitialSpeed : Movement->Velocity.Size();
+	if (Movement->MaxSpeed > 0.0f)
+	{
+		Type.Speed = FMath::Min(Type.Speed, Movement->MaxSpeed);
+	}
+	Type.GravityScale = Movement->ProjectileGravityScale;
+	Type.Damage = Bullet->Damage;
+	Type.LifeSpan = Bullet->InitialLifeSpan > 0.0f ? Bullet->InitialLifeSpan : DefaultLifeSpan;
+
+	if (Bullet->StaticMesh)
+	{
+		Type.Mesh = Bullet->StaticMesh->GetStaticMesh();
+		Type.MeshTransform = Bullet->StaticMesh->GetRelativeTransform();
+	}
+
+	const int32 TypeIndex = Types.Num() - 1;
+	TypeLookup.Add(ProjectileClass.Get(), TypeIndex);
+	return TypeIndex;
+}
+
+int32 UGProjectileSubsystem::Add(uint32 Id, int32 TypeIndex, const FVector& Location, const FVector& Direction, AActor* Owner, APawn* Instigator)
+{
+	const FGProjectileType& Type = Types[TypeIndex];
+
+	const int32 Index = Ids.Add(Id);
+	TypeIndices.Add(TypeIndex);
+	Locations.Add(Location);
+	Velocities.Add(Direction * Type.Speed);
+	LifeSpans.Add(Type.LifeSpan);
+	Owners.Add(Owner);
+	InstigatorControllers.Add(Instigator ? Instigator->GetController() : nullptr);
+	IdToIndex.Add(Id, Index);
+	return Index;
+}
+
+void UGProjectileSubsystem::RemoveAtSwap(int32 Index)
+{
+	IdToIndex.Remove(Ids[Index]);
+	const int32 LastIndex = Ids.Num() - 1;
+	if (Index != LastIndex)
+	{
+		IdToIndex.Add(Ids[LastIndex], Index);
+	}
+
+	Ids.RemoveAtSwap(Index, 1, false);
+	TypeIndices.RemoveAtSwap(Index, 1, false);
+	Locations.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	LifeSpans.RemoveAtSwap(Index, 1, false);
+	Owners.RemoveAtSwap(Index, 1, false);
+	InstigatorControllers.RemoveAtSwap(Index, 1, false);
+}
+
+void UGProjectileSubsystem::Impact(int32 Index, const FHitResult& Hit)
+{
+	const FGProjectileType& Type = Types[TypeIndices[Index]];
+
+	if (HasAuthority())
+	{
+		// Same call as AThirdPersonBullet::OnProjectileImpact. There's no bullet Actor, so the shooter is the damage causer.
+		if (AActor* OtherActor = Hit.GetActor())
+		{
+			UGameplayStatics::ApplyPointDamage(OtherActor, Type.Damage, Velocities[Index].GetSafeNormal(), Hit, InstigatorControllers[Index].Get(), Owners[Index].Get(), Type.DamageType);
+		}
+
+		// ApplyPointDamage may have removed us.
+		if (!Ids.IsValidIndex(Index))
+		{
+			return;
+		}
+
+		if (Replicator)
+		{
+			FGProjectileImpactEvent& Event = PendingImpacts.AddDefaulted_GetRef();
+			Event.Id = Ids[Index];
+			Event.bExploded = true;
+			Event.Location = Hit.Location;
+		}
+	}
+
+	if (ShouldDrawVisuals())
+	{
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Type.ExplosionEffect, Hit.Location, FRotator::ZeroRotator, true, EPSCPoolMethod::AutoRelease);
+	}
+
+	RemoveAtSwap(Index);
+}
+
+void UGProjectileSubsystem::UpdateVisuals()
+{
+	SCOPE_CYCLE_COUNTER(STAT_GProjectile_Visuals);
+
+	UWorld* World = GetWorld();
+	if (!VisualActor)
+	{
+		if (!Ids.Num())
+		{
+			return;
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		VisualActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		if (!VisualActor)
+		{
+			return;
+		}
+
+		USceneComponent* Root = NewObject<USceneComponent>(VisualActor, TEXT("Root"));
+		VisualActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	TArray<FTransform> Transforms;
+	for (int32 TypeIndex = 0; TypeIndex < Types.Num(); ++TypeIndex)
+	{
+		FGProjectileType& Type = Types[TypeIndex];
+		if (!Type.Mesh)
+		{
+			continue;
+		}
+
+		Transforms.Reset();
+		for (int32 Index = 0; Index < Ids.Num(); ++Index)
+		{
+			if (TypeIndices[Index] == TypeIndex)
+			{
+				//与子弹 Actor 一样, 旋转跟随速度
+				Transforms.Add(Type.MeshTransform * FTransform(Velocities[Index].Rotation(), Locations[Index]));
+			}
+		}
+
+		if (!Type.Visuals)
+		{
+			if (!Transforms.Num())
+			{
+				continue;
+			}
+
+			Type.Visuals = NewObject<UInstancedStaticMeshComponent>(VisualActor);
+			Type.Visuals->SetMobility(EComponentMobility::Movable);
+			Type.Visuals->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+			Type.Visuals->SetStaticMesh(Type.Mesh);
+			Type.Visuals->SetupAttachment(VisualActor->GetRootComponent());
+			Type.Visuals->RegisterComponent();
+			VisualActor->AddInstanceComponent(Type.Visuals);
+		}
+
+		UInstancedStaticMeshComponent* Visuals = Type.Visuals;
+		while (Visuals->GetInstanceCount() > Transforms.Num())
+		{
+			Visuals->RemoveInstance(Visuals->GetInstanceCount() - 1);
+		}
+		while (Visuals->GetInstanceCount() < Transforms.Num())
+		{
+			Visuals->AddInstance(Transforms[Visuals->GetInstanceCount()], true);
+		}
+
+		if (Transforms.Num())
+		{
+			Visuals->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+		}
+	}
+}
+
+void UGProjectileSubsystem::FlushEvents()
+{
+	if (!Replicator)
+	{
+		PendingSpawns.Reset();
+		PendingImpacts.Reset();
+		return;
+	}
+
+	if (PendingSpawns.Num() == 0 && PendingImpacts.Num() == 0)
+	{
+		return;
+	}
+
+	// Unreliable multicasts wait for the Actor's next net update and only net.MaxRPCPerNetUpdate of them go out per update,
+	// the rest are dropped. Send at most MaxRPCsPerFlush this frame and keep the remainder for the next one.
+	// Spawns go out before impacts so a projectile that hit on its first frame still shows up (and explodes) on clients.
+	const int32 ChunkSize = FMath::Max(MaxEventsPerRPC, 1);
+	const int32 MaxRPCs = FMath::Max(MaxRPCsPerFlush, 1);
+	int32 SpawnIndex = 0;
+	int32 ImpactIndex = 0;
+	int32 NumRPCs = 0;
+	while ((SpawnIndex < PendingSpawns.Num() || ImpactIndex < PendingImpacts.Num()) && NumRPCs < MaxRPCs)
+	{
+		const int32 NumSpawns = FMath::Min(ChunkSize, PendingSpawns.Num() - SpawnIndex);
+		const int32 NumImpacts = FMath::Min(ChunkSize - NumSpawns, PendingImpacts.Num() - ImpactIndex);
+
+		const TArray<FGProjectileSpawnEvent> Spawns(PendingSpawns.GetData() + SpawnIndex, NumSpawns);
+		const TArray<FGProjectileImpactEvent> Impacts(PendingImpacts.GetData() + ImpactIndex, NumImpacts);
+		Replicator->MulticastProjectileEvents(Spawns, Impacts);
+
+		SpawnIndex += NumSpawns;
+		ImpactIndex += NumImpacts;
+		++NumRPCs;
+	}
+
+	INC_DWORD_STAT_BY(STAT_GProjectile_EventsSent, SpawnIndex + ImpactIndex);
+
+	PendingSpawns.RemoveAt(0, SpawnIndex, false);
+	PendingImpacts.RemoveAt(0, ImpactIndex, false);
+
+	Replicator->ForceNetUpdate();
+}
+
+bool UGProjectileSubsystem::HasAuthority() const
+{
+	const UWorld* World = GetWorld();
+	return World && World->GetNetMode() != NM_Client;
+}
+
+bool UGProjectileSubsystem::ShouldDrawVisuals() const
+{
+	const UWorld* World = GetWorld();
+	return World && World->GetNetMode() != NM_DedicatedServer;
+}
+
+#if !UE_BUILD_SHIPPING
+/**
+ * G.Projectile.Bench [Count] [Frames]
+ * Fires Count shots high above the level through the Actor path, then through the manager, and compares spawn time and
+ * average game thread time over Frames frames. Run it on a server or standalone with nothing else firing.
+ */
+struct FGProjectileBenchmark
+{
+	TWeakObjectPtr<UWorld> World;
+	int32 Count = 500;
+	int32 NumFrames = 120;
+
+	int32 Phase = 0;
+	int32 Frame = 0;
+	uint64 GameThreadCycles = 0;
+	double SpawnMs[2] = { 0.0, 0.0 };
+	double FrameMs[2] = { 0.0, 0.0 };
+	TArray<TWeakObjectPtr<AActor>> Actors;
+
+	bool Tick(float DeltaTime)
+	{
+		UWorld* BenchWorld = World.Get();
+		UGProjectileSubsystem* Projectiles = UGProjectileSubsystem::Get(BenchWorld);
+		if (!BenchWorld || !Projectiles)
+		{
+			Cleanup(Projectiles);
+			return false;
+		}
+
+		if (Frame == 0)
+		{
+			Fire(*BenchWorld, *Projectiles);
+		}
+		else
+		{
+			// GGameThreadTime is the previous frame's, so start counting from the first frame after firing.
+			GameThreadCycles += GGameThreadTime;
+		}
+
+		if (++Frame <= NumFrames)
+		{
+			return true;
+		}
+
+		FrameMs[Phase] = FPlatformTime::ToMilliseconds64(GameThreadCycles) / NumFrames;
+		Cleanup(Projectiles);
+
+		Frame = 0;
+		GameThreadCycles = 0;
+		if (++Phase < 2)
+		{
+			return true;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("G.Projectile.Bench: %d shots, %d frames. Actors: spawn %.3f ms, game thread %.3f ms/frame. Manager: spawn %.3f ms, game thread %.3f ms/frame."),
+			Count, NumFrames, SpawnMs[0], FrameMs[0], SpawnMs[1], FrameMs[1]);
+		return false;
+	}
+
+	void Fire(UWorld& BenchWorld, UGProjectileSubsystem& Projectiles)
+	{
+		// Well above anything in the level, flying outwards, so neither path hits anything.
+		FRandomStream Stream(Count);
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FVector Location(Stream.FRandRange(-5000.0f, 5000.0f), Stream.FRandRange(-5000.0f, 5000.0f), 50000.0f);
+			const FRotator Rotation(0.0f, Stream.FRandRange(0.0f, 360.0f), 0.0f);
+			if (Phase == 0)
+			{
+				FActorSpawnParameters SpawnParams;
+				SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+				Actors.Add(BenchWorld.SpawnActor<AThirdPersonBullet>(Location, Rotation, SpawnParams));
+			}
+			else
+			{
+				Projectiles.Fire(AThirdPersonBullet::StaticClass(), Location, Rotation, nullptr, nullptr);
+			}
+		}
+		SpawnMs[Phase] = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+
+	void Cleanup(UGProjectileSubsystem* Projectiles)
+	{
+		for (const TWeakObjectPtr<AActor>& Actor : Actors)
+		{
+			if (Actor.IsValid())
+			{
+				Actor->Destroy();
+			}
+		}
+		Actors.Empty();
+
+		if (Projectiles)
+		{
+			Projectiles->Empty();
+		}
+	}
+};
+
+static void BenchProjectiles(const TArray<FString>& Args, UWorld* World)
+{
+	if (!World || World->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("G.Projectile.Bench must run on a server or in standalone"));
+		return;
+	}
+
+	TSharedRef<FGProjectileBenchmark> Benchmark = MakeShared<FGProjectileBenchmark>();
+	Benchmark->World = World;
+	if (Args.Num() > 0)
+	{
+		Benchmark->Count = FMath::Max(FCString::Atoi(*Args[0]), 1);
+	}
+	if (Args.Num() > 1)
+	{
+		Benchmark->NumFrames = FMath::Max(FCString::Atoi(*Args[1]), 1);
+	}
+
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Benchmark](float DeltaTime)
+	{
+		return Benchmark->Tick(DeltaTime);
+	}));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchProjectilesCommand(
+	TEXT("G.Projectile.Bench"),
+	TEXT("Compares AThirdPersonBullet Actors with the projectile manager for the same shots. Args: [Count=500] [Frames=120]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchProjectiles));
+
+static FAutoConsoleCommandWithWorld GProjectileEmptyCommand(
+	TEXT("G.Projectile.Empty"),
+	TEXT("Removes every live projectile without applying damage."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UGProjectileSubsystem* Projectiles = UGProjectileSubsystem::Get(World))
+		{
+			Projectiles->Empty();
+		}
+	}));
+#endif
@@ -0,0 +1,189 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "GameFramework/Actor.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GProjectileSubsystem.generated.h"
+
+class AThirdPersonBullet;
+class UDamageType;
+class UInstancedStaticMeshComponent;
+class UParticleSystem;
+class UStaticMesh;
+
+//服务器发射一颗投射物, 客户端据此自行模拟表现
+USTRUCT()
+struct FGProjectileSpawnEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint32 Id = 0;
+
+	UPROPERTY()
+	TSubclassOf<AThirdPersonBullet> ProjectileClass;
+
+	//发射者, 客户端扫描时忽略
+	UPROPERTY()
+	AActor* Owner = nullptr;
+
+	UPROPERTY()
+	FVector_NetQuantize10 Location;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+};
+
+//服务器上投射物命中或超时, 客户端移除对应的投射物
+USTRUCT()
+struct FGProjectileImpactEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint32 Id = 0;
+
+	//false 为超时或掉出世界, 不播放爆炸
+	UPROPERTY()
+	bool bExploded = false;
+
+	UPROPERTY()
+	FVector_NetQuantize10 Location;
+};
+
+//投射物参数, 取自 AThirdPersonBullet 子类的 CDO, 策划仍然在子弹蓝图上配置
+USTRUCT()
+struct FGProjectileType
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<AThirdPersonBullet> ProjectileClass;
+
+	UPROPERTY()
+	TSubclassOf<UDamageType> DamageType;
+
+	UPROPERTY()
+	UParticleSystem* ExplosionEffect = nullptr;
+
+	UPROPERTY()
+	UStaticMesh* Mesh = nullptr;
+
+	//客户端表现, 同类投射物共用一个 ISM
+	UPROPERTY()
+	UInstancedStaticMeshComponent* Visuals = nullptr;
+
+	FName CollisionProfile;
+	FTransform MeshTransform;
+	float Radius = 0.0f;
+	float Speed = 0.0f;
+	float GravityScale = 0.0f;
+	float Damage = 0.0f;
+	float LifeSpan = 0.0f;
+};
+
+/**
+ * Carries UGProjectileSubsystem events to clients. One per world, always relevant, spawned by the server subsystem.
+ * Events are batched per frame and sent unreliably; clients also sweep locally, so a lost impact only costs the explosion.
+ */
+UCLASS(NotPlaceable, Transient)
+class THIRDPERSON_API AGProjectileReplicator : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AGProjectileReplicator();
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastProjectileEvents(const TArray<FGProjectileSpawnEvent>& Spawns, const TArray<FGProjectileImpactEvent>& Impacts);
+};
+
+/**
+ * Simulates AThirdPersonBullet shots as data instead of one replicated Actor each. Live projectiles are kept in parallel arrays,
+ * swept together once per frame, and damage is applied on the server with the same ApplyPointDamage call the Actor used.
+ * Only spawn / impact events are replicated, clients simulate the flight and draw it with one instanced mesh per projectile class.
+ */
+UCLASS(Config = Game)
+class THIRDPERSON_API UGProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UGProjectileSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	//服务器发射, 返回投射物 Id, 失败返回 0
+	uint32 Fire(TSubclassOf<AThirdPersonBullet> ProjectileClass, const FVector& Location, const FRotator& Rotation, AActor* Owner, APawn* Instigator);
+
+	//客户端收到服务器事件
+	void HandleEvents(const TArray<FGProjectileSpawnEvent>& Spawns, const TArray<FGProjectileImpactEvent>& Impacts);
+
+	int32 Num() const { return Ids.Num(); }
+
+	//移除所有投射物, 不造成伤害
+	void Empty();
+
+private:
+	int32 FindOrAddType(TSubclassOf<AThirdPersonBullet> ProjectileClass);
+	int32 Add(uint32 Id, int32 TypeIndex, const FVector& Location, const FVector& Direction, AActor* Owner, APawn* Instigator);
+	void RemoveAtSwap(int32 Index);
+	void Impact(int32 Index, const FHitResult& Hit);
+	void UpdateVisuals();
+	void FlushEvents();
+	bool HasAuthority() const;
+	bool ShouldDrawVisuals() const;
+
+private:
+	//超过这个数量时并行扫描
+	UPROPERTY(Config)
+	int32 ParallelSweepThreshold = 64;
+
+	//子弹蓝图没有设置 InitialLifeSpan 时的最长飞行时间
+	UPROPERTY(Config)
+	float DefaultLifeSpan = 10.0f;
+
+	//单个 RPC 最多携带的事件数, 防止超出 bunch 大小
+	UPROPERTY(Config)
+	int32 MaxEventsPerRPC = 64;
+
+	//每帧最多发送的 RPC 数, 不能超过 net.MaxRPCPerNetUpdate, 剩余事件留到下一帧
+	UPROPERTY(Config)
+	int32 MaxRPCsPerFlush = 2;
+
+	UPROPERTY(Transient)
+	TArray<FGProjectileType> Types;
+
+	UPROPERTY(Transient)
+	AGProjectileReplicator* Replicator = nullptr;
+
+	UPROPERTY(Transient)
+	AActor* VisualActor = nullptr;
+
+	TMap<const UClass*, int32> TypeLookup;
+
+	// Live projectiles, one entry per projectile in every array.
+	TArray<uint32> Ids;
+	TArray<int32> TypeIndices;
+	TArray<FVector> Locations;
+	TArray<FVector> Velocities;
+	TArray<float> LifeSpans;
+	TArray<TWeakObjectPtr<AActor>> Owners;
+	TArray<TWeakObjectPtr<AController>> InstigatorControllers;
+	TMap<uint32, int32> IdToIndex;
+
+	TArray<FGProjectileSpawnEvent> PendingSpawns;
+	TArray<FGProjectileImpactEvent> PendingImpacts;
+
+	uint32 NextId = 1;
+};
@@ -19,6 +19,7 @@ public class ThirdPerson : ModuleRules
 		PrivateDependencyModuleNames.AddRange(new string[]{
 			"Able",
 			"AbleCore",
+			"NetCore",
 		});
 	}
 }
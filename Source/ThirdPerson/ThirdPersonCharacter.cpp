@@ -8,6 +8,7 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include "Net/UnrealNetwork.h"
 #include "Engine/Engine.h"
 #include "ThirdPersonBullet.h"
@@ -16,6 +17,10 @@
 #include "AbleCore/Classes/ablAbilityBlueprintLibrary.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "GInterActiveComponent.h"
+#include "GProjectileSubsystem.h"
+#include "GFootIKSubsystem.h"
+#include "Utiltiy/GAbilityRegistry.h"
+#include "AbleCore/Classes/ablSubSystem.h"
 
 float const Rad2Deg = 57.29578f;
 static int64 g_GuidVal = 0;
@@ -84,9 +89,15 @@ void AThirdPersonCharacter::GetLifetimeReplicatedProps(TArray <FLifetimeProperty
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME_CONDITION(AThirdPersonCharacter, Guid, COND_InitialOnly);
+	//ٱ仯, ģʽ, ޸ʱ, ÿ֡Ƚ
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	Params.Condition = COND_InitialOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AThirdPersonCharacter, Guid, Params);
 	//Ƶǰֵ
-	DOREPLIFETIME(AThirdPersonCharacter, CurrentHealth);
+	Params.Condition = COND_None;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AThirdPersonCharacter, CurrentHealth, Params);
 }
 
 
@@ -123,6 +134,41 @@ void AThirdPersonCharacter::SetupPlayerInputComponent(class UInputComponent* Pla
 }
 
 
+void AThirdPersonCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	//ϱʱԤؼ
+	if (UGAbilityRegistry* registry = UGAbilityRegistry::Get(this))
+	{
+		registry->Prefetch(m_SkillLoadout, this, [this](UAblAbility* pAbility) { PrewarmSkill(pAbility); });
+	}
+}
+
+void AThirdPersonCharacter::OnRep_Controller()
+{
+	Super::OnRep_Controller();
+
+	//ͻյControllerʱԤؼ
+	if (Controller != nullptr)
+	{
+		if (UGAbilityRegistry* registry = UGAbilityRegistry::Get(this))
+		{
+			registry->Prefetch(m_SkillLoadout, this, [this](UAblAbility* pAbility) { PrewarmSkill(pAbility); });
+		}
+	}
+}
+
+void AThirdPersonCharacter::PrewarmSkill(UAblAbility* pAbility)
+{
+	UWorld* world = GetWorld();
+	UAblAbilityUtilitySubsystem* subsystem = world ? world->GetSubsystem<UAblAbilityUtilitySubsystem>() : nullptr;
+	if (subsystem && m_SkillComp)
+	{
+		subsystem->PrewarmScratchPads({ pAbility }, 1, m_SkillComp);
+	}
+}
+
 void AThirdPersonCharacter::OnResetVR()
 {
 	// If ThirdPerson is added to a project via 'Add Feature' in the Unreal Editor the dependency on HeadMountedDisplay in ThirdPerson.Build.cs is not automatically propagated
@@ -231,6 +277,7 @@ void AThirdPersonCharacter::SetCurrentHealth(float healthValue)
 	if (GetLocalRole() == ROLE_Authority)
 	{
 		CurrentHealth = FMath::Clamp(healthValue, 0.f, MaxHealth);
+		MARK_PROPERTY_DIRTY_FROM_NAME(AThirdPersonCharacter, CurrentHealth, this);
 		OnHealthUpdate();
 	}
 }
@@ -263,6 +310,15 @@ void AThirdPersonCharacter::HandleFire_Implementation()
 	FVector spawnLocation = GetActorLocation() + (GetControlRotation().Vector() * 100.0f) + (GetActorUpVector() * 50.0f);
 	FRotator spawnRotation = GetControlRotation();
 
+	if (bUseProjectileManager)
+	{
+		if (UGProjectileSubsystem* projectiles = UGProjectileSubsystem::Get(this))
+		{
+			projectiles->Fire(ProjectileClass, spawnLocation, spawnRotation, this, GetInstigator());
+			return;
+		}
+	}
+
 	FActorSpawnParameters spawnParameters;
 	spawnParameters.Instigator = GetInstigator();
 	spawnParameters.Owner = this;
@@ -280,34 +336,57 @@ void AThirdPersonCharacter::PlaySkill(const FString& filePath, AActor* Sender, b
 		return;
 	}
 
-	UGAssetManager::Get()->AsyncLoadBluePrint(filePath, [this, filePath, Sender, bPlayImmediately](UObject* pObj) {
-		if (pObj == nullptr)
+	UGAbilityRegistry* registry = UGAbilityRegistry::Get(this);
+	if (registry == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("AGPlayerCharacter::PlaySkill No AbilityRegistry: %s"), *filePath);
+		return;
+	}
+
+	//Ѿפļͬţõȼػص
+	if (UAblAbility* pAbility = registry->FindResident(filePath))
+	{
+		ActivateSkill(pAbility, Sender, bPlayImmediately);
+		return;
+	}
+
+	TWeakObjectPtr<AThirdPersonCharacter> weakThis(this);
+	TWeakObjectPtr<AActor> weakSender(Sender);
+	const bool bHasSender = Sender != nullptr;
+	registry->LoadAbility(filePath, [weakThis, weakSender, bHasSender, filePath, bPlayImmediately](UAblAbility* pAbility) {
+		if (pAbility == nullptr)
 		{
 			UE_LOG(LogTemp, Error, TEXT("AGPlayerCharacter::PlaySkill No Object: %s"), *filePath);
 			return;
 		}
 
-		if (bPlayImmediately)
+		//ڼSender٣ٲ
+		if (!weakThis.IsValid() || (bHasSender && !weakSender.IsValid()))
 		{
-			this->StopSkill(EAblAbilityTaskResult::Interrupted);
+			return;
 		}
 
-		UBlueprintGeneratedClass* Bp = Cast<UBlueprintGeneratedClass>(pObj);
+		weakThis->ActivateSkill(pAbility, weakSender.Get(), bPlayImmediately);
+		}, this);
+}
 
-		//ʹBp->GetDefaultObjectȡUAblAbilityDS£ͻ˳DSBUG
-		UAblAbility* pAbility = Bp->GetDefaultObject<UAblAbility>();
+void AThirdPersonCharacter::ActivateSkill(UAblAbility* pAbility, AActor* Sender, bool bPlayImmediately)
+{
+	if (bPlayImmediately)
+	{
+		this->StopSkill(EAblAbilityTaskResult::Interrupted);
+	}
 
-		if (Sender == nullptr)
-		{
-			UAblAbilityContext* pContext = UAblAbilityBlueprintLibrary::CreateAbilityContext(pAbility, m_SkillComp, GetOwner(), GetOwner());
-			m_SkillComp->ActivateAbility(pContext);
-		}
-		else
-		{
-			UAblAbilityContext* pContext = UAblAbilityBlueprintLibrary::CreateAbilityContext(pAbility, m_SkillComp, GetOwner(), Sender);
-			m_SkillComp->ActivateAbility(pContext);
-		}
-		});
+	if (Sender == nullptr)
+	{
+		UAblAbilityContext* pContext = UAblAbilityBlueprintLibrary::CreateAbilityContext(pAbility, m_SkillComp, GetOwner(), GetOwner());
+		m_SkillComp->ActivateAbility(pContext);
+	}
+	else
+	{
+		UAblAbilityContext* pContext = UAblAbilityBlueprintLibrary::CreateAbilityContext(pAbility, m_SkillComp, GetOwner(), Sender);
+		m_SkillComp->ActivateAbility(pContext);
+	}
 }
 
 void AThirdPersonCharacter::StopSkill(EAblAbilityTaskResult reason)
@@ -322,19 +401,37 @@ void AThirdPersonCharacter::StopSkill(EAblAbilityTaskResult reason)
 
 void AThirdPersonCharacter::ClacIK(float deltaSecs)
 {
+	//ר÷ҪŲIK
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	if (bUseFootIKService)
+	{
+		//ϵͳͳһ첽ύһֵ֡Ӧ
+		if (UGFootIKSubsystem* FootIK = UGFootIKSubsystem::Get(this))
+		{
+			FootIK->Request(this);
+			return;
+		}
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
 	USkeletalMeshComponent* RootMeshComponent = GetMesh();
 	if (!RootMeshComponent)
 	{
 		return;
 	}
 
-	FName footLName = "foot_l";
+	const FName& footLName = UGFootIKSubsystem::LeftFootName;
 	if (!RootMeshComponent->DoesSocketExist(footLName))
 	{
 		return;
 	}
 
-	FName footRName = "foot_r";
+	const FName& footRName = UGFootIKSubsystem::RightFootName;
 	if (!RootMeshComponent->DoesSocketExist(footRName))
 	{
 		return;
@@ -344,61 +441,65 @@ void AThirdPersonCharacter::ClacIK(float deltaSecs)
 	FVector footLLocation = RootMeshComponent->GetSocketLocation(footLName);
 	FVector footRLocation = RootMeshComponent->GetSocketLocation(footRName);
 
+	FHitResult LeftHit;
+	const bool bLeftHit = SweapCollisionTrace(this, FVector(footLLocation.X, footLLocation.Y, curLocation.Z + UGFootIKSubsystem::TraceAbove), FVector(footLLocation.X, footLLocation.Y, curLocation.Z - UGFootIKSubsystem::TraceBelow), LeftHit);
+
+	FHitResult RightHit;
+	const bool bRightHit = SweapCollisionTrace(this, FVector(footRLocation.X, footRLocation.Y, curLocation.Z + UGFootIKSubsystem::TraceAbove), FVector(footRLocation.X, footRLocation.Y, curLocation.Z - UGFootIKSubsystem::TraceBelow), RightHit);
+
+	ApplyFootIK(bLeftHit ? &LeftHit : nullptr, bRightHit ? &RightHit : nullptr, curLocation.Z, deltaSecs);
+
+	if (UGFootIKSubsystem* FootIK = UGFootIKSubsystem::Get(this))
+	{
+		FootIK->AddSyncSample(FPlatformTime::Seconds() - StartTime);
+	}
+}
+
+void AThirdPersonCharacter::ApplyFootIK(const FHitResult* LeftHit, const FHitResult* RightHit, float BaseZ, float deltaSecs)
+{
 	float targetLeftZOffset = 0;
 	float targetRightZOffset = 0;
 	float targetZOffset = 0;
+	if (LeftHit)
 	{
-		FVector start(footLLocation.X, footLLocation.Y, curLocation.Z + 50.0f);
-		FVector end(footLLocation.X, footLLocation.Y, curLocation.Z - 75.0f);
+		m_LeftFootHit = true;
+		FVector Normal = LeftHit->Normal;
 
-		FHitResult Hit;
-		if (SweapCollisionTrace(GetOwner(), start, end, Hit))
-		{
-			m_LeftFootHit = true;
-			FVector Normal = Hit.Normal;
-
-			float Roll = FMath::Atan2(Normal.Y, Normal.Z) * Rad2Deg;
-			Roll = FMath::Clamp(Roll, m_FootRollMin, m_FootRollMax);
-			float Pitch = FMath::Atan2(Normal.X, Normal.Z) * Rad2Deg;
-			Pitch = -1.0f * FMath::Clamp(Pitch, m_FootPitchMin, m_FootPitchMax);
-			m_LeftFootRotOffset = FRotator(Pitch, 0.0f, Roll);
+		float Roll = FMath::Atan2(Normal.Y, Normal.Z) * Rad2Deg;
+		Roll = FMath::Clamp(Roll, m_FootRollMin, m_FootRollMax);
+		float Pitch = FMath::Atan2(Normal.X, Normal.Z) * Rad2Deg;
+		Pitch = -1.0f * FMath::Clamp(Pitch, m_FootPitchMin, m_FootPitchMax);
+		m_LeftFootRotOffset = FRotator(Pitch, 0.0f, Roll);
 
-			float ZOffset = Hit.Location.Z - curLocation.Z;
-			targetLeftZOffset = FMath::Clamp(ZOffset, m_FootZMin, m_FootZMax);
-		}
-		else
-		{
-			m_LeftFootHit = false;
-			m_LeftFootRotOffset = FRotator(0.0f, 0.0f, 0.0f);
-			targetLeftZOffset = 0.0f;
-		}
+		float ZOffset = LeftHit->Location.Z - BaseZ;
+		targetLeftZOffset = FMath::Clamp(ZOffset, m_FootZMin, m_FootZMax);
 	}
-
+	else
 	{
-		FVector start(footRLocation.X, footRLocation.Y, curLocation.Z + 50.0f);
-		FVector end(footRLocation.X, footRLocation.Y, curLocation.Z - 75.0f);
+		m_LeftFootHit = false;
+		m_LeftFootRotOffset = FRotator(0.0f, 0.0f, 0.0f);
+		targetLeftZOffset = 0.0f;
+	}
 
-		FHitResult Hit;
-		if (SweapCollisionTrace(GetOwner(), start, end, Hit))
-		{
-			m_LeftFootHit = true;
-			FVector Normal = Hit.Normal;
+	if (RightHit)
+	{
+		m_RightFootHit = true;
+		FVector Normal = RightHit->Normal;
 
-			float Roll = FMath::Atan2(Normal.Y, Normal.Z) * Rad2Deg;
-			Roll = FMath::Clamp(Roll, m_FootRollMin, m_FootRollMax);
-			float Pitch = FMath::Atan2(Normal.X, Normal.Z) * Rad2Deg;
-			Pitch = -1.0f * FMath::Clamp(Pitch, m_FootPitchMin, m_FootPitchMax);
-			m_RightFootRotOffset = FRotator(Pitch, 0.0f, Roll);
+		float Roll = FMath::Atan2(Normal.Y, Normal.Z) * Rad2Deg;
+		Roll = FMath::Clamp(Roll, m_FootRollMin, m_FootRollMax);
+		float Pitch = FMath::Atan2(Normal.X, Normal.Z) * Rad2Deg;
+		Pitch = -1.0f * FMath::Clamp(Pitch, m_FootPitchMin, m_FootPitchMax);
+		m_RightFootRotOffset = FRotator(Pitch, 0.0f, Roll);
 
-			float ZOffset = Hit.Location.Z - curLocation.Z;
-			targetRightZOffset = FMath::Clamp(ZOffset, m_FootZMin, m_FootZMax);
-		}
-		else
-		{
-			m_RightFootHit = false;
-			m_RightFootRotOffset = FRotator(0.0f, 0.0f, 0.0f);
-			targetRightZOffset = 0.0f;
-		}
+		float ZOffset = RightHit->Location.Z - BaseZ;
+		targetRightZOffset = FMath::Clamp(ZOffset, m_FootZMin, m_FootZMax);
+	}
+	else
+	{
+		m_RightFootHit = false;
+		m_RightFootRotOffset = FRotator(0.0f, 0.0f, 0.0f);
+		targetRightZOffset = 0.0f;
 	}
 
 	targetZOffset = FMath::Min(targetRightZOffset, targetLeftZOffset);
@@ -457,6 +558,12 @@ void AThirdPersonCharacter::HandleInteractive_Implementation(UGInterActiveCompon
 	}
 	else
 	{
+		//ֻڽҲܽ
+		if (target->GetInteractGuid() != GetGuid())
+		{
+			return;
+		}
+
 		//ضĹ
 		if (GetLocalRole() == ROLE_Authority)
 		{
@@ -67,6 +67,8 @@ protected:
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void OnRep_Controller() override;
 	// End of APawn interface
 
 public:
@@ -103,6 +105,8 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "IK")
 		void ClacIK(float deltaSecs);
+	/** ֻŵ߽IKƫƣûдnullptrBaseZΪʱMeshĸ߶ */
+	void ApplyFootIK(const FHitResult* LeftHit, const FHitResult* RightHit, float BaseZ, float deltaSecs);
 	UFUNCTION(BlueprintCallable, Category = "IK")
 		bool SweapCollisionTrace(AActor* pActor, const FVector& start, const FVector& end, FHitResult& Hit);
 
@@ -159,6 +163,10 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Gameplay|Projectile")
 		TSubclassOf<class AThirdPersonBullet> ProjectileClass;
 
+	/** ΪtrueʱUGProjectileSubsystemݷʽģͶÿһͬӵActorرպصɵActorʽڶԱȡ*/
+	UPROPERTY(EditDefaultsOnly, Config, Category = "Gameplay|Projectile")
+		bool bUseProjectileManager = true;
+
 	/** ֮ӳ٣λΪ롣ڿƲԷٶȣɷֹ½SpawnProjectileֱӰ롣*/
 	UPROPERTY(EditDefaultsOnly, Category = "Gameplay")
 		float FireRate;
@@ -172,6 +180,20 @@ protected:
 	/**  */
 	UAblAbilityComponent* m_SkillComp;
 
+	/** ɫõļܣʱԤأPlaySkillõ·"Skill/Able_Test"*/
+	UPROPERTY(EditDefaultsOnly, Category = "Skill")
+		TArray<FString> m_SkillLoadout;
+
+	/** Ѽأʼ */
+	void ActivateSkill(UAblAbility* pAbility, AActor* Sender, bool bPlayImmediately);
+
+	/** Ԥصļܳפ󣬰ԤScratchPadһͷʱ */
+	void PrewarmSkill(UAblAbility* pAbility);
+
+	/** ΪtrueʱClacIKUGFootIKSubsystemÿ֡첽⣬һ֡Ӧáرպصɵͬ⣬ڶԱȡ*/
+	UPROPERTY(EditDefaultsOnly, Config, Category = "AnimationIK")
+		bool bUseFootIKService = true;
+
 	/** IK */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AnimationIK", AdvancedDisplay)
 		bool m_RightFootHit;
@@ -0,0 +1,261 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GAbilityRegistry.h"
+
+#include "AbleCore/Classes/ablAbility.h"
+#include "AbleCore/Classes/Tasks/IAblAbilityTask.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/GameInstance.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+
+UGAbilityRegistry* UGAbilityRegistry::Get(const UObject* WorldContextObject)
+{
+	const UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UGAbilityRegistry>() : nullptr;
+}
+
+void UGAbilityRegistry::Deinitialize()
+{
+	Entries.Empty();
+	Waiters.Empty();
+	Stats.Resident = 0;
+	Stats.ResidentBytes = 0;
+
+	Super::Deinitialize();
+}
+
+UAblAbility* UGAbilityRegistry::FindResident(const FString& SkillId)
+{
+	FGAbilityEntry* Entry = Entries.Find(FName(*SkillId));
+	UAblAbility* Ability = Entry ? GetAbility(Entry->Class) : nullptr;
+	if (Ability)
+	{
+		Entry->LastUsedTime = FPlatformTime::Seconds();
+	}
+	return Ability;
+}
+
+void UGAbilityRegistry::LoadAbility(const FString& SkillId, const TFunction<void(UAblAbility*)>& Callback, const UObject* Owner/* = nullptr*/,
+	EGAssetLoadPriority Priority/* = EGAssetLoadPriority::Critical*/)
+{
+	FName Key;
+	FGAbilityEntry& Entry = FindOrAddEntry(SkillId, Key);
+	if (UAblAbility* Ability = GetAbility(Entry.Class))
+	{
+		Stats.Hits++;
+		Entry.LastUsedTime = FPlatformTime::Seconds();
+		if (Callback)
+		{
+			Callback(Ability);
+		}
+		return;
+	}
+
+	Stats.Misses++;
+	if (Callback)
+	{
+		FWaiter& Waiter = Waiters.FindOrAdd(Key).AddDefaulted_GetRef();
+		Waiter.Callback = Callback;
+		Waiter.Owner = Owner;
+		Waiter.bHasOwner = Owner != nullptr;
+	}
+	//同一个技能正在加载时只等结果, 不重复请求
+	if (!Entry.bLoading)
+	{
+		Load(Key, Entry, Priority, nullptr);
+	}
+}
+
+void UGAbilityRegistry::Prefetch(const TArray<FString>& SkillIds, const UObject* Owner/* = nullptr*/, const TFunction<void(UAblAbility*)>& Callback/* = nullptr*/)
+{
+	for (const FString& SkillId : SkillIds)
+	{
+		if (SkillId.IsEmpty())
+		{
+			continue;
+		}
+		FName Key;
+		FGAbilityEntry& Entry = FindOrAddEntry(SkillId, Key);
+		if (UAblAbility* Ability = GetAbility(Entry.Class))
+		{
+			if (Callback)
+			{
+				Callback(Ability);
+			}
+			continue;
+		}
+
+		if (Callback)
+		{
+			//预加载失败不通知, 和 LoadAbility 的等待者共用
+			FWaiter& Waiter = Waiters.FindOrAdd(Key).AddDefaulted_GetRef();
+			Waiter.Callback = [Callback](UAblAbility* Ability)
+			{
+				if (Ability)
+				{
+					Callback(Ability);
+				}
+			};
+			Waiter.Owner = Owner;
+			Waiter.bHasOwner = Owner != nullptr;
+		}
+		//每个角色被控制时都会预加载, 已经在队列里的不再重复排队
+		if (!Entry.bLoading && !Entry.IsPrefetchPending())
+		{
+			Load(Key, Entry, EGAssetLoadPriority::Prefetch, Owner);
+		}
+	}
+}
+
+FGAbilityEntry& UGAbilityRegistry::FindOrAddEntry(const FString& SkillId, FName& OutKey)
+{
+	OutKey = FName(*SkillId);
+	if (FGAbilityEntry* Entry = Entries.Find(OutKey))
+	{
+		return *Entry;
+	}
+	FGAbilityEntry& Entry = Entries.Add(OutKey);
+	Entry.SoftClassPath = UGAssetManager::ChangeToSoftClassPath(SkillId);
+	return Entry;
+}
+
+void UGAbilityRegistry::Load(FName Key, FGAbilityEntry& Entry, EGAssetLoadPriority Priority, const UObject* Owner)
+{
+	UGAssetManager* AssetManager = UGAssetManager::Get();
+	if (!AssetManager)
+	{
+		OnLoaded(Key, nullptr);
+		return;
+	}
+
+	//回调可能同步执行 (已经加载过), 先标记. 预加载可能因 Owner 销毁被丢掉, 不标记, 之后真正要用时再发一次请求
+	const bool bDelay = Priority != EGAssetLoadPriority::Critical;
+	Entry.bLoading |= !bDelay;
+	if (Priority == EGAssetLoadPriority::Prefetch)
+	{
+		Entry.bPrefetchPending = true;
+		Entry.PrefetchOwner = Owner;
+		Entry.bHasPrefetchOwner = Owner != nullptr;
+	}
+	TWeakObjectPtr<UGAbilityRegistry> WeakThis(this);
+	AssetManager->AsyncLoadAbility(Entry.SoftClassPath, [WeakThis, Key](UObject* Object)
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->OnLoaded(Key, Object);
+		}
+	}, bDelay, Priority, Owner);
+}
+
+void UGAbilityRegistry::OnLoaded(FName Key, UObject* Object)
+{
+	FGAbilityEntry* Entry = Entries.Find(Key);
+	if (!Entry)
+	{
+		return;
+	}
+	Entry->bLoading = false;
+	Entry->bPrefetchPending = false;
+
+	UClass* Class = Cast<UBlueprintGeneratedClass>(Object);
+	UAblAbility* Ability = GetAbility(Class);
+	if (!Ability)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UGAbilityRegistry %s is not an Able Ability: %s"), *Key.ToString(), *GetNameSafe(Object));
+	}
+	else if (!Entry->Class)
+	{
+		Entry->Class = Class;
+		Entry->Bytes = EstimateAbilityBytes(Class);
+		Stats.Resident++;
+		Stats.ResidentBytes += Entry->Bytes;
+	}
+	Entry->LastUsedTime = FPlatformTime::Seconds();
+
+	TArray<FWaiter> KeyWaiters;
+	Waiters.RemoveAndCopyValue(Key, KeyWaiters);
+	for (FWaiter& Waiter : KeyWaiters)
+	{
+		if (!Waiter.bHasOwner || Waiter.Owner.IsValid())
+		{
+			Waiter.Callback(Ability);
+		}
+	}
+
+	EvictOverBudget(Key);
+}
+
+void UGAbilityRegistry::EvictOverBudget(FName KeepKey)
+{
+	const int64 MaxBytes = (int64)(MaxResidentMemoryMB * 1024.0f * 1024.0f);
+	while (Stats.Resident > FMath::Max(MaxResidentAbilities, 1) || Stats.ResidentBytes > MaxBytes)
+	{
+		//技能数量不多, 直接找最久没用的
+		FGAbilityEntry* Oldest = nullptr;
+		for (TPair<FName, FGAbilityEntry>& It : Entries)
+		{
+			if (It.Value.Class && It.Key != KeepKey && (!Oldest || It.Value.LastUsedTime < Oldest->LastUsedTime))
+			{
+				Oldest = &It.Value;
+			}
+		}
+		if (!Oldest)
+		{
+			break;
+		}
+
+		Oldest->Class = nullptr;
+		Stats.Resident--;
+		Stats.ResidentBytes -= Oldest->Bytes;
+		Stats.Evictions++;
+		Oldest->Bytes = 0;
+	}
+}
+
+UAblAbility* UGAbilityRegistry::GetAbility(const UClass* Class)
+{
+	//使用 CDO 获取 UAblAbility, 解决在 DS 下客户端退出 DS 的 BUG
+	return Class ? Cast<UAblAbility>(Class->GetDefaultObject()) : nullptr;
+}
+
+int64 UGAbilityRegistry::EstimateAbilityBytes(const UClass* Class)
+{
+	//浅估算: Ability 和它的 Task, 共享的资源 (动画, 特效) 不算
+	int64 Bytes = Class->GetStructureSize();
+	if (const UAblAbility* Ability = GetAbility(Class))
+	{
+		for (const UAblAbilityTask* Task : Ability->GetTasks())
+		{
+			if (Task)
+			{
+				Bytes += Task->GetClass()->GetStructureSize();
+			}
+		}
+	}
+	return Bytes;
+}
+
+void UGAbilityRegistry::DumpStats() const
+{
+	UE_LOG(LogTemp, Display, TEXT("UGAbilityRegistry Resident=%d (%.1f KB) Hits=%d Misses=%d Evictions=%d"),
+		Stats.Resident, Stats.ResidentBytes / 1024.0, Stats.Hits, Stats.Misses, Stats.Evictions);
+	for (const TPair<FName, FGAbilityEntry>& It : Entries)
+	{
+		UE_LOG(LogTemp, Display, TEXT("  %s %s%s %lld B"), *It.Key.ToString(), It.Value.Class ? TEXT("resident") : TEXT("unloaded"),
+			It.Value.bLoading ? TEXT(" (loading)") : It.Value.IsPrefetchPending() ? TEXT(" (prefetching)") : TEXT(""), It.Value.Bytes);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld GAbilityRegistryDumpCommand(
+	TEXT("G.AbilityRegistry.Dump"),
+	TEXT("Logs resident abilities and hit / miss / eviction counts."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UGAbilityRegistry* Registry = UGAbilityRegistry::Get(World))
+		{
+			Registry->DumpStats();
+		}
+	}));
+#endif
@@ -0,0 +1,115 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GAssetManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "GAbilityRegistry.generated.h"
+
+class UAblAbility;
+
+USTRUCT()
+struct FGAbilityEntry
+{
+	GENERATED_BODY()
+
+	//常驻时持有, 淘汰后置空让 GC 卸载
+	UPROPERTY()
+	UClass* Class = nullptr;
+
+	//技能 ID 只转换一次
+	FSoftClassPath SoftClassPath;
+	double LastUsedTime = 0.0;
+	int64 Bytes = 0;
+	//立即加载的请求还没回来
+	bool bLoading = false;
+	//预加载已进入延迟队列还没回来, Owner 销毁后请求会被丢掉, 视为没有
+	bool bPrefetchPending = false;
+	TWeakObjectPtr<const UObject> PrefetchOwner;
+	bool bHasPrefetchOwner = false;
+
+	bool IsPrefetchPending() const { return bPrefetchPending && (!bHasPrefetchOwner || PrefetchOwner.IsValid()); }
+};
+
+USTRUCT(BlueprintType)
+struct FGAbilityRegistryStats
+{
+	GENERATED_BODY()
+
+	//常驻, 同步播放
+	UPROPERTY(BlueprintReadOnly, Category = AbilityRegistry)
+	int32 Hits = 0;
+
+	//需要异步加载
+	UPROPERTY(BlueprintReadOnly, Category = AbilityRegistry)
+	int32 Misses = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = AbilityRegistry)
+	int32 Evictions = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = AbilityRegistry)
+	int32 Resident = 0;
+
+	//常驻技能估算内存
+	UPROPERTY(BlueprintReadOnly, Category = AbilityRegistry)
+	int64 ResidentBytes = 0;
+};
+
+/**
+ * Maps skill IDs (the /Game relative paths PlaySkill takes, e.g. "Skill/Able_Test") to loaded UAblAbility classes.
+ * Loads go through UGAssetManager; resident abilities are held here, least recently used first out once over the count or memory budget.
+ */
+UCLASS(Config = Game)
+class THIRDPERSON_API UGAbilityRegistry : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UGAbilityRegistry* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	//常驻时直接返回 CDO, 否则返回 nullptr, 不会发起加载
+	UAblAbility* FindResident(const FString& SkillId);
+
+	//常驻时同步回调, 否则异步加载后回调, 失败回调 nullptr; Owner 销毁后不再回调
+	void LoadAbility(const FString& SkillId, const TFunction<void(UAblAbility*)>& Callback, const UObject* Owner = nullptr,
+		EGAssetLoadPriority Priority = EGAssetLoadPriority::Critical);
+
+	//把技能加入 UGAssetManager 的延迟加载队列, Callback 在每个技能常驻后调用 (已常驻则立即调用), 失败不回调; Owner 销毁后不再回调
+	void Prefetch(const TArray<FString>& SkillIds, const UObject* Owner = nullptr, const TFunction<void(UAblAbility*)>& Callback = nullptr);
+
+	const FGAbilityRegistryStats& GetStats() const { return Stats; }
+	void DumpStats() const;
+
+private:
+	struct FWaiter
+	{
+		TFunction<void(UAblAbility*)> Callback;
+		TWeakObjectPtr<const UObject> Owner;
+		bool bHasOwner = false;
+	};
+
+	FGAbilityEntry& FindOrAddEntry(const FString& SkillId, FName& OutKey);
+	void Load(FName Key, FGAbilityEntry& Entry, EGAssetLoadPriority Priority, const UObject* Owner);
+	void OnLoaded(FName Key, UObject* Object);
+	void EvictOverBudget(FName KeepKey);
+	static UAblAbility* GetAbility(const UClass* Class);
+	static int64 EstimateAbilityBytes(const UClass* Class);
+
+private:
+	//最多常驻的技能数
+	UPROPERTY(Config)
+	int32 MaxResidentAbilities = 64;
+
+	//常驻技能最多占用的内存 (估算)
+	UPROPERTY(Config)
+	float MaxResidentMemoryMB = 32.0f;
+
+	UPROPERTY(Transient)
+	TMap<FName, FGAbilityEntry> Entries;
+
+	TMap<FName, TArray<FWaiter>> Waiters;
+	FGAbilityRegistryStats Stats;
+};
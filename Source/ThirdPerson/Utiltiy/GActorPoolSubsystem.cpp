@@ -0,0 +1,407 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GActorPoolSubsystem.h"
+
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "GAssetManager.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+
+#define g_EvictCheckInterval 30.0f
+
+UGActorPoolSubsystem* UGActorPoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UGActorPoolSubsystem>() : nullptr;
+}
+
+bool UGActorPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGActorPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	InWorld.GetTimerManager().SetTimer(EvictTimerHandle, FTimerDelegate::CreateUObject(this, &UGActorPoolSubsystem::EvictIdle), g_EvictCheckInterval, true);
+
+	for (const FGActorPoolClassConfig& Config : PoolClasses)
+	{
+		if (Config.PrewarmCount <= 0 || Config.ActorClass.IsNull())
+		{
+			continue;
+		}
+
+		if (UClass* Class = Config.ActorClass.Get())
+		{
+			Prewarm(Class, Config.PrewarmCount);
+			continue;
+		}
+
+		UGAssetManager* AssetManager = UGAssetManager::Get();
+		if (!AssetManager)
+		{
+			Prewarm(Config.ActorClass.LoadSynchronous(), Config.PrewarmCount);
+			continue;
+		}
+
+		TWeakObjectPtr<UGActorPoolSubsystem> WeakThis(this);
+		const int32 PrewarmCount = Config.PrewarmCount;
+		AssetManager->AsyncLoadResource(Config.ActorClass.ToSoftObjectPath(), [WeakThis, PrewarmCount](UObject* Object)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->Prewarm(Cast<UClass>(Object), PrewarmCount);
+			}
+		});
+	}
+}
+
+void UGActorPoolSubsystem::Deinitialize()
+{
+	// The world is going away and takes the pooled Actors with it, just drop our references.
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(EvictTimerHandle);
+	}
+	Pools.Empty();
+	TotalStats.Pooled = 0;
+	TotalStats.PooledBytes = 0;
+
+	Super::Deinitialize();
+}
+
+AActor* UGActorPoolSubsystem::Acquire(UClass* Class, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters)
+{
+	UWorld* World = GetWorld();
+	if (!Class || !Class->IsChildOf<AActor>() || !World || World->bIsTearingDown)
+	{
+		return nullptr;
+	}
+
+	FPool& Pool = FindOrAddPool(Class);
+	while (Pool.Actors.Num())
+	{
+		const FPooledActor Pooled = Pool.Actors.Pop(false);
+		--Pool.Stats.Pooled;
+		--TotalStats.Pooled;
+		Pool.Stats.PooledBytes -= Pool.ActorBytes;
+		TotalStats.PooledBytes -= Pool.ActorBytes;
+
+		// Destroyed while pooled (level unload, etc).
+		AActor* Actor = Pooled.Actor.Get();
+		if (!IsValid(Actor))
+		{
+			continue;
+		}
+
+		++Pool.Stats.Hits;
+		++TotalStats.Hits;
+		Activate(Actor, Transform, SpawnParameters);
+		return Actor;
+	}
+
+	++Pool.Stats.Misses;
+	++TotalStats.Misses;
+	return World->SpawnActor<AActor>(Class, Transform, SpawnParameters);
+}
+
+void UGActorPoolSubsystem::Release(AActor* Actor)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	if (!World || World->bIsTearingDown || Actor->GetWorld() != World)
+	{
+		Actor->Destroy();
+		return;
+	}
+
+	FPool& Pool = FindOrAddPool(Actor->GetClass());
+	if (Pool.Actors.ContainsByPredicate([Actor](const FPooledActor& Pooled) { return Pooled.Actor.Get() == Actor; }))
+	{
+		return;
+	}
+
+	if (Pool.ActorBytes == 0)
+	{
+		Pool.ActorBytes = EstimateActorBytes(Actor);
+	}
+
+	if (Pool.Actors.Num() >= Pool.MaxPooled || Pool.Stats.PooledBytes + Pool.ActorBytes > Pool.MaxPooledBytes)
+	{
+		++Pool.Stats.Evictions;
+		++TotalStats.Evictions;
+		Actor->Destroy();
+		return;
+	}
+
+	Deactivate(Actor);
+	Pool.Actors.Add(FPooledActor{ Actor, World->GetTimeSeconds() });
+	++Pool.Stats.Pooled;
+	++TotalStats.Pooled;
+	Pool.Stats.PooledBytes += Pool.ActorBytes;
+	TotalStats.PooledBytes += Pool.ActorBytes;
+
+	EvictOverBudget();
+}
+
+void UGActorPoolSubsystem::Prewarm(UClass* Class, int32 Count)
+{
+	UWorld* World = GetWorld();
+	if (!Class || !Class->IsChildOf<AActor>() || !World || World->bIsTearingDown)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	int32 NumSpawned = 0;
+	for (; NumSpawned < Count; ++NumSpawned)
+	{
+		// Looked up again every time, a spawned Actor's BeginPlay can Acquire another class and grow Pools.
+		const FPool& Pool = FindOrAddPool(Class);
+		if (Pool.Actors.Num() >= Pool.MaxPooled)
+		{
+			break;
+		}
+
+		// The size is only known once the first one is pooled, stop before the class goes over its memory cap.
+		if (Pool.ActorBytes > 0 && Pool.Stats.PooledBytes + Pool.ActorBytes > Pool.MaxPooledBytes)
+		{
+			break;
+		}
+
+		if (AActor* Actor = World->SpawnActor<AActor>(Class, FTransform::Identity, SpawnParameters))
+		{
+			Release(Actor);
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("UGActorPoolSubsystem::Prewarm %s %d"), *Class->GetName(), NumSpawned);
+}
+
+void UGActorPoolSubsystem::Empty()
+{
+	for (TPair<const UClass*, FPool>& It : Pools)
+	{
+		while (It.Value.Actors.Num())
+		{
+			Evict(It.Value, It.Value.Actors.Num() - 1);
+		}
+	}
+}
+
+FGActorPoolStats UGActorPoolSubsystem::GetClassStats(const UClass* Class) const
+{
+	const FPool* Pool = Pools.Find(Class);
+	return Pool ? Pool->Stats : FGActorPoolStats();
+}
+
+void UGActorPoolSubsystem::DumpStats() const
+{
+	UE_LOG(LogTemp, Log, TEXT("UGActorPoolSubsystem Total: Hits %d Misses %d Evictions %d Pooled %d (%.2f MB)"),
+		TotalStats.Hits, TotalStats.Misses, TotalStats.Evictions, TotalStats.Pooled, TotalStats.PooledBytes / (1024.0f * 1024.0f));
+
+	for (const TPair<const UClass*, FPool>& It : Pools)
+	{
+		const FGActorPoolStats& Stats = It.Value.Stats;
+		UE_LOG(LogTemp, Log, TEXT("    %s: Hits %d Misses %d Evictions %d Pooled %d/%d (%.2f/%.2f MB)"),
+			*GetNameSafe(It.Key), Stats.Hits, Stats.Misses, Stats.Evictions, Stats.Pooled, It.Value.MaxPooled,
+			Stats.PooledBytes / (1024.0f * 1024.0f), It.Value.MaxPooledBytes / (1024.0f * 1024.0f));
+	}
+}
+
+UGActorPoolSubsystem::FPool& UGActorPoolSubsystem::FindOrAddPool(const UClass* Class)
+{
+	if (FPool* Pool = Pools.Find(Class))
+	{
+		return *Pool;
+	}
+
+	FPool& Pool = Pools.Add(Class);
+	Pool.MaxPooled = DefaultMaxPooledPerClass;
+	float MaxPooledMemoryPerClassMB = DefaultMaxPooledMemoryPerClassMB;
+
+	const FSoftObjectPath ClassPath(Class);
+	for (const FGActorPoolClassConfig& Config : PoolClasses)
+	{
+		if (Config.ActorClass.ToSoftObjectPath() == ClassPath)
+		{
+			Pool.MaxPooled = Config.MaxPooled > 0 ? Config.MaxPooled : DefaultMaxPooledPerClass;
+			MaxPooledMemoryPerClassMB = Config.MaxPooledMemoryMB > 0.0f ? Config.MaxPooledMemoryMB : DefaultMaxPooledMemoryPerClassMB;
+			break;
+		}
+	}
+	Pool.MaxPooledBytes = (int64)(MaxPooledMemoryPerClassMB * 1024.0f * 1024.0f);
+
+	return Pool;
+}
+
+void UGActorPoolSubsystem::Deactivate(AActor* Actor) const
+{
+	// A pending life span would destroy the Actor while it sits in the pool.
+	Actor->SetLifeSpan(0.0f);
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component)
+		{
+			Component->SetComponentTickEnabled(false);
+			Component->Deactivate();
+		}
+	}
+
+	if (Actor->GetIsReplicated() && Actor->HasAuthority())
+	{
+		Actor->ForceNetUpdate();
+	}
+
+	if (Actor->Implements<UGPoolableActor>())
+	{
+		IGPoolableActor::Execute_OnPooled(Actor);
+	}
+}
+
+void UGActorPoolSubsystem::Activate(AActor* Actor, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters) const
+{
+	const AActor* DefaultActor = Actor->GetClass()->GetDefaultObject<AActor>();
+
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetOwner(SpawnParameters.Owner);
+	Actor->SetInstigator(SpawnParameters.Instigator);
+
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component)
+		{
+			if (Component->bAutoActivate)
+			{
+				Component->Activate(true);
+			}
+			Component->SetComponentTickEnabled(Component->PrimaryComponentTick.bStartWithTickEnabled);
+		}
+	}
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+	Actor->SetActorEnableCollision(DefaultActor->GetActorEnableCollision());
+	Actor->SetActorHiddenInGame(DefaultActor->IsHidden());
+	Actor->CustomTimeDilation = DefaultActor->CustomTimeDilation;
+	Actor->SetLifeSpan(DefaultActor->InitialLifeSpan);
+
+	if (Actor->GetIsReplicated() && Actor->HasAuthority())
+	{
+		Actor->ForceNetUpdate();
+	}
+
+	if (Actor->Implements<UGPoolableActor>())
+	{
+		IGPoolableActor::Execute_OnUnpooled(Actor);
+	}
+}
+
+void UGActorPoolSubsystem::Evict(FPool& Pool, int32 Index)
+{
+	AActor* Actor = Pool.Actors[Index].Actor.Get();
+	Pool.Actors.RemoveAt(Index, 1, false);
+
+	--Pool.Stats.Pooled;
+	--TotalStats.Pooled;
+	Pool.Stats.PooledBytes -= Pool.ActorBytes;
+	TotalStats.PooledBytes -= Pool.ActorBytes;
+	++Pool.Stats.Evictions;
+	++TotalStats.Evictions;
+
+	if (IsValid(Actor))
+	{
+		Actor->Destroy();
+	}
+}
+
+void UGActorPoolSubsystem::EvictOverBudget()
+{
+	const int64 MaxPooledBytes = (int64)(MaxPooledMemoryMB * 1024.0f * 1024.0f);
+	while (TotalStats.Pooled > MaxPooledActors || TotalStats.PooledBytes > MaxPooledBytes)
+	{
+		// Actors are appended as they're released, so the front of each pool is its oldest.
+		FPool* OldestPool = nullptr;
+		for (TPair<const UClass*, FPool>& It : Pools)
+		{
+			if (It.Value.Actors.Num() && (!OldestPool || It.Value.Actors[0].ReleaseTime < OldestPool->Actors[0].ReleaseTime))
+			{
+				OldestPool = &It.Value;
+			}
+		}
+
+		if (!OldestPool)
+		{
+			break;
+		}
+
+		Evict(*OldestPool, 0);
+	}
+}
+
+void UGActorPoolSubsystem::EvictIdle()
+{
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	const double OldestAllowed = World->GetTimeSeconds() - IdleEvictSeconds;
+	for (TPair<const UClass*, FPool>& It : Pools)
+	{
+		while (It.Value.Actors.Num() && It.Value.Actors[0].ReleaseTime < OldestAllowed)
+		{
+			Evict(It.Value, 0);
+		}
+	}
+}
+
+int64 UGActorPoolSubsystem::EstimateActorBytes(const AActor* Actor)
+{
+	// Shallow, the Actor and its components. Shared assets (meshes, materials) aren't owned by the pool.
+	int64 Bytes = Actor->GetClass()->GetStructureSize();
+	for (const UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component)
+		{
+			Bytes += Component->GetClass()->GetStructureSize();
+		}
+	}
+	return Bytes;
+}
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld GActorPoolDumpCommand(
+	TEXT("G.ActorPool.Dump"),
+	TEXT("Logs hit / miss / eviction counts and pooled memory per Actor class."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UGActorPoolSubsystem* Pool = UGActorPoolSubsystem::Get(World))
+		{
+			Pool->DumpStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld GActorPoolEmptyCommand(
+	TEXT("G.ActorPool.Empty"),
+	TEXT("Destroys every pooled Actor."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UGActorPoolSubsystem* Pool = UGActorPoolSubsystem::Get(World))
+		{
+			Pool->Empty();
+		}
+	}));
+#endif
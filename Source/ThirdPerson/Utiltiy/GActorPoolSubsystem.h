@@ -0,0 +1,173 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "GActorPoolSubsystem.generated.h"
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UGPoolableActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Actors that can be reused by UGActorPoolSubsystem. Reset any per use state in these instead of BeginPlay / EndPlay,
+ * which only run once per pooled Actor.
+ */
+class THIRDPERSON_API IGPoolableActor
+{
+	GENERATED_BODY()
+
+public:
+	//进池前调用, Actor 已经隐藏, 关闭碰撞和 Tick
+	UFUNCTION(BlueprintNativeEvent, Category = ActorPool)
+	void OnPooled();
+
+	//出池后调用, Actor 已经放到新的位置并重新激活
+	//池只恢复隐藏、碰撞、Tick、组件激活、时间膨胀和寿命为类默认值, 其余状态 (生命值、速度等) 在这里重置
+	UFUNCTION(BlueprintNativeEvent, Category = ActorPool)
+	void OnUnpooled();
+};
+
+USTRUCT()
+struct FGActorPoolClassConfig
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config, EditAnywhere, Category = ActorPool)
+	TSoftClassPtr<AActor> ActorClass;
+
+	//BeginPlay 时预先生成的数量
+	UPROPERTY(Config, EditAnywhere, Category = ActorPool)
+	int32 PrewarmCount = 0;
+
+	//池中最多保留的数量, <= 0 使用 DefaultMaxPooledPerClass
+	UPROPERTY(Config, EditAnywhere, Category = ActorPool)
+	int32 MaxPooled = 0;
+
+	//池中最多占用的内存 (估算), <= 0 使用 DefaultMaxPooledMemoryPerClassMB
+	UPROPERTY(Config, EditAnywhere, Category = ActorPool)
+	float MaxPooledMemoryMB = 0.0f;
+};
+
+USTRUCT(BlueprintType)
+struct FGActorPoolStats
+{
+	GENERATED_BODY()
+
+	//从池中取到
+	UPROPERTY(BlueprintReadOnly, Category = ActorPool)
+	int32 Hits = 0;
+
+	//池为空, 新生成
+	UPROPERTY(BlueprintReadOnly, Category = ActorPool)
+	int32 Misses = 0;
+
+	//超出上限或闲置过久被销毁
+	UPROPERTY(BlueprintReadOnly, Category = ActorPool)
+	int32 Evictions = 0;
+
+	//当前池中数量
+	UPROPERTY(BlueprintReadOnly, Category = ActorPool)
+	int32 Pooled = 0;
+
+	//当前池中估算内存
+	UPROPERTY(BlueprintReadOnly, Category = ActorPool)
+	int64 PooledBytes = 0;
+};
+
+/**
+ * Per world Actor pool, keyed by class. Released Actors are deactivated (hidden, no collision, no tick) and kept in the level
+ * rather than rooted, so they go away with their world.
+ */
+UCLASS(Config = Game)
+class THIRDPERSON_API UGActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UGActorPoolSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	//从池中取, 没有则生成
+	AActor* Acquire(UClass* Class, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters = FActorSpawnParameters());
+
+	template< class T >
+	T* Acquire(UClass* Class, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters = FActorSpawnParameters())
+	{
+		return Cast<T>(Acquire(Class, Transform, SpawnParameters));
+	}
+
+	//放回池中, 超出上限则直接销毁
+	void Release(AActor* Actor);
+
+	//预先生成 Count 个放入池中
+	void Prewarm(UClass* Class, int32 Count);
+
+	//销毁池中所有 Actor
+	void Empty();
+
+	const FGActorPoolStats& GetStats() const { return TotalStats; }
+	FGActorPoolStats GetClassStats(const UClass* Class) const;
+
+	void DumpStats() const;
+
+private:
+	struct FPooledActor
+	{
+		TWeakObjectPtr<AActor> Actor;
+		double ReleaseTime;
+	};
+
+	struct FPool
+	{
+		TArray<FPooledActor> Actors;
+		int32 MaxPooled = 0;
+		int64 MaxPooledBytes = 0;
+		int64 ActorBytes = 0;
+		FGActorPoolStats Stats;
+	};
+
+	FPool& FindOrAddPool(const UClass* Class);
+	void Deactivate(AActor* Actor) const;
+	void Activate(AActor* Actor, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters) const;
+	void Evict(FPool& Pool, int32 Index);
+	void EvictOverBudget();
+	void EvictIdle();
+	static int64 EstimateActorBytes(const AActor* Actor);
+
+private:
+	UPROPERTY(Config)
+	TArray<FGActorPoolClassConfig> PoolClasses;
+
+	//没有单独配置的类, 池中最多保留的数量
+	UPROPERTY(Config)
+	int32 DefaultMaxPooledPerClass = 32;
+
+	//没有单独配置的类, 池中最多占用的内存 (估算)
+	UPROPERTY(Config)
+	float DefaultMaxPooledMemoryPerClassMB = 16.0f;
+
+	//所有类加起来最多保留的数量
+	UPROPERTY(Config)
+	int32 MaxPooledActors = 512;
+
+	//所有类加起来最多占用的内存 (估算)
+	UPROPERTY(Config)
+	float MaxPooledMemoryMB = 64.0f;
+
+	//闲置超过这个时间的 Actor 会被销毁
+	UPROPERTY(Config)
+	float IdleEvictSeconds = 600.0f;
+
+	TMap<const UClass*, FPool> Pools;
+	FGActorPoolStats TotalStats;
+	FTimerHandle EvictTimerHandle;
+};
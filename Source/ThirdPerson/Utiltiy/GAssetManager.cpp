@@ -2,7 +2,18 @@
 
 #include "GAssetManager.h"
 
+#include "AssetRegistry/IAssetRegistry.h"
+#include "HAL/IConsoleManager.h"
+
 #define g_ReleaseTime 600 //10 min
+
+DECLARE_STATS_GROUP(TEXT("GAssetManager"), STATGROUP_GAssetManager, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Delay Load Tick"), STAT_GAssetManager_DelayLoadTick, STATGROUP_GAssetManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Delay Load Queue (Critical)"), STAT_GAssetManager_QueuedCritical, STATGROUP_GAssetManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Delay Load Queue (Cosmetic)"), STAT_GAssetManager_QueuedCosmetic, STATGROUP_GAssetManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Delay Load Queue (Prefetch)"), STAT_GAssetManager_QueuedPrefetch, STATGROUP_GAssetManager);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Delay Loads Issued"), STAT_GAssetManager_Issued, STATGROUP_GAssetManager);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Delay Load Max Latency (ms)"), STAT_GAssetManager_MaxLatency, STATGROUP_GAssetManager);
 UGAssetManager* UGAssetManager::Get()
 {
 	return Cast<UGAssetManager>(GEngine->AssetManager);
@@ -13,10 +24,75 @@ UGAssetManager::UGAssetManager() : Super()
 	RegisterWorldBeginTearDown();
 }
 
+void UGAssetManager::StartInitialLoading()
+{
+	Super::StartInitialLoading();
+
+	//OnTick 没有被任何地方调用, 延迟加载队列从来不会出队, 这里挂到 Core Ticker 上
+	if (!TickHandle.IsValid())
+	{
+		TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float DeltaTime)
+		{
+			OnTick(DeltaTime);
+			return true;
+		}));
+	}
+
+	//Content/Skill 下的非资源文件通过 DirectoriesToAlwaysStageAsUFS 打进包里
+	const FString ManifestPath = FPaths::ProjectContentDir() / TEXT("Skill/AbilityManifest.json");
+	if (AbilityManifest.LoadFromFile(ManifestPath))
+	{
+		UE_LOG(LogTemp, Log, TEXT("UGAssetManager Ability manifest %d abilities"), AbilityManifest.Num());
+
+		//服务器和客户端用同一份清单, 技能同步时发清单里的序号而不是对象引用
+		FAblAbilityNetIndex::Get().Build(AbilityManifest);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Log, TEXT("UGAssetManager No ability manifest at %s, abilities load their content on their own"), *ManifestPath);
+	}
+}
+
+void UGAssetManager::BeginDestroy()
+{
+	if (TickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+		TickHandle.Reset();
+	}
+	Super::BeginDestroy();
+}
+
 void UGAssetManager::OnWorldBeginTearDown(UWorld* InWorld)
 {
-	EmptyObjectPoolMap();
-	AssetDelayLoadQueue.Empty();
+	EmptyObjectPoolMap(InWorld);
+
+	//丢掉没有 Owner 的 (回调里可能有这个 World 的裸指针) 和 Owner 属于这个 World 的, 其他 World 的保留
+	for (TArray<FGAssetDelayLoad>& Queue : AssetDelayLoadQueues)
+	{
+		Queue.RemoveAll([InWorld](const FGAssetDelayLoad& DelayLoad)
+		{
+			const UObject* Owner = DelayLoad.Owner.Get();
+			return !Owner || Owner == InWorld || Owner->IsIn(InWorld);
+		});
+	}
+}
+
+UWorld* UGAssetManager::GetCurWorld()
+{
+	if (!GEngine)
+	{
+		return nullptr;
+	}
+	for (const FWorldContext& WorldContext : GEngine->GetWorldContexts())
+	{
+		UWorld* World = WorldContext.World();
+		if (World && World->IsGameWorld() && !World->bIsTearingDown)
+		{
+			return World;
+		}
+	}
+	return nullptr;
 }
 
 FSoftObjectPath UGAssetManager::ChangeToSoftObjectPath(const FString& AssetPath)
@@ -72,13 +148,15 @@ bool UGAssetManager::IsAssetExist(const FString& AssetPath)
 }
 
 //异步加载纯资源文件
-void UGAssetManager::AsyncLoadResource(const FString& AssetPath, const TFunction<void(UObject*)>& Callback, bool Delay/* = false*/)
+void UGAssetManager::AsyncLoadResource(const FString& AssetPath, const TFunction<void(UObject*)>& Callback, bool Delay/* = false*/,
+	EGAssetLoadPriority Priority/* = EGAssetLoadPriority::Cosmetic*/, const UObject* Owner/* = nullptr*/)
 {
 	const FSoftObjectPath SoftObjectPath = ChangeToSoftObjectPath(AssetPath);
-	AsyncLoadResource(SoftObjectPath, Callback, Delay);
+	AsyncLoadResource(SoftObjectPath, Callback, Delay, Priority, Owner);
 }
 
-void UGAssetManager::AsyncLoadResource(const FSoftObjectPath& SoftObjectPath, const TFunction<void(UObject*)>& Callback, bool Delay/* = false*/)
+void UGAssetManager::AsyncLoadResource(const FSoftObjectPath& SoftObjectPath, const TFunction<void(UObject*)>& Callback, bool Delay/* = false*/,
+	EGAssetLoadPriority Priority/* = EGAssetLoadPriority::Cosmetic*/, const UObject* Owner/* = nullptr*/)
 {
 	UObject* Object = TryGetObjectFromPool(SoftObjectPath.ToString());
 	if (Object)
@@ -89,63 +167,97 @@ void UGAssetManager::AsyncLoadResource(const FSoftObjectPath& SoftObjectPath, co
 	}
 	if(Delay)
 	{
-		AssetDelayLoadQueue.Enqueue(FGAssetDelayLoad(SoftObjectPath, Callback));
+		EnqueueDelayLoad(SoftObjectPath, Callback, Priority, Owner);
 		return;
 	}
 	const TSharedPtr<FStreamableHandle> Handle = GetStreamableManager().RequestAsyncLoad(TArray<FSoftObjectPath>{SoftObjectPath});
 	BindStreamableCompleteDelegate(Handle, Callback);
 }
 
+void UGAssetManager::AsyncLoadAbility(const FSoftClassPath& SoftClassPath, const TFunction<void(UObject*)>& Callback, bool Delay/* = false*/,
+	EGAssetLoadPriority Priority/* = EGAssetLoadPriority::Critical*/, const UObject* Owner/* = nullptr*/)
+{
+	const FAblAbilityDependencies* Dependencies = AbilityManifest.Find(SoftClassPath);
+	if (!Dependencies)
+	{
+		AsyncLoadBluePrint(SoftClassPath, Callback, Delay, Priority, Owner);
+		return;
+	}
+
+	TArray<FSoftObjectPath> Paths;
+	Dependencies->GetLoadList(SoftClassPath, !IsRunningDedicatedServer(), Paths);
+	if (Delay)
+	{
+		FGAssetDelayLoad& DelayLoad = EnqueueDelayLoad(SoftClassPath, Callback, Priority, Owner);
+		DelayLoad.Dependencies.Append(Paths.GetData() + 1, Paths.Num() - 1);
+		return;
+	}
+
+	TArray<FGAssetDelayLoad> DelayLoads;
+	DelayLoads.Emplace(SoftClassPath, Callback, Owner);
+	IssueDelayLoads(MoveTemp(DelayLoads), MoveTemp(Paths), Priority);
+}
+
 void UGAssetManager::RequestAsyncLoad(const TArray<FSoftObjectPath>& TargetsToStream, TFunction<void(const TArray<UObject*>&)> Callback)
 {
 	TArray<FSoftObjectPath> RequestPaths;
-	TArray<FString> TargetStringArray;
-	TArray<UObject*> Caches;
-	for (const FSoftObjectPath& SoftObjectPath : TargetsToStream)
+	RequestPaths.Reserve(TargetsToStream.Num());
+	TSharedRef<FGAssetLoadBatch> Batch = MakeShared<FGAssetLoadBatch>();
+	Batch->Result.SetNumZeroed(TargetsToStream.Num());
+	Batch->Slots.Reset(TargetsToStream.Num());
+
+	//对象池通常是空的, 空的时候不用为查池子拼路径字符串
+	const bool bCheckPool = ObjectPoolMap.Num() > 0;
+	int32 NumCached = 0;
+	for (int32 Slot = 0; Slot < TargetsToStream.Num(); Slot++)
 	{
-		FString PathName = SoftObjectPath.ToString();
-		TargetStringArray.Push(PathName);
-		UObject* Object = TryGetObjectFromPool(PathName);
-		if (Object)
+		const FSoftObjectPath& SoftObjectPath = TargetsToStream[Slot];
+		if (SoftObjectPath.IsNull())
 		{
-			Object->AddToRoot();
-			Caches.Add(Object);
+			continue;
 		}
-		else
+		UObject* Object = bCheckPool ? TryGetObjectFromPool(SoftObjectPath.ToString()) : nullptr;
+		if (Object)
 		{
-			RequestPaths.Add(SoftObjectPath);
+			Batch->Result[Slot] = Object;
+			NumCached++;
+			continue;
 		}
+		Batch->Slots.Add(SoftObjectPath, Slot);
+		RequestPaths.Add(SoftObjectPath);
 	}
 	if (RequestPaths.Num() == 0)
 	{
-		Callback(Caches);
-		UE_LOG(LogTemp, Log, TEXT("UGAssetManager::RequestAsyncLoad All Cache %d"), Caches.Num());
+		Callback(Batch->Result);
+		UE_LOG(LogTemp, Log, TEXT("UGAssetManager::RequestAsyncLoad All Cache %d"), NumCached);
 		return;
 	}
-	const TSharedPtr<FStreamableHandle> StreamableHandle = GetStreamableManager().RequestAsyncLoad(RequestPaths);
+	const TSharedPtr<FStreamableHandle> StreamableHandle = GetStreamableManager().RequestAsyncLoad(MoveTemp(RequestPaths));
 	if (StreamableHandle->HasLoadCompleted())
 	{
-		StreamableCompleteDelegates(StreamableHandle, Callback, Caches, TargetStringArray);
+		StreamableCompleteDelegates(StreamableHandle, Callback, Batch);
 		return;
 	}
 
 	FStreamableDelegate Delegate;
-	Delegate.BindLambda([StreamableHandle, Callback, Caches, TargetStringArray]()
+	Delegate.BindLambda([StreamableHandle, Callback, Batch]()
 	{
-		StreamableCompleteDelegates(StreamableHandle, Callback, Caches, TargetStringArray);
+		StreamableCompleteDelegates(StreamableHandle, Callback, Batch);
 	});
 	StreamableHandle->BindCompleteDelegate(MoveTemp(Delegate));
 }
 
 //异步加载蓝图类文件
-void UGAssetManager::AsyncLoadBluePrint(const FString& Path, const TFunction<void(UObject*)>& Callback, bool Delay/* = false*/)
+void UGAssetManager::AsyncLoadBluePrint(const FString& Path, const TFunction<void(UObject*)>& Callback, bool Delay/* = false*/,
+	EGAssetLoadPriority Priority/* = EGAssetLoadPriority::Cosmetic*/, const UObject* Owner/* = nullptr*/)
 {
 	static FSoftClassPath s_SoftClassPath;
 	s_SoftClassPath = ChangeToSoftClassPath(Path);
-	AsyncLoadBluePrint(s_SoftClassPath, Callback, Delay);
+	AsyncLoadBluePrint(s_SoftClassPath, Callback, Delay, Priority, Owner);
 }
 
-void UGAssetManager::AsyncLoadBluePrint(const FSoftClassPath& SoftClassPath, const TFunction<void(UObject*)>& Callback, bool Delay/* = false*/)
+void UGAssetManager::AsyncLoadBluePrint(const FSoftClassPath& SoftClassPath, const TFunction<void(UObject*)>& Callback, bool Delay/* = false*/,
+	EGAssetLoadPriority Priority/* = EGAssetLoadPriority::Cosmetic*/, const UObject* Owner/* = nullptr*/)
 {
 	UObject* Object = TryGetObjectFromPool(SoftClassPath.ToString());
 	if (Object)
@@ -156,7 +268,7 @@ void UGAssetManager::AsyncLoadBluePrint(const FSoftClassPath& SoftClassPath, con
 	}
 	if(Delay)
 	{
-		AssetDelayLoadQueue.Enqueue(FGAssetDelayLoad(SoftClassPath, Callback));
+		EnqueueDelayLoad(SoftClassPath, Callback, Priority, Owner);
 		return;
 	}
 	TSharedPtr<FStreamableHandle> Handle = GetStreamableManager().RequestAsyncLoad(TArray<FSoftObjectPath>{SoftClassPath});
@@ -185,6 +297,11 @@ void UGAssetManager::Recycle(UObject* Object)
 	{
 		return;
 	}
+	if (AActor* Actor = Cast<AActor>(Object))
+	{
+		RecycleActor(Actor);
+		return;
+	}
 	CheckObjectPool();	// Remove OutData Object First
 	FString PathName = Object->GetPathName();
 	UE_LOG(LogTemp, Log, TEXT("UGAssetManager::Recycle %s"), *PathName);
@@ -194,22 +311,17 @@ void UGAssetManager::Recycle(UObject* Object)
 
 void UGAssetManager::RecycleActor(AActor* Object)
 {
-	if (!Object)
+	if (!IsValid(Object))
 	{
 		return;
 	}
-	CheckObjectPool();	// Remove OutData Object First
-
-	UClass* pClass = Object->GetClass();
-	if (pClass == nullptr)
+	UGActorPoolSubsystem* ActorPool = UGActorPoolSubsystem::Get(Object);
+	if (ActorPool == nullptr)
 	{
+		Object->Destroy();
 		return;
 	}
-	FString PathName = pClass->GetPathName();
-	UE_LOG(LogTemp, Log, TEXT("UGAssetManager::Recycle %s"), *PathName);
-	FObjectPool& Value = ObjectPoolMap.FindOrAdd(PathName);
-	Value.IsActor = true;
-	Value.Add(Object);
+	ActorPool->Release(Object);
 }
 
 void UGAssetManager::BindStreamableCompleteDelegate(TSharedPtr<FStreamableHandle> StreamableHandle, TFunction<void(UObject*)> Callback) const
@@ -243,25 +355,46 @@ void UGAssetManager::StreamableCompleteDelegate(TSharedPtr<FStreamableHandle> St
 }
 
 void UGAssetManager::StreamableCompleteDelegates(TSharedPtr<FStreamableHandle> StreamableHandle,
-	TFunction<void(const TArray<UObject*>&)> Callback, TArray<UObject*> Caches, const TArray<FString>& PathStringArray)
+	TFunction<void(const TArray<UObject*>&)> Callback, const TSharedRef<FGAssetLoadBatch>& Batch)
 {
-	StreamableHandle->GetLoadedAssets(Caches);
-	TArray<UObject*> Result(nullptr, PathStringArray.Num());
-	for (UObject* Object : Caches)
+	Batch->Slots.Assign(Batch->Result);
+	if (Callback)
 	{
-		const FString PathName = Object->GetPathName();
-		for (int Index = 0; Index < PathStringArray.Num(); Index++)
-		{
-			if (PathName == PathStringArray[Index])
-			{
-				Result[Index] = Object;
-				break;
-			}
-		}
+		Callback(Batch->Result);
 	}
-	if (Callback)
+}
+
+void FGAssetLoadSlots::Reset(int32 NumSlots)
+{
+	FirstSlot.Reset();
+	FirstSlot.Reserve(NumSlots);
+	NextSlot.Init(INDEX_NONE, NumSlots);
+}
+
+void FGAssetLoadSlots::Add(const FSoftObjectPath& SoftObjectPath, int32 Slot)
+{
+	//路径直接做 key, 不拆包名资源名也不拼字符串
+	if (int32* First = FirstSlot.Find(SoftObjectPath))
 	{
-		Callback(Result);
+		NextSlot[Slot] = *First;
+		*First = Slot;
+	}
+	else
+	{
+		FirstSlot.Add(SoftObjectPath, Slot);
+	}
+}
+
+void FGAssetLoadSlots::Assign(TArray<UObject*>& Result) const
+{
+	//每个不同的路径只解析一次, 和 GetLoadedAssets 内部做的一样, 但不用再把对象反查回路径
+	for (const TPair<FSoftObjectPath, int32>& Pair : FirstSlot)
+	{
+		UObject* Object = Pair.Key.ResolveObject();
+		for (int32 Slot = Pair.Value; Slot != INDEX_NONE; Slot = NextSlot[Slot])
+		{
+			Result[Slot] = Object;
+		}
 	}
 }
 
@@ -272,25 +405,130 @@ void UGAssetManager::OnTick(float DeltaTime)
 
 void UGAssetManager::TickAssetDelayLoad(float DeltaTime)
 {
-	if(AssetDelayLoadQueue.IsEmpty())
+	SCOPE_CYCLE_COUNTER(STAT_GAssetManager_DelayLoadTick);
+
+	//每帧按优先级出队, 受数量和时间预算限制; 同一优先级相邻的请求合并成一次 RequestAsyncLoad
+	const double EndTime = FPlatformTime::Seconds() + DelayLoadBudgetMs * 0.001;
+	const int32 BatchSize = FMath::Max(MaxDelayLoadBatchSize, 1);
+	int32 RequestBudget = FMath::Max(MaxDelayLoadsPerFrame, 1);
+	bool bIssuedAny = false;
+
+	for (int32 PriorityIndex = 0; PriorityIndex < (int32)EGAssetLoadPriority::Num; PriorityIndex++)
 	{
-		return;
+		TArray<FGAssetDelayLoad>& Queue = AssetDelayLoadQueues[PriorityIndex];
+		TArray<FGAssetDelayLoad> Batch;
+		TArray<FSoftObjectPath> BatchPaths;
+		int32 Head = 0;
+		while (Head < Queue.Num() && RequestBudget > 0 && (!bIssuedAny || FPlatformTime::Seconds() < EndTime))
+		{
+			FGAssetDelayLoad& DelayLoad = Queue[Head++];
+			if (DelayLoad.IsCancelled())
+			{
+				DelayLoadStats.Cancelled++;
+				continue;
+			}
+
+			RequestBudget--;
+			bIssuedAny = true;
+			BatchPaths.AddUnique(DelayLoad.SoftObjectPath);
+			for (const FSoftObjectPath& Dependency : DelayLoad.Dependencies)
+			{
+				BatchPaths.AddUnique(Dependency);
+			}
+			Batch.Add(MoveTemp(DelayLoad));
+			if (BatchPaths.Num() >= BatchSize)
+			{
+				IssueDelayLoads(MoveTemp(Batch), MoveTemp(BatchPaths), (EGAssetLoadPriority)PriorityIndex);
+				Batch.Reset();
+				BatchPaths.Reset();
+			}
+		}
+
+		if (Batch.Num())
+		{
+			IssueDelayLoads(MoveTemp(Batch), MoveTemp(BatchPaths), (EGAssetLoadPriority)PriorityIndex);
+		}
+		Queue.RemoveAt(0, Head, false);
+		DelayLoadStats.Queued[PriorityIndex] = Queue.Num();
 	}
 
-	FGAssetDelayLoad AssetDelayLoad;
-	if(AssetDelayLoadQueue.Dequeue(AssetDelayLoad) == false)
+	SET_DWORD_STAT(STAT_GAssetManager_QueuedCritical, DelayLoadStats.Queued[(int32)EGAssetLoadPriority::Critical]);
+	SET_DWORD_STAT(STAT_GAssetManager_QueuedCosmetic, DelayLoadStats.Queued[(int32)EGAssetLoadPriority::Cosmetic]);
+	SET_DWORD_STAT(STAT_GAssetManager_QueuedPrefetch, DelayLoadStats.Queued[(int32)EGAssetLoadPriority::Prefetch]);
+}
+
+UGAssetManager::FGAssetDelayLoad& UGAssetManager::EnqueueDelayLoad(const FSoftObjectPath& SoftObjectPath, const TFunction<void(UObject*)>& Callback, EGAssetLoadPriority Priority, const UObject* Owner)
+{
+	const int32 PriorityIndex = FMath::Clamp((int32)Priority, 0, (int32)EGAssetLoadPriority::Num - 1);
+	FGAssetDelayLoad& DelayLoad = AssetDelayLoadQueues[PriorityIndex].Emplace_GetRef(SoftObjectPath, Callback, Owner);
+	DelayLoadStats.Queued[PriorityIndex] = AssetDelayLoadQueues[PriorityIndex].Num();
+	return DelayLoad;
+}
+
+void UGAssetManager::IssueDelayLoads(TArray<FGAssetDelayLoad>&& DelayLoads, TArray<FSoftObjectPath>&& Paths, EGAssetLoadPriority Priority)
+{
+	DelayLoadStats.Issued += DelayLoads.Num();
+	DelayLoadStats.Batches++;
+	INC_DWORD_STAT_BY(STAT_GAssetManager_Issued, DelayLoads.Num());
+
+	const TAsyncLoadPriority LoadPriority = Priority == EGAssetLoadPriority::Critical ? FStreamableManager::AsyncLoadHighPriority : FStreamableManager::DefaultAsyncLoadPriority;
+	const TSharedPtr<FStreamableHandle> Handle = GetStreamableManager().RequestAsyncLoad(MoveTemp(Paths), FStreamableDelegate(), LoadPriority);
+	TSharedRef<TArray<FGAssetDelayLoad>> Loads = MakeShared<TArray<FGAssetDelayLoad>>(MoveTemp(DelayLoads));
+	if (!Handle.IsValid() || Handle->HasLoadCompleted())
 	{
+		CompleteDelayLoads(*Loads);
+		if (Handle.IsValid())
+		{
+			Handle->ReleaseHandle();
+		}
 		return;
 	}
 
-	const TSharedPtr<FStreamableHandle> Handle = GetStreamableManager().RequestAsyncLoad(TArray<FSoftObjectPath>{AssetDelayLoad.SoftObjectPath});
-	BindStreamableCompleteDelegate(Handle, AssetDelayLoad.Callback);
+	FStreamableDelegate Delegate;
+	Delegate.BindLambda([this, Loads, Handle]()
+	{
+		CompleteDelayLoads(*Loads);
+		Handle->ReleaseHandle();
+	});
+	Handle->BindCompleteDelegate(MoveTemp(Delegate));
+}
+
+void UGAssetManager::CompleteDelayLoads(TArray<FGAssetDelayLoad>& DelayLoads)
+{
+	const double Now = FPlatformTime::Seconds();
+	for (FGAssetDelayLoad& DelayLoad : DelayLoads)
+	{
+		//加载期间 Owner 销毁了, 资源留在内存里, 只是不再回调
+		if (DelayLoad.IsCancelled())
+		{
+			DelayLoadStats.Cancelled++;
+			continue;
+		}
+
+		const double LatencyMs = (Now - DelayLoad.QueueTime) * 1000.0;
+		DelayLoadStats.Completed++;
+		DelayLoadStats.TotalLatencyMs += LatencyMs;
+		DelayLoadStats.MaxLatencyMs = FMath::Max(DelayLoadStats.MaxLatencyMs, LatencyMs);
+		SET_FLOAT_STAT(STAT_GAssetManager_MaxLatency, DelayLoadStats.MaxLatencyMs);
+
+		if (DelayLoad.Callback)
+		{
+			DelayLoad.Callback(DelayLoad.SoftObjectPath.ResolveObject());
+		}
+	}
+}
+
+void UGAssetManager::DumpDelayLoadStats() const
+{
+	const FGAssetDelayLoadStats& Stats = DelayLoadStats;
+	UE_LOG(LogTemp, Display, TEXT("UGAssetManager DelayLoad Queued Critical=%d Cosmetic=%d Prefetch=%d, Issued=%lld in %lld batches, Completed=%lld, Cancelled=%lld, Latency avg %.1f ms max %.1f ms"),
+		Stats.Queued[(int32)EGAssetLoadPriority::Critical], Stats.Queued[(int32)EGAssetLoadPriority::Cosmetic], Stats.Queued[(int32)EGAssetLoadPriority::Prefetch],
+		Stats.Issued, Stats.Batches, Stats.Completed, Stats.Cancelled,
+		Stats.Completed > 0 ? Stats.TotalLatencyMs / Stats.Completed : 0.0, Stats.MaxLatencyMs);
 }
 
 UObject* UGAssetManager::TryGetObjectFromPool(const FString& Path)
 {
-	//todo 异常崩溃
-	return nullptr;
 	FObjectPool* ObjectPool = ObjectPoolMap.Find(Path);
 	if (!ObjectPool)
 	{
@@ -304,9 +542,22 @@ void UGAssetManager::RegisterWorldBeginTearDown()
 	FWorldDelegates::OnWorldBeginTearDown.AddUObject(this, &UGAssetManager::OnWorldBeginTearDown);
 }
 
-void UGAssetManager::EmptyObjectPoolMap()
+void UGAssetManager::EmptyObjectPoolMap(UWorld* InWorld)
 {
-	ObjectPoolMap.Empty();
+	//只清理属于这个 World 的对象, 否则 Root 住的对象会让 World 无法释放
+	TArray<FString> EmptyKey;
+	for (auto& it : ObjectPoolMap)
+	{
+		if (it.Value.RemoveInWorld(InWorld) == 0)
+		{
+			EmptyKey.Add(it.Key);
+		}
+	}
+
+	for (FString& Key : EmptyKey)
+	{
+		ObjectPoolMap.Remove(Key);
+	}
 }
 
 void UGAssetManager::CheckObjectPool()
@@ -345,13 +596,16 @@ void UGAssetManager::FObjectPool::Add(UObject* Object)
 
 UObject* UGAssetManager::FObjectPool::Pop()
 {
-	if (ObjectCaches.Num())
+	while (ObjectCaches.Num())
 	{
 		auto Index = ObjectCaches.Num() - 1;
 		UObject* Object = ObjectCaches[Index].Object;
-		Object->RemoveFromRoot();
 		ObjectCaches.RemoveAtSwap(Index, 1, false);
-		return Object;
+		if (IsValid(Object))
+		{
+			Object->RemoveFromRoot();
+			return Object;
+		}
 	}
 	return nullptr;
 }
@@ -367,12 +621,10 @@ int UGAssetManager::FObjectPool::TickOutDate(float Seconds)
 			ObjectCache.Seconds -= Seconds;
 			continue;
 		}
-		UE_LOG(LogTemp, Log, TEXT("UGAssetManager Object Remove OutDate %s"), *ObjectCache.Object->GetName());
-		ObjectCache.Object->RemoveFromRoot();
-		if (IsActor)
+		UE_LOG(LogTemp, Log, TEXT("UGAssetManager Object Remove OutDate %s"), *GetNameSafe(ObjectCache.Object));
+		if (ObjectCache.Object)
 		{
-			AActor* pActor = Cast<AActor>(ObjectCache.Object);
-			pActor->Destroy();
+			ObjectCache.Object->RemoveFromRoot();
 		}
 		ObjectCache.Object = nullptr;
 		ObjectCaches.RemoveAtSwap(Index, 1, false);
@@ -380,15 +632,142 @@ int UGAssetManager::FObjectPool::TickOutDate(float Seconds)
 	return ObjectCaches.Num();
 }
 
+int UGAssetManager::FObjectPool::RemoveInWorld(UWorld* InWorld)
+{
+	for (int Index = ObjectCaches.Num() - 1; Index >= 0; Index--)
+	{
+		UObject* Object = ObjectCaches[Index].Object;
+		if (Object && InWorld && !Object->IsIn(InWorld))
+		{
+			continue;
+		}
+		if (Object)
+		{
+			Object->RemoveFromRoot();
+		}
+		ObjectCaches.RemoveAtSwap(Index, 1, false);
+	}
+	return ObjectCaches.Num();
+}
+
 UGAssetManager::FObjectPool::FObjectPool()
 {
-	IsActor = false;
 }
 
 UGAssetManager::FObjectPool::~FObjectPool()
 {
 	for (FObjectCache& ObjectCache : ObjectCaches)
 	{
-		ObjectCache.Object->RemoveFromRoot();
+		if (ObjectCache.Object)
+		{
+			ObjectCache.Object->RemoveFromRoot();
+		}
 	}
 }
+
+#if !UE_BUILD_SHIPPING
+/**
+ * G.AssetManager.BenchRequestAsyncLoad [Count]
+ * Loads up to Count assets under /Game through RequestAsyncLoad, checks every slot holds the asset that was asked for,
+ * and times the slot assembly against the old GetPathName / string compare matching on the same objects.
+ */
+static void BenchRequestAsyncLoad(const TArray<FString>& Args)
+{
+	UGAssetManager* AssetManager = UGAssetManager::Get();
+	if (!AssetManager)
+	{
+		return;
+	}
+
+	const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 2000;
+	TArray<FAssetData> Assets;
+	AssetManager->GetAssetRegistry().GetAssetsByPath(FName(TEXT("/Game")), Assets, true);
+
+	TArray<FSoftObjectPath> Paths;
+	for (int32 Index = 0; Index < Assets.Num() && Paths.Num() < Count; Index++)
+	{
+		Paths.Add(Assets[Index].ToSoftObjectPath());
+	}
+	//放几个重复的路径进去, 每个槽位都应该有结果
+	for (int32 Index = 0; Index < Paths.Num() && Index < 16; Index++)
+	{
+		Paths.Add(Paths[Index]);
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	AssetManager->RequestAsyncLoad(Paths, [Paths, StartTime](const TArray<UObject*>& Result)
+	{
+		const double LoadMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		int32 Loaded = 0;
+		int32 Mismatched = 0;
+		TArray<UObject*> LoadedObjects;
+		for (int32 Slot = 0; Slot < Result.Num(); Slot++)
+		{
+			if (!Result[Slot])
+			{
+				continue;
+			}
+			Loaded++;
+			LoadedObjects.AddUnique(Result[Slot]);
+			if (Result[Slot]->GetPathName() != Paths[Slot].ToString())
+			{
+				Mismatched++;
+			}
+		}
+
+		double SlotStart = FPlatformTime::Seconds();
+		FGAssetLoadSlots Slots;
+		Slots.Reset(Paths.Num());
+		for (int32 Slot = 0; Slot < Paths.Num(); Slot++)
+		{
+			Slots.Add(Paths[Slot], Slot);
+		}
+		TArray<UObject*> SlotResult;
+		SlotResult.SetNumZeroed(Paths.Num());
+		Slots.Assign(SlotResult);
+		const double SlotMs = (FPlatformTime::Seconds() - SlotStart) * 1000.0;
+
+		SlotStart = FPlatformTime::Seconds();
+		TArray<FString> PathStrings;
+		for (const FSoftObjectPath& Path : Paths)
+		{
+			PathStrings.Add(Path.ToString());
+		}
+		TArray<UObject*> LegacyResult;
+		LegacyResult.SetNumZeroed(Paths.Num());
+		for (UObject* Object : LoadedObjects)
+		{
+			const FString PathName = Object->GetPathName();
+			for (int32 Index = 0; Index < PathStrings.Num(); Index++)
+			{
+				if (PathName == PathStrings[Index])
+				{
+					LegacyResult[Index] = Object;
+					break;
+				}
+			}
+		}
+		const double LegacyMs = (FPlatformTime::Seconds() - SlotStart) * 1000.0;
+
+		UE_LOG(LogTemp, Display, TEXT("G.AssetManager.BenchRequestAsyncLoad: %d paths, %d loaded, %d mismatched, load %.1f ms. Assembly: slots %.3f ms, string match %.3f ms"),
+			Paths.Num(), Loaded, Mismatched, LoadMs, SlotMs, LegacyMs);
+	});
+}
+
+static FAutoConsoleCommand GAssetManagerBenchRequestAsyncLoadCommand(
+	TEXT("G.AssetManager.BenchRequestAsyncLoad"),
+	TEXT("Loads up to Count assets under /Game with RequestAsyncLoad, checks the result slots and times their assembly. Args: [Count=2000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchRequestAsyncLoad));
+
+static FAutoConsoleCommand GAssetManagerDelayLoadStatsCommand(
+	TEXT("G.AssetManager.DelayLoadStats"),
+	TEXT("Logs delay load queue depth per priority, issued / cancelled counts and latency."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (const UGAssetManager* AssetManager = UGAssetManager::Get())
+		{
+			AssetManager->DumpDelayLoadStats();
+		}
+	}));
+#endif
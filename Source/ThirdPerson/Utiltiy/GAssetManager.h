@@ -3,13 +3,62 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "AbleCore/Classes/ablAbilityDependencies.h"
+#include "Containers/Ticker.h"
 #include "Engine/AssetManager.h"
+#include "GActorPoolSubsystem.h"
 #include "GAssetManager.generated.h"
 
+//延迟加载的优先级, 每帧按顺序处理, 高优先级的先发出
+UENUM()
+enum class EGAssetLoadPriority : uint8
+{
+	//影响玩法, 用高优先级的 RequestAsyncLoad
+	Critical,
+	//特效, 模型等表现资源
+	Cosmetic,
+	//预加载, 前面的都处理完才轮到
+	Prefetch,
+	Num UMETA(Hidden)
+};
+
+struct FGAssetDelayLoadStats
+{
+	//当前排队数量
+	int32 Queued[(int32)EGAssetLoadPriority::Num] = {};
+	//已发出的请求数和合并后的 RequestAsyncLoad 次数
+	int64 Issued = 0;
+	int64 Batches = 0;
+	//Owner 已销毁, 没有回调
+	int64 Cancelled = 0;
+	int64 Completed = 0;
+	//从入队到回调
+	double TotalLatencyMs = 0.0;
+	double MaxLatencyMs = 0.0;
+};
+
+/**
+ * RequestAsyncLoad 的结果槽位, 请求时直接用 FSoftObjectPath 建好 路径 -> 槽位 的表, 加载完成后每个不同的路径 ResolveObject 一次放回槽位,
+ * 不再对每个对象 GetPathName 再和所有路径做字符串比较
+ */
+struct THIRDPERSON_API FGAssetLoadSlots
+{
+	void Reset(int32 NumSlots);
+	void Add(const FSoftObjectPath& SoftObjectPath, int32 Slot);
+	//把加载到的对象放进 Result 对应的槽位, 同一路径请求了多次的每个槽位都会放
+	void Assign(TArray<UObject*>& Result) const;
+
+private:
+	//5.0 还没有 FTopLevelAssetPath, FSoftObjectPath 本身按 (FName 资源路径, 子路径) 哈希, 子对象路径也一样处理
+	TMap<FSoftObjectPath, int32> FirstSlot;
+	//同一路径的下一个槽位, INDEX_NONE 结束
+	TArray<int32> NextSlot;
+};
+
 /**
  * 
  */
-UCLASS()
+UCLASS(Config = Game)
 class THIRDPERSON_API UGAssetManager : public UAssetManager
 {
 	GENERATED_BODY()
@@ -20,15 +69,26 @@ public:
 
 public:
 	UGAssetManager();
+	virtual void StartInitialLoading() override;
+	virtual void BeginDestroy() override;
 private:
 	void OnWorldBeginTearDown(UWorld* InWorld);
 public:
 	//异步加载纯资源文件
-	void AsyncLoadResource(const FString& AssetPath, const TFunction<void(UObject*)>& Callback, bool Delay = false);
-	void AsyncLoadResource(const FSoftObjectPath& SoftObjectPath, const TFunction<void(UObject*)>& Callback, bool Delay = false);
+	//Delay 为 true 时进入延迟加载队列, 按 Priority 分帧发出; Owner 销毁后不再加载也不回调
+	void AsyncLoadResource(const FString& AssetPath, const TFunction<void(UObject*)>& Callback, bool Delay = false,
+		EGAssetLoadPriority Priority = EGAssetLoadPriority::Cosmetic, const UObject* Owner = nullptr);
+	void AsyncLoadResource(const FSoftObjectPath& SoftObjectPath, const TFunction<void(UObject*)>& Callback, bool Delay = false,
+		EGAssetLoadPriority Priority = EGAssetLoadPriority::Cosmetic, const UObject* Owner = nullptr);
 	//异步加载蓝图类文件
-	void AsyncLoadBluePrint(const FString& Path, const TFunction<void(UObject*)>& Callback, bool Delay = false);
-	void AsyncLoadBluePrint(const FSoftClassPath& SoftClassPath, const TFunction<void(UObject*)>& Callback, bool Delay = false);
+	void AsyncLoadBluePrint(const FString& Path, const TFunction<void(UObject*)>& Callback, bool Delay = false,
+		EGAssetLoadPriority Priority = EGAssetLoadPriority::Cosmetic, const UObject* Owner = nullptr);
+	void AsyncLoadBluePrint(const FSoftClassPath& SoftClassPath, const TFunction<void(UObject*)>& Callback, bool Delay = false,
+		EGAssetLoadPriority Priority = EGAssetLoadPriority::Cosmetic, const UObject* Owner = nullptr);
+	//异步加载技能蓝图和清单 (AblAbilityManifest commandlet 生成) 里它依赖的资源, 合并成一次请求; 专用服务器跳过只在客户端用的资源
+	//不在清单里的技能和 AsyncLoadBluePrint 一样
+	void AsyncLoadAbility(const FSoftClassPath& SoftClassPath, const TFunction<void(UObject*)>& Callback, bool Delay = false,
+		EGAssetLoadPriority Priority = EGAssetLoadPriority::Critical, const UObject* Owner = nullptr);
 	//异步加载多个文件 
 	void RequestAsyncLoad(const TArray<FSoftObjectPath>& TargetsToStream, TFunction<void(const TArray<UObject*>&)> Callback);
 public:
@@ -38,8 +98,11 @@ public:
 	//同步加载蓝图类文件
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = UGAssetManager)
 	UObject* SyncLoadBluePrint(const FString& Path) const;
+	//回收对象, Actor 放回所在 World 的 UGActorPoolSubsystem
 	void Recycle(UObject* Object);
 	void RecycleActor(AActor* Object);
+	//当前的游戏 World
+	static UWorld* GetCurWorld();
 public:
 	template< class T >
 	static T* LoadClass(const FString& Path, UObject* Outer)
@@ -67,25 +130,22 @@ public:
 	template< class T >
 	static T* SpawnActor(const FSoftClassPath& SoftClassPath, UWorld* World = nullptr, const FActorSpawnParameters& SpawnParameters = FActorSpawnParameters())
 	{
-		//Find From Pool
-		FString path = SoftClassPath.GetAssetPathName().ToString();
-		UObject* pObject = UGAssetManager::Get()->TryGetObjectFromPool(path);
-		if (pObject != nullptr)
-		{
-			return Cast<T>(pObject);
-		}
-
-		//Spawn new Actor
 		if (!World)
 		{
 			World = GetCurWorld();
 		}
 		UClass* BlueprintVar = StaticLoadClass(T::StaticClass(), nullptr, *SoftClassPath.ToString());
-		if (BlueprintVar != nullptr)
+		if (BlueprintVar == nullptr || World == nullptr)
 		{
-			return World->SpawnActor<T>(BlueprintVar, SpawnParameters);
+			return nullptr;
 		}
-		return nullptr;
+
+		//Find From Pool
+		if (UGActorPoolSubsystem* ActorPool = World->GetSubsystem<UGActorPoolSubsystem>())
+		{
+			return ActorPool->Acquire<T>(BlueprintVar, FTransform::Identity, SpawnParameters);
+		}
+		return World->SpawnActor<T>(BlueprintVar, SpawnParameters);
 	}
 	template< class T >
 	void AsyncSpawnActor(const FString& Path, const TFunction<void(T*)>& Callback)
@@ -96,12 +156,10 @@ public:
 	template< class T >
 	void AsyncSpawnActor(const FSoftClassPath& SoftClassPath, const TFunction<void(T*)>& Callback, bool Delay = false)
 	{
-		//Find From Pool
-		FString path = SoftClassPath.GetAssetPathName().ToString();
-		UObject* pObject = UGAssetManager::Get()->TryGetObjectFromPool(path);
-		if (pObject != nullptr)
+		//Class already loaded, take it from the pool right away
+		if (SoftClassPath.ResolveClass() != nullptr)
 		{
-			T* pActor = Cast<T>(pObject);
+			T* pActor = SpawnActor<T>(SoftClassPath);
 			if (Callback)
 			{
 				Callback(pActor);
@@ -122,9 +180,11 @@ public:
 				return;
 			}
 			UBlueprintGeneratedClass* Class = Cast<UBlueprintGeneratedClass>(pObj);
-			if (Class)
+			UWorld* World = GetCurWorld();
+			if (Class && World)
 			{
-				T* Actor = GetCurWorld()->SpawnActor<T>(Class);
+				UGActorPoolSubsystem* ActorPool = World->GetSubsystem<UGActorPoolSubsystem>();
+				T* Actor = ActorPool ? ActorPool->Acquire<T>(Class, FTransform::Identity) : World->SpawnActor<T>(Class);
 				Callback(Actor);
 			}
 			else
@@ -203,33 +263,65 @@ public:
 	}
 private:
 	static void StreamableCompleteDelegate(TSharedPtr<FStreamableHandle> StreamableHandle, TFunction<void(UObject*)> Callback);
+	struct FGAssetLoadBatch
+	{
+		FGAssetLoadSlots Slots;
+		//池中取到的对象已经放在对应槽位
+		TArray<UObject*> Result;
+	};
 	static void StreamableCompleteDelegates(TSharedPtr<FStreamableHandle> StreamableHandle,
-		TFunction<void(const TArray<UObject*>&)> Callback, TArray<UObject*> Caches, const TArray<FString>& PathStringArray);
+		TFunction<void(const TArray<UObject*>&)> Callback, const TSharedRef<FGAssetLoadBatch>& Batch);
 	void BindStreamableCompleteDelegate(TSharedPtr<FStreamableHandle> StreamableHandle, TFunction<void(UObject*)> Callback) const;
 
 public:
 	void OnTick(float DeltaTime);
+	const FGAssetDelayLoadStats& GetDelayLoadStats() const { return DelayLoadStats; }
+	void DumpDelayLoadStats() const;
 private:
 	void TickAssetDelayLoad(float DeltaTime);
 private:
 	struct FGAssetDelayLoad
 	{
-		FGAssetDelayLoad(const FSoftObjectPath& InSoftObjectPath, const TFunction<void(UObject*)>& InCallback)
-			:SoftObjectPath(InSoftObjectPath), Callback(InCallback)
+		FGAssetDelayLoad(const FSoftObjectPath& InSoftObjectPath, const TFunction<void(UObject*)>& InCallback, const UObject* InOwner)
+			:SoftObjectPath(InSoftObjectPath), Callback(InCallback), Owner(InOwner), bHasOwner(InOwner != nullptr), QueueTime(FPlatformTime::Seconds())
 		{
 			
 		}
 		FGAssetDelayLoad(){}
+		bool IsCancelled() const { return bHasOwner && !Owner.IsValid(); }
 		FSoftObjectPath SoftObjectPath;
+		//和 SoftObjectPath 在同一个请求里加载, 不回调
+		TArray<FSoftObjectPath> Dependencies;
 		TFunction<void(UObject*)> Callback;
+		TWeakObjectPtr<const UObject> Owner;
+		bool bHasOwner = false;
+		double QueueTime = 0.0;
 	};
-	TQueue<FGAssetDelayLoad> AssetDelayLoadQueue;
+	FGAssetDelayLoad& EnqueueDelayLoad(const FSoftObjectPath& SoftObjectPath, const TFunction<void(UObject*)>& Callback, EGAssetLoadPriority Priority, const UObject* Owner);
+	void IssueDelayLoads(TArray<FGAssetDelayLoad>&& DelayLoads, TArray<FSoftObjectPath>&& Paths, EGAssetLoadPriority Priority);
+	void CompleteDelayLoads(TArray<FGAssetDelayLoad>& DelayLoads);
+	//每个优先级一个队列, 队头在前
+	TArray<FGAssetDelayLoad> AssetDelayLoadQueues[(int32)EGAssetLoadPriority::Num];
+	FGAssetDelayLoadStats DelayLoadStats;
+	FTSTicker::FDelegateHandle TickHandle;
+	//技能依赖清单, StartInitialLoading 时读取
+	FAblAbilityManifest AbilityManifest;
+
+	//每帧最多发出的延迟加载数
+	UPROPERTY(Config)
+	int32 MaxDelayLoadsPerFrame = 8;
+	//每帧处理延迟加载的时间预算 (毫秒), 至少发出一个
+	UPROPERTY(Config)
+	float DelayLoadBudgetMs = 1.0f;
+	//同一优先级相邻的请求合并成一次 RequestAsyncLoad, 最多这么多个资源
+	UPROPERTY(Config)
+	int32 MaxDelayLoadBatchSize = 8;
 	////////////////////
-		///ObjectPool
+		///ObjectPool, 只存放非 Actor 对象, Actor 由 UGActorPoolSubsystem 管理
 	UObject* TryGetObjectFromPool(const FString& Path);
 	void CheckObjectPool();
 	void RegisterWorldBeginTearDown();
-	void EmptyObjectPoolMap();
+	void EmptyObjectPoolMap(UWorld* InWorld);
 private:
 	struct FObjectCache
 	{
@@ -239,13 +331,13 @@ private:
 	struct FObjectPool
 	{
 		TArray<FObjectCache> ObjectCaches;
-		bool IsActor;
 
 		FObjectPool();
 		~FObjectPool();
 		void Add(UObject* Object);
 		UObject* Pop();
 		int TickOutDate(float Seconds);
+		int RemoveInWorld(UWorld* InWorld);
 	};
 private:
 	TMap<FString, FObjectPool> ObjectPoolMap;
@@ -9,6 +9,11 @@ public class ThirdPersonServerTarget : TargetRules
 	{
 		Type = TargetType.Server;
 		DefaultBuildSettings = BuildSettingsVersion.V2;
+
+		// Push model replication (see Net.IsPushModelEnabled in DefaultEngine.ini)
+		BuildEnvironment = TargetBuildEnvironment.Unique;
+		bWithPushModel = true;
+
 		ExtraModuleNames.Add("ThirdPerson");
 	}
 }